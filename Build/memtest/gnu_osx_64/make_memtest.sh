@@ -0,0 +1,3 @@
+#!/bin/bash
+rm -f *.o
+make -f ../Makefile gnu_osx_64
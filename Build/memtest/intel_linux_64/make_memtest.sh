@@ -0,0 +1,3 @@
+#!/bin/bash
+rm -f *.o
+make -f ../Makefile intel_linux_64
@@ -0,0 +1,3 @@
+#!/bin/bash
+rm -f *.o
+make -f ../Makefile intel_osx_64
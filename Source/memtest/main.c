@@ -0,0 +1,252 @@
+#define INMAIN
+#include "options.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "string_util.h"
+#include "file_util.h"
+#include "MALLOCC.h"
+#include "threadpool.h"
+#include "datadefs.h"
+
+#define LEN_BUFFER   1024
+#define MAX_LIVE     256
+#define LARGE_SIZE   65536
+
+// allocate/free microbenchmark for NewMemory and FreeMemory.  each of nthreads tasks makes
+// nops allocations of mostly small (1 to max_size bytes) and a few large blocks keeping
+// at most MAX_LIVE blocks alive.  the remote test frees blocks from a different thread than
+// the one that allocated them and the frame test allocates temporaries from a frame arena.
+// -malloc runs the same tests with malloc and free for comparison
+
+int nthreads = 0, nops = 1000000, max_size = 1024, use_malloc = 0;
+
+typedef struct _memtestdata {
+  int index;
+  unsigned int seed;
+  void *blocks[MAX_LIVE];
+} memtestdata;
+
+memtestdata memtestinfo[MAX_POOL_THREADS];
+
+/* ------------------ Usage ------------------------ */
+
+void Usage(char *prog, int option){
+ char githash[LEN_BUFFER];
+ char gitdate[LEN_BUFFER];
+
+  GetGitInfo(githash,gitdate);    // get githash
+
+  fprintf(stdout, "\n%s (%s) %s\n", prog, githash, __DATE__);
+  fprintf(stdout, "time multi-threaded memory allocation and frees\n\n");
+  fprintf(stdout, "Usage:\n");
+  fprintf(stdout, "  %s [-threads n] [-ops n] [-size n] [-malloc]\n", prog);
+  fprintf(stdout, "  -threads n - number of threads (default: number of processors)\n");
+  fprintf(stdout, "  -ops n     - allocations per thread (default: %i)\n", nops);
+  fprintf(stdout, "  -size n    - largest small block in bytes (default: %i)\n", max_size);
+  fprintf(stdout, "  -malloc    - use malloc and free instead of NewMemory and FreeMemory\n");
+  UsageCommon(HELP_SUMMARY);
+  if(option == HELP_ALL){
+    UsageCommon(HELP_ALL);
+  }
+}
+
+/* ------------------ GetRandom ------------------------ */
+
+unsigned int GetRandom(unsigned int *seed){
+  *seed = 1664525*(*seed)+1013904223;
+  return *seed>>8;
+}
+
+/* ------------------ GetBlockSize ------------------------ */
+
+size_t GetBlockSize(unsigned int *seed){
+  unsigned int r;
+
+  r = GetRandom(seed);
+  if(r%100==0)return LARGE_SIZE+r%LARGE_SIZE;
+  return 1+r%max_size;
+}
+
+/* ------------------ AllocBlock ------------------------ */
+
+void *AllocBlock(size_t size){
+  void *block;
+
+  if(use_malloc==1){
+    block = malloc(size);
+  }
+  else{
+    NewMemory(&block, size);
+  }
+  if(block!=NULL)*(char *)block = 1;
+  return block;
+}
+
+/* ------------------ FreeBlock ------------------------ */
+
+void FreeBlock(void *block){
+  if(block==NULL)return;
+  if(use_malloc==1){
+    free(block);
+  }
+  else{
+    FreeMemory(block);
+  }
+}
+
+/* ------------------ MtLocalTest ------------------------ */
+
+void *MtLocalTest(void *arg){
+  memtestdata *mi;
+  int i;
+
+  mi = (memtestdata *)arg;
+  memset(mi->blocks, 0, sizeof(mi->blocks));
+  for(i = 0; i<nops; i++){
+    int islot;
+
+    islot = GetRandom(&mi->seed)%MAX_LIVE;
+    FreeBlock(mi->blocks[islot]);
+    mi->blocks[islot] = AllocBlock(GetBlockSize(&mi->seed));
+  }
+  for(i = 0; i<MAX_LIVE; i++){
+    FreeBlock(mi->blocks[i]);
+    mi->blocks[i] = NULL;
+  }
+  return NULL;
+}
+
+/* ------------------ MtRemoteAlloc ------------------------ */
+
+void *MtRemoteAlloc(void *arg){
+  memtestdata *mi;
+  int i;
+
+  mi = (memtestdata *)arg;
+  for(i = 0; i<MAX_LIVE; i++){
+    mi->blocks[i] = AllocBlock(GetBlockSize(&mi->seed));
+  }
+  return NULL;
+}
+
+/* ------------------ MtRemoteFree ------------------------ */
+
+void *MtRemoteFree(void *arg){
+
+// free the blocks allocated by the previous task (usually on another thread)
+
+  memtestdata *mi, *mfrom;
+  int i;
+
+  mi = (memtestdata *)arg;
+  mfrom = memtestinfo+(mi->index+nthreads-1)%nthreads;
+  for(i = 0; i<MAX_LIVE; i++){
+    FreeBlock(mfrom->blocks[i]);
+    mfrom->blocks[i] = NULL;
+  }
+  return NULL;
+}
+
+/* ------------------ MtFrameTest ------------------------ */
+
+void *MtFrameTest(void *arg){
+  memtestdata *mi;
+  framearenadata *fa;
+  int i;
+
+  mi = (memtestdata *)arg;
+  fa = GetFrameArena();
+  for(i = 0; i<nops; i++){
+    char *block;
+
+    if(i%MAX_LIVE==0)FrameArenaReset(fa);
+    block = FrameArenaAlloc(fa, GetBlockSize(&mi->seed));
+    if(block!=NULL)*block = 1;
+  }
+  FrameArenaReset(fa);
+  return NULL;
+}
+
+/* ------------------ RunTasks ------------------------ */
+
+void RunTasks(char *label, void *(*func)(void *)){
+  taskdata *tasks[MAX_POOL_THREADS];
+  int i;
+
+  for(i = 0; i<nthreads; i++){
+    tasks[i] = ThreadPoolSubmit(label, func, memtestinfo+i);
+  }
+  ThreadPoolWaitAll(tasks, nthreads);
+}
+
+/* ------------------ PrintTime ------------------------ */
+
+void PrintTime(char *label, double elapsed, int ops){
+  if(elapsed<=0.0)return;
+  printf("%-8s %3i threads %10.3f s %12.0f ops/s\n", label, nthreads, elapsed, (double)ops*nthreads/elapsed);
+}
+
+/* ------------------ main ------------------------ */
+
+int main(int argc, char **argv){
+  int i, nrounds;
+  double start;
+
+  initMALLOC();
+  SetStdOut(stdout);
+
+  ParseCommonOptions(argc, argv);
+  if(show_help!=0){
+    Usage("memtest", show_help);
+    return 1;
+  }
+  if(show_version==1){
+    PRINTVERSION("memtest", argv[0]);
+    return 1;
+  }
+  for(i = 1; i<argc; i++){
+    if(strcmp(argv[i], "-threads")==0&&i+1<argc){
+      sscanf(argv[++i], "%i", &nthreads);
+    }
+    else if(strcmp(argv[i], "-ops")==0&&i+1<argc){
+      sscanf(argv[++i], "%i", &nops);
+    }
+    else if(strcmp(argv[i], "-size")==0&&i+1<argc){
+      sscanf(argv[++i], "%i", &max_size);
+    }
+    else if(strcmp(argv[i], "-malloc")==0){
+      use_malloc = 1;
+    }
+  }
+  if(max_size<1)max_size = 1;
+  if(nops<1)nops = 1;
+  nthreads = ThreadPoolInit(nthreads);
+  for(i = 0; i<nthreads; i++){
+    memtestinfo[i].index = i;
+    memtestinfo[i].seed = i+1;
+  }
+
+  printf("%s, %i ops per thread, blocks of 1 to %i bytes\n", use_malloc==1 ? "malloc/free" : "NewMemory/FreeMemory", nops, max_size);
+
+  start = GetWallTime();
+  RunTasks("local", MtLocalTest);
+  PrintTime("local", GetWallTime()-start, nops);
+
+  // blocks allocated by one task are freed by another
+
+  nrounds = MAX(nops/MAX_LIVE, 1);
+  start = GetWallTime();
+  for(i = 0; i<nrounds; i++){
+    RunTasks("alloc", MtRemoteAlloc);
+    RunTasks("remote", MtRemoteFree);
+  }
+  PrintTime("remote", GetWallTime()-start, nrounds*MAX_LIVE);
+
+  if(use_malloc==0){
+    start = GetWallTime();
+    RunTasks("frame", MtFrameTest);
+    PrintTime("frame", GetWallTime()-start, nops);
+  }
+  return 0;
+}
@@ -32,20 +32,51 @@ typedef char bbyte;
 #define MMEXTERN extern MMCCC
 #endif
 
-#ifdef pp_MEMDEBUG
 #define MMsize unsigned long long
-#endif
+
+// memory ids tag blocks belonging to one loaded file so the memory used by the file
+// (GetMemoryIdBytes) and by each type of file (GetMemoryTypeBytes) is known and so
+// FreeAllMemory(memory_id) can free the file's blocks.  blocks allocated with a memory_id
+// of 0 get the calling thread's current id (set by SetMemoryId), blocks allocated with
+// MEMORY_ID_UNTAGGED are not counted against any file
+
+#define MEMORY_ID_UNTAGGED -1
+
+#define MAX_MEMORY_TYPES 16
 
 typedef struct {
   unsigned char marker;
   void *prev, *next;
   int memory_id;
-#ifdef pp_MEMPRINT
-  size_t size;
+#ifndef pp_MEMDEBUG
+  int size_class;
+  void *arena, *free_next;
 #endif
+  size_t size;
 
 } MMdata;
 
+// a frame arena hands out temporary buffers from a list of chunks.  the buffers are released
+// all at once by FrameArenaReset or back to a position saved by FrameArenaMark, both O(1).
+// chunks of FRAME_ARENA_CHUNK bytes are kept for reuse until FrameArenaFree is called, larger
+// chunks are freed when they are released
+
+#define FRAME_ARENA_CHUNK 1048576
+
+typedef struct _framechunkdata {
+  struct _framechunkdata *next;
+  size_t size, used;
+} framechunkdata;
+
+typedef struct _framearenadata {
+  framechunkdata *first, *current;
+} framearenadata;
+
+typedef struct _framemarkdata {
+  framechunkdata *chunk;
+  size_t used;
+} framemarkdata;
+
 MMEXTERN MMdata MMfirst, MMlast;
 MMEXTERN MMdata *MMfirstptr, *MMlastptr;
 #ifdef pp_MEMDEBUG
@@ -74,7 +105,7 @@ MMEXTERN pthread_mutex_t mutexSLICE_BOUND,mutexPATCH_BOUND,mutexPART2ISO,mutexPR
 #define ResizeMemory(f,g)        __ResizeMemory((f),(g),0,(#f),__FILE__,__LINE__)
 
 #define NewMemoryMemID(f,g,h)    __NewMemory((f),(g),(h),(#f),__FILE__,__LINE__)
-#define ResizeMemoryMemID(f,g,h) __ResizeMemory((f),(g),(j),(#f),__FILE__,__LINE__)
+#define ResizeMemoryMemID(f,g,h) __ResizeMemory((f),(g),(h),(#f),__FILE__,__LINE__)
 #else
 #define NewMemory(f,g)           _NewMemory((f),(g),0,(#f),__FILE__,__LINE__)
 #define ResizeMemory(f,g)        _ResizeMemory((f),(g),0,(#f),__FILE__,__LINE__)
@@ -112,8 +143,8 @@ void _memorystatus(unsigned int size,unsigned int *availmem, unsigned int *memus
 #define PrintMemoryInfo
 #endif
 
-#ifdef pp_MEMDEBUG
 void getMemusage(MMsize totalmemory,char *MEMlabel);
+#ifdef pp_MEMDEBUG
 void _CheckMemory(void);
 void _CheckMemoryNOTHREAD(void);
 void _CheckMemoryOn(void);
@@ -175,5 +206,18 @@ void initMALLOC(void);
 void FreeAllMemory(int memory_id);
 mallocflag _ValidPointer(void *pv, size_t size);
 
-#define FREEMEMORY(f) if((f)!=NULL){LOCK_MEM;FreeMemoryNOTHREAD((f));UNLOCK_MEM;(f)=NULL;}
+MMEXTERN int NewMemoryId(int memory_type);
+MMEXTERN int SetMemoryId(int memory_id);
+MMEXTERN int GetMemoryIdType(int memory_id);
+MMEXTERN MMsize GetMemoryIdBytes(int memory_id);
+MMEXTERN void GetMemoryTypeBytes(MMsize *type_bytes);
+
+MMEXTERN framearenadata *GetFrameArena(void);
+MMEXTERN void *FrameArenaAlloc(framearenadata *fa, size_t size);
+MMEXTERN framemarkdata FrameArenaMark(framearenadata *fa);
+MMEXTERN void FrameArenaRelease(framearenadata *fa, framemarkdata mark);
+MMEXTERN void FrameArenaReset(framearenadata *fa);
+MMEXTERN void FrameArenaFree(framearenadata *fa);
+
+#define FREEMEMORY(f) if((f)!=NULL){FreeMemory((f));(f)=NULL;}
 #endif
@@ -4,6 +4,7 @@
 #include <string.h>
 
 #include "MALLOCC.h"
+#include "datadefs.h"
 #include "compress.h"
 
 #define MARK 255
@@ -66,35 +67,163 @@ unsigned int CompressRLE(unsigned char *buffer_in, int nchars_in, unsigned char
   return buffer_out-buffer_start;
 }
 
-/* ------------------ UnCompressRLE ------------------------ */
+/* ------------------ FirstNonZero ------------------------ */
 
-unsigned int UnCompressRLE(unsigned char *buffer_in, int nchars_in, unsigned char *buffer_out){
-  int nrepeats,nn;
-  unsigned char thischar, *buffer_in_end;
+static int FirstNonZero(unsigned char *buffer, int n){
 
-  nn=0;
-  buffer_in_end  = buffer_in  + nchars_in;
+// index of the first non-zero byte of buffer, -1 if all n bytes are zero.  zeros are skipped 8 bytes at a time
 
-  while(buffer_in<buffer_in_end){
-    if(*buffer_in==MARK){
-      if(buffer_in+2>=buffer_in_end)break;
-      buffer_in++;
-      thischar=*buffer_in++;
-      nrepeats=*buffer_in++;
-      nn+=nrepeats;
-      memset(buffer_out,thischar,nrepeats);
-      buffer_out+=nrepeats;
+  int i;
+
+  for(i = 0; i+8<=n; i += 8){
+    unsigned long long word;
+
+    memcpy(&word, buffer+i, 8);
+    if(word!=0)break;
+  }
+  for(; i<n; i++){
+    if(buffer[i]!=0)return i;
+  }
+  return -1;
+}
+
+/* ------------------ LastNonZero ------------------------ */
+
+static int LastNonZero(unsigned char *buffer, int n){
+
+// index of the last non-zero byte of buffer, -1 if all n bytes are zero
+
+  int i;
+
+  for(i = n; i>=8; i -= 8){
+    unsigned long long word;
+
+    memcpy(&word, buffer+i-8, 8);
+    if(word!=0)break;
+  }
+  for(; i>0; i--){
+    if(buffer[i-1]!=0)return i-1;
+  }
+  return -1;
+}
+
+/* ------------------ AddBoxRow ------------------------ */
+
+static void AddBoxRow(int *box, int row, int i1, int i2, int ny){
+  int j, k;
+
+  k = row/ny;
+  j = row-k*ny;
+  if(box[0]<0){
+    box[0] = i1;
+    box[1] = i2;
+    box[2] = j;
+    box[3] = j;
+    box[4] = k;
+    box[5] = k;
+    return;
+  }
+  box[0] = MIN(box[0], i1);
+  box[1] = MAX(box[1], i2);
+  box[2] = MIN(box[2], j);
+  box[3] = MAX(box[3], j);
+  box[4] = MIN(box[4], k);
+  box[5] = MAX(box[5], k);
+}
+
+/* ------------------ AddBoxSegment ------------------------ */
+
+static void AddBoxSegment(unsigned char *buffer, int offset, int nbuffer, int *dims, int *box){
+
+// add the non-zero bytes of buffer (nbuffer bytes starting at offset offset of a dims[0] x dims[1] x dims[2]
+// array) to the bounding box.  if buffer is NULL all nbuffer bytes are non-zero (an RLE run).
+// the segment is split into rows, the non-zero bytes of a row are bounded by its first and last non-zero byte
+
+  int nx, ny, row, i;
+
+  nx = dims[0];
+  ny = dims[1];
+  row = offset/nx;
+  i = offset-row*nx;
+  while(nbuffer>0){
+    int npiece;
+
+    npiece = MIN(nbuffer, nx-i);
+    if(buffer==NULL){
+      AddBoxRow(box, row, i, i+npiece-1, ny);
     }
     else{
-      *buffer_out++=*buffer_in++;
-      nn++;
+      int first;
+
+      first = FirstNonZero(buffer, npiece);
+      if(first>=0)AddBoxRow(box, row, i+first, i+first+LastNonZero(buffer+first, npiece-first), ny);
+      buffer += npiece;
     }
+    nbuffer -= npiece;
+    row++;
+    i = 0;
+  }
+}
+
+/* ------------------ GetFrameBox ------------------------ */
+
+void GetFrameBox(unsigned char *buffer, int nbuffer, int *dims, int *box){
+
+// bounding box (imin, imax, jmin, jmax, kmin, kmax) of the non-zero bytes of a dims[0] x dims[1] x dims[2]
+// array, box[0] is -1 if all bytes are zero
+
+  box[0] = -1;
+  AddBoxSegment(buffer, 0, nbuffer, dims, box);
+}
+
+/* ------------------ UnCompressRLEBox ------------------------ */
 
+unsigned int UnCompressRLEBox(unsigned char *buffer_in, int nchars_in, unsigned char *buffer_out, int *dims, int *box){
 
+// RLE decode buffer_in.  if box is not NULL the bounding box of the non-zero output bytes is found in the
+// same pass (see GetFrameBox).  literal bytes between run MARKs are found with memchr and copied as a block
+
+  int nn;
+  unsigned char *buffer_in_end;
+
+  nn = 0;
+  buffer_in_end = buffer_in+nchars_in;
+  if(box!=NULL)box[0] = -1;
+
+  while(buffer_in<buffer_in_end){
+    unsigned char *mark;
+    int nliteral;
+
+    mark = (unsigned char *)memchr(buffer_in, MARK, buffer_in_end-buffer_in);
+    nliteral = (mark==NULL ? buffer_in_end : mark)-buffer_in;
+    if(nliteral>0){
+      memcpy(buffer_out+nn, buffer_in, nliteral);
+      if(box!=NULL)AddBoxSegment(buffer_in, nn, nliteral, dims, box);
+      nn += nliteral;
+      buffer_in += nliteral;
+    }
+    if(mark==NULL||buffer_in+2>=buffer_in_end)break;
+    {
+      unsigned char thischar;
+      int nrepeats;
+
+      thischar = buffer_in[1];
+      nrepeats = buffer_in[2];
+      buffer_in += 3;
+      memset(buffer_out+nn, thischar, nrepeats);
+      if(box!=NULL&&thischar!=0&&nrepeats>0)AddBoxSegment(NULL, nn, nrepeats, dims, box);
+      nn += nrepeats;
+    }
   }
   return nn;
 }
 
+/* ------------------ UnCompressRLE ------------------------ */
+
+unsigned int UnCompressRLE(unsigned char *buffer_in, int nchars_in, unsigned char *buffer_out){
+  return UnCompressRLEBox(buffer_in, nchars_in, buffer_out, NULL, NULL);
+}
+
 /* ------------------ CompressVolSliceFrame ------------------------ */
 
 void CompressVolSliceFrame(float *data_in, int n_data_in, float timeval_in, float *vmin_in, float *vmax_in,
@@ -8,6 +8,8 @@ int CompressZLIB(unsigned char *dest, uLongf *destLen, unsigned char *source, in
 int UnCompressZLIB(unsigned char *dest, uLongf *destLen, unsigned char *source, int sourceLen);
 unsigned int CompressRLE(unsigned char *buffer_in, int nchars_in, unsigned char *buffer_out);
 unsigned int UnCompressRLE(unsigned char *buffer_in, int nchars_in, unsigned char *buffer_out);
+unsigned int UnCompressRLEBox(unsigned char *buffer_in, int nchars_in, unsigned char *buffer_out, int *dims, int *box);
+void GetFrameBox(unsigned char *buffer, int nbuffer, int *dims, int *box);
 void CompressVolSliceFrame(float *data_in, int n_data_in,
                 float timeval_in, float *vmin_in, float *vmax_in,
                 unsigned char **compressed_data_out, uLongf *ncompressed_data_out);
@@ -4,6 +4,7 @@
 #include <string.h>
 #include <stdio.h>
 #include "MALLOCC.h"
+#include "datadefs.h"
 #ifdef pp_MEMDEBUG
 static int checkmemoryflag=1;
 #endif
@@ -65,10 +66,349 @@ void _memorystatus(unsigned int size,unsigned int *availmem,unsigned int *physme
 #endif
 #endif
 
+#ifndef pp_MEMDEBUG
+
+// each thread allocates from its own arena so NewMemory and FreeMemory do not contend on a
+// global lock.  an arena keeps a list of its live blocks (used by FreeAllMemory) and caches
+// freed blocks in power of two size classes from MEM_MIN_CLASS to MEM_MAX_CLASS bytes.
+// a small block freed by a thread other than its owner is pushed without locking onto the
+// owning arena's remote free list which the owner drains when it next allocates.  the arena
+// of a thread that exits is orphaned and adopted by the next thread that needs an arena.
+
+#define MEM_NCLASSES    9
+#define MEM_MIN_CLASS  16
+#define MEM_MAX_CLASS  (MEM_MIN_CLASS<<(MEM_NCLASSES-1))
+#define MEM_MAX_CACHED 64
+#define MEM_CLASS_SIZE(sizeclass) ((size_t)MEM_MIN_CLASS<<(sizeclass))
+
+typedef struct _memarenadata {
+  MMdata first, last;
+  MMdata *cache[MEM_NCLASSES];
+  int ncache[MEM_NCLASSES], orphaned, memory_id;
+  void *volatile remote_free;
+  framearenadata frame;
+#ifdef pp_THREAD
+  pthread_mutex_t mutex;
+#endif
+  struct _memarenadata *next;
+} memarenadata;
+
+static memarenadata *arena_list = NULL;
+
+#ifdef pp_THREAD
+static pthread_key_t arena_key;
+#define LOCK_ARENA(a)   pthread_mutex_lock(&(a)->mutex)
+#define UNLOCK_ARENA(a) pthread_mutex_unlock(&(a)->mutex)
+#ifdef WIN32
+#define MEM_CAS(ptr, oldval, newval) (InterlockedCompareExchangePointer((PVOID volatile *)(ptr), (newval), (oldval))==(oldval))
+#else
+#define MEM_CAS(ptr, oldval, newval) __sync_bool_compare_and_swap((ptr), (oldval), (newval))
+#endif
+#else
+#define LOCK_ARENA(a)
+#define UNLOCK_ARENA(a)
+#endif
+
+#define LOCK_MEMDEBUG
+#define UNLOCK_MEMDEBUG
+#else
+#define LOCK_MEMDEBUG   LOCK_MEM;
+#define UNLOCK_MEMDEBUG UNLOCK_MEM;
+#ifdef pp_THREAD
+static pthread_key_t frame_arena_key;
+
+/* ------------------ FrameArenaThreadExit ------------------------ */
+
+static void FrameArenaThreadExit(void *arg){
+  FrameArenaFree((framearenadata *)arg);
+  free(arg);
+}
+#endif
+#endif
+
+#ifndef pp_MEMDEBUG
+
+/* ------------------ GetSizeClass ------------------------ */
+
+static int GetSizeClass(size_t size){
+  int sizeclass;
+
+  if(size>MEM_MAX_CLASS)return -1;
+  for(sizeclass = 0; MEM_CLASS_SIZE(sizeclass)<size; sizeclass++){
+  }
+  return sizeclass;
+}
+
+/* ------------------ NewArena ------------------------ */
+
+static memarenadata *NewArena(void){
+  memarenadata *arena;
+
+  arena = (memarenadata *)calloc(1, sizeof(memarenadata));
+  if(arena==NULL)return NULL;
+  arena->first.prev = NULL;
+  arena->first.next = &arena->last;
+  arena->last.prev = &arena->first;
+  arena->last.next = NULL;
+#ifdef pp_THREAD
+  pthread_mutex_init(&arena->mutex, NULL);
+#endif
+  arena->next = arena_list;
+  arena_list = arena;
+  return arena;
+}
+
+/* ------------------ ReleaseBlock ------------------------ */
+
+static void ReleaseBlock(memarenadata *arena, MMdata *this_ptr){
+
+// unlink a block from its arena's live list and cache or free it.  the arena must be locked
+
+  MMdata *prev_ptr, *next_ptr;
+  int sizeclass;
+
+  prev_ptr = this_ptr->prev;
+  next_ptr = this_ptr->next;
+  prev_ptr->next = next_ptr;
+  next_ptr->prev = prev_ptr;
+  this_ptr->marker = 0;
+
+  sizeclass = this_ptr->size_class;
+  if(sizeclass>=0&&arena->ncache[sizeclass]<MEM_MAX_CACHED){
+    this_ptr->free_next = arena->cache[sizeclass];
+    arena->cache[sizeclass] = this_ptr;
+    arena->ncache[sizeclass]++;
+  }
+  else{
+    free(this_ptr);
+  }
+}
+
+/* ------------------ DrainRemoteFrees ------------------------ */
+
+static void DrainRemoteFrees(memarenadata *arena){
+
+// release the blocks other threads have freed.  the arena must be locked
+
+#ifdef pp_THREAD
+  MMdata *this_ptr, *next_ptr;
+  void *head;
+
+  do{
+    head = arena->remote_free;
+  } while(!MEM_CAS(&arena->remote_free, head, NULL));
+  for(this_ptr = head; this_ptr!=NULL; this_ptr = next_ptr){
+    next_ptr = this_ptr->free_next;
+    ReleaseBlock(arena, this_ptr);
+  }
+#endif
+}
+
+#ifdef pp_THREAD
+/* ------------------ ArenaThreadExit ------------------------ */
+
+static void ArenaThreadExit(void *arg){
+  memarenadata *arena;
+
+  arena = (memarenadata *)arg;
+  FrameArenaFree(&arena->frame);
+  LOCK_ARENA(arena);
+  arena->orphaned = 1;
+  DrainRemoteFrees(arena);
+  UNLOCK_ARENA(arena);
+}
+#endif
+
+/* ------------------ GetMemArena ------------------------ */
+
+static memarenadata *GetMemArena(void){
+#ifdef pp_THREAD
+  memarenadata *arena;
+
+  arena = (memarenadata *)pthread_getspecific(arena_key);
+  if(arena!=NULL)return arena;
+
+  // first allocation by this thread, adopt an orphaned arena or make a new one
+
+  LOCK_MEM;
+  for(arena = arena_list; arena!=NULL; arena = arena->next){
+    if(arena->orphaned==1)break;
+  }
+  if(arena==NULL){
+    arena = NewArena();
+  }
+  else{
+    LOCK_ARENA(arena);
+    arena->orphaned = 0;
+    UNLOCK_ARENA(arena);
+  }
+  UNLOCK_MEM;
+  if(arena!=NULL)pthread_setspecific(arena_key, arena);
+  return arena;
+#else
+  if(arena_list==NULL)NewArena();
+  return arena_list;
+#endif
+}
+#endif
+
+// bytes in use for each memory id.  the counters are kept in fixed size chunks so they can
+// be updated without a lock while NewMemoryId adds ids
+
+#define MEMID_CHUNK      1024
+#define MAX_MEMID_CHUNKS 1024
+
+typedef struct _memiddata {
+  volatile long long bytes;
+  int type;
+} memiddata;
+
+static memiddata memid_untagged, *memid_chunks[MAX_MEMID_CHUNKS];
+static int nmemids = 0;
+#ifdef pp_MEMDEBUG
+static int memid_current = 0;
+#endif
+
+/* ------------------ GetMemIdData ------------------------ */
+
+static memiddata *GetMemIdData(int memory_id){
+  memiddata *chunk;
+
+  if(memory_id<=0||memory_id>nmemids)return &memid_untagged;
+  chunk = memid_chunks[memory_id/MEMID_CHUNK];
+  if(chunk==NULL)return &memid_untagged;
+  return chunk+memory_id%MEMID_CHUNK;
+}
+
+/* ------------------ AddMemoryBytes ------------------------ */
+
+static void AddMemoryBytes(int memory_id, long long nbytes){
+  memiddata *mi;
+
+  mi = GetMemIdData(memory_id);
+#ifdef pp_THREAD
+#ifdef WIN32
+  InterlockedExchangeAdd64((LONGLONG volatile *)&mi->bytes, nbytes);
+#else
+  __sync_fetch_and_add(&mi->bytes, nbytes);
+#endif
+#else
+  mi->bytes += nbytes;
+#endif
+}
+
+/* ------------------ GetCurrentMemoryId ------------------------ */
+
+static int GetCurrentMemoryId(void){
+#ifdef pp_MEMDEBUG
+  return memid_current;
+#else
+  memarenadata *arena;
+
+  arena = GetMemArena();
+  return (arena==NULL ? 0 : arena->memory_id);
+#endif
+}
+
+/* ------------------ NewMemoryId ------------------------ */
+
+int NewMemoryId(int memory_type){
+
+// return a new memory id for a file of type memory_type, 0 (untagged) if the ids are used up
+
+  int memory_id, ichunk;
+
+  LOCK_MEM;
+  memory_id = nmemids+1;
+  ichunk = memory_id/MEMID_CHUNK;
+  if(ichunk>=MAX_MEMID_CHUNKS){
+    UNLOCK_MEM;
+    return 0;
+  }
+  if(memid_chunks[ichunk]==NULL){
+    memid_chunks[ichunk] = (memiddata *)calloc(MEMID_CHUNK, sizeof(memiddata));
+    if(memid_chunks[ichunk]==NULL){
+      UNLOCK_MEM;
+      return 0;
+    }
+  }
+  memid_chunks[ichunk][memory_id%MEMID_CHUNK].type = CLAMP(memory_type, 0, MAX_MEMORY_TYPES-1);
+  nmemids = memory_id;
+  UNLOCK_MEM;
+  return memory_id;
+}
+
+/* ------------------ SetMemoryId ------------------------ */
+
+int SetMemoryId(int memory_id){
+
+// blocks the calling thread allocates without a memory id are tagged with memory_id.
+// returns the previous id so it can be restored
+
+  int memory_id_old;
+#ifdef pp_MEMDEBUG
+
+  memory_id_old = memid_current;
+  memid_current = memory_id;
+#else
+  memarenadata *arena;
+
+  arena = GetMemArena();
+  if(arena==NULL)return 0;
+  memory_id_old = arena->memory_id;
+  arena->memory_id = memory_id;
+#endif
+  return memory_id_old;
+}
+
+/* ------------------ GetMemoryIdType ------------------------ */
+
+int GetMemoryIdType(int memory_id){
+  return GetMemIdData(memory_id)->type;
+}
+
+/* ------------------ GetMemoryIdBytes ------------------------ */
+
+MMsize GetMemoryIdBytes(int memory_id){
+  long long nbytes;
+
+  nbytes = GetMemIdData(memory_id)->bytes;
+  return (MMsize)MAX(nbytes, 0);
+}
+
+/* ------------------ GetMemoryTypeBytes ------------------------ */
+
+void GetMemoryTypeBytes(MMsize *type_bytes){
+
+// bytes in use by each type of memory id (MAX_MEMORY_TYPES entries), untagged blocks are type 0
+
+  int i;
+
+  for(i = 0; i<MAX_MEMORY_TYPES; i++){
+    type_bytes[i] = 0;
+  }
+  for(i = 0; i<=nmemids; i++){
+    memiddata *mi;
+
+    mi = GetMemIdData(i);
+    if(mi->bytes>0)type_bytes[mi->type] += (MMsize)mi->bytes;
+  }
+}
+
 /* ------------------ initMALLOC ------------------------ */
 
 void initMALLOC(void){
 
+#ifndef pp_MEMDEBUG
+  if(arena_list!=NULL)return;
+#ifdef pp_THREAD
+  pthread_mutex_init(&mutexMEM,NULL);
+  pthread_key_create(&arena_key, ArenaThreadExit);
+#endif
+  GetMemArena();
+  MMfirstptr=&arena_list->first;
+  MMlastptr=&arena_list->last;
+#else
   MMfirstptr=&MMfirst;
   MMlastptr=&MMlast;
 
@@ -79,8 +419,8 @@ void initMALLOC(void){
   MMlastptr->next=NULL;
 #ifdef pp_THREAD
   pthread_mutex_init(&mutexMEM,NULL);
+  pthread_key_create(&frame_arena_key, FrameArenaThreadExit);
 #endif
-#ifdef pp_MEMDEBUG
   MMmaxmemory=0;
   MMtotalmemory=0;
 #endif
@@ -92,7 +432,8 @@ void initMALLOC(void){
 mallocflag _NewMemory(void **ppv, size_t size, int memory_id, char *varname, char *file, int linenumber){
   mallocflag returnval;
 
-  LOCK_MEM;
+  LOCK_MEMDEBUG
+  if(memory_id==0)memory_id = GetCurrentMemoryId();
   returnval=_NewMemoryNOTHREAD(ppv, size, memory_id);
   if(returnval!=1){
     fprintf(stderr,"*** Error: memory allocation request of size %llu failed\n",(unsigned long long)size);
@@ -105,7 +446,7 @@ mallocflag _NewMemory(void **ppv, size_t size, int memory_id, char *varname, cha
       fprintf(stderr,"          line number: %i\n",linenumber);
     }
   }
-  UNLOCK_MEM;
+  UNLOCK_MEMDEBUG
   return returnval;
 }
 
@@ -115,6 +456,9 @@ mallocflag _NewMemoryNOTHREAD(void **ppv, size_t size, int memory_id){
   void **ppb=(void **)ppv;
 #ifdef pp_MEMDEBUG
   char *c;
+#else
+  memarenadata *arena;
+  int sizeclass;
 #endif
   int infoblocksize;
   MMdata *this_ptr, *prev_ptr, *next_ptr;
@@ -130,9 +474,6 @@ mallocflag _NewMemoryNOTHREAD(void **ppv, size_t size, int memory_id){
   else{
     this_ptr = NULL;
   }
-#else
-  this_ptr = (void *)malloc(infoblocksize+size+sizeofDebugByte);
-#endif
   if(this_ptr!=NULL){
     prev_ptr=MMfirstptr;
     next_ptr=MMfirstptr->next;
@@ -140,21 +481,19 @@ mallocflag _NewMemoryNOTHREAD(void **ppv, size_t size, int memory_id){
     prev_ptr->next=this_ptr;
     next_ptr->prev=this_ptr;
 
-#ifdef pp_MEMPRINT
     this_ptr->size = size;
-#endif
     this_ptr->memory_id = memory_id;
     this_ptr->prev=prev_ptr;
     this_ptr->next=next_ptr;
     this_ptr->marker=markerByte;
 
     *ppb=(char *)this_ptr+infoblocksize;
+    AddMemoryBytes(memory_id, size);
   }
   else{
     *ppb=NULL;
   }
 
-#ifdef pp_MEMDEBUG
   {
     CheckMemoryNOTHREAD;
     if(*ppb != NULL){
@@ -171,6 +510,48 @@ mallocflag _NewMemoryNOTHREAD(void **ppv, size_t size, int memory_id){
     MMtotalmemory+=size;
     ASSERT(*ppb !=NULL);
   }
+#else
+  arena = GetMemArena();
+  if(arena==NULL){
+    *ppb=NULL;
+    return 0;
+  }
+  sizeclass = GetSizeClass(size);
+
+  LOCK_ARENA(arena);
+  if(arena->remote_free!=NULL)DrainRemoteFrees(arena);
+  this_ptr = NULL;
+  if(sizeclass>=0&&arena->cache[sizeclass]!=NULL){
+    this_ptr = arena->cache[sizeclass];
+    arena->cache[sizeclass] = this_ptr->free_next;
+    arena->ncache[sizeclass]--;
+  }
+  if(this_ptr==NULL){
+    this_ptr = (void *)malloc(infoblocksize+(sizeclass>=0 ? MEM_CLASS_SIZE(sizeclass) : size));
+  }
+  if(this_ptr!=NULL){
+    prev_ptr=&arena->first;
+    next_ptr=arena->first.next;
+
+    prev_ptr->next=this_ptr;
+    next_ptr->prev=this_ptr;
+
+    this_ptr->size = size;
+    this_ptr->size_class = sizeclass;
+    this_ptr->arena = arena;
+    this_ptr->free_next = NULL;
+    this_ptr->memory_id = memory_id;
+    this_ptr->prev=prev_ptr;
+    this_ptr->next=next_ptr;
+    this_ptr->marker=markerByte;
+
+    *ppb=(char *)this_ptr+infoblocksize;
+  }
+  else{
+    *ppb=NULL;
+  }
+  UNLOCK_ARENA(arena);
+  if(this_ptr!=NULL)AddMemoryBytes(memory_id, size);
 #endif
   return (*ppb != NULL);
 }
@@ -180,22 +561,15 @@ mallocflag _NewMemoryNOTHREAD(void **ppv, size_t size, int memory_id){
 void FreeAllMemory(int memory_id){
   MMdata *thisptr, *nextptr;
   int infoblocksize;
+#ifndef pp_MEMDEBUG
+  memarenadata *arena;
+#endif
 
   LOCK_MEM;
   infoblocksize=(sizeof(MMdata)+3)/4;
   infoblocksize*=4;
 
 #ifdef pp_MEMDEBUG
-  thisptr = MMfirstptr->next;
-  for(;;){
-    // if the 'thisptr' memory block is freed then thisptr is no longer valid.
-    // so, nextptr (which is thisptr->next) must be defined before it is freed
-    nextptr = thisptr->next;
-    if(thisptr->next == NULL || thisptr->marker != markerByte)break;
-    thisptr = nextptr;
-  }
-#endif
-
   thisptr = MMfirstptr->next;
   for(;;){
     // if the 'thisptr' memory block is freed then thisptr is no longer valid.
@@ -207,15 +581,32 @@ void FreeAllMemory(int memory_id){
     }
     thisptr = nextptr;
   }
+#else
+  for(arena = arena_list; arena!=NULL; arena = arena->next){
+    LOCK_ARENA(arena);
+    if(arena->remote_free!=NULL)DrainRemoteFrees(arena);
+    thisptr = arena->first.next;
+    for(;;){
+      nextptr = thisptr->next;
+      if(thisptr->next == NULL || thisptr->marker != markerByte)break;
+      if(memory_id == 0 || thisptr->memory_id == memory_id){
+        AddMemoryBytes(thisptr->memory_id, -(long long)thisptr->size);
+        ReleaseBlock(arena, thisptr);
+      }
+      thisptr = nextptr;
+    }
+    UNLOCK_ARENA(arena);
+  }
+#endif
   UNLOCK_MEM;
 }
 
 /* ------------------ FreeMemory ------------------------ */
 
 void FreeMemory(void *pv){
-  LOCK_MEM;
+  LOCK_MEMDEBUG
   FreeMemoryNOTHREAD(pv);
-  UNLOCK_MEM;
+  UNLOCK_MEMDEBUG
 }
 
 /* ------------------ FreeMemoryNOTHREAD ------------------------ */
@@ -223,9 +614,12 @@ void FreeMemory(void *pv){
 void FreeMemoryNOTHREAD(void *pv){
 #ifdef pp_MEMDEBUG
   int len_memory;
+  MMdata *prev_ptr, *next_ptr;
+#else
+  memarenadata *arena;
 #endif
   int infoblocksize;
-  MMdata *this_ptr, *prev_ptr, *next_ptr;
+  MMdata *this_ptr;
 
   ASSERT(pv != NULL);
   infoblocksize=(sizeof(MMdata)+3)/4;
@@ -241,15 +635,44 @@ void FreeMemoryNOTHREAD(void *pv){
     memset((char *)pv, memGarbage, len_memory);
     FreeBlockInfo((char *)pv);
   }
-#endif
   this_ptr=(MMdata *)((char *)pv-infoblocksize);
   ASSERT(this_ptr->marker==markerByte);
+  AddMemoryBytes(this_ptr->memory_id, -(long long)this_ptr->size);
   prev_ptr=this_ptr->prev;
   next_ptr=this_ptr->next;
 
   prev_ptr->next=next_ptr;
   next_ptr->prev=prev_ptr;
   free((char *)pv-infoblocksize);
+#else
+  this_ptr=(MMdata *)((char *)pv-infoblocksize);
+  ASSERT(this_ptr->marker==markerByte);
+  AddMemoryBytes(this_ptr->memory_id, -(long long)this_ptr->size);
+  arena = (memarenadata *)this_ptr->arena;
+#ifdef pp_THREAD
+
+  // a small block freed by another thread goes on the owner's remote free list.  large blocks
+  // are released right away so unloading data returns the memory to the system
+
+  if(this_ptr->size_class>=0&&arena!=pthread_getspecific(arena_key)){
+    void *head;
+
+    do{
+      head = arena->remote_free;
+      this_ptr->free_next = head;
+    } while(!MEM_CAS(&arena->remote_free, head, (void *)this_ptr));
+    if(arena->orphaned==1){
+      LOCK_ARENA(arena);
+      DrainRemoteFrees(arena);
+      UNLOCK_ARENA(arena);
+    }
+    return;
+  }
+#endif
+  LOCK_ARENA(arena);
+  ReleaseBlock(arena, this_ptr);
+  UNLOCK_ARENA(arena);
+#endif
 }
 
 /* ------------------ _ResizeMemory ------------------------ */
@@ -257,7 +680,7 @@ void FreeMemoryNOTHREAD(void *pv){
 mallocflag _ResizeMemory(void **ppv, size_t sizeNew, int memory_id, char *varname, char *file, int linenumber){
   mallocflag returnval;
 
-  LOCK_MEM;
+  LOCK_MEMDEBUG
   returnval=_ResizeMemoryNOTHREAD(ppv, sizeNew, memory_id);
   if(returnval!=1){
     fprintf(stderr,"*** Error: memory allocation request of size %llu failed\n",(unsigned long long)sizeNew);
@@ -270,7 +693,7 @@ mallocflag _ResizeMemory(void **ppv, size_t sizeNew, int memory_id, char *varnam
       fprintf(stderr,"          line number: %i\n",linenumber);
     }
   }
-  UNLOCK_MEM;
+  UNLOCK_MEMDEBUG
   return returnval;
 }
 
@@ -300,13 +723,37 @@ mallocflag _ResizeMemoryNOTHREAD(void **ppv, size_t sizeNew, int memory_id){
     else if(sizeNew > sizeOld){
       void *pbForceNew;
 
-      if(_NewMemoryNOTHREAD((void **)&pbForceNew, sizeNew, 0)){
+      this_ptr=(MMdata *)((char *)(*ppold)-infoblocksize);
+      if(_NewMemoryNOTHREAD((void **)&pbForceNew, sizeNew, this_ptr->memory_id)){
         memcpy(pbForceNew, *ppold, sizeOld);
         FreeMemoryNOTHREAD(*ppold);
         *ppold = pbForceNew;
       }
     }
   }
+#else
+  this_ptr=(MMdata *)((char *)(*ppold)-infoblocksize);
+  ASSERT(this_ptr->marker==markerByte);
+
+  // a block in a size class is reused if it is big enough, otherwise a small block
+  // is moved to a new block.  large blocks are resized in their own arena
+
+  if(this_ptr->size_class>=0&&sizeNew<=MEM_CLASS_SIZE(this_ptr->size_class)&&
+    (memory_id==0||memory_id==this_ptr->memory_id)){
+    AddMemoryBytes(this_ptr->memory_id, (long long)sizeNew-(long long)this_ptr->size);
+    this_ptr->size = sizeNew;
+    return 1;
+  }
+  if(this_ptr->size_class>=0||sizeNew<=MEM_MAX_CLASS){
+    void *pbMove;
+
+    if(_NewMemoryNOTHREAD(&pbMove, sizeNew, memory_id==0 ? this_ptr->memory_id : memory_id)==0)return 0;
+    memcpy(pbMove, *ppold, MIN(this_ptr->size, sizeNew));
+    FreeMemoryNOTHREAD(*ppold);
+    *ppold = pbMove;
+    return 1;
+  }
+  LOCK_ARENA((memarenadata *)this_ptr->arena);
 #endif
 
   this_ptr=(MMdata *)((char *)(*ppold)-infoblocksize);
@@ -320,14 +767,17 @@ mallocflag _ResizeMemoryNOTHREAD(void **ppv, size_t sizeNew, int memory_id){
       prev_ptr->next=this_ptr;
       next_ptr->prev=this_ptr;
 
-#ifdef pp_MEMPRINT
-      this_ptr->size = sizeNew;
-#endif
-      this_ptr->memory_id = memory_id;
       this_ptr->next=next_ptr;
       this_ptr->prev=prev_ptr;
       this_ptr->marker=markerByte;
     }
+
+    // the block keeps its memory id unless a new one is given
+
+    AddMemoryBytes(this_ptr->memory_id, -(long long)this_ptr->size);
+    if(memory_id!=0)this_ptr->memory_id = memory_id;
+    AddMemoryBytes(this_ptr->memory_id, sizeNew);
+    this_ptr->size = sizeNew;
 #ifdef pp_MEMDEBUG
     {
       if(sizeofDebugByte!=0){
@@ -342,9 +792,152 @@ mallocflag _ResizeMemoryNOTHREAD(void **ppv, size_t sizeNew, int memory_id){
 #endif
     *ppold = pbNew+infoblocksize;
   }
+#ifndef pp_MEMDEBUG
+  UNLOCK_ARENA((memarenadata *)this_ptr->arena);
+#endif
   return (pbNew != NULL);
 }
 
+/* ------------------ GetFrameArena ------------------------ */
+
+framearenadata *GetFrameArena(void){
+
+// return the calling thread's frame arena
+
+#ifdef pp_MEMDEBUG
+#ifdef pp_THREAD
+  framearenadata *fa;
+
+  fa = (framearenadata *)pthread_getspecific(frame_arena_key);
+  if(fa==NULL){
+    fa = (framearenadata *)calloc(1, sizeof(framearenadata));
+    ASSERT(fa!=NULL);
+    pthread_setspecific(frame_arena_key, fa);
+  }
+  return fa;
+#else
+  static framearenadata frame_arena = {NULL, NULL};
+
+  return &frame_arena;
+#endif
+#else
+  memarenadata *arena;
+
+  arena = GetMemArena();
+  ASSERT(arena!=NULL);
+  return &arena->frame;
+#endif
+}
+
+/* ------------------ FrameArenaAlloc ------------------------ */
+
+void *FrameArenaAlloc(framearenadata *fa, size_t size){
+
+// return size bytes (16 byte aligned) from the frame arena fa, NULL if out of memory
+
+  framechunkdata *chunk, *next_chunk;
+  size_t headersize, chunksize;
+
+  headersize = 16*((sizeof(framechunkdata)+15)/16);
+  size = 16*((size+15)/16);
+  chunk = fa->current;
+  if(chunk!=NULL&&chunk->used+size<=chunk->size){
+    chunk->used += size;
+    return (char *)chunk+headersize+chunk->used-size;
+  }
+
+  // use a chunk kept from an earlier frame if it is big enough, otherwise add a new chunk
+
+  next_chunk = (chunk==NULL ? fa->first : chunk->next);
+  if(next_chunk==NULL||next_chunk->size<size){
+    chunksize = MAX(size, FRAME_ARENA_CHUNK);
+    if(chunk!=NULL)chunksize = MAX(chunksize, 2*chunk->size);
+
+    // chunks are shared by every file the thread reads, they are not counted against the current memory id
+
+    if(NewMemoryMemID((void **)&next_chunk, headersize+chunksize, MEMORY_ID_UNTAGGED)==0)return NULL;
+    next_chunk->size = chunksize;
+    if(chunk==NULL){
+      next_chunk->next = fa->first;
+      fa->first = next_chunk;
+    }
+    else{
+      next_chunk->next = chunk->next;
+      chunk->next = next_chunk;
+    }
+  }
+  next_chunk->used = size;
+  fa->current = next_chunk;
+  return (char *)next_chunk+headersize;
+}
+
+/* ------------------ FrameArenaTrim ------------------------ */
+
+static void FrameArenaTrim(framechunkdata **chunkptr){
+
+// free the chunks in the list starting at *chunkptr that are larger than FRAME_ARENA_CHUNK.
+// they were added for an oversized frame and would otherwise stay attached to the thread
+
+  while(*chunkptr!=NULL){
+    framechunkdata *chunk;
+
+    chunk = *chunkptr;
+    if(chunk->size>FRAME_ARENA_CHUNK){
+      *chunkptr = chunk->next;
+      FreeMemory(chunk);
+    }
+    else{
+      chunkptr = &chunk->next;
+    }
+  }
+}
+
+/* ------------------ FrameArenaMark ------------------------ */
+
+framemarkdata FrameArenaMark(framearenadata *fa){
+  framemarkdata mark;
+
+  mark.chunk = fa->current;
+  mark.used = (fa->current==NULL ? 0 : fa->current->used);
+  return mark;
+}
+
+/* ------------------ FrameArenaRelease ------------------------ */
+
+void FrameArenaRelease(framearenadata *fa, framemarkdata mark){
+
+// release everything allocated from fa since mark was obtained
+
+  if(mark.chunk==NULL){
+    FrameArenaReset(fa);
+    return;
+  }
+  fa->current = mark.chunk;
+  fa->current->used = mark.used;
+  FrameArenaTrim(&fa->current->next);
+}
+
+/* ------------------ FrameArenaReset ------------------------ */
+
+void FrameArenaReset(framearenadata *fa){
+  FrameArenaTrim(&fa->first);
+  fa->current = fa->first;
+  if(fa->current!=NULL)fa->current->used = 0;
+}
+
+/* ------------------ FrameArenaFree ------------------------ */
+
+void FrameArenaFree(framearenadata *fa){
+  framechunkdata *chunk, *next_chunk;
+
+  for(chunk = fa->first; chunk!=NULL; chunk = next_chunk){
+    next_chunk = chunk->next;
+    FreeMemory(chunk);
+  }
+  fa->first = NULL;
+  fa->current = NULL;
+}
+
 #ifdef pp_MEMDEBUG
 /* ------------------ pointer comparison defines ------------------------ */
 
@@ -368,6 +961,7 @@ mallocflag __NewMemory(void **ppv, size_t size, int memory_id, char *varname, ch
 #endif
 
   LOCK_MEM;
+  if(memory_id==0)memory_id = GetCurrentMemoryId();
   return_code=_NewMemoryNOTHREAD(ppb,size,memory_id);
   pbi=GetBlockInfo((bbyte *)*ppb);
   pbi->linenumber=linenumber;
@@ -709,6 +1303,7 @@ void set_memcheck(int index){
     break;
   }
 }
+#endif
 
 /* ------------------ getMemusage ------------------------ */
 
@@ -726,5 +1321,4 @@ void getMemusage(MMsize totalmemory,char *MEMlabel){
   }
 
 }
-#endif
 
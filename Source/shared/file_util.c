@@ -1,3 +1,8 @@
+#ifdef pp_LINUX
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // statx
+#endif
+#endif
 #include "options.h"
 #include <stdio.h>
 #include <stdarg.h>
@@ -21,13 +26,24 @@
 #include <io.h>
 #include <direct.h>
 #include <dirent_win.h>
+#include <windows.h>
 #else
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+#ifdef pp_LINUX
+#include <unistd.h>
+#include <sys/inotify.h>
 #endif
 #include "MALLOCC.h"
 
 FILE *alt_stdout=NULL;
 
+filelistdata *dircache_files = NULL;
+int ndircache_files = 0, *dircache_hash = NULL, dircache_hash_size = 0, dircache_active = 0;
+int nfile_metadata_calls = 0;
+
 /* ------------------ CopySMVBuffer ------------------------ */
 
 bufferstreamdata *CopySMVBuffer(bufferstreamdata *stream_in){
@@ -484,9 +500,16 @@ FILE_SIZE GetFileSizeSMV(const char *filename){
   STRUCTSTAT statbuffer;
   int statfile;
   FILE_SIZE return_val;
+  filelistdata *entry;
 
   return_val=0;
   if(filename==NULL)return return_val;
+  if(InDirCache(filename, &entry)==1){
+    if(entry==NULL)return return_val;
+    StatDirCacheFile(entry);
+    return entry->size;
+  }
+  nfile_metadata_calls++;
   statfile=STAT(filename,&statbuffer);
   if(statfile!=0)return return_val;
   return_val = statbuffer.st_size;
@@ -536,6 +559,7 @@ void FreeFileBuffer(filedata *fileinfo){
   if(fileinfo==NULL)return;
   buffer = fileinfo->buffer;
   FREEMEMORY(buffer);
+  FREEMEMORY(fileinfo->line_keys);
   FREEMEMORY(fileinfo);
 }
 
@@ -584,6 +608,7 @@ int AppendFileBuffer(filedata *file1, filedata *file2){
 
   FREEMEMORY(file1->buffer);
   FREEMEMORY(file1->lines);
+  FREEMEMORY(file1->line_keys);
   file1->buffer = new_buffer;
   file1->lines = new_lines;
   file1->filesize = new_filesize;
@@ -594,6 +619,16 @@ int AppendFileBuffer(filedata *file1, filedata *file2){
   /* ------------------ File2Buffer ------------------------ */
 
 filedata *File2Buffer(char *filename){
+  return File2BufferOffset(filename, 0);
+}
+
+  /* ------------------ File2BufferOffset ------------------------ */
+
+filedata *File2BufferOffset(char *filename, FILE_SIZE offset){
+
+// read filename starting at byte offset into a buffer split into lines.  line positions in the
+// buffer are the same as in the file (relative to offset)
+
   FILE_SIZE i,filesize;
   filedata *fileinfo;
   char *buffer, **lines;
@@ -602,9 +637,14 @@ filedata *File2Buffer(char *filename){
 
   if(FILE_EXISTS(filename)==NO)return NULL;
   filesize = GetFileSizeSMV(filename);
-  if(filesize==0)return NULL;
+  if(filesize<=offset)return NULL;
+  filesize -= offset;
   stream = fopen(filename,"rb");
   if(stream==NULL)return NULL;
+  if(offset>0&&FSEEK(stream, offset, SEEK_SET)!=0){
+    fclose(stream);
+    return NULL;
+  }
   NewMemory((void **)&fileinfo, sizeof(filedata));
   if(NewMemory((void **)&buffer, filesize+1)==0){
     FREEMEMORY(fileinfo);
@@ -620,6 +660,7 @@ filedata *File2Buffer(char *filename){
   fileinfo->buffer = buffer;
   fileinfo->filesize = filesize;
   fileinfo->iline = 0;
+  fileinfo->line_keys = NULL;
   CheckMemory;
 
   // count number of lines
@@ -659,6 +700,73 @@ filedata *File2Buffer(char *filename){
   return fileinfo;
 }
 
+/* ------------------ MMapFile ------------------------ */
+
+int MMapFile(char *filename, mmapfiledata *mapinfo, int access_pattern){
+
+// map filename read-only into memory, returns 1 if successful, 0 otherwise.
+// access_pattern is MMAP_SEQUENTIAL if the file is read front to back (the kernel reads ahead)
+// or MMAP_RANDOM if only scattered parts of it are read.
+// the caller must release the mapping with MUnmapFile
+
+  FILE_SIZE filesize;
+
+  mapinfo->buffer = NULL;
+  mapinfo->size = 0;
+  if(filename==NULL)return 0;
+  filesize = GetFileSizeSMV(filename);
+  if(filesize==0||filesize!=(FILE_SIZE)(size_t)filesize)return 0;
+#ifdef WIN32
+  mapinfo->file_handle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ|FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+                                      access_pattern==MMAP_RANDOM ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if(mapinfo->file_handle==INVALID_HANDLE_VALUE)return 0;
+  mapinfo->map_handle = CreateFileMapping(mapinfo->file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+  if(mapinfo->map_handle==NULL){
+    CloseHandle(mapinfo->file_handle);
+    return 0;
+  }
+  mapinfo->buffer = (unsigned char *)MapViewOfFile(mapinfo->map_handle, FILE_MAP_READ, 0, 0, (SIZE_T)filesize);
+  if(mapinfo->buffer==NULL){
+    CloseHandle(mapinfo->map_handle);
+    CloseHandle(mapinfo->file_handle);
+    return 0;
+  }
+#else
+  {
+    void *buffer;
+
+    mapinfo->fd = open(filename, O_RDONLY);
+    if(mapinfo->fd==-1)return 0;
+    buffer = mmap(NULL, (size_t)filesize, PROT_READ, MAP_PRIVATE, mapinfo->fd, 0);
+    if(buffer==MAP_FAILED){
+      close(mapinfo->fd);
+      return 0;
+    }
+
+    madvise(buffer, (size_t)filesize, access_pattern==MMAP_RANDOM ? MADV_RANDOM : MADV_SEQUENTIAL);
+    mapinfo->buffer = (unsigned char *)buffer;
+  }
+#endif
+  mapinfo->size = filesize;
+  return 1;
+}
+
+/* ------------------ MUnmapFile ------------------------ */
+
+void MUnmapFile(mmapfiledata *mapinfo){
+  if(mapinfo==NULL||mapinfo->buffer==NULL)return;
+#ifdef WIN32
+  UnmapViewOfFile(mapinfo->buffer);
+  CloseHandle(mapinfo->map_handle);
+  CloseHandle(mapinfo->file_handle);
+#else
+  munmap(mapinfo->buffer, (size_t)mapinfo->size);
+  close(mapinfo->fd);
+#endif
+  mapinfo->buffer = NULL;
+  mapinfo->size = 0;
+}
+
 /* ------------------ FileExistsOrig ------------------------ */
 
 int FileExistsOrig(char *filename){
@@ -682,6 +790,7 @@ int FileExists(char *filename, filelistdata *filelist, int nfilelist, filelistda
       return YES;
     }
   }
+  nfile_metadata_calls++;
   if(ACCESS(filename,F_OK)==-1){
     return NO;
   }
@@ -690,6 +799,205 @@ int FileExists(char *filename, filelistdata *filelist, int nfilelist, filelistda
   }
 }
 
+/* ------------------ HashFileName ------------------------ */
+
+unsigned int HashFileName(const char *file){
+
+// FNV-1a hash of a file name
+
+  unsigned int hash;
+
+  hash = 2166136261u;
+  for(; *file!=0; file++){
+    hash = (hash^(unsigned char)*file)*16777619u;
+  }
+  return hash;
+}
+
+/* ------------------ InCaseDir ------------------------ */
+
+int InCaseDir(const char *file){
+
+// returns 1 if file names a file in the current (case) directory
+
+  if(file==NULL||file[0]==0)return 0;
+  if(strchr(file, '/')!=NULL)return 0;
+#ifdef WIN32
+  if(strchr(file, '\\')!=NULL||strchr(file, ':')!=NULL)return 0;
+#endif
+  return 1;
+}
+
+/* ------------------ FreeDirCache ------------------------ */
+
+void FreeDirCache(void){
+  dircache_active = 0;
+  FreeFileList(dircache_files, &ndircache_files);
+  FREEMEMORY(dircache_hash);
+  dircache_hash_size = 0;
+}
+
+/* ------------------ MakeDirCache ------------------------ */
+
+int MakeDirCache(const char *path){
+
+// read the directory path once and index its regular files and links to files by name in a
+// hash table so that existence and size checks made while a case is opened do not each go to the
+// file system.  sizes and modification times are filled in by StatDirCacheFile
+// when first needed (or all at once by a parallel sweep)
+
+  struct dirent *entry;
+  DIR *dp;
+  int i, nfiles_max = 0;
+
+  FreeDirCache();
+  dp = opendir(path);
+  nfile_metadata_calls++;
+  if(dp==NULL)return 0;
+  while((entry = readdir(dp))!=NULL){
+    filelistdata *filei;
+
+    if(entry->d_type!=DT_REG&&entry->d_type!=DT_LNK&&entry->d_type!=DT_UNKNOWN)continue;
+    if(ndircache_files>=nfiles_max){
+      nfiles_max = 2*nfiles_max+1024;
+      NewResizeMemory(dircache_files, nfiles_max*sizeof(filelistdata));
+    }
+    filei = dircache_files+ndircache_files;
+    NewMemory((void **)&filei->file, strlen(entry->d_name)+1);
+    strcpy(filei->file, entry->d_name);
+    filei->type    = 0;
+    filei->size    = 0;
+    filei->modtime = 0;
+    filei->stat    = FILE_STAT_UNKNOWN;
+    ndircache_files++;
+
+    // a link may point to nothing, stat it now (through the link) so that dangling links are left out
+
+    if(entry->d_type==DT_LNK){
+      StatDirCacheFile(filei);
+      if(filei->stat==FILE_STAT_MISSING){
+        FREEMEMORY(filei->file);
+        ndircache_files--;
+      }
+    }
+  }
+  closedir(dp);
+
+  for(dircache_hash_size = 1024; dircache_hash_size<2*ndircache_files; dircache_hash_size *= 2);
+  NewMemory((void **)&dircache_hash, dircache_hash_size*sizeof(int));
+  for(i = 0; i<dircache_hash_size; i++){
+    dircache_hash[i] = -1;
+  }
+  for(i = 0; i<ndircache_files; i++){
+    unsigned int slot;
+
+    slot = HashFileName(dircache_files[i].file)&(dircache_hash_size-1);
+    while(dircache_hash[slot]>=0){
+      slot = (slot+1)&(dircache_hash_size-1);
+    }
+    dircache_hash[slot] = i;
+  }
+  dircache_active = 1;
+  return ndircache_files;
+}
+
+/* ------------------ UseDirCache ------------------------ */
+
+void UseDirCache(int flag){
+
+// the cache is only consulted while a case is being opened, afterwards files may grow
+
+  if(dircache_hash==NULL)flag = 0;
+  dircache_active = flag;
+}
+
+/* ------------------ GetDirCache ------------------------ */
+
+filelistdata *GetDirCache(int *nfiles){
+  *nfiles = ndircache_files;
+  return dircache_files;
+}
+
+/* ------------------ GetFileMetadataCalls ------------------------ */
+
+int GetFileMetadataCalls(void){
+  return nfile_metadata_calls;
+}
+
+/* ------------------ InDirCache ------------------------ */
+
+int InDirCache(const char *file, filelistdata **entry){
+
+// returns 1 if the cache can answer for file, entry is then set to the file (NULL if it does not exist)
+
+  unsigned int slot;
+
+  if(dircache_active==0||InCaseDir(file)==0)return 0;
+  slot = HashFileName(file)&(dircache_hash_size-1);
+  *entry = NULL;
+  while(dircache_hash[slot]>=0){
+    filelistdata *filei;
+
+    filei = dircache_files+dircache_hash[slot];
+    if(strcmp(filei->file, file)==0){
+      *entry = filei;
+      break;
+    }
+    slot = (slot+1)&(dircache_hash_size-1);
+  }
+  return 1;
+}
+
+/* ------------------ StatDirCacheFile ------------------------ */
+
+void StatDirCacheFile(filelistdata *filei){
+  if(filei->stat!=FILE_STAT_UNKNOWN)return;
+  nfile_metadata_calls++;
+#ifdef STATX_SIZE
+
+  // AT_STATX_DONT_SYNC lets network file systems answer from cached attributes
+
+  {
+    struct statx statxbuffer;
+
+    if(statx(AT_FDCWD, filei->file, AT_STATX_DONT_SYNC, STATX_SIZE|STATX_MTIME, &statxbuffer)!=0){
+      filei->stat = FILE_STAT_MISSING;
+      return;
+    }
+    filei->size    = statxbuffer.stx_size;
+    filei->modtime = statxbuffer.stx_mtime.tv_sec;
+  }
+#else
+  {
+    STRUCTSTAT statbuffer;
+
+    if(STAT(filei->file, &statbuffer)!=0){
+      filei->stat = FILE_STAT_MISSING;
+      return;
+    }
+    filei->size    = statbuffer.st_size;
+    filei->modtime = statbuffer.st_mtime;
+  }
+#endif
+  filei->stat = FILE_STAT_FOUND;
+}
+
+/* ------------------ FileExistsCaseDir ------------------------ */
+
+int FileExistsCaseDir(char *filename){
+
+// returns YES if the file filename exists, files in the case directory are looked up in the cache
+
+  filelistdata *entry;
+
+  if(filename==NULL)return NO;
+  if(InDirCache(filename, &entry)==1){
+    if(entry==NULL)return NO;
+    return YES;
+  }
+  return FileExists(filename, NULL, 0, NULL, 0);
+}
+
 /* ------------------ FreeFileList ------------------------ */
 
 void FreeFileList(filelistdata *filelist, int *nfilelist){
@@ -1043,15 +1351,89 @@ time_t FileModtime(char *filename){
   STRUCTSTAT statbuffer;
   time_t return_val;
   int statfile;
+  filelistdata *entry;
 
   return_val=0;
   if(filename==NULL)return return_val;
+  if(InDirCache(filename, &entry)==1){
+    if(entry==NULL)return return_val;
+    StatDirCacheFile(entry);
+    return entry->modtime;
+  }
+  nfile_metadata_calls++;
   statfile=STAT(filename,&statbuffer);
   if(statfile!=0)return return_val;
   return_val = statbuffer.st_mtime;
   return return_val;
 }
 
+/* ------------------ FileWatchInit ------------------------ */
+
+int FileWatchInit(void){
+
+// returns a non-blocking inotify descriptor or -1 if file change notification
+// is not available on this platform (callers then compare file sizes)
+
+#ifdef pp_LINUX
+  return inotify_init1(IN_NONBLOCK|IN_CLOEXEC);
+#else
+  return -1;
+#endif
+}
+
+/* ------------------ FileWatchAdd ------------------------ */
+
+int FileWatchAdd(int watch, char *filename){
+
+// watch filename for writes, returns a watch id or -1
+
+#ifdef pp_LINUX
+  if(watch<0||filename==NULL)return -1;
+  return inotify_add_watch(watch, filename, IN_MODIFY|IN_CLOSE_WRITE);
+#else
+  return -1;
+#endif
+}
+
+/* ------------------ FileWatchRead ------------------------ */
+
+int FileWatchRead(int watch, int *ids, int nids){
+
+// drain pending notifications without blocking, ids[i] is set to 1 for each
+// watch id i < nids that was written to.  returns the number of events read
+
+  int count = 0;
+
+#ifdef pp_LINUX
+  char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+  if(watch<0)return 0;
+  for(;;){
+    ssize_t len;
+    char *ptr;
+
+    len = read(watch, buffer, sizeof(buffer));
+    if(len<=0)break;
+    for(ptr = buffer; ptr<buffer+len; ptr += sizeof(struct inotify_event)+((struct inotify_event *)ptr)->len){
+      struct inotify_event *event;
+
+      event = (struct inotify_event *)ptr;
+      if(ids!=NULL&&event->wd>=0&&event->wd<nids)ids[event->wd] = 1;
+      count++;
+    }
+  }
+#endif
+  return count;
+}
+
+/* ------------------ FileWatchClose ------------------------ */
+
+void FileWatchClose(int watch){
+#ifdef pp_LINUX
+  if(watch>=0)close(watch);
+#endif
+}
+
 /* ------------------ Which ------------------------ */
 
 char *Which(char *progname){
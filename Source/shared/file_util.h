@@ -22,16 +22,22 @@
 
 /* --------------------------  filelistdata ------------------------------------ */
 
+#define FILE_STAT_UNKNOWN  0
+#define FILE_STAT_FOUND    1
+#define FILE_STAT_MISSING -1
+
 typedef struct {
   char *file;
-  int type;
+  int type, stat;
+  FILE_SIZE size;
+  time_t modtime;
 } filelistdata;
 
 /* --------------------------  _filedata ------------------------------------ */
 
 typedef struct _filedata {
   char *buffer, **lines;
-  int iline, nlines;
+  int iline, nlines, *line_keys;
   FILE_SIZE filesize;
 } filedata;
 
@@ -42,6 +48,21 @@ typedef struct bufferstreamdata{
   filedata *fileinfo;
 } bufferstreamdata;
 
+/* --------------------------  mmapfiledata ------------------------------------ */
+
+typedef struct _mmapfiledata {
+  unsigned char *buffer;
+  FILE_SIZE size;
+#ifdef WIN32
+  void *file_handle, *map_handle;
+#else
+  int fd;
+#endif
+} mmapfiledata;
+
+#define MMAP_SEQUENTIAL 0
+#define MMAP_RANDOM     1
+
 // vvvvvvvvvvvvvvvvvvvvvvvv preprocessing directives vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
 
 #ifdef WIN32
@@ -72,7 +93,7 @@ typedef struct bufferstreamdata{
 #define BFILE bufferstreamdata
 
 #define FILE_EXISTS(a)         FileExists(a,NULL,0,NULL,0)
-#define FILE_EXISTS_CASEDIR(a) FileExists(a,filelist_casename, nfilelist_casename,filelist_casedir,nfilelist_casedir)
+#define FILE_EXISTS_CASEDIR(a) FileExistsCaseDir(a)
 int FileExistsOrig(char *filename);
 
 #ifdef WIN32
@@ -109,6 +130,9 @@ EXTERNCPP void RewindFileBuffer(filedata *fileinfo);
 EXTERNCPP void OutputFileBuffer(filedata *fileinfo);
 EXTERNCPP void FreeFileBuffer(filedata *fileinfo);
 EXTERNCPP filedata *File2Buffer(char *filename);
+EXTERNCPP filedata *File2BufferOffset(char *filename, FILE_SIZE offset);
+EXTERNCPP int MMapFile(char *filename, mmapfiledata *mapinfo, int access_pattern);
+EXTERNCPP void MUnmapFile(mmapfiledata *mapinfo);
 EXTERNCPP int FFLUSH(void);
 EXTERNCPP int PRINTF(const char * format, ...);
 EXTERNCPP void SetStdOut(FILE *stream);
@@ -134,12 +158,24 @@ EXTERNCPP int Writable(char *dir);
 EXTERNCPP   int FileExists(char *filename, filelistdata *filelist, int nfiles, filelistdata *filelist2, int nfiles2);
 EXTERNCPP filelistdata *FileInList(char *file, filelistdata *filelist, int nfiles, filelistdata *filelist2, int nfiles2);
 EXTERNCPP void FreeFileList(filelistdata *filelist, int *nfilelist);
+EXTERNCPP int FileExistsCaseDir(char *filename);
+EXTERNCPP int InDirCache(const char *file, filelistdata **entry);
+EXTERNCPP int MakeDirCache(const char *path);
+EXTERNCPP void FreeDirCache(void);
+EXTERNCPP void UseDirCache(int flag);
+EXTERNCPP filelistdata *GetDirCache(int *nfiles);
+EXTERNCPP void StatDirCacheFile(filelistdata *filei);
+EXTERNCPP int GetFileMetadataCalls(void);
 EXTERNCPP int GetFileListSize(const char *path, char *filter) ;
 EXTERNCPP int MakeFileList(const char *path, char *filter, int maxfiles, int sort_files, filelistdata **filelist);
 EXTERNCPP char *Which(char *progname);
 EXTERNCPP FILE_SIZE GetFileSizeSMV(const char *filename);
 EXTERNCPP time_t FileModtime(char *filename);
 EXTERNCPP int IsFileNewer(char *file1, char *file2);
+EXTERNCPP int FileWatchInit(void);
+EXTERNCPP int FileWatchAdd(int watch, char *filename);
+EXTERNCPP int FileWatchRead(int watch, int *ids, int nids);
+EXTERNCPP void FileWatchClose(int watch);
 EXTERNCPP char *GetProgDir(char *progname, char **svpath);
 
 #ifdef pp_LUA
@@ -172,6 +172,38 @@ void CopyBuckets2Histogram(int *buckets, int nbuckets, float valmin, float valma
   histogram->defined = 1;
 }
 
+/* ------------------ GetMinMax ------------------------ */
+
+void GetMinMax(float *vals, int nvals, float *valmin, float *valmax){
+
+// min and max of vals[0..nvals-1] (nvals>0).  MINMAX_LANES independent running min/max pairs are
+// kept so the compiler can compute them with vector min/max instructions
+
+  float lane_min[MINMAX_LANES], lane_max[MINMAX_LANES];
+  int i, j;
+
+  for(j = 0; j<MINMAX_LANES; j++){
+    lane_min[j] = vals[0];
+    lane_max[j] = vals[0];
+  }
+  for(i = 0; i+MINMAX_LANES<=nvals; i += MINMAX_LANES){
+    for(j = 0; j<MINMAX_LANES; j++){
+      lane_min[j] = MIN(vals[i+j], lane_min[j]);
+      lane_max[j] = MAX(vals[i+j], lane_max[j]);
+    }
+  }
+  for(; i<nvals; i++){
+    lane_min[0] = MIN(vals[i], lane_min[0]);
+    lane_max[0] = MAX(vals[i], lane_max[0]);
+  }
+  for(j = 1; j<MINMAX_LANES; j++){
+    lane_min[0] = MIN(lane_min[j], lane_min[0]);
+    lane_max[0] = MAX(lane_max[j], lane_max[0]);
+  }
+  *valmin = lane_min[0];
+  *valmax = lane_max[0];
+}
+
   /* ------------------ CopyU2Histogram ------------------------ */
 
 void CopyVals2Histogram(float *vals, char *mask, float *weight, int nvals, histogramdata *histogram){
@@ -195,22 +227,28 @@ void CopyVals2Histogram(float *vals, char *mask, float *weight, int nvals, histo
 
 // compute min/max, skip over mask'd data
 
-  for(i=0;i<nvals;i++){
-    if(mask!=NULL&&mask[i]==0)continue;
-    if(weight != NULL){
-      nnvals += weight[i];
-    }
-    else{
-      nnvals++;
-    }
-    if(first==1){
-      valmin=vals[i];
-      valmax=vals[i];
-      first=0;
-      continue;
+  if(mask==NULL&&weight==NULL&&nvals>0){
+    GetMinMax(vals, nvals, &valmin, &valmax);
+    nnvals = nvals;
+  }
+  else{
+    for(i=0;i<nvals;i++){
+      if(mask!=NULL&&mask[i]==0)continue;
+      if(weight != NULL){
+        nnvals += weight[i];
+      }
+      else{
+        nnvals++;
+      }
+      if(first==1){
+        valmin=vals[i];
+        valmax=vals[i];
+        first=0;
+        continue;
+      }
+      valmin=MIN(vals[i],valmin);
+      valmax=MAX(vals[i],valmax);
     }
-    valmin=MIN(vals[i],valmin);
-    valmax=MAX(vals[i],valmax);
   }
 
 // record unmasked data in histogram
@@ -19,6 +19,7 @@
 /* --------------------------  flowlabels ------------------------------------ */
 
 #define NHIST_BUCKETS 10000
+#define MINMAX_LANES 8
 typedef struct {
   unsigned int *buckets_polar;
   float *buckets, bucket_maxval, bucket_maxr, bucket_maxtheta;
@@ -46,6 +47,7 @@ int Get2DBounds(float *times, float *uvals, float *vvals, int nvals, float tmin,
 void GetHistogramStats(histogramdata *histogram);
 float GetHistogramCDF(histogramdata *histogram, float val);
 float GetHistogramVal(histogramdata *histogram, float cdf);
+void GetMinMax(float *vals, int nvals, float *valmin, float *valmax);
 void GetPolarBounds(float *speed, int nvals, float *rmin, float *rmax);
 void InitHistogram(histogramdata *histogram, int nbuckets, float *valmin, float *valmax);
 void InitHistogramPolar(histogramdata *histogram, int nx, int ny, float *rmin, float *rmax);
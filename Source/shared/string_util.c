@@ -726,14 +726,14 @@ char *Time2TimeLabel(float sv_time, float dt, char *timelabel){
 /* ------------------ Match ------------------------ */
 
 int Match(char *buffer, const char *key){
-  size_t lenbuffer;
-  size_t lenkey;
 
-  lenkey=strlen(key);
-  lenbuffer=strlen(buffer);
-  if(lenbuffer<lenkey)return NOTMATCH; // buffer shorter than key so no match
-  if(strncmp(buffer,key,lenkey) != 0)return NOTMATCH; // key doesn't match buffer so no match
-  if(lenbuffer>lenkey&&!isspace((unsigned char)buffer[lenkey]))return NOTMATCH;
+// buffer matches key if it starts with key followed by white space or the end of the string.
+// buffer is compared one character at a time so long lines are not scanned
+
+  for(; *key!=0; key++, buffer++){
+    if(*buffer!=*key)return NOTMATCH; // also no match if buffer is shorter than key
+  }
+  if(*buffer!=0&&!isspace((unsigned char)*buffer))return NOTMATCH;
   return MATCH;
 }
 
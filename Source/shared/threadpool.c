@@ -0,0 +1,401 @@
+#include "options.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/time.h>
+#endif
+
+#include "MALLOCC.h"
+#include "datadefs.h"
+#include "threadpool.h"
+
+// a persistent pool of worker threads.  each worker owns a task queue.  a worker runs the
+// newest task in its own queue and when that is empty steals the oldest task from another
+// worker's queue.  ThreadPoolSubmit returns a task that is passed to ThreadPoolWait to
+// obtain the result (a future).  ThreadPoolRun submits a task that nobody waits for.
+
+int npool_threads = 0, pool_next_queue = 0, npool_pending = 0, npool_timings = 0;
+taskqueuedata pool_queues[MAX_POOL_THREADS];
+tasktimedata pool_timings[MAX_POOL_TIMINGS];
+
+#ifdef pp_THREAD
+int pool_queue_index[MAX_POOL_THREADS];
+pthread_t pool_thread_ids[MAX_POOL_THREADS];
+pthread_mutex_t mutexPOOL = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t condPOOL_WORK = PTHREAD_COND_INITIALIZER, condPOOL_DONE = PTHREAD_COND_INITIALIZER;
+pthread_key_t pool_worker_key;
+#endif
+
+/* ------------------ GetWallTime ------------------------ */
+
+double GetWallTime(void){
+#ifdef WIN32
+  LARGE_INTEGER freq, count;
+
+  QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&count);
+  return (double)count.QuadPart/(double)freq.QuadPart;
+#else
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return (double)tv.tv_sec+(double)tv.tv_usec/1000000.0;
+#endif
+}
+
+/* ------------------ GetNumProcessors ------------------------ */
+
+int GetNumProcessors(void){
+#ifdef WIN32
+  SYSTEM_INFO sysinfo;
+
+  GetSystemInfo(&sysinfo);
+  return MAX((int)sysinfo.dwNumberOfProcessors, 1);
+#else
+  long nprocs;
+
+  nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+  if(nprocs<1)nprocs = 1;
+  return (int)nprocs;
+#endif
+}
+
+/* ------------------ AddTaskTime ------------------------ */
+
+void AddTaskTime(taskdata *task){
+  tasktimedata *tt = NULL;
+  int i;
+
+  for(i = 0; i<npool_timings; i++){
+    if(strcmp(pool_timings[i].label, task->label)==0){
+      tt = pool_timings+i;
+      break;
+    }
+  }
+  if(tt==NULL){
+    if(npool_timings==MAX_POOL_TIMINGS)return;
+    tt = pool_timings+npool_timings++;
+    strcpy(tt->label, task->label);
+    tt->count = 0;
+    tt->time = 0.0;
+    tt->time_max = 0.0;
+  }
+  tt->count++;
+  tt->time += task->time;
+  tt->time_max = MAX(tt->time_max, task->time);
+}
+
+/* ------------------ RunTask ------------------------ */
+
+void RunTask(taskdata *task){
+  double start;
+  int detached;
+
+  start = GetWallTime();
+  task->result = task->func(task->arg);
+  task->time = (float)(GetWallTime()-start);
+#ifdef pp_THREAD
+  pthread_mutex_lock(&mutexPOOL);
+#endif
+  AddTaskTime(task);
+  detached = task->detached;
+  task->state = TASK_DONE;
+#ifdef pp_THREAD
+  pthread_cond_broadcast(&condPOOL_DONE);
+  pthread_mutex_unlock(&mutexPOOL);
+#endif
+  if(detached==1)FREEMEMORY(task);
+}
+
+#ifdef pp_THREAD
+
+/* ------------------ UnlinkTask ------------------------ */
+
+void UnlinkTask(taskqueuedata *q, taskdata *task){
+  if(task->prev==NULL){
+    q->first = task->next;
+  }
+  else{
+    task->prev->next = task->next;
+  }
+  if(task->next==NULL){
+    q->last = task->prev;
+  }
+  else{
+    task->next->prev = task->prev;
+  }
+  task->prev = NULL;
+  task->next = NULL;
+  task->state = TASK_RUNNING;
+}
+
+/* ------------------ GetTask ------------------------ */
+
+taskdata *GetTask(int index){
+  taskdata *task = NULL;
+  int i;
+
+  for(i = 0; i<npool_threads&&task==NULL; i++){
+    taskqueuedata *q;
+
+    q = pool_queues+(index+i)%npool_threads;
+    pthread_mutex_lock(&q->mutex);
+    task = (i==0 ? q->last : q->first); // newest from our own queue, oldest from others
+    if(task!=NULL)UnlinkTask(q, task);
+    pthread_mutex_unlock(&q->mutex);
+  }
+  if(task!=NULL){
+    pthread_mutex_lock(&mutexPOOL);
+    npool_pending--;
+    pthread_mutex_unlock(&mutexPOOL);
+  }
+  return task;
+}
+
+/* ------------------ MtPoolWorker ------------------------ */
+
+void *MtPoolWorker(void *arg){
+  int index;
+
+  index = *(int *)arg;
+  pthread_setspecific(pool_worker_key, arg);
+  for(;;){
+    taskdata *task;
+
+    task = GetTask(index);
+    if(task==NULL){
+      pthread_mutex_lock(&mutexPOOL);
+      while(npool_pending<=0){
+        pthread_cond_wait(&condPOOL_WORK, &mutexPOOL);
+      }
+      pthread_mutex_unlock(&mutexPOOL);
+      continue;
+    }
+    RunTask(task);
+  }
+  return NULL;
+}
+#endif
+
+/* ------------------ ThreadPoolInit ------------------------ */
+
+int ThreadPoolInit(int nthreads){
+
+// start nthreads workers (the number of processors if nthreads<=0).  returns the pool size
+
+#ifdef pp_THREAD
+  int i;
+
+  if(npool_threads>0)return npool_threads;
+  if(nthreads<=0)nthreads = GetNumProcessors();
+  nthreads = CLAMP(nthreads, 1, MAX_POOL_THREADS);
+  pthread_key_create(&pool_worker_key, NULL);
+  for(i = 0; i<nthreads; i++){
+    pool_queues[i].first = NULL;
+    pool_queues[i].last = NULL;
+    pthread_mutex_init(&pool_queues[i].mutex, NULL);
+    pool_queue_index[i] = i;
+  }
+  npool_threads = nthreads;
+  for(i = 0; i<nthreads; i++){
+    pthread_create(pool_thread_ids+i, NULL, MtPoolWorker, pool_queue_index+i);
+    pthread_detach(pool_thread_ids[i]);
+  }
+#endif
+  return npool_threads;
+}
+
+/* ------------------ ThreadPoolSize ------------------------ */
+
+int ThreadPoolSize(void){
+  return MAX(npool_threads, 1);
+}
+
+/* ------------------ ThreadPoolIsWorker ------------------------ */
+
+int ThreadPoolIsWorker(void){
+
+// return 1 if called from one of the pool's worker threads
+
+#ifdef pp_THREAD
+  if(npool_threads>0&&pthread_getspecific(pool_worker_key)!=NULL)return 1;
+#endif
+  return 0;
+}
+
+/* ------------------ ThreadPoolSubmit ------------------------ */
+
+taskdata *ThreadPoolSubmit(char *label, void *(*func)(void *), void *arg){
+  taskdata *task;
+
+  NewMemory((void **)&task, sizeof(taskdata));
+  task->func = func;
+  task->arg = arg;
+  task->result = NULL;
+  task->state = TASK_QUEUED;
+  task->detached = 0;
+  task->time = 0.0;
+  task->prev = NULL;
+  task->next = NULL;
+  strncpy(task->label, label, sizeof(task->label)-1);
+  task->label[sizeof(task->label)-1] = 0;
+#ifdef pp_THREAD
+  if(npool_threads>0){
+    taskqueuedata *q;
+    int *worker;
+
+    // a task submitted by a worker goes on that worker's queue, otherwise queues are used in turn
+
+    worker = (int *)pthread_getspecific(pool_worker_key);
+    pthread_mutex_lock(&mutexPOOL);
+    if(worker!=NULL){
+      task->queue = *worker;
+    }
+    else{
+      task->queue = pool_next_queue;
+      pool_next_queue = (pool_next_queue+1)%npool_threads;
+    }
+    pthread_mutex_unlock(&mutexPOOL);
+
+    q = pool_queues+task->queue;
+    pthread_mutex_lock(&q->mutex);
+    task->prev = q->last;
+    if(q->last==NULL){
+      q->first = task;
+    }
+    else{
+      q->last->next = task;
+    }
+    q->last = task;
+    pthread_mutex_unlock(&q->mutex);
+
+    pthread_mutex_lock(&mutexPOOL);
+    npool_pending++;
+    pthread_cond_signal(&condPOOL_WORK);
+    pthread_mutex_unlock(&mutexPOOL);
+    return task;
+  }
+#endif
+  task->queue = 0;
+  task->state = TASK_RUNNING;
+  RunTask(task);
+  return task;
+}
+
+/* ------------------ ThreadPoolRun ------------------------ */
+
+void ThreadPoolRun(char *label, void *(*func)(void *), void *arg){
+  taskdata *task;
+  int done = 0;
+
+  task = ThreadPoolSubmit(label, func, arg);
+#ifdef pp_THREAD
+  pthread_mutex_lock(&mutexPOOL);
+#endif
+  if(task->state==TASK_DONE){
+    done = 1;
+  }
+  else{
+    task->detached = 1;
+  }
+#ifdef pp_THREAD
+  pthread_mutex_unlock(&mutexPOOL);
+#endif
+  if(done==1)FREEMEMORY(task);
+}
+
+/* ------------------ ThreadPoolDone ------------------------ */
+
+int ThreadPoolDone(taskdata *task){
+  int done;
+
+  if(task==NULL)return 1;
+#ifdef pp_THREAD
+  pthread_mutex_lock(&mutexPOOL);
+#endif
+  done = (task->state==TASK_DONE ? 1 : 0);
+#ifdef pp_THREAD
+  pthread_mutex_unlock(&mutexPOOL);
+#endif
+  return done;
+}
+
+/* ------------------ ThreadPoolWait ------------------------ */
+
+void *ThreadPoolWait(taskdata *task){
+
+// wait for task to finish, free it and return its result.  a task that has not
+// started yet is run by the calling thread
+
+  void *result;
+
+  if(task==NULL)return NULL;
+#ifdef pp_THREAD
+  if(npool_threads>0){
+    taskqueuedata *q;
+    int run_here = 0;
+
+    q = pool_queues+task->queue;
+    pthread_mutex_lock(&q->mutex);
+    if(task->state==TASK_QUEUED){
+      UnlinkTask(q, task);
+      run_here = 1;
+    }
+    pthread_mutex_unlock(&q->mutex);
+    if(run_here==1){
+      pthread_mutex_lock(&mutexPOOL);
+      npool_pending--;
+      pthread_mutex_unlock(&mutexPOOL);
+      RunTask(task);
+    }
+    else{
+      pthread_mutex_lock(&mutexPOOL);
+      while(task->state!=TASK_DONE){
+        pthread_cond_wait(&condPOOL_DONE, &mutexPOOL);
+      }
+      pthread_mutex_unlock(&mutexPOOL);
+    }
+  }
+#endif
+  result = task->result;
+  FREEMEMORY(task);
+  return result;
+}
+
+/* ------------------ ThreadPoolWaitAll ------------------------ */
+
+void ThreadPoolWaitAll(taskdata **tasks, int ntasks){
+  int i;
+
+  for(i = 0; i<ntasks; i++){
+    ThreadPoolWait(tasks[i]);
+    tasks[i] = NULL;
+  }
+}
+
+/* ------------------ ThreadPoolPrintTimes ------------------------ */
+
+void ThreadPoolPrintTimes(void){
+  int i;
+
+#ifdef pp_THREAD
+  pthread_mutex_lock(&mutexPOOL);
+#endif
+  if(npool_timings>0){
+    PRINTF("task timings (%i threads)\n", ThreadPoolSize());
+    PRINTF("  %-24s %6s %10s %10s\n", "task", "count", "total(s)", "max(s)");
+  }
+  for(i = 0; i<npool_timings; i++){
+    tasktimedata *tt;
+
+    tt = pool_timings+i;
+    PRINTF("  %-24s %6i %10.3f %10.3f\n", tt->label, tt->count, tt->time, tt->time_max);
+  }
+#ifdef pp_THREAD
+  pthread_mutex_unlock(&mutexPOOL);
+#endif
+}
@@ -0,0 +1,53 @@
+#ifndef THREADPOOL_H_DEFINED
+#define THREADPOOL_H_DEFINED
+#ifdef pp_THREAD
+#include <pthread.h>
+#endif
+
+#define MAX_POOL_THREADS 64
+#define MAX_POOL_TIMINGS 64
+
+#define TASK_QUEUED  0
+#define TASK_RUNNING 1
+#define TASK_DONE    2
+
+/* --------------------------  taskdata ------------------------------------ */
+
+typedef struct _taskdata {
+  void *(*func)(void *);
+  void *arg, *result;
+  char label[32];
+  int state, detached, queue;
+  float time;
+  struct _taskdata *prev, *next;
+} taskdata;
+
+/* --------------------------  taskqueuedata ------------------------------------ */
+
+typedef struct _taskqueuedata {
+  taskdata *first, *last;
+#ifdef pp_THREAD
+  pthread_mutex_t mutex;
+#endif
+} taskqueuedata;
+
+/* --------------------------  tasktimedata ------------------------------------ */
+
+typedef struct _tasktimedata {
+  char label[32];
+  int count;
+  float time, time_max;
+} tasktimedata;
+
+int      ThreadPoolInit(int nthreads);
+int      ThreadPoolSize(void);
+int      ThreadPoolIsWorker(void);
+int      GetNumProcessors(void);
+double   GetWallTime(void);
+taskdata *ThreadPoolSubmit(char *label, void *(*func)(void *), void *arg);
+void     ThreadPoolRun(char *label, void *(*func)(void *), void *arg);
+int      ThreadPoolDone(taskdata *task);
+void     *ThreadPoolWait(taskdata *task);
+void     ThreadPoolWaitAll(taskdata **tasks, int ntasks);
+void     ThreadPoolPrintTimes(void);
+#endif
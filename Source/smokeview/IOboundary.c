@@ -1,4 +1,5 @@
 #include "options.h"
+#include "glew.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/stat.h>
@@ -8,6 +9,7 @@
 #include "update.h"
 #include "smokeviewvars.h"
 #include "compress.h"
+#include "threadpool.h"
 
 #define FIRST_TIME 1
 
@@ -1177,6 +1179,118 @@ void GetBoundaryHeader2(char *file,
   fclose(stream);
 }
 
+/* ------------------ CloseBoundaryFile ------------------------ */
+
+void CloseBoundaryFile(bndffiledata *bndfi){
+  MUnmapFile(&bndfi->map);
+  FREEMEMORY(bndfi->ijk);
+  FREEMEMORY(bndfi->patchsize);
+  bndfi->npatches = 0;
+  bndfi->npatchsize = 0;
+  bndfi->nframes = 0;
+}
+
+/* ------------------ OpenBoundaryFile ------------------------ */
+
+int OpenBoundaryFile(char *file, int version, bndffiledata *bndfi){
+
+// map a boundary file and read its header, returns 1 if successful, 0 otherwise.
+// the file is
+//   three 30 character labels (long label, short label, unit)
+//   npatches
+//   i1,i2,j1,j2,k1,k2(,patchdir if version!=0) for each patch
+// followed by frames of
+//   time
+//   the values of each patch, one record per patch
+// frames are located from the header and frame sizes so they may be read in any order
+
+  unsigned char *record;
+  FILE_SIZE offset;
+  int i, nijk;
+
+  bndfi->map.buffer = NULL;
+  bndfi->ijk = NULL;
+  bndfi->patchsize = NULL;
+  bndfi->npatches = 0;
+  bndfi->npatchsize = 0;
+  bndfi->nframes = 0;
+  if(MMapFile(file, &bndfi->map, MMAP_SEQUENTIAL)==0){
+    PRINTF(" The boundary file name, %s, does not exist\n", file);
+    return 0;
+  }
+
+  offset = 0;
+  for(i = 0; i<3; i++){
+    if(GetFortRecord(&bndfi->map, &offset, 30)==NULL){
+      CloseBoundaryFile(bndfi);
+      return 0;
+    }
+  }
+  record = GetFortRecord(&bndfi->map, &offset, 4);
+  if(record==NULL){
+    CloseBoundaryFile(bndfi);
+    return 0;
+  }
+  memcpy(&bndfi->npatches, record, 4);
+  if(bndfi->npatches<0){
+    CloseBoundaryFile(bndfi);
+    return 0;
+  }
+
+  nijk = (version==0 ? 6 : 7);
+  NewMemory((void **)&bndfi->ijk,       7*MAX(bndfi->npatches, 1)*sizeof(int));
+  NewMemory((void **)&bndfi->patchsize,   MAX(bndfi->npatches, 1)*sizeof(int));
+  for(i = 0; i<bndfi->npatches; i++){
+    int *ijk;
+
+    ijk = bndfi->ijk+7*i;
+    ijk[6] = 0;
+    record = GetFortRecord(&bndfi->map, &offset, 4*nijk);
+    if(record==NULL){
+      CloseBoundaryFile(bndfi);
+      return 0;
+    }
+    memcpy(ijk, record, 4*nijk);
+    bndfi->patchsize[i] = (ijk[1]+1-ijk[0])*(ijk[3]+1-ijk[2])*(ijk[5]+1-ijk[4]);
+    bndfi->npatchsize += bndfi->patchsize[i];
+  }
+  bndfi->header_size = offset;
+  bndfi->frame_size  = (HEADER_SIZE+4+TRAILER_SIZE)+(FILE_SIZE)bndfi->npatches*(HEADER_SIZE+TRAILER_SIZE)+4*(FILE_SIZE)bndfi->npatchsize;
+  bndfi->nframes     = (int)((bndfi->map.size-bndfi->header_size)/bndfi->frame_size);
+  return 1;
+}
+
+/* ------------------ GetBoundaryFrame ------------------------ */
+
+int GetBoundaryFrame(bndffiledata *bndfi, int iframe, float *time, float *vals, int *file_size){
+
+// copy frame iframe of a boundary file opened with OpenBoundaryFile, returns 1 if successful, 0 if the
+// frame is not complete (the end of the file or a frame still being written)
+
+  unsigned char *record;
+  FILE_SIZE offset;
+  int i;
+
+  *file_size = 0;
+  if(iframe<0||iframe>=bndfi->nframes)return 0;
+  offset = bndfi->header_size+(FILE_SIZE)iframe*bndfi->frame_size;
+  record = GetFortRecord(&bndfi->map, &offset, 4);
+  if(record==NULL)return 0;
+  memcpy(time, record, 4);
+  *file_size += 4;
+  for(i = 0; i<bndfi->npatches; i++){
+    int nbytes;
+
+    nbytes = 4*bndfi->patchsize[i];
+    record = GetFortRecord(&bndfi->map, &offset, nbytes);
+    if(record==NULL)return 0;
+    memcpy(vals, record, nbytes);
+    vals += bndfi->patchsize[i];
+    *file_size += nbytes;
+  }
+  return 1;
+}
+
 /* ------------------ GetBoundarySizeInfo ------------------------ */
 
 void GetBoundarySizeInfo(patchdata *patchi, int *nframes, int *buffersize){
@@ -1296,7 +1410,6 @@ void GetBoundarySizeInfo(patchdata *patchi, int *nframes, int *buffersize){
 
 FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
   int error;
-  FILE_SIZE lenfile;
   int patchfilenum;
   float *xyzpatchcopy;
   float *xyzpatch_ignitecopy;
@@ -1304,9 +1417,6 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
   int maxtimes_boundary;
   int n;
   int ii;
-  int headersize, framesize;
-  int statfile;
-  STRUCTSTAT statbuffer;
   int nbb;
   int ibartemp,jbartemp,kbartemp;
   float *xplttemp,*yplttemp,*zplttemp;
@@ -1326,12 +1436,17 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
   int ncompressed_buffer;
   char *file;
   float read_time, total_time;
-  int file_unit, wallcenter=0;
+  int wallcenter=0;
   FILE_SIZE return_filesize = 0;
+  bndffiledata bndf_file;
+  int iframe_file = 0;
 
   update_fileload = 1;
   patchi = patchinfo + ifile;
   if(patchi->loaded==0&&flag==UNLOAD)return 0;
+  bndf_file.map.buffer = NULL;
+  bndf_file.ijk = NULL;
+  bndf_file.patchsize = NULL;
   if(strcmp(patchi->label.shortlabel,"wc")==0)wallcenter=1;
 
   if(output_patchdata==1){
@@ -1472,14 +1587,13 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
 
   UpdateBoundaryHist(patchi);
 
-  lenfile = strlen(file);
   if(patchi->compression_type==UNCOMPRESSED){
-    FORTgetpatchsizes1(&file_unit,file,&meshi->npatches,&headersize,&error,lenfile);
-    if(error!=0){
+    if(OpenBoundaryFile(file, patchi->version, &bndf_file)==0){
       ReadBoundary(ifile,UNLOAD,&error);
       *errorcode=1;
       return 0;
     }
+    meshi->npatches = bndf_file.npatches;
   }
   else{
     meshi->npatches=0;
@@ -1506,7 +1620,7 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
        NewResizeMemory(meshi->blockstart,        sizeof(int)*(1+meshi->npatches))==0){
       *errorcode=1;
       if(patchi->compression_type==UNCOMPRESSED){
-        FORTclosefortranfile(&file_unit);
+        CloseBoundaryFile(&bndf_file);
       }
       ReadBoundary(ifile,UNLOAD,&error);
       return 0;
@@ -1514,10 +1628,19 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
   }
 
   if(patchi->compression_type==UNCOMPRESSED){
-    FORTgetpatchsizes2(&file_unit,&patchi->version,
-      &meshi->npatches,&meshi->npatchsize,
-      meshi->pi1,meshi->pi2,meshi->pj1,meshi->pj2,meshi->pk1,meshi->pk2,meshi->patchdir,
-      &headersize,&framesize);
+    for(n=0;n<meshi->npatches;n++){
+      int *ijk;
+
+      ijk = bndf_file.ijk+7*n;
+      meshi->pi1[n] = ijk[0];
+      meshi->pi2[n] = ijk[1];
+      meshi->pj1[n] = ijk[2];
+      meshi->pj2[n] = ijk[3];
+      meshi->pk1[n] = ijk[4];
+      meshi->pk2[n] = ijk[5];
+      if(patchi->version!=0)meshi->patchdir[n] = ijk[6];
+    }
+    meshi->npatchsize = bndf_file.npatchsize;
 
     // loadpatchbysteps
     //  0 - load entire uncompressed data set
@@ -1526,16 +1649,13 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
 
     loadpatchbysteps=UNCOMPRESSED_ALLFRAMES;
     if(flag==LOAD||flag==RELOAD){
+      int file_frames;
+
       maxtimes_boundary = MAXFRAMES+51;
-      statfile=STAT(file,&statbuffer);
-      if(statfile==0&&framesize!=0){
-        int file_frames;
-
-        patchi->ntimes_old = patchi->ntimes;
-        patchi->ntimes = (statbuffer.st_size-headersize)/framesize;
-        file_frames=patchi->ntimes+51;
-        if(file_frames<maxtimes_boundary)maxtimes_boundary=file_frames;
-      }
+      patchi->ntimes_old = patchi->ntimes;
+      patchi->ntimes = bndf_file.nframes;
+      file_frames=patchi->ntimes+51;
+      if(file_frames<maxtimes_boundary)maxtimes_boundary=file_frames;
       meshi->maxtimes_boundary=maxtimes_boundary;
 
 
@@ -1545,7 +1665,7 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
   one time step at a time rather than for all time steps.
   */
 
-      if(statfile==0&&(setpatchmin==1||setpatchmax==1)&&cache_boundarydata==0)loadpatchbysteps=UNCOMPRESSED_BYFRAME;
+      if((setpatchmin==1||setpatchmax==1)&&cache_boundarydata==0)loadpatchbysteps=UNCOMPRESSED_BYFRAME;
     }
   }
   else{
@@ -1584,7 +1704,7 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
       patchi->loaded=0;
       patchi->display=0;
       if(patchi->compression_type==UNCOMPRESSED){
-        FORTclosefortranfile(&file_unit);
+        CloseBoundaryFile(&bndf_file);
       }
       ReadBoundary(ifile,UNLOAD,&error);
       return 0;
@@ -2067,7 +2187,7 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
       NewResizeMemory(meshi->patchval, sizeof(float)*meshi->npatchsize)==0||
       NewResizeMemory(meshi->cpatchval,sizeof(unsigned char)*npatchvals)==0){
       *errorcode=1;
-      FORTclosefortranfile(&file_unit);
+      CloseBoundaryFile(&bndf_file);
       ReadBoundary(ifile,UNLOAD,&error);
       return 0;
     }
@@ -2087,7 +2207,7 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
   NewResizeMemory(meshi->zipsize,    sizeof(unsigned int)*maxtimes_boundary);
   if(meshi->patch_times==NULL){
     *errorcode=1;
-    FORTclosefortranfile(&file_unit);
+    CloseBoundaryFile(&bndf_file);
     ReadBoundary(ifile,UNLOAD,&error);
     return 0;
   }
@@ -2101,7 +2221,7 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
   else{
     if(meshi->patchval == NULL){
       *errorcode = 1;
-      FORTclosefortranfile(&file_unit);
+      CloseBoundaryFile(&bndf_file);
       ReadBoundary(ifile, UNLOAD, &error);
       return 0;
     }
@@ -2127,20 +2247,14 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
     error=0;
     if(loadpatchbysteps==UNCOMPRESSED_ALLFRAMES||loadpatchbysteps==UNCOMPRESSED_BYFRAME){
       if(ii==framestart&&framestart>0){
-        int framesizes;
-
-        framesizes = framesize*framestart-8;
-        FORTskipdata(&file_unit,&framesizes);
+        iframe_file = framestart;
         local_first = 0;
       }
       for(n=0;n<boundframestep;n++){
         if(error==0){
-          int npatchval_iframe;
           int filesize;
 
-          FORTgetpatchdata(&file_unit,&meshi->npatches,
-          meshi->pi1,meshi->pi2,meshi->pj1,meshi->pj2,meshi->pk1,meshi->pk2,
-          meshi->patch_timesi,meshi->patchval_iframe,&npatchval_iframe,&filesize, &error);
+          if(GetBoundaryFrame(&bndf_file, iframe_file++, meshi->patch_timesi, meshi->patchval_iframe, &filesize)==0)error = 1;
           return_filesize += filesize;
         }
       }
@@ -2233,7 +2347,7 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
              ){
               *errorcode=1;
               ReadBoundary(ifile,UNLOAD,&error);
-              FORTclosefortranfile(&file_unit);
+              CloseBoundaryFile(&bndf_file);
               return 0;
             }
           }
@@ -2249,6 +2363,7 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
     }
   }
   STOP_TIMER(read_time);
+  CloseBoundaryFile(&bndf_file);
 
   /* convert patch values into integers pointing to an rgb color table */
 
@@ -2259,7 +2374,7 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
     npatchvals = meshi->npatch_times*meshi->npatchsize;
     if(npatchvals==0||NewResizeMemory(meshi->cpatchval,sizeof(unsigned char)*npatchvals)==0){
       *errorcode=1;
-      FORTclosefortranfile(&file_unit);
+      CloseBoundaryFile(&bndf_file);
       ReadBoundary(ifile,UNLOAD,&error);
       return 0;
     }
@@ -2267,7 +2382,7 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
   if(NewResizeMemory(colorlabelpatch,MAXRGB*sizeof(char *))==0){
     *errorcode=1;
     if(loadpatchbysteps!=COMPRESSED_ALLFRAMES){
-      FORTclosefortranfile(&file_unit);
+      CloseBoundaryFile(&bndf_file);
     }
     ReadBoundary(ifile,UNLOAD,&error);
     return 0;
@@ -2279,7 +2394,7 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
     if(NewResizeMemory(colorlabelpatch[n],11)==0){
       *errorcode=1;
       if(loadpatchbysteps!=COMPRESSED_ALLFRAMES){
-        FORTclosefortranfile(&file_unit);
+        CloseBoundaryFile(&bndf_file);
       }
       ReadBoundary(ifile,UNLOAD,&error);
       return 0;
@@ -2343,6 +2458,7 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
   }
   patchi->loaded=1;
   patchi->display=1;
+  update_boundary_vbo = 1;
   iboundarytype=GetBoundaryType(patchi);
   ShowBoundaryMenu(ShowEXTERIORwallmenu);
   for(n = 0;n<meshi->npatches;n++){
@@ -2371,125 +2487,94 @@ FILE_SIZE ReadBoundaryBndf(int ifile, int flag, int *errorcode){
   return return_filesize;
 }
 
-/* ------------------ ReadGeomDataSize ------------------------ */
+/* ------------------ GetGeomDataSize ------------------------ */
 
-void GetGeomDataSize(char *filename,int *ntimes,int *nvars,int *error){
+void GetGeomDataSize(mmapfiledata *mapinfo, int *ntimes, int *nvars, int *error){
 
-  float time;
-  int one, version;
-  int nvert_s, nvert_d, nface_s, nface_d;
-  FILE *stream=NULL;
-  int returncode=0;
-  int nvars_local, ntimes_local;
+// count the frames and values of a mapped boundary element file.  a frame that is not
+// complete (a frame still being written) is not counted
 
-  *error=1;
-  if(filename==NULL)return;
-  stream = fopen(filename,"rb");
-  if(stream==NULL)printf(" The boundary element file name, %s, does not exist",filename);
+  FILE_SIZE offset;
+  int nvars_local, ntimes_local;
 
+  *error = 1;
+  *ntimes = 0;
+  *nvars = 0;
+  offset = 0;
+  if(GetFortRecord(mapinfo, &offset, 4)==NULL)return;  // one
+  if(GetFortRecord(mapinfo, &offset, 4)==NULL)return;  // version
   *error = 0;
 
-  FORTREAD(&one, 1, stream);
-  FORTREAD(&version, 1, stream);
   ntimes_local = 0;
   nvars_local = 0;
   for(;;){
-    int nvals[4], nskip;
-
-    FORTREAD(&time, 1, stream);
-    if(returncode==0)break;
-    FORTREAD(nvals, 4, stream);
-    if(returncode==0)break;
-    nvert_s = nvals[0];
-    nface_s = nvals[1];
-    nvert_d = nvals[2];
-    nface_d = nvals[3];
-    nskip = 0;
-    if(nvert_s>0)nskip += 4 + 4*nvert_s + 4;
-    if(nface_s>0)nskip += 4 + 4*nface_s + 4;
-    if(nvert_d>0)nskip += 4 + 4*nvert_d + 4;
-    if(nface_d>0)nskip += 4 + 4*nface_d + 4;
-    if(fseek(stream, nskip, SEEK_CUR)!=0)break;
-    nvars_local += nvert_s+nvert_d+nface_s+nface_d;
+    unsigned char *record;
+    int nvals[4], j;
+
+    if(GetFortRecord(mapinfo, &offset, 4)==NULL)break;
+    record = GetFortRecord(mapinfo, &offset, 4*4);
+    if(record==NULL)break;
+    memcpy(nvals, record, 4*4);
+    for(j = 0; j<4; j++){
+      if(nvals[j]>0&&GetFortRecord(mapinfo, &offset, 4*nvals[j])==NULL)break;
+    }
+    if(j<4)break;
+    nvars_local += nvals[0]+nvals[1]+nvals[2]+nvals[3];
     ntimes_local++;
   }
   *nvars = nvars_local;
   *ntimes = ntimes_local;
-  fclose(stream);
 }
 
-/* ------------------ ReadGeomData ------------------------ */
+/* ------------------ GetGeomData ------------------------ */
 
-FILE_SIZE GetGeomData(char *filename, int ntimes, int nvals, float *times, int *nstatics, int *ndynamics, float *vals, int *error){
-  FILE_SIZE file_size;
+FILE_SIZE GetGeomData(mmapfiledata *mapinfo, int ntimes, int nvals, float *times, int *nstatics, int *ndynamics, float *vals, int *error){
 
-  int i, one, nvars;
-  int nvert_s, ntri_s, nvert_d, ntri_d;
-  int version;
-  int returncode=0;
-  float time;
+// copy the frames counted by GetGeomDataSize from a mapped boundary element file
 
-  FILE *stream;
+  FILE_SIZE file_size, offset;
+  int i, nvars;
 
   file_size = 0;
   *error = 1;
-  if(filename==NULL)return 0;
-  stream = fopen(filename, "rb");
-  if(stream==NULL){
-    printf(" The boundary file name %s does not exist\n",filename);
-    return 0;
-  }
+  offset = 0;
+  if(GetFortRecord(mapinfo, &offset, 4)==NULL)return 0;
+  if(GetFortRecord(mapinfo, &offset, 4)==NULL)return 0;
 
   *error = 0;
-  FORTREAD(&one, 1, stream);
-  FORTREAD(&version, 1, stream);
   file_size = 2*(4+4+4);
   nvars = 0;
   for(i = 0; i<ntimes; i++){
-    int nvals[4];
+    unsigned char *record;
+    int nframe_vals[4], j;
 
-    FORTREAD(&time, 1, stream);
-    times[i] = time;
-    if(returncode==0)break;
+    record = GetFortRecord(mapinfo, &offset, 4);
+    if(record==NULL)break;
+    memcpy(times+i, record, 4);
     file_size += (4+4+4);
-    FORTREAD(nvals, 4, stream);
-    nvert_s = nvals[0];
-    ntri_s = nvals[1];
-    nvert_d = nvals[2];
-    ntri_d = nvals[3];
+    record = GetFortRecord(mapinfo, &offset, 4*4);
+    if(record==NULL)break;
+    memcpy(nframe_vals, record, 4*4);
     file_size += (4+4*4+4);
-    nstatics[i] = nvert_s+ntri_s;
+    nstatics[i]  = nframe_vals[0]+nframe_vals[1];
+    ndynamics[i] = nframe_vals[2]+nframe_vals[3];
 
-    if(nvert_s>0){
-      FORTREAD(vals+nvars, nvert_s, stream);
-      if(returncode==0)break;
-      file_size += (4+4*nvert_s+4);
-    }
-    nvars += nvert_s;
+    // vertex and face values, static then dynamic
 
-    if(ntri_s>0){
-      FORTREAD(vals+nvars, ntri_s, stream);
-      if(returncode==0)break;
-      file_size += (4+4*ntri_s+4);
-    }
-    nvars += ntri_s;
+    for(j = 0; j<4; j++){
+      int nj;
 
-    ndynamics[i] = nvert_d+ntri_d;
-    if(nvert_d>0){
-      FORTREAD(vals+nvars, nvert_d, stream);
-      if(returncode==0)break;
-      file_size += (4+4*nvert_d+4);
+      nj = nframe_vals[j];
+      if(nj<=0)continue;
+      if(nvars+nj>nvals)break;
+      record = GetFortRecord(mapinfo, &offset, 4*nj);
+      if(record==NULL)break;
+      memcpy(vals+nvars, record, 4*nj);
+      nvars += nj;
+      file_size += (4+4*nj+4);
     }
-    nvars += nvert_d;
-
-    if(ntri_d>0){
-      FORTREAD(vals+nvars, ntri_d, stream);
-      if(returncode==0)break;
-      file_size += (4+4*ntri_d+4);
-    }
-    nvars += ntri_d;
+    if(j<4)break;
   }
-  fclose(stream);
   return file_size;
 }
 
@@ -2505,6 +2590,7 @@ FILE_SIZE ReadGeomData(patchdata *patchi, slicedata *slicei, int load_flag, int
   int error;
   FILE_SIZE return_filesize = 0;
   float total_time;
+  mmapfiledata geom_map;
 
   // 1
   // time
@@ -2546,11 +2632,14 @@ FILE_SIZE ReadGeomData(patchdata *patchi, slicedata *slicei, int load_flag, int
   }
   if(patchi->skip == 1)return 0;
 
-  //GetGeomDataHeader(file,&ntimes,&nvals);
-
-  GetGeomDataSize(file, &ntimes_local, &nvals, &error);
+  if(MMapFile(file, &geom_map, MMAP_SEQUENTIAL)==0){
+    if(load_flag!=UPDATE_HIST)PRINTF(" - no data\n");
+    return 0;
+  }
+  GetGeomDataSize(&geom_map, &ntimes_local, &nvals, &error);
 
   if(nvals==0){
+    MUnmapFile(&geom_map);
     if(load_flag!=UPDATE_HIST)PRINTF(" - no data\n");
     return 0;
   }
@@ -2565,8 +2654,9 @@ FILE_SIZE ReadGeomData(patchdata *patchi, slicedata *slicei, int load_flag, int
   }
 
   if(load_flag == UPDATE_HIST){
-    GetGeomData(file, ntimes_local, nvals, patchi->geom_times,
+    GetGeomData(&geom_map, ntimes_local, nvals, patchi->geom_times,
       patchi->geom_nstatics, patchi->geom_ndynamics, patchi->geom_vals, &error);
+    MUnmapFile(&geom_map);
     ResetHistogram(patchi->histogram, NULL, NULL);
     UpdateHistogram(patchi->geom_vals, NULL, nvals, patchi->histogram);
     CompleteHistogram(patchi->histogram);
@@ -2576,8 +2666,9 @@ FILE_SIZE ReadGeomData(patchdata *patchi, slicedata *slicei, int load_flag, int
     int filesize;
 
     PRINTF("Loading %s(%s)", file,patchi->label.shortlabel);
-    filesize=GetGeomData(file, ntimes_local, nvals, patchi->geom_times,
+    filesize=GetGeomData(&geom_map, ntimes_local, nvals, patchi->geom_times,
       patchi->geom_nstatics, patchi->geom_ndynamics, patchi->geom_vals, &error);
+    MUnmapFile(&geom_map);
     return_filesize += filesize;
   }
 
@@ -2700,9 +2791,13 @@ FILE_SIZE ReadGeomData(patchdata *patchi, slicedata *slicei, int load_flag, int
 FILE_SIZE ReadBoundary(int ifile, int load_flag, int *errorcode){
   patchdata *patchi;
   FILE_SIZE return_filesize = 0;
+  int memory_id_save;
 
   update_fileload = 1;
+  PrefetchFlush();
   patchi = patchinfo + ifile;
+  if(load_flag==LOAD)EnforceMemoryBudget(GetMemoryLoadSize(patchi->file, patchi->memory_id, &patchi->last_display));
+  memory_id_save = SetMemoryId(patchi->memory_id);
   if(patchi->structured == NO){
     ASSERT(ifile>=0&&ifile<ngeominfo);
     if(load_flag == LOAD){
@@ -2714,6 +2809,7 @@ FILE_SIZE ReadBoundary(int ifile, int load_flag, int *errorcode){
     ASSERT(ifile>=0&&ifile<npatchinfo);
     return_filesize=ReadBoundaryBndf(ifile,load_flag,errorcode);
   }
+  SetMemoryId(memory_id_save);
   if(load_flag==LOAD){
 
   }
@@ -2775,6 +2871,282 @@ void Global2LocalBoundaryBounds(const char *key){
   }
 }
 
+#ifdef pp_GPU
+
+/* ------------------ FreeBoundaryVBO ------------------------ */
+
+void FreeBoundaryVBO(meshdata *meshi){
+  boundaryvbodata *vbo;
+
+  vbo = &meshi->boundary_vbo;
+  if(vbo->defined==0)return;
+  glDeleteBuffers(1, &vbo->vertex_id);
+  glDeleteBuffers(1, &vbo->index_id);
+  glDeleteBuffers(1, &vbo->value_id);
+  FREEMEMORY(vbo->patch_starts);
+  FREEMEMORY(vbo->patch_counts);
+  FREEMEMORY(vbo->draw_starts);
+  FREEMEMORY(vbo->draw_counts);
+  vbo->defined = 0;
+}
+
+/* ------------------ MakeBoundaryVBO ------------------------ */
+
+void MakeBoundaryVBO(meshdata *meshi){
+
+// the patch nodes (xyzpatch) are put into a static vertex buffer in the same order as the
+// boundary file values so each frame of values can be copied into the value buffer as is.
+// the index buffer holds two triangles for each unblanked cell, patch by patch.  the last
+// vertex of each triangle is the lower left node of its cell, the node that colors the cell
+// when a cell centered file is drawn with flat shading.
+
+  boundaryvbodata *vbo;
+  unsigned int *indices;
+  int n, nindices, nmax;
+
+  FreeBoundaryVBO(meshi);
+  vbo = &meshi->boundary_vbo;
+  if(meshi->npatches<=0||meshi->npatchsize<=0||meshi->xyzpatch==NULL||meshi->patchblank==NULL)return;
+
+  nmax = 0;
+  for(n = 0; n<meshi->npatches; n++){
+    nmax += 6*MAX(meshi->boundary_row[n]-1, 0)*MAX(meshi->boundary_col[n]-1, 0);
+  }
+  NewMemory((void **)&indices,           MAX(nmax, 1)*sizeof(unsigned int));
+  NewMemory((void **)&vbo->patch_starts, meshi->npatches*sizeof(int));
+  NewMemory((void **)&vbo->patch_counts, meshi->npatches*sizeof(int));
+  NewMemory((void **)&vbo->draw_starts,  meshi->npatches*sizeof(GLvoid *));
+  NewMemory((void **)&vbo->draw_counts,  meshi->npatches*sizeof(int));
+
+  nindices = 0;
+  for(n = 0; n<meshi->npatches; n++){
+    int nrow, ncol, irow, icol, *patchblank;
+
+    nrow = meshi->boundary_row[n];
+    ncol = meshi->boundary_col[n];
+    patchblank = meshi->patchblank;
+    vbo->patch_starts[n] = nindices;
+    for(irow = 0; irow<nrow-1; irow++){
+      for(icol = 0; icol<ncol-1; icol++){
+        unsigned int ii1, ii2, *ind;
+
+        ii1 = meshi->blockstart[n]+irow*ncol+icol;
+        ii2 = ii1+ncol;
+        if(patchblank[ii1]!=GAS||patchblank[ii1+1]!=GAS||patchblank[ii2]!=GAS||patchblank[ii2+1]!=GAS)continue;
+        ind = indices+nindices;
+        if(meshi->patchdir[n]<0){
+          ind[0] = ii2+1;
+          ind[1] = ii1+1;
+          ind[2] = ii1;
+          ind[3] = ii2;
+          ind[4] = ii2+1;
+          ind[5] = ii1;
+        }
+        else{
+          ind[0] = ii1+1;
+          ind[1] = ii2+1;
+          ind[2] = ii1;
+          ind[3] = ii2+1;
+          ind[4] = ii2;
+          ind[5] = ii1;
+        }
+        nindices += 6;
+      }
+    }
+    vbo->patch_counts[n] = nindices-vbo->patch_starts[n];
+  }
+
+  glGenBuffers(1, &vbo->vertex_id);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo->vertex_id);
+  glBufferData(GL_ARRAY_BUFFER, 3*meshi->npatchsize*sizeof(float), meshi->xyzpatch, GL_STATIC_DRAW);
+
+  // threshold times (floats) followed by the values (bytes), refilled in DrawBoundaryGPU
+
+  glGenBuffers(1, &vbo->value_id);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo->value_id);
+  glBufferData(GL_ARRAY_BUFFER, meshi->npatchsize*(sizeof(float)+1), NULL, GL_STREAM_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  glGenBuffers(1, &vbo->index_id);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo->index_id);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, MAX(nindices, 1)*sizeof(unsigned int), indices, GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  FREEMEMORY(indices);
+  vbo->defined = 1;
+}
+
+/* ------------------ DrawBoundaryVBOPatches ------------------------ */
+
+void DrawBoundaryVBOPatches(const meshdata *meshi, int side, int dir, int threshold){
+
+// side 0 draws the patches drawn from "both sides", side 1 and -1 the one sided patches facing
+// the positive and negative directions.  dir, if not 0, selects patches with that direction.
+// threshold uses the patch selection of DrawBoundaryTextureThreshold.
+
+  const boundaryvbodata *vbo;
+  int n, ndraws = 0;
+
+  vbo = &meshi->boundary_vbo;
+  for(n = 0; n<meshi->npatches; n++){
+    int iblock, drawit, patchdir;
+    meshdata *meshblock;
+
+    if(vbo->patch_counts[n]==0)continue;
+    iblock = meshi->blockonpatch[n];
+    meshblock = meshi->meshonpatch[n];
+    if(iblock!=-1&&meshblock!=NULL){
+      blockagedata *bc;
+
+      bc = meshblock->blockageinfoptrs[iblock];
+      if(bc->showtimelist!=NULL&&bc->showtimelist[itimes]==0)continue;
+    }
+    patchdir = meshi->patchdir[n];
+    drawit = 0;
+    if(threshold==1){
+      if(meshi->vis_boundaries[n]==1){
+        if(side==0&&patchdir==0)drawit = 1;
+        if(side==1&&patchdir>0)drawit = 1;
+        if(side==-1&&patchdir<0)drawit = 1;
+      }
+    }
+    else if(side==0){
+      if(meshi->vis_boundaries[n]==1&&patchdir==0)drawit = 1;
+      if(meshi->boundarytype[n]!=INTERIORwall&&showpatch_both==1)drawit = 1;
+    }
+    else if(meshi->vis_boundaries[n]==1&&(meshi->boundarytype[n]==INTERIORwall||showpatch_both==0)){
+      if(side==1&&patchdir>0)drawit = 1;
+      if(side==-1&&patchdir<0)drawit = 1;
+    }
+    if(drawit==0||(dir!=0&&patchdir!=dir))continue;
+    vbo->draw_starts[ndraws] = (GLvoid *)(vbo->patch_starts[n]*sizeof(unsigned int));
+    vbo->draw_counts[ndraws] = vbo->patch_counts[n];
+    ndraws++;
+  }
+  if(ndraws>0)glMultiDrawElements(GL_TRIANGLES, vbo->draw_counts, GL_UNSIGNED_INT, (const GLvoid **)vbo->draw_starts, ndraws);
+}
+
+/* ------------------ DrawBoundaryGPU ------------------------ */
+
+void DrawBoundaryGPU(const meshdata *meshi, int cell_center, int threshold){
+
+// draws what DrawBoundaryTexture (cell_center 0, threshold 0), DrawBoundaryTextureThreshold
+// (0, 1), DrawBoundaryCellCenter (1, 0) and DrawBoundaryThresholdCellcenter (1, 1) draw.
+// only the values of the current frame, and the threshold times when needed, are sent to
+// the GPU, the colorbar and threshold colors are applied by the boundary shader.
+
+  const boundaryvbodata *vbo;
+  patchdata *patchi;
+  unsigned char *cpatchval_iframe;
+  int use_data, use_threshold, use_transparency;
+  float burn_color[4] = {0.0,0.0,0.0,1.0};
+
+  vbo = &meshi->boundary_vbo;
+  patchi = patchinfo+meshi->patchfilenum;
+  if(patchi->compression_type==COMPRESSED_ZLIB){
+    cpatchval_iframe = meshi->cpatchval_iframe_zlib;
+  }
+  else{
+    cpatchval_iframe = meshi->cpatchval_iframe;
+  }
+  if(cpatchval_iframe==NULL)return;
+
+  use_data = 1;
+  if(cell_center==1&&threshold==1)use_data = 0;
+  use_threshold = threshold;
+  if(cell_center==1&&threshold==0&&vis_threshold==1&&vis_onlythreshold==0&&do_threshold==1){
+    use_threshold = 1;
+    memcpy(burn_color, char_color, 4*sizeof(float));
+  }
+  use_transparency = 0;
+  if(threshold==0&&((use_transparency_data==1&&contour_type==LINE_CONTOURS)||setpatchchopmin==1||setpatchchopmax==1))use_transparency = 1;
+
+  glBindBuffer(GL_ARRAY_BUFFER, vbo->value_id);
+  glBufferSubData(GL_ARRAY_BUFFER, meshi->npatchsize*sizeof(float), meshi->npatchsize, cpatchval_iframe);
+  if(use_threshold==1){
+    glBufferSubData(GL_ARRAY_BUFFER, 0, meshi->npatchsize*sizeof(float), meshi->thresholdtime);
+  }
+
+  LoadBoundaryShaders();
+  glUniform1i(GPUbndf_colormap, 0);
+  glUniform1i(GPUbndf_cell_center, cell_center);
+  glUniform1i(GPUbndf_use_data, use_data);
+  glUniform1i(GPUbndf_use_threshold, use_threshold);
+  glUniform4fv(GPUbndf_burn_color, 1, burn_color);
+  glUniform1f(GPUbndf_time, global_times[itimes]);
+  glActiveTexture(GL_TEXTURE0);
+  if(threshold==1&&cell_center==0){
+    glBindTexture(GL_TEXTURE_1D, texture_colorbar_id);
+  }
+  else{
+    glBindTexture(GL_TEXTURE_1D, texture_patch_colorbar_id);
+  }
+
+  glEnableVertexAttribArray(GPUbndf_value);
+  glVertexAttribPointer(GPUbndf_value, 1, GL_UNSIGNED_BYTE, GL_FALSE, 0, (void *)(meshi->npatchsize*sizeof(float)));
+  if(use_threshold==1){
+    glEnableVertexAttribArray(GPUbndf_thresholdtime);
+    glVertexAttribPointer(GPUbndf_thresholdtime, 1, GL_FLOAT, GL_FALSE, 0, (void *)0);
+  }
+  else{
+    glVertexAttrib1f(GPUbndf_thresholdtime, -1.0);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, vbo->vertex_id);
+  glEnableVertexAttribArray(GPUbndf_position);
+  glVertexAttribPointer(GPUbndf_position, 3, GL_FLOAT, GL_FALSE, 0, (void *)0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo->index_id);
+  if(cell_center==1)glShadeModel(GL_FLAT);
+  if(use_transparency==1)TransparentOn();
+
+  /* if a contour boundary does not match a blockage face then draw "both sides" of boundary */
+
+  if(cullfaces==1)glDisable(GL_CULL_FACE);
+  DrawBoundaryVBOPatches(meshi, 0, 0, threshold);
+  if(cullfaces==1)glEnable(GL_CULL_FACE);
+
+  /* if a contour boundary DOES match a blockage face then draw "one sides" of boundary */
+
+  if(threshold==1||hidepatchsurface==1){
+    DrawBoundaryVBOPatches(meshi, 1,  0, threshold);
+    DrawBoundaryVBOPatches(meshi, -1, 0, threshold);
+  }
+  else{
+    float dbound[3];
+    int dir;
+
+    dbound[0] = (meshi->xplt[1]-meshi->xplt[0])/10.0;
+    dbound[1] = (meshi->yplt[1]-meshi->yplt[0])/10.0;
+    dbound[2] = (meshi->zplt[1]-meshi->zplt[0])/10.0;
+    for(dir = XDIR; dir<=ZDIR; dir++){
+      float offset[3] = {0.0, 0.0, 0.0};
+
+      // the y offsets are reversed, as in DrawBoundaryTexture
+
+      offset[dir-1] = dbound[dir-1];
+      if(dir==YDIR)offset[dir-1] = -offset[dir-1];
+
+      glPushMatrix();
+      glTranslatef(offset[0], offset[1], offset[2]);
+      DrawBoundaryVBOPatches(meshi, 1, dir, threshold);
+      glPopMatrix();
+
+      glPushMatrix();
+      glTranslatef(-offset[0], -offset[1], -offset[2]);
+      DrawBoundaryVBOPatches(meshi, -1, -dir, threshold);
+      glPopMatrix();
+    }
+  }
+
+  if(use_transparency==1)TransparentOff();
+  if(cell_center==1)glShadeModel(GL_SMOOTH);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glDisableVertexAttribArray(GPUbndf_position);
+  if(use_threshold==1)glDisableVertexAttribArray(GPUbndf_thresholdtime);
+  glDisableVertexAttribArray(GPUbndf_value);
+  UnLoadShaders();
+}
+#endif
+
 /* ------------------ DrawBoundaryTexture ------------------------ */
 
 void DrawBoundaryTexture(const meshdata *meshi){
@@ -2835,6 +3207,12 @@ void DrawBoundaryTexture(const meshdata *meshi){
   patchi = patchinfo + meshi->patchfilenum;
 
   if(patch_times[0]>global_times[itimes]||patchi->display==0)return;
+#ifdef pp_GPU
+  if(meshi->boundary_vbo.defined==1){
+    DrawBoundaryGPU(meshi, 0, 0);
+    return;
+  }
+#endif
   if(cullfaces==1)glDisable(GL_CULL_FACE);
 
   /* if a contour boundary does not match a blockage face then draw "both sides" of boundary */
@@ -3154,6 +3532,12 @@ void DrawBoundaryTextureThreshold(const meshdata *meshi){
   patchi = patchinfo + meshi->patchfilenum;
 
   if(patch_times[0]>global_times[itimes]||patchi->display==0)return;
+#ifdef pp_GPU
+  if(meshi->boundary_vbo.defined==1){
+    DrawBoundaryGPU(meshi, 0, 1);
+    return;
+  }
+#endif
   if(cullfaces==1)glDisable(GL_CULL_FACE);
 
   /* if a contour boundary does not match a blockage face then draw "both sides" of boundary */
@@ -3464,6 +3848,12 @@ void DrawBoundaryThresholdCellcenter(const meshdata *meshi){
   patchi = patchinfo + meshi->patchfilenum;
 
   if(patch_times[0]>global_times[itimes]||patchi->display==0)return;
+#ifdef pp_GPU
+  if(meshi->boundary_vbo.defined==1){
+    DrawBoundaryGPU(meshi, 1, 1);
+    return;
+  }
+#endif
   if(cullfaces==1)glDisable(GL_CULL_FACE);
 
   /* if a contour boundary does not match a blockage face then draw "both sides" of boundary */
@@ -3688,6 +4078,12 @@ void DrawBoundaryCellCenter(const meshdata *meshi){
   patchi = patchinfo+meshi->patchfilenum;
 
   if(patch_times[0]>global_times[itimes]||patchi->display==0)return;
+#ifdef pp_GPU
+  if(meshi->boundary_vbo.defined==1&&patchventcolors==NULL){
+    DrawBoundaryGPU(meshi, 1, 0);
+    return;
+  }
+#endif
   if(cullfaces==1)glDisable(GL_CULL_FACE);
 
   /* if a contour boundary does not match a blockage face then draw "both sides" of boundary */
@@ -4368,7 +4764,8 @@ void DrawBoundary(const meshdata *meshi){
 
 void DrawBoundaryFrame(int flag){
   meshdata *meshi;
-  int i;
+  int i, use_gpu = 0, ndrawn = 0;
+  double draw_start = 0.0;
 
   for(i=0;i<npatchinfo;i++){
     patchdata *patchi;
@@ -4390,8 +4787,24 @@ void DrawBoundaryFrame(int flag){
     }
   }
   if(flag == DRAW_TRANSPARENT)return;
+  if(show_task_timings==1){
+    glFinish();
+    draw_start = GetWallTime();
+  }
+#ifdef pp_GPU
+  if(use_boundary_gpu==1&&gpuactive==1)use_gpu = 1;
+#endif
   for(i=0;i<nmeshes;i++){
     meshi=meshinfo+i;
+#ifdef pp_GPU
+    if(update_boundary_vbo==1)FreeBoundaryVBO(meshi);
+    if(use_gpu==1&&meshi->npatches>0&&meshi->patchfilenum>=0&&patchinfo[meshi->patchfilenum].loaded==1){
+      if(meshi->boundary_vbo.defined==0)MakeBoundaryVBO(meshi);
+    }
+    else{
+      FreeBoundaryVBO(meshi);
+    }
+#endif
     if(meshi->npatches>0){
       int filenum;
 
@@ -4401,6 +4814,7 @@ void DrawBoundaryFrame(int flag){
 
         patchi = patchinfo + filenum;
         if(patchi->loaded==0||patchi->display==0||patchi->shortlabel_index!=iboundarytype)continue;
+        ndrawn++;
         if(usetexturebar!=0){
           if(vis_threshold==1&&do_threshold==1){
             if(patchi->patch_filetype==PATCH_STRUCTURED_CELL_CENTER){
@@ -4431,6 +4845,12 @@ void DrawBoundaryFrame(int flag){
       }
     }
   }
+  update_boundary_vbo = 0;
+  if(show_task_timings==1&&ndrawn>0){
+    glFinish();
+    boundary_draw_time[use_gpu] += GetWallTime()-draw_start;
+    nboundary_draw_frames[use_gpu]++;
+  }
 }
 
 /* ------------------ UpdateBoundaryTypes ------------------------ */
@@ -4737,6 +5157,7 @@ void UncompressBoundaryDataFrame(meshdata *meshi,int local_iframe){
   uLongf countout;
   unsigned char *compressed_data;
 
+  if(PrefetchGetFrame(PREFETCH_BOUNDARY, meshi, local_iframe, &meshi->cpatchval_iframe_zlib, meshi->npatchsize)==1)return;
   compressed_data = meshi->cpatchval_zlib+meshi->zipoffset[local_iframe];
   countin = meshi->zipsize[local_iframe];
   countout=meshi->npatchsize;
@@ -4784,25 +5205,59 @@ void UpdateAllBoundaryBoundsST(void){
   UNLOCK_COMPRESS;
 }
 
+/* ------------------ GetBoundaryFileHist ------------------------ */
+
+void GetBoundaryFileHist(patchdata *patchi){
+
+// histogram all frames of a structured boundary file.  only patchi is modified so that
+// the files of several meshes may be histogrammed at the same time
+
+  bndffiledata bndf_file;
+  float *patchframe, patchtime;
+  int i;
+
+  if(OpenBoundaryFile(patchi->file, patchi->version, &bndf_file)==0)return;
+  if(bndf_file.npatches==0){
+    CloseBoundaryFile(&bndf_file);
+    return;
+  }
+  NewMemory((void **)&patchframe, MAX(bndf_file.npatchsize, 1)*sizeof(float));
+  ResetHistogram(patchi->histogram, NULL, NULL);
+  for(i = 0; i<bndf_file.nframes; i++){
+    int filesize;
+
+    if(GetBoundaryFrame(&bndf_file, i, &patchtime, patchframe, &filesize)==0)break;
+    UpdateHistogram(patchframe, NULL, bndf_file.npatchsize, patchi->histogram);
+  }
+  FREEMEMORY(patchframe);
+  CloseBoundaryFile(&bndf_file);
+  CompleteHistogram(patchi->histogram);
+}
+
+/* ------------------ MtGetBoundaryFileHist ------------------------ */
+
+void *MtGetBoundaryFileHist(void *arg){
+  GetBoundaryFileHist((patchdata *)arg);
+  return NULL;
+}
+
 /* ------------------ UpdateBoundaryHist ------------------------ */
 
 int UpdateBoundaryHist(patchdata *patchj){
+
+// histogram the boundary files of every mesh with the same quantity as patchj.  the structured files
+// are read through memory mappings on the pool's worker threads, one task per file
+
   int i;
-  int first=1;
   int sum=0;
+  patchdata **hist_patches = NULL;
+  int nhist_patches = 0;
 
   if(patchj->setvalmax==SET_MAX&&patchj->setvalmin==SET_MIN)return 0;
 
+  if(patchj->structured == YES)NewMemory((void **)&hist_patches, npatchinfo*sizeof(patchdata *));
   for(i=0;i<npatchinfo;i++){
-    int npatches, error;
     patchdata *patchi;
-    int unit1;
-    FILE_SIZE lenfile;
-    int error1;
-    int *pi1, *pi2, *pj1, *pj2, *pk1, *pk2, *patchdir, *patchsize;
-    float patchtime1, *patchframe;
-    int patchframesize;
-    int j;
     time_t modtime;
 
     patchi = patchinfo + i;
@@ -4820,62 +5275,10 @@ int UpdateBoundaryHist(patchdata *patchj){
     if(patchi->inuse_getbounds==1||patchi->histogram->complete==1||patchi->bounds.defined==1)continue;
 
     patchi->inuse_getbounds=1;
-
-    if(first==1){
-      first=0;
-    }
     sum++;
-    lenfile=strlen(patchi->file);
 
     if (patchj->structured == YES) {
-      FORTgetboundaryheader1(patchi->file, &unit1, &npatches, &error, lenfile);
-      if (npatches == 0) {
-        FORTclosefortranfile(&unit1);
-        continue;
-      }
-
-      NewMemory((void **)&pi1, npatches * sizeof(int));
-      NewMemory((void **)&pi2, npatches * sizeof(int));
-      NewMemory((void **)&pj1, npatches * sizeof(int));
-      NewMemory((void **)&pj2, npatches * sizeof(int));
-      NewMemory((void **)&pk1, npatches * sizeof(int));
-      NewMemory((void **)&pk2, npatches * sizeof(int));
-      NewMemory((void **)&patchdir, npatches * sizeof(int));
-      NewMemory((void **)&patchsize, npatches * sizeof(int));
-
-      FORTgetboundaryheader2(&unit1, &patchi->version, &npatches, pi1, pi2, pj1, pj2, pk1, pk2, patchdir);
-
-      patchframesize = 0;
-      for (j = 0; j < npatches; j++) {
-        int npatchsize;
-
-        npatchsize = (pi2[j] + 1 - pi1[j]);
-        npatchsize *= (pj2[j] + 1 - pj1[j]);
-        npatchsize *= (pk2[j] + 1 - pk1[j]);
-        patchframesize += npatchsize;
-      }
-
-      NewMemory((void **)&patchframe, patchframesize * sizeof(float));
-      ResetHistogram(patchi->histogram, NULL, NULL);
-      error1 = 0;
-      while (error1 == 0) {
-        int ndummy, filesize;
-
-        FORTgetpatchdata(&unit1, &npatches,
-          pi1, pi2, pj1, pj2, pk1, pk2, &patchtime1, patchframe, &ndummy, &filesize, &error1);
-        UpdateHistogram(patchframe, NULL, patchframesize, patchi->histogram);
-      }
-      FORTclosefortranfile(&unit1);
-      FREEMEMORY(patchframe);
-      FREEMEMORY(pi1);
-      FREEMEMORY(pi2);
-      FREEMEMORY(pj1);
-      FREEMEMORY(pj2);
-      FREEMEMORY(pk1);
-      FREEMEMORY(pk2);
-      FREEMEMORY(patchdir);
-      FREEMEMORY(patchsize);
-      CompleteHistogram(patchi->histogram);
+      hist_patches[nhist_patches++] = patchi;
     }
     else{
       int error_code;
@@ -4884,6 +5287,22 @@ int UpdateBoundaryHist(patchdata *patchj){
       ReadGeomData(patchi, NULL, UNLOAD, &error_code);
     }
   }
+  if(boundary_multithread==1&&ThreadPoolSize()>1&&nhist_patches>1){
+    taskdata **tasks;
+
+    NewMemory((void **)&tasks, nhist_patches*sizeof(taskdata *));
+    for(i = 0; i<nhist_patches; i++){
+      tasks[i] = ThreadPoolSubmit("boundary histogram", MtGetBoundaryFileHist, hist_patches[i]);
+    }
+    ThreadPoolWaitAll(tasks, nhist_patches);
+    FREEMEMORY(tasks);
+  }
+  else{
+    for(i = 0; i<nhist_patches; i++){
+      GetBoundaryFileHist(hist_patches[i]);
+    }
+  }
+  FREEMEMORY(hist_patches);
   return sum;
 }
 
@@ -970,6 +970,7 @@ FILE_SIZE ReadIso(const char *file, int ifile, int flag, int *geom_frame_index,
   if(ifile>=0&&ifile<nisoinfo){
 
     isoi = isoinfo+ifile;
+    if(flag==LOAD)EnforceMemoryBudget(GetMemoryLoadSize(isoi->file, isoi->memory_id, &isoi->last_display));
     if(flag==LOAD)PRINTF("Loading %s(%s)", file,isoi->surface_label.shortlabel);
     if(isoi->is_fed==1){
       ReadFed(ifile, ALL_SLICE_FRAMES, NULL,  flag, FED_ISO, errorcode);
@@ -2,6 +2,7 @@
 #define NXYZ_COMP_PART 3
 
 #include "options.h"
+#include "glew.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -15,12 +16,16 @@
 #include "compress.h"
 #include "IOobjects.h"
 #include "stdio_m.h"
+#include "threadpool.h"
+
+// var points into the file buffer so the read only fails if the record runs past the end of the buffer,
+// a record ending exactly at the end of the file (the last class of the last frame has no quantities) is complete
 
 #define FORTPART5READ_mv(var,size) \
 fseek_m(PART5FILE,4,SEEK_CUR);\
 fread_mv(var,4,size,PART5FILE);\
 fseek_m(PART5FILE,4,SEEK_CUR);\
-returncode=feof_m(PART5FILE)
+returncode = ftell_m(PART5FILE)<0 ? FAIL_m : PASS_m
 
 #define FORTPART5READ_m(var,size) \
 fseek_m(PART5FILE,4,SEEK_CUR);\
@@ -143,23 +148,71 @@ void CopyDepVals(partclassdata *partclassi, part5data *datacopy, float *colorptr
   prop->tag_number = datacopy->tags[j];
 }
 
-/* ------------------ CompareTags ------------------------ */
+/* ------------------ HashTag ------------------------ */
 
-int CompareTags(const void *arg1, const void *arg2){
-  int i, j;
+int HashTag(int tag, int nhash){
+  unsigned int hash;
 
-  i = *(int *)arg1;
-  j = *(int *)arg2;
-  if(i < j)return -1;
-  if(i > j)return 1;
-  return 0;
+  // tags are often consecutive integers, Fibonacci hashing spreads them over the table
+
+  hash = (unsigned int)tag*2654435761u;
+  return (int)(hash%(unsigned int)nhash);
+}
+
+/* ------------------ PartRank ------------------------ */
+
+unsigned char PartRank(int tag){
+
+  // a particle's level of detail rank only depends on its tag, so the same particles are
+  // drawn in every frame.  the top byte of the Fibonacci hash is spread evenly over 0-255
+  // even for consecutive tags
 
+  return (unsigned char)(((unsigned int)tag*2654435761u)>>24);
+}
+
+/* ------------------ MakeTagHash ------------------------ */
+
+void MakeTagHash(part5data *datacopy, int nparts){
+  int *tag_hash, nhash, j;
+
+// the tag hash of a frame/class is an open addressing table of 2*npoints particle indices
+// (-1 for an empty entry) keyed by the particle's tag, so a tag is found in O(1) probes
+
+  nhash = 2*datacopy->npoints;
+  if(nhash<=0)return;
+  tag_hash = datacopy->tag_hash;
+  for(j = 0; j<nhash; j++){
+    tag_hash[j] = -1;
+  }
+  nparts = MIN(nparts, datacopy->npoints);
+  for(j = 0; j<nparts; j++){
+    int ihash;
+
+    ihash = HashTag(datacopy->tags[j], nhash);
+    while(tag_hash[ihash]!=-1){
+      if(++ihash==nhash)ihash = 0;
+    }
+    tag_hash[ihash] = j;
+  }
+}
+
+/* ------------------ FindTag ------------------------ */
+
+int FindTag(const part5data *datacopy, int tag){
+  int *tag_hash, nhash, ihash;
+
+  nhash = 2*datacopy->npoints;
+  tag_hash = datacopy->tag_hash;
+  for(ihash = HashTag(tag, nhash);tag_hash[ihash]!=-1;){
+    if(datacopy->tags[tag_hash[ihash]]==tag)return tag_hash[ihash];
+    if(++ihash==nhash)ihash = 0;
+  }
+  return -1;
 }
 
 /* ------------------ GetTagIndex ------------------------ */
 
 int GetTagIndex(const partdata *partin_arg, part5data **datain_arg, int tagval_arg){
-  int *returnval_local;
   part5data *data_local;
   int i;
 
@@ -167,6 +220,7 @@ int GetTagIndex(const partdata *partin_arg, part5data **datain_arg, int tagval_a
 
   for(i = -1; i < npartinfo; i++){
     const partdata *parti_local;
+    int index_local;
 
     if(i == -1){
       parti_local = partin_arg;
@@ -182,15 +236,165 @@ int GetTagIndex(const partdata *partin_arg, part5data **datain_arg, int tagval_a
 
     if(data_local->npoints == 0)continue;
     ASSERT(data_local->npoints>0);
-    ASSERT(data_local->sort_tags != NULL);
-    returnval_local = bsearch(&tagval_arg, data_local->sort_tags, data_local->npoints, 2 * sizeof(int), CompareTags);
-    if(returnval_local== NULL)continue;
+    ASSERT(data_local->tag_hash != NULL);
+    index_local = FindTag(data_local, tagval_arg);
+    if(index_local== -1)continue;
     *datain_arg = data_local;
-    return *(returnval_local+ 1);
+    return index_local;
   }
   return -1;
 }
 
+/* ------------------ DrawPartPoints ------------------------ */
+
+void DrawPartPoints(part5data *datacopy, int itype, int show_default){
+  short *sx, *sy, *sz;
+  unsigned char *vis, *rank, *color;
+  int j;
+
+  sx = datacopy->sx;
+  sy = datacopy->sy;
+  sz = datacopy->sz;
+  vis = datacopy->vis_part;
+  rank = datacopy->ranks;
+  glBegin(GL_POINTS);
+  if(show_default == 1){
+    glColor4fv(datacopy->partclassbase->rgb);
+    for(j = 0;j < datacopy->npoints;j++){
+      if(vis[j] == 1&&rank[j] < part_lod_level){
+        glVertex3f(xplts[sx[j]], yplts[sy[j]], zplts[sz[j]]);
+      }
+    }
+  }
+  else{
+    color = datacopy->irvals + itype*datacopy->npoints;
+    for(j = 0;j < datacopy->npoints;j++){
+      if(vis[j] == 1&&rank[j] < part_lod_level){
+        if(current_property != NULL && (color[j] > current_property->imax || color[j] < current_property->imin))continue;
+        glColor4fv(rgb_full[color[j]]);
+        glVertex3f(xplts[sx[j]], yplts[sy[j]], zplts[sz[j]]);
+      }
+    }
+  }
+  glEnd();
+}
+
+#ifdef pp_GPU
+/* ------------------ FreePartVBO ------------------------ */
+
+void FreePartVBO(partdata *parti){
+  partvbodata *vbo;
+
+  vbo = &parti->vbo;
+  if(vbo->buffer_ids==NULL)return;
+  glDeleteBuffers(vbo->nbuffers, vbo->buffer_ids);
+  FREEMEMORY(vbo->buffer_ids);
+  vbo->nbuffers = 0;
+  vbo->frame = -1;
+}
+
+/* ------------------ UpdatePartVBO ------------------------ */
+
+void UpdatePartVBO(partdata *parti){
+  partvbodata *vbo;
+  part5data *datacopy;
+  int i, ipframe;
+
+// each class of the displayed frame gets one buffer holding sx, sy and sz (shorts), the
+// visibility flags, the level of detail ranks and every color index column (bytes).  the
+// buffers are only refilled when the frame changes, so showing a different particle
+// quantity just selects another column in DrawPartPointsGPU
+
+  vbo = &parti->vbo;
+  if(vbo->buffer_ids!=NULL&&vbo->nbuffers!=parti->nclasses)FreePartVBO(parti);
+  if(vbo->buffer_ids==NULL){
+    NewMemory((void **)&vbo->buffer_ids, parti->nclasses*sizeof(GLuint));
+    glGenBuffers(parti->nclasses, vbo->buffer_ids);
+    vbo->nbuffers = parti->nclasses;
+    vbo->frame = -1;
+  }
+  ipframe = MAX(parti->itime, 0);
+  if(vbo->frame==ipframe)return;
+  vbo->frame = ipframe;
+
+  datacopy = parti->data5 + parti->nclasses*ipframe;
+  for(i = 0; i<parti->nclasses; i++){
+    int npoints, ntypes;
+
+    npoints = datacopy->npoints;
+    ntypes = 0;
+    if(parti->irvals!=NULL)ntypes = datacopy->partclassbase->ntypes;
+    if(npoints>0){
+      glBindBuffer(GL_ARRAY_BUFFER, vbo->buffer_ids[i]);
+      glBufferData(GL_ARRAY_BUFFER, npoints*(3*sizeof(short)+2+ntypes), NULL, GL_STREAM_DRAW);
+      glBufferSubData(GL_ARRAY_BUFFER, 0,                   npoints*sizeof(short), datacopy->sx);
+      glBufferSubData(GL_ARRAY_BUFFER, npoints*sizeof(short),   npoints*sizeof(short), datacopy->sy);
+      glBufferSubData(GL_ARRAY_BUFFER, 2*npoints*sizeof(short), npoints*sizeof(short), datacopy->sz);
+      glBufferSubData(GL_ARRAY_BUFFER, 3*npoints*sizeof(short),           npoints, datacopy->vis_part);
+      glBufferSubData(GL_ARRAY_BUFFER, 3*npoints*sizeof(short)+npoints,   npoints, datacopy->ranks);
+      if(ntypes>0){
+        glBufferSubData(GL_ARRAY_BUFFER, 3*npoints*sizeof(short)+2*npoints, npoints*ntypes, datacopy->irvals);
+      }
+    }
+    datacopy++;
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/* ------------------ DrawPartPointsGPU ------------------------ */
+
+void DrawPartPointsGPU(const partdata *parti, part5data *datacopy, int iclass, int itype, int show_default){
+  int npoints;
+  float xyz0[3], dxyz[3];
+
+  npoints = datacopy->npoints;
+  xyz0[0] = xplts[0];
+  xyz0[1] = yplts[0];
+  xyz0[2] = zplts[0];
+  dxyz[0] = (xplts[256*128-1]-xplts[0])/(float)(256*128-1);
+  dxyz[1] = (yplts[256*128-1]-yplts[0])/(float)(256*128-1);
+  dxyz[2] = (zplts[256*128-1]-zplts[0])/(float)(256*128-1);
+
+  glUniform3fv(GPUpart_xyz0, 1, xyz0);
+  glUniform3fv(GPUpart_dxyz, 1, dxyz);
+  glUniform1i(GPUpart_colormap, 0);
+  glUniform1i(GPUpart_use_default, show_default);
+  glUniform4fv(GPUpart_default_color, 1, datacopy->partclassbase->rgb);
+  glUniform1f(GPUpart_imin, (float)current_property->imin);
+  glUniform1f(GPUpart_imax, (float)current_property->imax);
+  glUniform1f(GPUpart_lod_level, (float)part_lod_level);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_1D, texture_colorbar_id);
+
+  glBindBuffer(GL_ARRAY_BUFFER, parti->vbo.buffer_ids[iclass]);
+  glEnableVertexAttribArray(GPUpart_sx);
+  glEnableVertexAttribArray(GPUpart_sy);
+  glEnableVertexAttribArray(GPUpart_sz);
+  glEnableVertexAttribArray(GPUpart_vis);
+  glEnableVertexAttribArray(GPUpart_rank);
+  glVertexAttribPointer(GPUpart_sx,   1, GL_SHORT,         GL_FALSE, 0, (void *)0);
+  glVertexAttribPointer(GPUpart_sy,   1, GL_SHORT,         GL_FALSE, 0, (void *)(npoints*sizeof(short)));
+  glVertexAttribPointer(GPUpart_sz,   1, GL_SHORT,         GL_FALSE, 0, (void *)(2*npoints*sizeof(short)));
+  glVertexAttribPointer(GPUpart_vis,  1, GL_UNSIGNED_BYTE, GL_FALSE, 0, (void *)(3*npoints*sizeof(short)));
+  glVertexAttribPointer(GPUpart_rank, 1, GL_UNSIGNED_BYTE, GL_FALSE, 0, (void *)(3*npoints*sizeof(short)+npoints));
+  if(show_default==0){
+    glEnableVertexAttribArray(GPUpart_color);
+    glVertexAttribPointer(GPUpart_color, 1, GL_UNSIGNED_BYTE, GL_FALSE, 0, (void *)(3*npoints*sizeof(short)+(2+itype)*npoints));
+  }
+  else{
+    glVertexAttrib1f(GPUpart_color, 0.0);
+  }
+  glDrawArrays(GL_POINTS, 0, npoints);
+  if(show_default==0)glDisableVertexAttribArray(GPUpart_color);
+  glDisableVertexAttribArray(GPUpart_rank);
+  glDisableVertexAttribArray(GPUpart_vis);
+  glDisableVertexAttribArray(GPUpart_sz);
+  glDisableVertexAttribArray(GPUpart_sy);
+  glDisableVertexAttribArray(GPUpart_sx);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+#endif
+
 /* ------------------ DrawPart ------------------------ */
 
 void DrawPart(const partdata *parti){
@@ -222,7 +426,7 @@ void DrawPart(const partdata *parti){
       for(i = 0;i < parti->nclasses;i++){
         short *sx, *sy, *sz;
         float *angle, *width, *depth, *height;
-        unsigned char *vis, *color;
+        unsigned char *vis, *rank, *color;
         partclassdata *partclassi;
         int partclass_index, itype, vistype, class_vis;
         int show_default;
@@ -250,6 +454,7 @@ void DrawPart(const partdata *parti){
         sy = datacopy->sy;
         sz = datacopy->sz;
         vis = datacopy->vis_part;
+        rank = datacopy->ranks;
         if(parti->evac == 1){
           int avatar_type = 0;
 
@@ -378,26 +583,18 @@ void DrawPart(const partdata *parti){
             // *** draw particles as points
 
             if(datacopy->partclassbase->vis_type == PART_POINTS){
-              glBegin(GL_POINTS);
-              if(show_default == 1){
-                glColor4fv(datacopy->partclassbase->rgb);
-                for(j = 0;j < datacopy->npoints;j++){
-                  if(vis[j] == 1){
-                    glVertex3f(xplts[sx[j]], yplts[sy[j]], zplts[sz[j]]);
-                  }
-                }
+#ifdef pp_GPU
+              if(parti->vbo.buffer_ids != NULL){
+                LoadPartShaders();
+                DrawPartPointsGPU(parti, datacopy, i, itype, show_default);
+                UnLoadShaders();
               }
               else{
-                color = datacopy->irvals + itype*datacopy->npoints;
-                for(j = 0;j < datacopy->npoints;j++){
-                  if(vis[j] == 1){
-                    if(current_property != NULL && (color[j] > current_property->imax || color[j] < current_property->imin))continue;
-                    glColor4fv(rgb_full[color[j]]);
-                    glVertex3f(xplts[sx[j]], yplts[sy[j]], zplts[sz[j]]);
-                  }
-                }
+                DrawPartPoints(datacopy, itype, show_default);
               }
-              glEnd();
+#else
+              DrawPartPoints(datacopy, itype, show_default);
+#endif
             }
 
             // *** draw particles using smokeview object
@@ -406,7 +603,7 @@ void DrawPart(const partdata *parti){
               for(j = 0;j < datacopy->npoints;j++){
                 float *colorptr;
 
-                if(vis[j] != 1)continue;
+                if(vis[j] != 1 || rank[j] >= part_lod_level)continue;
 
                 glPushMatrix();
                 glTranslatef(xplts[sx[j]], yplts[sy[j]], zplts[sz[j]]);
@@ -463,7 +660,7 @@ void DrawPart(const partdata *parti){
               if(show_default == 1){
                 glColor4fv(datacopy->partclassbase->rgb);
                 for(j = 0;j < datacopy->npoints;j++){
-                  if(vis[j] == 1){
+                  if(vis[j] == 1 && rank[j] < part_lod_level){
                     if(flag == 1){
                       dx = dxv[j];
                       dy = dyv[j];
@@ -477,7 +674,7 @@ void DrawPart(const partdata *parti){
               else{
                 color = datacopy->irvals + itype*datacopy->npoints;
                 for(j = 0;j < datacopy->npoints;j++){
-                  if(vis[j] == 1){
+                  if(vis[j] == 1 && rank[j] < part_lod_level){
                     glColor4fv(rgb_full[color[j]]);
                     if(flag == 1){
                       dx = dxv[j];
@@ -506,13 +703,13 @@ void DrawPart(const partdata *parti){
                 zz = zplts[sz[j]];
 
                 zoffset = GetZCellValOffset(meshinfo, xx, yy, &loc);
-                if(vis[j] == 1)glVertex3f(xx, yy, zz + zoffset);
+                if(vis[j] == 1 && rank[j] < part_lod_level)glVertex3f(xx, yy, zz + zoffset);
               }
             }
             else{
               color = datacopy->irvals + itype*datacopy->npoints;
               for(j = 0;j < datacopy->npoints;j++){
-                if(vis[j] == 1){
+                if(vis[j] == 1 && rank[j] < part_lod_level){
                   glColor4fv(rgb_full[color[j]]);
                   glVertex3f(xplts[sx[j]], yplts[sy[j]], zplts[sz[j]]);
                 }
@@ -535,7 +732,7 @@ void DrawPart(const partdata *parti){
     for(i = 0;i < parti->nclasses;i++){
       short *sx, *sy, *sz;
       short *sxx, *syy, *szz;
-      unsigned char *vis;
+      unsigned char *vis, *rank;
       int k;
       int show_default;
       float *colorptr;
@@ -566,6 +763,7 @@ void DrawPart(const partdata *parti){
       sy = datacopy->sy;
       sz = datacopy->sz;
       vis = datacopy->vis_part;
+      rank = datacopy->ranks;
 
       if(show_default == 1){
 
@@ -579,7 +777,7 @@ void DrawPart(const partdata *parti){
           int tagval;
 
           tagval = datacopy->tags[j];
-          if(vis[j] == 0)continue;
+          if(vis[j] == 0 || rank[j] >= part_lod_level)continue;
           glBegin(GL_LINE_STRIP);
           glVertex3f(xplts[sx[j]], yplts[sy[j]], zplts[sz[j]]);
           for(k = 1;k < streak5step;k++){
@@ -607,7 +805,7 @@ void DrawPart(const partdata *parti){
           int tagval;
 
           tagval = datacopy->tags[j];
-          if(vis[j] == 0)continue;
+          if(vis[j] == 0 || rank[j] >= part_lod_level)continue;
           if(GetEvacPartColor(&colorptr, datacopy, show_default, j, itype) == 0)continue;
 
           glBegin(GL_LINE_STRIP);
@@ -638,15 +836,113 @@ void DrawPart(const partdata *parti){
 
 }
 
+/* ------------------ UpdatePartLOD ------------------------ */
+
+// pick how many of the 256 particle ranks to draw so that the number of points per pixel
+// covered by the particle domain stays near part_lod_density.  while time is paused on
+// one frame the level doubles each redraw until every particle is shown again.
+
+void UpdatePartLOD(void){
+  double mv_setup[16], projection_setup[16];
+  GLint viewport_setup[4];
+  float xmin, xmax, ymin, ymax, area, target;
+  int i, npoints = 0, full_view = 0;
+  static int itimes_lod = -1;
+
+  if(use_part_lod==0){
+    part_lod_level = 256;
+    return;
+  }
+  for(i = 0;i < npartinfo;i++){
+    partdata *parti;
+    part5data *datacopy;
+    int j, ipframe;
+
+    parti = partinfo + i;
+    if(parti->loaded==0||parti->display==0||parti->evac==1||parti->data5==NULL)continue;
+    ipframe = MAX(parti->itime, 0);
+    datacopy = parti->data5 + parti->nclasses*ipframe;
+    for(j = 0;j < parti->nclasses;j++){
+      npoints += datacopy[j].npoints;
+    }
+  }
+  if(npoints==0){
+    part_lod_level = 256;
+    return;
+  }
+
+  glGetDoublev(GL_MODELVIEW_MATRIX, mv_setup);
+  glGetDoublev(GL_PROJECTION_MATRIX, projection_setup);
+  glGetIntegerv(GL_VIEWPORT, viewport_setup);
+  xmin = viewport_setup[0]+viewport_setup[2];
+  xmax = viewport_setup[0];
+  ymin = viewport_setup[1]+viewport_setup[3];
+  ymax = viewport_setup[1];
+  for(i = 0;i < 8;i++){
+    double dscreen[3];
+    float x, y, z;
+
+    x = (i&1)==0 ? xplts[0] : xplts[256*128-1];
+    y = (i&2)==0 ? yplts[0] : yplts[256*128-1];
+    z = (i&4)==0 ? zplts[0] : zplts[256*128-1];
+    gluProject(x, y, z, mv_setup, projection_setup, viewport_setup, dscreen, dscreen+1, dscreen+2);
+    if(dscreen[2]<0.0||dscreen[2]>1.0)full_view = 1;
+    xmin = MIN(xmin, dscreen[0]);
+    xmax = MAX(xmax, dscreen[0]);
+    ymin = MIN(ymin, dscreen[1]);
+    ymax = MAX(ymax, dscreen[1]);
+  }
+  if(full_view==1){
+    area = (float)viewport_setup[2]*(float)viewport_setup[3];
+  }
+  else{
+    xmin = MAX(xmin, viewport_setup[0]);
+    xmax = MIN(xmax, viewport_setup[0]+viewport_setup[2]);
+    ymin = MAX(ymin, viewport_setup[1]);
+    ymax = MIN(ymax, viewport_setup[1]+viewport_setup[3]);
+    area = MAX(xmax-xmin, 1.0)*MAX(ymax-ymin, 1.0);
+  }
+  target = 256.0*part_lod_density*area/(float)npoints;
+  target = CLAMP(target, 1.0, 256.0);
+
+  if(stept==1||itimes!=itimes_lod||part_lod_level<(int)target){
+    part_lod_level = (int)target;
+  }
+  else if(part_lod_level<256){
+    part_lod_level = MIN(2*part_lod_level, 256);
+  }
+  itimes_lod = itimes;
+  if(stept==0&&part_lod_level<256)GLUTPOSTREDISPLAY;
+}
+
 /* ------------------ DrawPartFrame ------------------------ */
 
 void DrawPartFrame(void){
   partdata *parti;
-  int i;
+  int i, use_gpu = 0, ndrawn = 0;
+  double draw_start = 0.0;
 
+  if(show_task_timings==1){
+    glFinish();
+    draw_start = GetWallTime();
+  }
+  UpdatePartLOD();
+#ifdef pp_GPU
+  if(use_part_gpu==1&&gpuactive==1)use_gpu = 1;
+#endif
   for(i=0;i<npartinfo;i++){
     parti = partinfo + i;
+#ifdef pp_GPU
+    if(update_part_vbo==1)parti->vbo.frame = -1;
+    if(parti->loaded==0||use_gpu==0||parti->evac==1||parti->data5==NULL){
+      FreePartVBO(parti);
+    }
+    else{
+      UpdatePartVBO(parti);
+    }
+#endif
     if(parti->loaded==0||parti->display==0)continue;
+    ndrawn++;
     if(parti->evac==1){
       DrawEvac(parti);
       SNIFF_ERRORS("after DrawEvac");
@@ -656,6 +952,15 @@ void DrawPartFrame(void){
       SNIFF_ERRORS("after DrawPart");
     }
   }
+  update_part_vbo = 0;
+  if(show_task_timings==1&&ndrawn>0){
+    int itiming;
+
+    itiming = use_gpu+2*use_part_lod; // cpu, gpu, cpu lod, gpu lod
+    glFinish();
+    part_draw_time[itiming] += GetWallTime()-draw_start;
+    npart_draw_frames[itiming]++;
+  }
 }
 
 /* ------------------ DrawEvacFrame ------------------------ */
@@ -700,8 +1005,9 @@ void FreeAllPart5Data(partdata *parti){
   }
   FREEMEMORY(parti->data5);
   FREEMEMORY(parti->vis_part);
+  FREEMEMORY(parti->ranks);
   FREEMEMORY(parti->tags);
-  FREEMEMORY(parti->sort_tags);
+  FREEMEMORY(parti->tag_hash);
   FREEMEMORY(parti->sx);
   FREEMEMORY(parti->sy);
   FREEMEMORY(parti->sz);
@@ -725,7 +1031,8 @@ void InitPart5Data(part5data *datacopy, partclassdata *partclassi){
   datacopy->avatar_depth=NULL;
   datacopy->tags=NULL;
   datacopy->vis_part=NULL;
-  datacopy->sort_tags=NULL;
+  datacopy->ranks=NULL;
+  datacopy->tag_hash=NULL;
   datacopy->rvals=NULL;
   datacopy->irvals=NULL;
 }
@@ -811,6 +1118,7 @@ void UpdateAllPartVis(partdata *parti){
     }
     if(firstframe_local== 1)firstframe_local = 0;
   }
+  update_part_vbo = 1;
 }
 
 /* ------------------ GetHistFileStatus ------------------------ */
@@ -1254,9 +1562,109 @@ void MergePartHistograms(void){
 }
 #endif
 
+/* ------------------ QuantizePartCoords ------------------------ */
+
+void QuantizePartCoords(short *s, float *x, int n, float x0, float scale){
+  int j;
+
+  // one multiply-add and a conversion per point, no branches - the compiler vectorizes this loop
+
+  for(j = 0; j<n; j++){
+    s[j] = (short)((x[j]-x0)*scale);
+  }
+}
+
+/* ------------------ DecodePartFrame ------------------------ */
+
+void DecodePartFrame(partdata *parti, partframedata *framei){
+  part5data *datacopy;
+  float *xyz;
+  int nparts, i;
+  float factor = 256*128-1;
+
+  datacopy = framei->datacopy;
+  nparts = framei->nparts;
+  if(nparts<=0)return;
+
+  // sx = factor*NORMALIZE_X(x)/xbar
+
+  xyz = framei->xyz;
+  QuantizePartCoords(datacopy->sx, xyz,          nparts, xbar0, factor/(xyzmaxdiff*xbar));
+  QuantizePartCoords(datacopy->sy, xyz+nparts,   nparts, ybar0, factor/(xyzmaxdiff*ybar));
+  QuantizePartCoords(datacopy->sz, xyz+2*nparts, nparts, zbar0, factor/(xyzmaxdiff*zbar));
+  if(parti->evac==1){
+    memcpy(datacopy->avatar_angle,  xyz+3*nparts, nparts*sizeof(float));
+    memcpy(datacopy->avatar_width,  xyz+4*nparts, nparts*sizeof(float));
+    memcpy(datacopy->avatar_depth,  xyz+5*nparts, nparts*sizeof(float));
+    memcpy(datacopy->avatar_height, xyz+6*nparts, nparts*sizeof(float));
+  }
+
+  memcpy(datacopy->tags, framei->tags, nparts*sizeof(int));
+  for(i = 0; i<nparts; i++){
+    datacopy->ranks[i] = PartRank(framei->tags[i]);
+  }
+  MakeTagHash(datacopy, nparts);
+}
+
+/* ------------------ MtDecodePartFrames ------------------------ */
+
+void *MtDecodePartFrames(void *arg){
+  partdecodedata *decodei;
+  int i;
+
+  decodei = (partdecodedata *)arg;
+  for(i = decodei->itask; i<decodei->nframes; i += decodei->ntasks){
+    DecodePartFrame(decodei->parti, decodei->frames+i);
+  }
+  return NULL;
+}
+
+/* ------------------ DecodePartFrames ------------------------ */
+
+void DecodePartFrames(partdata *parti, partframedata *frames, int nframes){
+  int i, mode;
+  double start;
+
+  if(nframes==0)return;
+  start = GetWallTime();
+  if(part_decode_multithread==1&&ThreadPoolSize()>1&&nframes>1){
+    taskdata *tasks[MAX_POOL_THREADS];
+    partdecodedata decodeinfo[MAX_POOL_THREADS];
+    int ntasks;
+
+    mode = 1;
+    ntasks = MIN(ThreadPoolSize(), nframes);
+    for(i = 0; i<ntasks; i++){
+      decodeinfo[i].parti   = parti;
+      decodeinfo[i].frames  = frames;
+      decodeinfo[i].nframes = nframes;
+      decodeinfo[i].itask   = i;
+      decodeinfo[i].ntasks  = ntasks;
+      tasks[i] = ThreadPoolSubmit("particle decode", MtDecodePartFrames, decodeinfo+i);
+    }
+    ThreadPoolWaitAll(tasks, ntasks);
+  }
+  else{
+    mode = 0;
+    for(i = 0; i<nframes; i++){
+      DecodePartFrame(parti, frames+i);
+    }
+  }
+  LOCK_PART_LOAD;
+  part_decode_time[mode] += GetWallTime()-start;
+  npart_decode_files[mode]++;
+  npart_decode_frames[mode] += nframes;
+  UNLOCK_PART_LOAD;
+}
+
 /* ------------------ GetPartData ------------------------ */
 
 void GetPartData(partdata *parti, int partframestep_arg, int nf_all_arg, FILE_SIZE *file_size_arg){
+
+// the file is read in two passes.  The first walks the record headers, indexing where the
+// positions and tags of each frame/class are in the file buffer.  The second decodes the
+// indexed frames into their part5data slots on the pool's worker threads
+
   FILE_m *PART5FILE;
   int i;
   int one_local, version_local, nclasses_local;
@@ -1267,6 +1675,8 @@ void GetPartData(partdata *parti, int partframestep_arg, int nf_all_arg, FILE_SI
   size_t returncode;
   float time_local;
   part5data *datacopy_local;
+  partframedata *frames = NULL;
+  int nframes = 0, nframes_max;
 
   *file_size_arg = GetFileSizeSMV(parti->reg_file);
 
@@ -1301,6 +1711,9 @@ void GetPartData(partdata *parti, int partframestep_arg, int nf_all_arg, FILE_SI
   }
   CheckMemory;
 
+  nframes_max = parti->ntimes*nclasses_local;
+  NewMemory((void **)&frames, MAX(nframes_max, 1)*sizeof(partframedata));
+
   datacopy_local = parti->data5;
   count_local =0;
   count2_local =-1;
@@ -1318,6 +1731,7 @@ void GetPartData(partdata *parti, int partframestep_arg, int nf_all_arg, FILE_SI
       doit_local=0;
     }
     else{
+      if(nframes+nclasses_local>nframes_max)break;
       count2_local++;
       doit_local =1;
     }
@@ -1333,54 +1747,21 @@ void GetPartData(partdata *parti, int partframestep_arg, int nf_all_arg, FILE_SI
       skip_local=0;
       CheckMemory;
       if(doit_local==1){
-        float *xyz;
-        int j;
+        partframedata *framei;
 
+        framei = frames+nframes;
+        framei->datacopy = datacopy_local;
+        framei->nparts   = nparts_local;
         if(parti->evac==1){
-          FORTPART5READ_mv((void **)&xyz, NXYZ_COMP_EVAC*nparts_local);
+          FORTPART5READ_mv((void **)&framei->xyz, NXYZ_COMP_EVAC*nparts_local);
         }
         else{
-          FORTPART5READ_mv((void **)&xyz, NXYZ_COMP_PART*nparts_local);
+          FORTPART5READ_mv((void **)&framei->xyz, NXYZ_COMP_PART*nparts_local);
         }
         if(returncode==FAIL_m)goto wrapup;
-        CheckMemory;
-        if(nparts_local>0){
-          float *x_local, *y_local, *z_local;
-          short *sx_local, *sy_local, *sz_local;
-          float *angle_local, *width_local, *depth_local, *height_local;
-
-          x_local = xyz;
-          y_local = xyz+nparts_local;
-          z_local = xyz+2*nparts_local;
-          sx_local = datacopy_local->sx;
-          sy_local = datacopy_local->sy;
-          sz_local = datacopy_local->sz;
-          if(parti->evac==1){
-            angle_local =datacopy_local->avatar_angle;
-            width_local =datacopy_local->avatar_width;
-            depth_local =datacopy_local->avatar_depth;
-            height_local =datacopy_local->avatar_height;
-          }
-          for(j=0;j<nparts_local;j++){
-            float xx_local, yy_local, zz_local;
-            int factor_local=256*128-1;
-
-            xx_local = NORMALIZE_X(x_local[j])/xbar;
-            yy_local = NORMALIZE_Y(y_local[j])/ybar;
-            zz_local = NORMALIZE_Z(z_local[j])/zbar;
-
-            sx_local[j] = factor_local*xx_local;
-            sy_local[j] = factor_local*yy_local;
-            sz_local[j] = factor_local*zz_local;
-            if(parti->evac==1){
-              angle_local[j] =x_local[j+3*nparts_local];
-              width_local[j] =x_local[j+4*nparts_local];
-              depth_local[j] =x_local[j+5*nparts_local];
-              height_local[j]=x_local[j+6*nparts_local];
-            }
-          }
-          CheckMemory;
-        }
+        FORTPART5READ_mv((void **)&framei->tags, nparts_local);
+        if(returncode==FAIL_m)goto wrapup;
+        nframes++;
       }
       else{
         if(parti->evac==1){
@@ -1389,25 +1770,6 @@ void GetPartData(partdata *parti, int partframestep_arg, int nf_all_arg, FILE_SI
         else{
           skip_local += 4 + NXYZ_COMP_PART*nparts_local*sizeof(float) + 4;
         }
-      }
-      CheckMemory;
-      if(doit_local==1){
-        int *sort_tags_local;
-        int j;
-
-        sort_tags_local =datacopy_local->sort_tags;
-        FORTPART5READ_m(datacopy_local->tags,nparts_local);
-        if(returncode==FAIL_m)goto wrapup;
-        CheckMemory;
-        if(nparts_local>0){
-          for(j=0;j<nparts_local;j++){
-            sort_tags_local[2*j]=datacopy_local->tags[j];
-            sort_tags_local[2*j+1]=j;
-          }
-          qsort( sort_tags_local, (size_t)nparts_local, 2*sizeof(int), CompareTags);
-        }
-      }
-      else{
         skip_local += 4 + nparts_local*sizeof(int) + 4;  // skip over tag
       }
       CheckMemory;
@@ -1449,8 +1811,10 @@ void GetPartData(partdata *parti, int partframestep_arg, int nf_all_arg, FILE_SI
     if(first_frame_local==1)first_frame_local =0;
   }
 wrapup:
+  DecodePartFrames(parti, frames, nframes);
   UpdateAllPartVis(parti);
   CheckMemory;
+  FREEMEMORY(frames);
   FREEMEMORY(numtypes_local);
   FREEMEMORY(numpoints_local);
 }
@@ -2056,18 +2420,21 @@ void GetPartHeader(partdata *parti, int partframestep_arg, int *nf_all, int opti
     }
     if(nall_points_local>0){
       FREEMEMORY(parti->vis_part);
+      FREEMEMORY(parti->ranks);
       FREEMEMORY(parti->tags);
-      FREEMEMORY(parti->sort_tags);
+      FREEMEMORY(parti->tag_hash);
       FREEMEMORY(parti->sx);
       FREEMEMORY(parti->sy);
       FREEMEMORY(parti->sz);
 
       NewMemory((void **)&parti->vis_part,    nall_points_local*sizeof(unsigned char));
+      NewMemory((void **)&parti->ranks,       nall_points_local*sizeof(unsigned char));
       NewMemory((void **)&parti->tags,        nall_points_local*sizeof(int));
-      NewMemory((void **)&parti->sort_tags, 2*nall_points_local*sizeof(int));
+      NewMemory((void **)&parti->tag_hash,  2*nall_points_local*sizeof(int));
       NewMemory((void **)&parti->sx,          nall_points_local*sizeof(short));
       NewMemory((void **)&parti->sy,          nall_points_local*sizeof(short));
       NewMemory((void **)&parti->sz,          nall_points_local*sizeof(short));
+      memset(parti->tag_hash, 255, 2*nall_points_local*sizeof(int)); // empty tag hash entries are -1
     }
     if(nall_points_types_local>0){
       FREEMEMORY(parti->irvals);
@@ -2085,8 +2452,9 @@ void GetPartHeader(partdata *parti, int partframestep_arg, int *nf_all, int opti
 
         datacopy_local->irvals    = parti->irvals    +     nall_points_types_local;
         datacopy_local->vis_part  = parti->vis_part  +     nall_points_local;
+        datacopy_local->ranks     = parti->ranks     +     nall_points_local;
         datacopy_local->tags      = parti->tags      +     nall_points_local;
-        datacopy_local->sort_tags = parti->sort_tags +   2*nall_points_local;
+        datacopy_local->tag_hash = parti->tag_hash +   2*nall_points_local;
         datacopy_local->sx        = parti->sx        +     nall_points_local;
         datacopy_local->sy        = parti->sy        +     nall_points_local;
         datacopy_local->sz        = parti->sz        +     nall_points_local;
@@ -2179,7 +2547,7 @@ void FinalizePartLoad(partdata *parti){
 
 FILE_SIZE ReadPart(char *file_arg, int ifile_arg, int loadflag_arg, int *errorcode_arg){
   size_t lenfile_local;
-  int error_local=0, nf_all_local;
+  int error_local=0, nf_all_local, memory_id_save;
   partdata *parti;
   FILE_SIZE file_size_local;
   float load_time_local;
@@ -2189,6 +2557,7 @@ FILE_SIZE ReadPart(char *file_arg, int ifile_arg, int loadflag_arg, int *errorco
   parti=partinfo+ifile_arg;
 
   update_fileload = 1;
+  update_part_vbo = 1;
   FreeAllPart5Data(parti);
 
   if(parti->loaded==0&&loadflag_arg==UNLOAD)return 0.0;
@@ -2216,6 +2585,7 @@ FILE_SIZE ReadPart(char *file_arg, int ifile_arg, int loadflag_arg, int *errorco
     return 0.0;
   }
 
+  EnforceMemoryBudget(GetMemoryLoadSize(parti->file, parti->memory_id, &parti->last_display));
   lenfile_local = strlen(file_arg);
   if(lenfile_local==0){
     ReadPart("",ifile_arg,UNLOAD,&error_local);
@@ -2231,10 +2601,12 @@ FILE_SIZE ReadPart(char *file_arg, int ifile_arg, int loadflag_arg, int *errorco
   else{
     PRINTF("Loading %s", file_arg);
   }
+  memory_id_save = SetMemoryId(parti->memory_id);
   GetPartHeader(parti, partframestep, &nf_all_local, NOT_FORCE, 1);
   CheckMemory;
   GetPartData(parti, partframestep, nf_all_local, &file_size_local);
   CheckMemory;
+  SetMemoryId(memory_id_save);
   LOCK_PART_LOAD;
   parti->loaded = 1;
   parti->display = 1;
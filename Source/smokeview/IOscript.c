@@ -218,6 +218,7 @@ void FreeScript(void){
 
       FREEMEMORY(scripti->cval);
       FREEMEMORY(scripti->cval2);
+      FREEMEMORY(scripti->fvals);
     }
     FREEMEMORY(scriptinfo);
     nscriptinfo=0;
@@ -236,6 +237,7 @@ void InitScriptI(scriptdata *scripti, int command,char *label){
   scripti->command=command;
   scripti->cval=NULL;
   scripti->cval2=NULL;
+  scripti->fvals=NULL;
   scripti->fval=0.0;
   scripti->ival=0;
   scripti->ival2=0;
@@ -262,6 +264,7 @@ int GetScriptKeywordIndex(char *keyword){
   if(MatchUpper(keyword,"LABEL")==MATCH)return SCRIPT_LABEL;
   if(MatchUpper(keyword,"LOAD3DSMOKE") == MATCH)return SCRIPT_LOAD3DSMOKE;               // documented
   if(MatchUpper(keyword,"LOADBOUNDARY") == MATCH)return SCRIPT_LOADBOUNDARY;             // documented
+  if(MatchUpper(keyword,"LOADBOX") == MATCH)return SCRIPT_LOADBOX;                       // documented
   if(MatchUpper(keyword,"LOADBOUNDARYM") == MATCH)return SCRIPT_LOADBOUNDARYM;
   if(MatchUpper(keyword,"LOADFILE") == MATCH)return SCRIPT_LOADFILE;                     // documented
   if(MatchUpper(keyword,"LOADINIFILE") == MATCH)return SCRIPT_LOADINIFILE;               // documented
@@ -314,6 +317,7 @@ int GetScriptKeywordIndex(char *keyword){
   if(MatchUpper(keyword,"SETVIEWPOINT") == MATCH)return SCRIPT_SETVIEWPOINT;             // documented
   if(MatchUpper(keyword,"SHOWPLOT3DDATA") == MATCH)return SCRIPT_SHOWPLOT3DDATA;         // documented
   if(MatchUpper(keyword,"SHOWSMOKESENSORS")==MATCH)return SCRIPT_SHOWSMOKESENSORS;
+  if(MatchUpper(keyword,"SLICEPROBES") == MATCH)return SCRIPT_SLICEPROBES;               // documented
   if(MatchUpper(keyword,"SMOKEFRAMES")==MATCH)return SCRIPT_SMOKEFRAMES;
   if(MatchUpper(keyword,"UNLOADALL") == MATCH)return SCRIPT_UNLOADALL;                   // documented
   if(MatchUpper(keyword,"UNLOADTOUR") == MATCH)return SCRIPT_UNLOADTOUR;                 // documented
@@ -589,6 +593,44 @@ int CompileScript(char *scriptfile){
         SETival;
         break;
 
+// LOADBOX
+//  option (int)
+//  xmin (float) xmax (float) ymin (float) ymax (float) zmin (float) zmax (float)
+      case SCRIPT_LOADBOX:
+        SETbuffer;
+        sscanf(buffer, "%i", &scripti->ival);
+        SETcval;
+        scripti->need_graphics = 0;
+        break;
+
+// SLICEPROBES
+//  quantity (char)
+//  csv file (char)
+//  number of points (int)
+//  x (float) y (float) z (float)   (one line per point)
+      case SCRIPT_SLICEPROBES:
+        scripti->need_graphics = 0;
+        SETcval;
+        SETcval2;
+        SETival;
+        if(scripti->ival>0){
+          int i;
+
+          NewMemory((void **)&scripti->fvals, 3*scripti->ival*sizeof(float));
+          for(i = 0; i<scripti->ival; i++){
+            float *xyz;
+
+            xyz = scripti->fvals+3*i;
+            xyz[0] = 0.0;
+            xyz[1] = 0.0;
+            xyz[2] = 0.0;
+            SETbuffer;
+            sscanf(buffptr, "%f %f %f", xyz, xyz+1, xyz+2);
+          }
+          scripti->ival = i;
+        }
+        break;
+
 // X/y/ZSCENECLIP
 // imin (int) min (float) imax (int) max (float)
       case SCRIPT_XSCENECLIP:
@@ -1576,6 +1618,41 @@ void ScriptLoad3dSmoke(scriptdata *scripti){
 
 }
 
+/* ------------------ ScriptLoadBox ------------------------ */
+
+void ScriptLoadBox(scriptdata *scripti){
+  load_box_option = CLAMP(scripti->ival, LOADBOX_OFF, LOADBOX_CLIP);
+  if(scripti->cval!=NULL){
+    sscanf(scripti->cval, "%f %f %f %f %f %f", load_box, load_box+1, load_box+2, load_box+3, load_box+4, load_box+5);
+  }
+  PRINTF("script: 3d slice and 3d smoke load region: ");
+  if(load_box_option==LOADBOX_USER){
+    PRINTF("%f %f %f %f %f %f", load_box[0], load_box[1], load_box[2], load_box[3], load_box[4], load_box[5]);
+  }
+  else if(load_box_option==LOADBOX_CLIP){
+    PRINTF("clip planes");
+  }
+  else{
+    PRINTF("whole mesh");
+  }
+  PRINTF("\n\n");
+  updatemenu = 1;
+}
+
+/* ------------------ ScriptSliceProbes ------------------------ */
+
+void ScriptSliceProbes(scriptdata *scripti){
+  int nfound;
+
+  if(scripti->cval==NULL||scripti->cval2==NULL||scripti->fvals==NULL)return;
+  PRINTF("script: outputting %s at %i points to %s\n", scripti->cval, scripti->ival, scripti->cval2);
+  nfound = SliceProbesToCSV(scripti->cval, scripti->fvals, scripti->ival, scripti->cval2);
+  if(nfound>=0&&nfound<scripti->ival){
+    fprintf(stderr, "*** Warning: %i of %i points are not in a 3d %s slice\n", scripti->ival-nfound, scripti->ival, scripti->cval);
+  }
+  PRINTF("\n");
+}
+
 /* ------------------ ScriptLoadSlice ------------------------ */
 
 void ScriptLoadSlice(scriptdata *scripti){
@@ -3068,6 +3145,12 @@ int RunScriptCommand(scriptdata *script_command){
     case SCRIPT_LOAD3DSMOKE:
       ScriptLoad3dSmoke(scripti);
       break;
+    case SCRIPT_LOADBOX:
+      ScriptLoadBox(scripti);
+      break;
+    case SCRIPT_SLICEPROBES:
+      ScriptSliceProbes(scripti);
+      break;
     case SCRIPT_LOADVOLSMOKE:
       ScriptLoadVolSmoke(scripti);
       break;
@@ -63,6 +63,8 @@
 #define SCRIPT_VIEWZMIN          231
 #define SCRIPT_VIEWZMAX          232
 #define SCRIPT_LOADSLICERENDER   233
+#define SCRIPT_LOADBOX           234
+#define SCRIPT_SLICEPROBES       235
 
 #define SCRIPT_SETTIMEVAL        301
 #define SCRIPT_SETVIEWPOINT      302
@@ -14,6 +14,7 @@
 #include "interp.h"
 #include "smokeviewvars.h"
 #include "IOscript.h"
+#include "threadpool.h"
 
 void DrawQuadSlice(float *v1, float *v2, float *v3, float *v4, float t1, float t2, float t3, float t4, float del, int level);
 void DrawQuadVectorSlice(float *v1, float *v2, float *v3, float *v4, float del, int level);
@@ -31,6 +32,9 @@ slicedata *gslice;
 #define FOPEN(file,mode) fopen(file,mode)
 #endif
 
+#define SLICE_FRAME_SIZE(sd) (sizeof(sliceframedata)+(sd)->nsliceijk*(sizeof(float)+1))
+#define SLICE_BLOCK 32   // block size used when transposing slice frames
+
 #define FORTRLESLICEREAD(var,size) FSEEK(RLESLICEFILE,4,SEEK_CUR);\
                            returncode=fread(var,4,size,RLESLICEFILE);\
                            FSEEK(RLESLICEFILE,4,SEEK_CUR)
@@ -455,6 +459,11 @@ float Get3DSliceVal(slicedata *sd, float *xyz){
   ijk_min = sd->ijk_min;
   ijk_max = sd->ijk_max;
 
+  // a cropped slice only has data for ijk_min..ijk_max, points outside of that get the nearest value
+  i = CLAMP(i, ijk_min[0], ijk_max[0]);
+  j = CLAMP(j, ijk_min[1], ijk_max[1]);
+  k = CLAMP(k, ijk_min[2], ijk_max[2]);
+
   ijk = (i - ijk_min[0])*slice_nz*slice_ny + (j - ijk_min[1])*slice_nz + (k - ijk_min[2]);
 
   dx = (xyz[0] - xplt[i]) / dxbar;
@@ -466,9 +475,9 @@ float Get3DSliceVal(slicedata *sd, float *xyz){
 
 
   // ijk
-  if(i <= ijk_max[0])ip1 = slice_nz*slice_ny;
-  if(j <= ijk_max[1])jp1 = slice_nz;
-  if(k <= ijk_max[2])kp1 = 1;
+  if(i + 1 <= ijk_max[0])ip1 = slice_nz*slice_ny;
+  if(j + 1 <= ijk_max[1])jp1 = slice_nz;
+  if(k + 1 <= ijk_max[2])kp1 = 1;
 
   val000 = (float)GET_VAL_N(sd, ijk);     // i,j,k
   val001 = (float)GET_VAL_N(sd, ijk + kp1); // i,j,k+1
@@ -547,6 +556,11 @@ float GetSliceTextureIndex(float *xyz){
   // val(i,j,k) = di*nj*nk + dj*nk + dk
   ijk_min = gslice->ijk_min;
   ijk_max = gslice->ijk_max;
+
+  // a cropped slice only has data for ijk_min..ijk_max, points outside of that get the nearest value
+  i = CLAMP(i, ijk_min[0], ijk_max[0]);
+  j = CLAMP(j, ijk_min[1], ijk_max[1]);
+  k = CLAMP(k, ijk_min[2], ijk_max[2]);
   ijk = (i - ijk_min[0])*slice_nz*slice_ny + (j - ijk_min[1])*slice_nz + (k - ijk_min[2]);
 
   dx = (xyz[0] - xplt[i]) / dxbar;
@@ -1736,6 +1750,7 @@ void UncompressSliceDataFrame(slicedata *sd, int iframe_local){
   uLongf countout;
   unsigned char *compressed_data;
 
+  if(PrefetchGetFrame(PREFETCH_SLICE, sd, iframe_local, &sd->slicecomplevel, sd->nsliceijk)==1)return;
   compressed_data = sd->qslicedata_compressed + sd->compindex[iframe_local].offset;
   countin = sd->compindex[iframe_local].size;
   countout = sd->nsliceijk;
@@ -1804,6 +1819,13 @@ void GetSlicePercentileBounds(char *slicetype, float global_min, float global_ma
 
     nn = -1;
     for(itime = 0; itime<slicei->ntimes; itime++){
+      float *qframe;
+
+      qframe = GetSliceFrame(slicei, itime, NULL);
+      if(qframe==NULL){
+        nn += slicei->nsliceijk;
+        continue;
+      }
       for(ii = 0; ii<slicei->nslicei; ii++){
         int j;
         int i1, i1p1;
@@ -1832,7 +1854,7 @@ void GetSlicePercentileBounds(char *slicetype, float global_min, float global_ma
               if(slicei->slice_filetype!=SLICE_CELL_CENTER&& iblank_node!=NULL&&iblank_node[IJKNODE(slicei->is1+ii, slicei->js1+j, slicei->ks1+k)]==SOLID)continue;
               if(slicei->slice_filetype==SLICE_CELL_CENTER&& iblank_cell!=NULL&&iblank_cell[IJKCELL(slicei->is1+ii-1, slicei->js1+j-1, slicei->ks1+k-1)]==EMBED_YES)continue;
             }
-            val = slicei->qslicedata[nn];
+            val = qframe[nn-itime*slicei->nsliceijk];
             ival = (int)(factor*(val-global_min)+0.5);
             ival = CLAMP(ival, 0, NBUCKETS-1);
             buckets[ival]++;
@@ -1971,23 +1993,26 @@ void GetSliceHists(slicedata *sd){
     InitHistogram(sd->histograms + i, NHIST_BUCKETS, NULL, NULL);
   }
 
-  n = 0;
   for(istep = 0; istep < ntimes; istep++){
     histogramdata *histi, *histall;
+    float *qframe = NULL;
     int nn;
 
     if(sd->compression_type != UNCOMPRESSED){
       UncompressSliceDataFrame(sd, istep);
     }
+    else{
+      qframe = GetSliceFrame(sd, istep, NULL);
+      if(qframe==NULL)continue;
+    }
     for(nn = 0; nn < sd->nslicei*sd->nslicej*sd->nslicek; nn++){
       if(sd->compression_type != UNCOMPRESSED){
         pdata0[nn] = sd->qval256[sd->slicecomplevel[nn]];
       }
       else{
-        pdata0[nn] = sd->qslicedata[n + nn];
+        pdata0[nn] = qframe[nn];
       }
     }
-    n += sd->nslicei*sd->nslicej*sd->nslicek;
 
     // compute histogram for each timestep, histi and all time steps, histall
 
@@ -2306,6 +2331,25 @@ void SetSliceColors(float smin, float smax, slicedata *sd, int *errorcode){
       &sd->extreme_min, &sd->extreme_max
     );
   }
+  else if(sd->paged==1){
+    sliceframedata *framei;
+
+    // set the color labels then recompute the color indices of the cached frames
+
+    sd->pageinfo.colormin = smin;
+    sd->pageinfo.colormax = smax;
+    GetSliceColors(NULL, 0, NULL,
+      smin, smax,
+      nrgb_full, nrgb,
+      sb->colorlabels, sb->colorvalues, &scale, &sb->fscale, sb->levels256,
+      &sd->extreme_min, &sd->extreme_max
+    );
+    LOCK_SLICE_FRAMES;
+    for(framei = slice_frame_first; framei!=NULL; framei = framei->next){
+      if(framei->slicei==sd)GetSliceFrameLevels(sd, framei);
+    }
+    UNLOCK_SLICE_FRAMES;
+  }
   else{
     if(sd->qslicedata == NULL)return;
     GetSliceColors(sd->qslicedata, sd->nslicetotal, sd->slicelevel,
@@ -3061,7 +3105,15 @@ void UpdateFedinfo(void){
     sd->autoload = 0;
     sd->display = 0;
     sd->loaded = 0;
+    sd->memory_id = NewMemoryId(MEMORY_SLICE);
+    sd->last_display = 0;
+    sd->force_paged = 0;
     sd->qslicedata = NULL;
+    sd->paged = 0;
+    sd->pageinfo.stream = NULL;
+    sd->pageinfo.frame_offsets = NULL;
+    sd->pageinfo.frames = NULL;
+    sd->vbo.defined = 0;
     sd->compindex = NULL;
     sd->slicecomplevel = NULL;
     sd->qslicedata_compressed = NULL;
@@ -3835,7 +3887,7 @@ void UpdateSliceContours(int slice_type_index, float line_min, float line_max, i
 
     slice_type_j = GetSliceBoundsIndex(sd);
     if(slice_type_j!=slice_type_index)continue;
-    if(sd->qslicedata==NULL){
+    if(sd->qslicedata==NULL&&sd->paged==0){
       fprintf(stderr,"*** Error: data not available from %s to generate contours\n",sd->reg_file);
       continue;
     }
@@ -3906,7 +3958,8 @@ void UpdateSliceContours(int slice_type_index, float line_min, float line_max, i
       float *vals;
       contour *ci;
 
-      vals = sd->qslicedata + i*sd->nsliceijk;
+      vals = GetSliceFrame(sd, i, NULL);
+      if(vals==NULL)continue;
       ci = sd->line_contours+i;
       if(slice_contour_type==SLICE_LINE_CONTOUR){
         PRINTF("updating line contour: %i of %i\n",i+1,sd->nline_contours);
@@ -4065,6 +4118,11 @@ void GetSliceDataBounds(slicedata *sd, float *pmin, float *pmax){
     return;
   }
 #endif
+  if(sd->paged==1){
+    *pmin = sd->pageinfo.datamin;
+    *pmax = sd->pageinfo.datamax;
+    return;
+  }
   meshi = meshinfo + sd->blocknumber;
   iblank_node = meshi->c_iblank_node;
   iblank_cell = meshi->c_iblank_cell;
@@ -4235,7 +4293,15 @@ void AdjustSliceBounds(const slicedata *sd, float *pmin, float *pmax){
 #ifdef pp_NEWBOUND_DIALOG
   AdjustBoundsNoSet(pdata, ndata, pmin, pmax);
 #else
-  AdjustBounds(glui_setslicemin, glui_setslicemax, pdata, ndata, pmin, pmax);
+  if(sd->paged==1){
+
+    // percentile bounds need all of the data, a paged slice only has the frames in the cache
+
+    AdjustBounds(SET_MIN, SET_MAX, NULL, 0, pmin, pmax);
+  }
+  else{
+    AdjustBounds(glui_setslicemin, glui_setslicemax, pdata, ndata, pmin, pmax);
+  }
 #endif
 }
 
@@ -4643,6 +4709,8 @@ FILE_SIZE GetSliceData(char *slicefilename, int time_frame, int *is1ptr, int *is
   float *qq;
   int nx, ny, nxy;
   int count_timeframe;
+  framearenadata *fa;
+  framemarkdata fa_mark;
 
   joff = 0;
   koff = 0;
@@ -4687,7 +4755,13 @@ FILE_SIZE GetSliceData(char *slicefilename, int time_frame, int *is1ptr, int *is
 
   GetSliceFileDirection(*is1ptr, is2ptr, &iis1, &iis2, *js1ptr, js2ptr, *ks1ptr, ks2ptr, idirptr, &joff, &koff, &volslice);
 
-  NewMemory((void **)&qq, nxsp*(nysp+joff)*(nzsp+koff)*sizeof(float));
+  fa = GetFrameArena();
+  fa_mark = FrameArenaMark(fa);
+  qq = FrameArenaAlloc(fa, nxsp*(nysp+joff)*(nzsp+koff)*sizeof(float));
+  if(qq==NULL){
+    fclose(stream);
+    return file_size;
+  }
 
   count = -1;
   time_max = -1000000.0;
@@ -4871,430 +4945,1457 @@ FILE_SIZE GetSliceData(char *slicefilename, int time_frame, int *is1ptr, int *is
     }
   }
   fclose(stream);
-  FREEMEMORY(qq);
+  FrameArenaRelease(fa, fa_mark);
   return file_size;
 }
 
-/* ------------------ GetNSliceFrames ------------------------ */
+/* ------------------ GetFortRecord ------------------------ */
 
-int GetNSliceFrames(char *file, float *stime_min, float *stime_max){
-  int is1, is2, js1, js2, ks1, ks2, error;
+unsigned char *GetFortRecord(mmapfiledata *mapinfo, FILE_SIZE *offsetptr, int nbytes){
 
-  int header_size = 3*(4+30+4)+4+6*4+4;
-  FILE_SIZE file_size = GetFileSizeSMV(file);
+// return a pointer to the data portion of the Fortran record starting at *offsetptr
+// and advance *offsetptr past it.  NULL is returned if the record is incomplete or if either
+// record marker does not match nbytes (a truncated file or a frame still being written)
 
-  GetSliceFileHeader(file, &is1, &is2, &js1, &js2, &ks1, &ks2, &error);
-  int frame_size = 12;
-  frame_size += 8+(is2+1-is1)*(js2+1-js1)*(ks2+1-ks1)*4;
-  int nframes = (file_size-header_size)/frame_size;
+  int marker_head, marker_tail;
+  unsigned char *record;
+  FILE_SIZE offset;
 
-  if(*stime_min > *stime_max&&nframes>0){
-    FILE *stream = fopen(file, "rb");
-    if(stream!=NULL){
-      fseek(stream, header_size, SEEK_SET);
-      fseek(stream, 4, SEEK_CUR); fread(stime_min, sizeof(float), 1, stream); fseek(stream, 4, SEEK_CUR);
-      *stime_max = *stime_min;
-      if(nframes>1){
-        fseek(stream, header_size + (nframes-1)*frame_size, SEEK_SET);
-        fseek(stream, 4, SEEK_CUR); fread(stime_max, sizeof(float), 1, stream); fseek(stream, 4, SEEK_CUR);
-      }
-    }
-    if(stream!=NULL)fclose(stream);
-  }
-  return nframes;
+  offset = *offsetptr;
+  if(offset+HEADER_SIZE+nbytes+TRAILER_SIZE>mapinfo->size)return NULL;
+  memcpy(&marker_head, mapinfo->buffer+offset, HEADER_SIZE);
+  memcpy(&marker_tail, mapinfo->buffer+offset+HEADER_SIZE+nbytes, TRAILER_SIZE);
+  if(marker_head!=nbytes||marker_tail!=nbytes)return NULL;
+  record = mapinfo->buffer+offset+HEADER_SIZE;
+  *offsetptr = offset+HEADER_SIZE+nbytes+TRAILER_SIZE;
+  return record;
 }
 
-/* ------------------ ReadSlice ------------------------ */
+/* ------------------ CopySliceFrame ------------------------ */
 
-FILE_SIZE ReadSlice(char *file, int ifile, int time_frame, float *time_value, int flag, int set_slicecolor, int *errorcode){
-  float *xplt_local, *yplt_local, *zplt_local, offset, qmin, qmax, read_time, total_time;
-  int blocknumber, error, i, ii, headersize, framesize, flag2 = 0;
-  slicedata *sd;
-  int ntimes_slice_old;
+void CopySliceFrame(float *qdata, unsigned char *frame, int nxsp, int nysp, int nzsp, int joff, int koff, int contiguous,
+                    float *qminptr, float *qmaxptr){
 
-  vslicedata *vd;
-  meshdata *meshi;
+// copy one slice frame from the file (i varies fastest) to the smokeview ordering (k varies fastest)
+// qdata[(i*ny+j)*nz+k] = frame[i+j*nxsp+k*nxsp*nysp] where ny=nysp+joff and nz=nzsp+koff .
+// planes/lines added by joff/koff duplicate the first plane/line (FORTgetslicedata behavior).
+// the transpose is done in blocks so both the reads and the writes stay in cache and the
+// min and max are computed in the same pass.
 
-  FILE_SIZE return_filesize=0;
-  int file_size=0;
-#ifdef pp_memstatus
-  unsigned int availmemory;
-#endif
+  int ny, nz, nxy_file;
+  int i, j, k;
+  float qmin, qmax;
 
-#ifndef pp_FSEEK
-  if(flag==RELOAD)flag = LOAD;
-#endif
-  update_fileload = 1;
-  CheckMemory;
-  START_TIMER(total_time);
-  *errorcode = 0;
-  error = 0;
-  show_slice_average = 0;
-  blocknumber = sliceinfo[ifile].blocknumber;
-  meshi = meshinfo + blocknumber;
-  if(meshi->terrain!=NULL&&meshi->terrain->nvalues==0){
-    if(flag==LOAD){
-      printf("***warning: all terrain elevations below %f.  Slice file %s not loaded\n", meshi->terrain->zmin_cutoff, file);
-    }
-    return 0;
-  }
+  ny = nysp+joff;
+  nz = nzsp+koff;
+  nxy_file = nxsp*nysp;
+  qmin = *qminptr;
+  qmax = *qmaxptr;
 
-  slicefilenumber = ifile;
-  slicefilenum = ifile;
-  histograms_defined = 0;
+  if(contiguous==1){
 
-  ASSERT(slicefilenumber >= 0 && slicefilenumber<nsliceinfo);
-  sd = sliceinfo + slicefilenumber;
-  if(flag != RESETBOUNDS){
-    if(sd->loaded == 0 && flag == UNLOAD)return 0;
-    sd->display = 0;
-#ifdef pp_MEMDEBUG
-    if(sd->qslicedata != NULL){
-      ASSERT(ValidPointer(sd->qslicedata, sizeof(float)*sd->nslicetotal));
-    }
-#endif
+    // layout in memory matches layout in file (only the i or the k index varies)
 
-// free memory buffers
+    for(k = 0; k<nz; k++){
+      float *qq;
+      int kk;
 
-    if(flag!=RELOAD){
-      if(sd->qslicedata != NULL){
-        FreeMemory(sd->qslicedata);
-        sd->qslicedata = NULL;
+      kk = MIN(k, nzsp-1);
+      qq = qdata+k*nxsp*ny;
+      memcpy(qq, frame+4*(size_t)kk*nxy_file, 4*nxsp*ny);
+      for(i = 0; i<nxsp*ny; i++){
+        qmin = MIN(qmin, qq[i]);
+        qmax = MAX(qmax, qq[i]);
       }
-      FREEMEMORY(sd->times);
-      FREEMEMORY(sd->slicelevel);
-      FREEMEMORY(sd->compindex);
-      FREEMEMORY(sd->qslicedata_compressed);
-      FREEMEMORY(sd->slicecomplevel);
-
-      if(sd->histograms!=NULL){
-        for(i = 0; i<sd->nhistograms; i++){
-          FreeHistogram(sd->histograms+i);
+    }
+  }
+  else{
+    int ibeg, jbeg, kbeg;
+
+    for(jbeg = 0; jbeg<ny; jbeg += SLICE_BLOCK){
+      int jend;
+
+      jend = MIN(jbeg+SLICE_BLOCK, ny);
+      for(kbeg = 0; kbeg<nz; kbeg += SLICE_BLOCK){
+        int kend;
+
+        kend = MIN(kbeg+SLICE_BLOCK, nz);
+        for(ibeg = 0; ibeg<nxsp; ibeg += SLICE_BLOCK){
+          int iend;
+
+          iend = MIN(ibeg+SLICE_BLOCK, nxsp);
+          for(j = jbeg; j<jend; j++){
+            int jj;
+
+            jj = MIN(j, nysp-1);
+            for(k = kbeg; k<kend; k++){
+              unsigned char *qqfrom;
+              float *qqto;
+              int kk;
+
+              kk = MIN(k, nzsp-1);
+              qqfrom = frame+4*((size_t)kk*nxy_file+(size_t)jj*nxsp+ibeg);
+              qqto = qdata+((size_t)ibeg*ny+j)*nz+k;
+              for(i = ibeg; i<iend; i++){
+                float val;
+
+                memcpy(&val, qqfrom, 4);
+                *qqto = val;
+                qmin = MIN(qmin, val);
+                qmax = MAX(qmax, val);
+                qqfrom += 4;
+                qqto += ny*nz;
+              }
+            }
+          }
         }
-        FREEMEMORY(sd->histograms);
       }
     }
+  }
+  *qminptr = qmin;
+  *qmaxptr = qmax;
+}
 
-    slicefilenum = ifile;
+/* ------------------ GetSliceCropBounds ------------------------ */
 
-// reset slice variables to an unloaded state
+void GetSliceCropBounds(int *loadbox, int *ijk_file, int *bounds){
 
-    if(flag == UNLOAD){
-      update_flipped_colorbar = 1;
-      sd->ntimes_old = 0;
-      sd->ntimes = 0;
-      updatemenu = 1;
-      sd->loaded = 0;
-      sd->vloaded = 0;
-      sd->display = 0;
-      plotstate = GetPlotState(DYNAMIC_PLOTS);
-      ReadVolSlice = 0;
-      for(ii = 0; ii<nslice_loaded; ii++){
-        slicedata *sdi;
+// intersect the mesh region loadbox (see GetLoadBox) with the slice bounds ijk_file=(i1,i2,j1,j2,k1,k2)
+// keeping at least one cell along each axis
 
-        i = slice_loaded_list[ii];
-        sdi = sliceinfo + i;
-        if(sdi->volslice == 1)ReadVolSlice = 1;
-      }
-      for(ii = 0; ii<nslice_loaded; ii++){
-        slicedata *sdi;
+  int n;
 
-        i = slice_loaded_list[ii];
-        sdi = sliceinfo + i;
-        if(sdi->slicefile_labelindex == slicefile_labelindex){
-          slicefilenum = i;
-          flag2 = 1;
-          break;
-        }
-      }
-      if(flag2 == 0){
-        for(ii = 0; ii<nslice_loaded; ii++){
-          slicedata *sdi;
+  for(n = 0; n<6; n += 2){
+    int i1, i2;
 
-          i = slice_loaded_list[ii];
-          sdi = sliceinfo + i;
-          if(sdi->slicefile_labelindex != slicefile_labelindex){
-            slicefilenum = i;
-            flag2 = 1;
-            break;
-          }
-        }
-      }
-      if(flag2 == 0){
-        slicefilenum = 0;
-        slicefile_labelindex = 0;
-      }
+    i1 = MAX(loadbox[n], ijk_file[n]);
+    i2 = MIN(loadbox[n+1], ijk_file[n+1]);
+    if(i2<=i1){
+      i1 = CLAMP(i1, ijk_file[n], ijk_file[n+1]-1);
+      i2 = i1+1;
+    }
+    bounds[n] = i1;
+    bounds[n+1] = i2;
+  }
+}
 
-      for(i = 0; i<nvsliceinfo; i++){
-        vd = vsliceinfo + i;
-        if(vd->iu == ifile)vd->u = NULL;
-        if(vd->iv == ifile)vd->v = NULL;
-        if(vd->iw == ifile)vd->w = NULL;
-        if(vd->u == NULL&&vd->v == NULL&&vd->w == NULL){
-          vd->loaded = 0;
-          vd->display = 0;
-        }
-        if(vd->ival == ifile){
-          vd->val = NULL;
-          vd->loaded = 0;
-          vd->display = 0;
-        }
-      }
-      if(use_set_slicecolor == 0 || set_slicecolor == SET_SLICECOLOR){
-        if(sd->compression_type == UNCOMPRESSED){
-          UpdateSliceBounds();
-          list_slice_index = slicefile_labelindex;
-          SliceBounds2Glui(slicefile_labelindex);
-          UpdateAllSliceColors(slicefile_labelindex, errorcode);
-        }
-        else{
-          UpdateAllSliceLabels(slicefile_labelindex, errorcode);
-        }
-      }
+/* ------------------ CopySliceFrameBox ------------------------ */
 
-      UpdateGlui();
-      UpdateUnitDefs();
-      UpdateTimes();
-      RemoveSliceLoadstack(slicefilenumber);
-      return 0;
-    }
+void CopySliceFrameBox(float *qdata, unsigned char *frame, int nxsp, int nysp, int *bounds,
+                       float *qminptr, float *qmaxptr){
 
-// load entire slice file (flag=LOAD) or
-// load only portion of slice file written to since last time it was loaded (flag=RELOAD)
+// copy the part bounds=(i1,i2,j1,j2,k1,k2) (relative to the start of the slice) of a 3d slice frame
+// (i varies fastest) to the smokeview ordering (k varies fastest).  Only rows of the frame inside bounds
+// are read so pages of a memory mapped file outside of bounds are not touched.
 
-    if(sd->compression_type == UNCOMPRESSED){
-      sd->ntimes_old = sd->ntimes;
-      if(use_cslice==1){
-        GetSliceSizes(file, time_frame, &sd->nslicei, &sd->nslicej, &sd->nslicek, &sd->ntimes, sliceframestep, &error,
-          settmin_s, settmax_s, tmin_s, tmax_s, &headersize, &framesize);
-      }
-      else{
-        FORTgetslicesizes(file, &sd->nslicei, &sd->nslicej, &sd->nslicek, &sd->ntimes, &sliceframestep, &error,
-          &settmin_s, &settmax_s, &tmin_s, &tmax_s, &headersize, &framesize,
-          strlen(file));
-      }
-    }
-    else if(sd->compression_type != UNCOMPRESSED){
-      if(
-        GetSliceHeader(sd->comp_file, sd->size_file, sd->compression_type,
-          sliceframestep, settmin_s, settmax_s, tmin_s, tmax_s,
-          &sd->nslicei, &sd->nslicej, &sd->nslicek, &sd->ntimes, &sd->ncompressed, &sd->valmin, &sd->valmax) == 0){
-        ReadSlice("", ifile, time_frame, time_value, UNLOAD, set_slicecolor, &error);
-        *errorcode = 1;
-        return 0;
-      }
-    }
-    if(sd->nslicei != 1 && sd->nslicej != 1 && sd->nslicek != 1){
-      sd->volslice = 1;
-      ReadVolSlice = 1;
-    }
-    if(error != 0){
-      ReadSlice("", ifile, time_frame, time_value, UNLOAD, set_slicecolor, &error);
-      *errorcode = 1;
-      return 0;
-    }
-    if(settmax_s == 0 && settmin_s == 0 && sd->compression_type == UNCOMPRESSED){
-      if(framesize <= 0){
-        fprintf(stderr, "*** Error: frame size is 0 in slice file %s . \n", file);
-        error = 1;
-      }
-      else{
-        if(time_frame==ALL_SLICE_FRAMES){
-          sd->ntimes = (int)(GetFileSizeSMV(file)-headersize)/framesize;
-          if(sliceframestep>1)sd->ntimes /= sliceframestep;
-        }
-      }
-    }
-    if(error != 0 || sd->ntimes<1){
-      ReadSlice("", ifile, time_frame, time_value, UNLOAD, set_slicecolor, &error);
-      *errorcode = 1;
-      return 0;
-    }
-    if(time_frame==ALL_SLICE_FRAMES){
-      PRINTF("Loading %s(%s)", file, sd->label.shortlabel);
-    }
-    MEMSTATUS(1, &availmemory, NULL, NULL);
-    START_TIMER(read_time);
-    if(sd->compression_type != UNCOMPRESSED){
-      int return_code;
+  int nx, ny, nz;
+  int i, j, k;
+  float qmin, qmax;
+
+  nx = bounds[1]+1-bounds[0];
+  ny = bounds[3]+1-bounds[2];
+  nz = bounds[5]+1-bounds[4];
+  qmin = *qminptr;
+  qmax = *qmaxptr;
+  for(k = 0; k<nz; k++){
+    for(j = 0; j<ny; j++){
+      unsigned char *row;
+      float *qqto;
+
+      row = frame+4*((size_t)(bounds[4]+k)*nxsp*nysp+(size_t)(bounds[2]+j)*nxsp+bounds[0]);
+      qqto = qdata+(size_t)j*nz+k;
+      for(i = 0; i<nx; i++){
+        float val;
 
-      return_code = NewResizeMemory(sd->qslicedata_compressed, sd->ncompressed);
-      if(return_code!=0)return_code = NewResizeMemory(sd->times, sizeof(float)*sd->ntimes);
-      if(return_code!=0)return_code = NewResizeMemory(sd->compindex, sizeof(compdata)*(1+sd->ntimes));
-      if(return_code==0){
-        ReadSlice("", ifile, time_frame, time_value, UNLOAD, set_slicecolor, &error);
-        *errorcode = 1;
-        return 0;
-      }
-      return_code=GetSliceCompressedData(sd->comp_file, sd->compression_type,
-        settmin_s, settmax_s, tmin_s, tmax_s, sd->ncompressed, sliceframestep, sd->ntimes,
-        sd->times, sd->qslicedata_compressed, sd->compindex, &sd->globalmin, &sd->globalmax);
-      if(return_code == 0){
-        ReadSlice("", ifile, time_frame, time_value, UNLOAD,  set_slicecolor, &error);
-        *errorcode = 1;
-        return 0;
+        memcpy(&val, row+4*i, 4);
+        *qqto = val;
+        qmin = MIN(qmin, val);
+        qmax = MAX(qmax, val);
+        qqto += ny*nz;
       }
-      file_size = sd->ncompressed;
-      return_filesize = (FILE_SIZE)file_size;
     }
-    else{
-      int return_val;
+  }
+  *qminptr = qmin;
+  *qmaxptr = qmax;
+}
 
-      return_val = NewResizeMemory(sd->qslicedata, sizeof(float)*(sd->nslicei+1)*(sd->nslicej+1)*(sd->nslicek+1)*sd->ntimes);
-      if(return_val!=0)return_val = NewResizeMemory(sd->times, sizeof(float)*sd->ntimes);
+/* ------------------ GetSliceDataMMap ------------------------ */
 
-      if(return_val == 0){
-        *errorcode = 1;
-        ReadSlice("", ifile, time_frame, time_value, UNLOAD, set_slicecolor, &error);
-        return 0;
-      }
-#ifdef pp_MEMDEBUG
-      ASSERT(ValidPointer(sd->qslicedata, sizeof(float)*sd->nslicei*sd->nslicej*sd->nslicek*sd->ntimes));
+FILE_SIZE GetSliceDataMMap(char *slicefilename, int time_frame, int *is1ptr, int *is2ptr, int *js1ptr, int *js2ptr, int *ks1ptr, int *ks2ptr, int *idirptr,
+  float *qminptr, float *qmaxptr, float *qdataptr, slicepagedata *pageinfo, int *loadbox, int *croppedptr, float *timesptr, int ntimes_old_arg, int *ntimesptr,
+  int sliceframestep_arg, int settmin_s_arg, int settmax_s_arg, float tmin_s_arg, float tmax_s_arg
+#ifdef pp_MULTI_RES
+  , int multi_res
 #endif
+){
 
-      ntimes_slice_old = 0;
-      if(flag==RELOAD){
-        ntimes_slice_old = sd->ntimes_old;
-        qmin = sd->globalmin;
-        qmax = sd->globalmax;
-      }
-      else{
-        qmin = 1.0e30;
-        qmax = -1.0e30;
-      }
-      if(sd->ntimes > ntimes_slice_old){
-        if(use_cslice==1){
-          return_filesize =
-            GetSliceData(file, time_frame, &sd->is1, &sd->is2, &sd->js1, &sd->js2, &sd->ks1, &sd->ks2, &sd->idir,
-              &qmin, &qmax, sd->qslicedata, sd->times, ntimes_slice_old, &sd->ntimes,
-              sliceframestep, settmin_s, settmax_s, tmin_s, tmax_s
+// same as GetSliceData but reads the slice file through a memory mapping.  Each frame is copied
+// directly from the mapped pages into qdataptr, avoiding the intermediate frame buffer and a second
+// pass over the data to compute the min and max.  Falls back to GetSliceData if the file cannot be mapped.
+// If pageinfo is not NULL (paged slice loading) no data is copied.  The file offset of each selected
+// frame is saved in pageinfo->frame_offsets so the frame can be read later by GetSliceFrame.
+// If loadbox is not NULL (see GetLoadBox) only the part of a 3d slice inside loadbox is copied
+// (qdataptr need only hold the cropped frames, see GetSliceCropBounds), *croppedptr is set to 1 and
+// the bounds returned are those of the cropped region (*is2ptr is not reset to *is1ptr in this case).
+// Nothing is read if the file cannot be mapped and pageinfo or loadbox is not NULL.
+
+  mmapfiledata mapinfo;
+  unsigned char *record;
+  FILE_SIZE offset, frame_offset, file_size;
+  int ijk[6];
+  int nxsp, nysp, nzsp, nframe;
+  int joff, koff, volslice, iis1, iis2;
+  int nsteps, count, contiguous, nframes, frame_size;
+  int i, crop, nframe_crop, bounds[6], bounds_rel[6];
+  float time_max;
+
+  if(MMapFile(slicefilename, &mapinfo, MMAP_SEQUENTIAL)==0){
+    if(pageinfo!=NULL||loadbox!=NULL){
+      *ntimesptr = 0;
+      return 0;
+    }
+    return GetSliceData(slicefilename, time_frame, is1ptr, is2ptr, js1ptr, js2ptr, ks1ptr, ks2ptr, idirptr,
+      qminptr, qmaxptr, qdataptr, timesptr, ntimes_old_arg, ntimesptr,
+      sliceframestep_arg, settmin_s_arg, settmax_s_arg, tmin_s_arg, tmax_s_arg
 #ifdef pp_MULTI_RES
-              , sd->multi_res
-#endif
-            );
-          file_size = (int)return_filesize;
-        }
-        else{
-          FORTgetslicedata(file,
-            &sd->is1, &sd->is2, &sd->js1, &sd->js2, &sd->ks1, &sd->ks2, &sd->idir,
-            &qmin, &qmax, sd->qslicedata, sd->times, &ntimes_slice_old, &sd->ntimes, &sliceframestep,
-            &settmin_s, &settmax_s, &tmin_s, &tmax_s, &file_size, strlen(file));
-          return_filesize = (FILE_SIZE)file_size;
-        }
-      }
-#ifdef pp_MEMDEBUG
-      ASSERT(ValidPointer(sd->qslicedata, sizeof(float)*sd->nslicei*sd->nslicej*sd->nslicek*sd->ntimes));
+      , multi_res
 #endif
-    }
-    if(time_value!=NULL&&sd->ntimes>0){
-      *time_value = sd->times[0];
-    }
-    STOP_TIMER(read_time);
-
-    if(slice_average_flag == 1){
-      int data_per_timestep;
-      int ndata;
-      int ntimes_local;
+    );
+  }
 
-      data_per_timestep = sd->nslicei*sd->nslicej*sd->nslicek;
-      ntimes_local = sd->ntimes;
-      ndata = data_per_timestep*ntimes_local;
-      show_slice_average = 1;
+  // header: three 30 character labels followed by the slice bounds
 
-      if(
-        sd->compression_type != UNCOMPRESSED ||
-        TimeAverageData(sd->qslicedata, sd->qslicedata, ndata, data_per_timestep, sd->times, ntimes_local, slice_average_interval) == 1
-        ){
-        show_slice_average = 0; // averaging failed
-      }
+  offset = 0;
+  for(i = 0; i<3; i++){
+    if(GetFortRecord(&mapinfo, &offset, 30)==NULL){
+      MUnmapFile(&mapinfo);
+      return 0;
     }
+  }
+  record = GetFortRecord(&mapinfo, &offset, 6*4);
+  if(record==NULL){
+    MUnmapFile(&mapinfo);
+    return 0;
+  }
+  memcpy(ijk, record, 6*4);
+  *is1ptr = ijk[0];
+  *is2ptr = ijk[1];
+  *js1ptr = ijk[2];
+  *js2ptr = ijk[3];
+  *ks1ptr = ijk[4];
+  *ks2ptr = ijk[5];
+  file_size = 6*4;
+
+  nxsp = *is2ptr+1-*is1ptr;
+  nysp = *js2ptr+1-*js1ptr;
+  nzsp = *ks2ptr+1-*ks1ptr;
+  nframe = nxsp*nysp*nzsp;
+  GetSliceFileDirection(*is1ptr, is2ptr, &iis1, &iis2, *js1ptr, js2ptr, *ks1ptr, ks2ptr, idirptr, &joff, &koff, &volslice);
+
+  crop = 0;
+  nframe_crop = 0;
+  if(loadbox!=NULL&&pageinfo==NULL&&volslice==1){
+    int ijk_file[6], n;
+
+    // GetSliceFileDirection reset is2 to is1
+
+    ijk_file[0] = *is1ptr;
+    ijk_file[1] = *is1ptr+nxsp-1;
+    ijk_file[2] = *js1ptr;
+    ijk_file[3] = *js2ptr;
+    ijk_file[4] = *ks1ptr;
+    ijk_file[5] = *ks2ptr;
+    GetSliceCropBounds(loadbox, ijk_file, bounds);
+    for(n = 0; n<6; n++){
+      bounds_rel[n] = bounds[n]-ijk_file[n-n%2];
+    }
+    nframe_crop = (bounds[1]+1-bounds[0])*(bounds[3]+1-bounds[2])*(bounds[5]+1-bounds[4]);
+    crop = 1;
+  }
+
+  contiguous = 0;
+  if(nxsp==1&&nysp+joff==1)contiguous = 1;
+  if(nysp+joff==1&&nzsp+koff==1)contiguous = 1;
+#ifdef pp_MULTI_RES
+  if(*idirptr==2&&multi_res==1)contiguous = 1;
+#endif
+  if(pageinfo!=NULL){
+    pageinfo->nxsp = nxsp;
+    pageinfo->nysp = nysp;
+    pageinfo->nzsp = nzsp;
+    pageinfo->joff = joff;
+    pageinfo->koff = koff;
+    pageinfo->contiguous = contiguous;
+  }
+
+  // validate the record markers of every frame once, up front.  frames are then located by offset.
+
+  frame_size = (HEADER_SIZE+4+TRAILER_SIZE)+(HEADER_SIZE+4*nframe+TRAILER_SIZE);
+  frame_offset = offset;
+  for(nframes = 0;; nframes++){
+    FILE_SIZE check_offset;
+
+    check_offset = frame_offset+(FILE_SIZE)nframes*frame_size;
+    if(GetFortRecord(&mapinfo, &check_offset, 4)==NULL)break;
+    if(GetFortRecord(&mapinfo, &check_offset, 4*nframe)==NULL)break;
+  }
+
+  nsteps = 0;
+  count = -1;
+  time_max = -1000000.0;
+  i = 0;
+  if(time_frame>0){
+    i = time_frame;
+  }
+  else if(*ntimesptr!=ntimes_old_arg&&ntimes_old_arg>0){
+    i = ntimes_old_arg;
+    nsteps = ntimes_old_arg;
+  }
+  for(; i<nframes; i++){
+    unsigned char *frame;
+    float timeval;
+    int loadframe;
+
+    offset = frame_offset+(FILE_SIZE)i*frame_size;
+    record = GetFortRecord(&mapinfo, &offset, 4);
+    memcpy(&timeval, record, 4);
+    file_size += 4;
+    if((settmin_s_arg!=0&&timeval<tmin_s_arg)||timeval<=time_max){
+      loadframe = 0;
+    }
+    else{
+      loadframe = 1;
+      time_max = timeval;
+    }
+    if(settmax_s_arg!=0&&timeval>tmax_s_arg)break;
+    if(nsteps>=*ntimesptr)break;
+    count++;
+    if(count%sliceframestep_arg!=0)loadframe = 0;
+    if(loadframe==0)continue;
+    if(pageinfo!=NULL){
+      int n;
+
+      pageinfo->frame_offsets[nsteps] = offset;
+      frame = GetFortRecord(&mapinfo, &offset, 4*nframe);
+      timesptr[nsteps] = timeval;
+      for(n = 0; n<nframe; n++){
+        float val;
+
+        memcpy(&val, frame+4*n, 4);
+        *qminptr = MIN(*qminptr, val);
+        *qmaxptr = MAX(*qmaxptr, val);
+      }
+      nsteps++;
+      file_size += 4*nframe;
+      continue;
+    }
+    frame = GetFortRecord(&mapinfo, &offset, 4*nframe);
+
+    timesptr[nsteps] = timeval;
+    if(crop==1){
+      CopySliceFrameBox(qdataptr+(size_t)nsteps*nframe_crop, frame, nxsp, nysp, bounds_rel, qminptr, qmaxptr);
+    }
+    else{
+      CopySliceFrame(qdataptr+(size_t)nsteps*nxsp*(nysp+joff)*(nzsp+koff), frame, nxsp, nysp, nzsp, joff, koff, contiguous, qminptr, qmaxptr);
+    }
+    nsteps++;
+    file_size += 4*nframe;
+  }
+  *ks2ptr += koff;
+  *js2ptr += joff;
+  if(crop==1){
+    *is1ptr = bounds[0];
+    *is2ptr = bounds[1];
+    *js1ptr = bounds[2];
+    *js2ptr = bounds[3];
+    *ks1ptr = bounds[4];
+    *ks2ptr = bounds[5];
+    *croppedptr = 1;
+  }
+  *ntimesptr = nsteps;
+  MUnmapFile(&mapinfo);
+  return file_size;
+}
+
+/* ------------------ GetSliceProbeHeader ------------------------ */
+
+int GetSliceProbeHeader(mmapfiledata *mapinfo, int *ijk, FILE_SIZE *frame_offsetptr, int *frame_sizeptr){
+
+// read the header of the mapped slice file mapinfo.  the slice bounds are returned in ijk and the
+// file offset and size of the first frame in *frame_offsetptr and *frame_sizeptr.  returns the number of
+// frames in the file (computed from the file size) or -1 if the header could not be read
+
+  unsigned char *record;
+  FILE_SIZE offset;
+  int i, nframe;
+
+  offset = 0;
+  for(i = 0; i<3; i++){
+    if(GetFortRecord(mapinfo, &offset, 30)==NULL)return -1;
+  }
+  record = GetFortRecord(mapinfo, &offset, 6*4);
+  if(record==NULL)return -1;
+  memcpy(ijk, record, 6*4);
+  nframe = (ijk[1]+1-ijk[0])*(ijk[3]+1-ijk[2])*(ijk[5]+1-ijk[4]);
+  *frame_offsetptr = offset;
+  *frame_sizeptr = (HEADER_SIZE+4+TRAILER_SIZE)+(HEADER_SIZE+4*nframe+TRAILER_SIZE);
+  return (int)((mapinfo->size-offset)/(FILE_SIZE)(*frame_sizeptr));
+}
+
+/* ------------------ GetSliceProbeWeights ------------------------ */
+
+int GetSliceProbeWeights(meshdata *meshi, int *ijk, int cell_center, float *xyz, int *offsets, float *weights){
+
+// compute the frame offsets (in floats) and trilinear weights of the 8 values of the slice with
+// bounds ijk surrounding the point xyz.  returns 0 if xyz is outside the slice, 1 otherwise.
+// a cell centered slice stores the value of the cell between nodes i-1 and i at index i so its values
+// are interpolated between cell centers (and held constant in the outer half of the boundary cells)
+
+  float *plt[3], f[3];
+  int n, index[3], step[3], nx, nxy;
+
+  plt[0] = meshi->xplt_orig;
+  plt[1] = meshi->yplt_orig;
+  plt[2] = meshi->zplt_orig;
+  for(n = 0; n<3; n++){
+    int i1, i2;
+    float *xplt;
+
+    i1 = ijk[2*n];
+    i2 = ijk[2*n+1];
+    if(i2<=i1)return 0;
+    xplt = plt[n]+i1;
+    index[n] = GetInterval(xyz[n], xplt, i2+1-i1);
+    if(index[n]<0)return 0;
+    step[n] = 1;
+    if(cell_center==1){
+      int ncells, c0;
+      float xc0, xc1;
+
+      ncells = i2-i1;
+      if(ncells==1){
+        index[n] = 1;
+        step[n] = 0;
+        f[n] = 0.0;
+        continue;
+      }
+      c0 = index[n];
+      if(xyz[n]<(xplt[c0]+xplt[c0+1])/2.0)c0--;
+      c0 = CLAMP(c0, 0, ncells-2);
+      xc0 = (xplt[c0]+xplt[c0+1])/2.0;
+      xc1 = (xplt[c0+1]+xplt[c0+2])/2.0;
+      index[n] = c0+1;
+      f[n] = (xyz[n]-xc0)/(xc1-xc0);
+    }
+    else{
+      f[n] = (xyz[n]-xplt[index[n]])/(xplt[index[n]+1]-xplt[index[n]]);
+    }
+    f[n] = CLAMP(f[n], 0.0, 1.0);
+  }
+
+  // slice frames are written with i varying fastest
+
+  nx = ijk[1]+1-ijk[0];
+  nxy = nx*(ijk[3]+1-ijk[2]);
+  for(n = 0; n<8; n++){
+    int di, dj, dk;
+
+    di = n&1;
+    dj = (n>>1)&1;
+    dk = (n>>2)&1;
+    offsets[n] = (index[0]+di*step[0])+(index[1]+dj*step[1])*nx+(index[2]+dk*step[2])*nxy;
+    weights[n] = (di==1?f[0]:1.0-f[0])*(dj==1?f[1]:1.0-f[1])*(dk==1?f[2]:1.0-f[2]);
+  }
+  return 1;
+}
+
+/* ------------------ SliceProbesToCSV ------------------------ */
+
+int SliceProbesToCSV(char *quantity, float *xyz, int nprobes, char *csvfile){
+
+// output the time history of the 3d slice quantity at the nprobes points xyz (x,y,z triples) to
+// csvfile.  each slice file is mapped and only the 8 nodes surrounding each point are read in each
+// frame, the file is not loaded.  returns the number of points found in a 3d slice or -1 on error
+
+  int *probe_slice, *probe_offsets, *probe_ntimes, *slice_ntimes, *slice_ijk;
+  float *probe_weights, *vals, *times;
+  int i, p, ntimes, nfound;
+  char *unit;
+  FILE *stream;
+
+  if(quantity==NULL||xyz==NULL||nprobes<=0||csvfile==NULL)return -1;
+  stream = fopen(csvfile, "w");
+  if(stream==NULL){
+    fprintf(stderr, "*** Error: unable to open %s for output\n", csvfile);
+    return -1;
+  }
+
+  NewMemory((void **)&probe_slice, nprobes*sizeof(int));
+  NewMemory((void **)&probe_ntimes, nprobes*sizeof(int));
+  NewMemory((void **)&probe_offsets, 8*nprobes*sizeof(int));
+  NewMemory((void **)&probe_weights, 8*nprobes*sizeof(float));
+  NewMemory((void **)&slice_ntimes, (nsliceinfo+1)*sizeof(int));
+  NewMemory((void **)&slice_ijk, 6*(nsliceinfo+1)*sizeof(int));
+
+  // find an uncompressed 3d slice of quantity whose data surrounds each point.  a slice file header is
+  // only read when a point is in its mesh (slice_ntimes is -2 until then).  meshes overlap and a slice
+  // may only cover part of its mesh so the search goes on when the point is not inside the slice data
+
+  for(i = 0; i<nsliceinfo; i++){
+    slice_ntimes[i] = -2;
+  }
+  unit = NULL;
+  ntimes = 0;
+  for(p = 0; p<nprobes; p++){
+    float *xyzp;
+
+    xyzp = xyz+3*p;
+    probe_slice[p] = -1;
+    probe_ntimes[p] = 0;
+    for(i = 0; i<nsliceinfo; i++){
+      slicedata *slicei;
+      meshdata *meshi;
+      float *xplt, *yplt, *zplt;
+      int cell_center;
+
+      slicei = sliceinfo+i;
+      if(slicei->volslice==0||slicei->is_fed==1||slicei->compression_type!=UNCOMPRESSED)continue;
+      if(slicei->file==NULL||MatchUpper(slicei->label.longlabel, quantity)==NOTMATCH)continue;
+      meshi = meshinfo+slicei->blocknumber;
+      xplt = meshi->xplt_orig;
+      yplt = meshi->yplt_orig;
+      zplt = meshi->zplt_orig;
+      if(xyzp[0]<xplt[0]||xyzp[0]>xplt[meshi->ibar])continue;
+      if(xyzp[1]<yplt[0]||xyzp[1]>yplt[meshi->jbar])continue;
+      if(xyzp[2]<zplt[0]||xyzp[2]>zplt[meshi->kbar])continue;
+      if(slice_ntimes[i]==-2){
+        mmapfiledata mapinfo;
+        FILE_SIZE frame_offset;
+        int frame_size, nframes;
+
+        nframes = -1;
+        if(MMapFile(slicei->file, &mapinfo, MMAP_RANDOM)==1){
+          nframes = GetSliceProbeHeader(&mapinfo, slice_ijk+6*i, &frame_offset, &frame_size);
+          MUnmapFile(&mapinfo);
+        }
+        slice_ntimes[i] = MAX(nframes, 0);
+      }
+      if(slice_ntimes[i]<=0)continue;
+      cell_center = slicei->slice_filetype==SLICE_CELL_CENTER ? 1 : 0;
+      if(GetSliceProbeWeights(meshi, slice_ijk+6*i, cell_center, xyzp, probe_offsets+8*p, probe_weights+8*p)==0)continue;
+      probe_slice[p] = i;
+      probe_ntimes[p] = slice_ntimes[i];
+      ntimes = MAX(ntimes, slice_ntimes[i]);
+      unit = slicei->label.unit;
+      break;
+    }
+  }
+
+  // read the values at each point, one slice file at a time
+
+  times = NULL;
+  vals = NULL;
+  if(ntimes>0){
+    NewMemory((void **)&times, ntimes*sizeof(float));
+    NewMemory((void **)&vals, (size_t)ntimes*nprobes*sizeof(float));
+  }
+  for(i = 0; i<ntimes; i++){
+    times[i] = 0.0;
+  }
+  for(i = 0; i<nsliceinfo; i++){
+    mmapfiledata mapinfo;
+    FILE_SIZE frame_offset;
+    int ijk[6], frame_size, nframes, nframe, itime;
+
+    if(slice_ntimes[i]<=0)continue;
+    for(p = 0; p<nprobes; p++){
+      if(probe_slice[p]==i)break;
+    }
+    if(p==nprobes)continue;
+
+    // only the cells around each point are read from each frame, read ahead would load the whole file
+
+    if(MMapFile(sliceinfo[i].file, &mapinfo, MMAP_RANDOM)==0)continue;
+    nframes = GetSliceProbeHeader(&mapinfo, ijk, &frame_offset, &frame_size);
+    nframes = MIN(nframes, slice_ntimes[i]);
+    nframe = (ijk[1]+1-ijk[0])*(ijk[3]+1-ijk[2])*(ijk[5]+1-ijk[4]);
+    for(itime = 0; itime<nframes; itime++){
+      FILE_SIZE offset;
+      unsigned char *record, *frame;
+
+      offset = frame_offset+(FILE_SIZE)itime*frame_size;
+      frame = NULL;
+      record = GetFortRecord(&mapinfo, &offset, 4);
+      if(record!=NULL)frame = GetFortRecord(&mapinfo, &offset, 4*nframe);
+      if(record==NULL||frame==NULL){
+        nframes = itime;
+        break;
+      }
+      memcpy(times+itime, record, 4);
+      for(p = 0; p<nprobes; p++){
+        float val;
+        int n;
+
+        if(probe_slice[p]!=i)continue;
+        val = 0.0;
+        for(n = 0; n<8; n++){
+          float node_val;
+
+          memcpy(&node_val, frame+4*(size_t)probe_offsets[8*p+n], 4);
+          val += probe_weights[8*p+n]*node_val;
+        }
+        vals[(size_t)itime*nprobes+p] = val;
+      }
+    }
+    for(p = 0; p<nprobes; p++){
+      if(probe_slice[p]==i)probe_ntimes[p] = MIN(probe_ntimes[p], nframes);
+    }
+    MUnmapFile(&mapinfo);
+  }
+
+  // output: units, point labels then one line per time.  points not in a 3d slice are left blank
+
+  nfound = 0;
+  fprintf(stream, "s");
+  for(p = 0; p<nprobes; p++){
+    if(probe_slice[p]>=0)nfound++;
+    fprintf(stream, ",%s", unit==NULL?"":unit);
+  }
+  fprintf(stream, "\nTime");
+  for(p = 0; p<nprobes; p++){
+    fprintf(stream, ",%s %g %g %g", quantity, xyz[3*p], xyz[3*p+1], xyz[3*p+2]);
+  }
+  fprintf(stream, "\n");
+  for(i = 0; i<ntimes; i++){
+    fprintf(stream, "%f", times[i]);
+    for(p = 0; p<nprobes; p++){
+      if(probe_slice[p]>=0&&i<probe_ntimes[p]){
+        fprintf(stream, ",%f", vals[(size_t)i*nprobes+p]);
+      }
+      else{
+        fprintf(stream, ",");
+      }
+    }
+    fprintf(stream, "\n");
+  }
+  fclose(stream);
+
+  FREEMEMORY(probe_slice);
+  FREEMEMORY(probe_ntimes);
+  FREEMEMORY(probe_offsets);
+  FREEMEMORY(probe_weights);
+  FREEMEMORY(slice_ntimes);
+  FREEMEMORY(slice_ijk);
+  FREEMEMORY(times);
+  FREEMEMORY(vals);
+  return nfound;
+}
+
+/* ------------------ UnlinkSliceFrame ------------------------ */
+
+void UnlinkSliceFrame(sliceframedata *framei){
+  if(framei->prev!=NULL){
+    framei->prev->next = framei->next;
+  }
+  else{
+    slice_frame_first = framei->next;
+  }
+  if(framei->next!=NULL){
+    framei->next->prev = framei->prev;
+  }
+  else{
+    slice_frame_last = framei->prev;
+  }
+  framei->prev = NULL;
+  framei->next = NULL;
+}
+
+/* ------------------ PushSliceFrame ------------------------ */
+
+void PushSliceFrame(sliceframedata *framei){
+
+// make framei the most recently used frame
+
+  framei->prev = NULL;
+  framei->next = slice_frame_first;
+  if(slice_frame_first!=NULL)slice_frame_first->prev = framei;
+  slice_frame_first = framei;
+  if(slice_frame_last==NULL)slice_frame_last = framei;
+}
+
+/* ------------------ FreeSliceFrame ------------------------ */
+
+void FreeSliceFrame(sliceframedata *framei){
+  slicedata *sd;
+
+  sd = framei->slicei;
+  UnlinkSliceFrame(framei);
+  sd->pageinfo.frames[framei->itime] = NULL;
+  slice_frame_cache_size -= SLICE_FRAME_SIZE(sd);
+  FreeMemory(framei);
+}
+
+/* ------------------ FreeSliceFrames ------------------------ */
+
+void FreeSliceFrames(slicedata *sd){
+  slicepagedata *pageinfo;
+
+  pageinfo = &sd->pageinfo;
+  LOCK_SLICE_FRAMES;
+  if(pageinfo->frames!=NULL){
+    int i;
+
+    for(i = 0; i<pageinfo->nframes; i++){
+      if(pageinfo->frames[i]!=NULL)FreeSliceFrame(pageinfo->frames[i]);
+    }
+  }
+  if(pageinfo->stream!=NULL){
+    fclose(pageinfo->stream);
+    pageinfo->stream = NULL;
+  }
+  FREEMEMORY(pageinfo->frames);
+  FREEMEMORY(pageinfo->frame_offsets);
+  pageinfo->nframes = 0;
+  sd->paged = 0;
+  UNLOCK_SLICE_FRAMES;
+}
+
+/* ------------------ GetSliceFrameLevels ------------------------ */
+
+void GetSliceFrameLevels(slicedata *sd, sliceframedata *framei){
+  char colorlabels[12][11], scalebuffer[31], *scale;
+  float colorvalues[12], fscale, levels256[256];
+  int extreme_min, extreme_max;
+
+  scale = scalebuffer;
+  GetSliceColors(framei->vals, sd->nsliceijk, framei->levels,
+    sd->pageinfo.colormin, sd->pageinfo.colormax,
+    nrgb_full, nrgb,
+    colorlabels, colorvalues, &scale, &fscale, levels256,
+    &extreme_min, &extreme_max
+  );
+  if(extreme_min==1)sd->extreme_min = 1;
+  if(extreme_max==1)sd->extreme_max = 1;
+}
+
+/* ------------------ GetSliceFrame ------------------------ */
+
+float *GetSliceFrame(slicedata *sd, int itime, unsigned char **levelsptr){
+
+// return the data for frame itime of slice sd and, if levelsptr is not NULL, its color indices.
+// For a paged slice (sd->paged==1) the frame is read from the slice file if it is not already cached.
+// Least recently used frames are freed to keep the cache within slice_frame_budget MB.  Frames being
+// displayed (frame sd->itime of each slice) are never freed so pointers obtained while drawing stay valid.
+// The slice file stays open (pageinfo->stream) until the slice is unloaded.  The frame list is shared by
+// all slices so it is only changed while holding the LOCK_SLICE_FRAMES lock.
+
+  slicepagedata *pageinfo;
+  sliceframedata *framei;
+
+  if(levelsptr!=NULL)*levelsptr = NULL;
+  if(sd->paged==0){
+    if(sd->qslicedata==NULL)return NULL;
+    if(levelsptr!=NULL&&sd->slicelevel!=NULL)*levelsptr = sd->slicelevel+itime*sd->nsliceijk;
+    return sd->qslicedata+itime*sd->nsliceijk;
+  }
+
+  pageinfo = &sd->pageinfo;
+  if(itime<0||itime>=pageinfo->nframes)return NULL;
+  LOCK_SLICE_FRAMES;
+  framei = pageinfo->frames[itime];
+  if(framei!=NULL){
+    if(framei!=slice_frame_first){
+      UnlinkSliceFrame(framei);
+      PushSliceFrame(framei);
+    }
+  }
+  else{
+    FILE *stream;
+    unsigned char *frame_buffer;
+    sliceframedata *framej;
+    framearenadata *fa;
+    framemarkdata fa_mark;
+    FILE_SIZE frame_budget;
+    int nframe;
+    float qmin = 1.0e30, qmax = -1.0e30;
+
+    // free least recently used frames until the new frame fits
+
+    frame_budget = (FILE_SIZE)slice_frame_budget*1024*1024;
+    for(framej = slice_frame_last; framej!=NULL&&slice_frame_cache_size+SLICE_FRAME_SIZE(sd)>frame_budget;){
+      sliceframedata *prev;
+
+      prev = framej->prev;
+      if(framej->itime!=framej->slicei->itime)FreeSliceFrame(framej);
+      framej = prev;
+    }
+
+    nframe = pageinfo->nxsp*pageinfo->nysp*pageinfo->nzsp;
+    fa = GetFrameArena();
+    fa_mark = FrameArenaMark(fa);
+    frame_buffer = FrameArenaAlloc(fa, 4*nframe);
+    if(frame_buffer==NULL){
+      UNLOCK_SLICE_FRAMES;
+      return NULL;
+    }
+    if(pageinfo->stream==NULL)pageinfo->stream = FOPEN(sd->file, "rb");
+    stream = pageinfo->stream;
+    if(stream==NULL){
+      FrameArenaRelease(fa, fa_mark);
+      UNLOCK_SLICE_FRAMES;
+      return NULL;
+    }
+    FSEEK(stream, pageinfo->frame_offsets[itime]+HEADER_SIZE, SEEK_SET);
+    if(fread(frame_buffer, 4, nframe, stream)!=nframe||NewMemoryMemID((void **)&framei, SLICE_FRAME_SIZE(sd), sd->memory_id)==0){
+      FrameArenaRelease(fa, fa_mark);
+      UNLOCK_SLICE_FRAMES;
+      return NULL;
+    }
+
+    framei->slicei = sd;
+    framei->itime = itime;
+    framei->vals = (float *)(framei+1);
+    framei->levels = (unsigned char *)(framei->vals+sd->nsliceijk);
+    CopySliceFrame(framei->vals, frame_buffer, pageinfo->nxsp, pageinfo->nysp, pageinfo->nzsp,
+                   pageinfo->joff, pageinfo->koff, pageinfo->contiguous, &qmin, &qmax);
+    FrameArenaRelease(fa, fa_mark);
+    GetSliceFrameLevels(sd, framei);
+    PushSliceFrame(framei);
+    pageinfo->frames[itime] = framei;
+    slice_frame_cache_size += SLICE_FRAME_SIZE(sd);
+  }
+  UNLOCK_SLICE_FRAMES;
+  if(levelsptr!=NULL)*levelsptr = framei->levels;
+  return framei->vals;
+}
+
+/* ------------------ GetNSliceFrames ------------------------ */
+
+int GetNSliceFrames(char *file, float *stime_min, float *stime_max){
+  int is1, is2, js1, js2, ks1, ks2, error;
+
+  int header_size = 3*(4+30+4)+4+6*4+4;
+  FILE_SIZE file_size = GetFileSizeSMV(file);
+
+  GetSliceFileHeader(file, &is1, &is2, &js1, &js2, &ks1, &ks2, &error);
+  int frame_size = 12;
+  frame_size += 8+(is2+1-is1)*(js2+1-js1)*(ks2+1-ks1)*4;
+  int nframes = (file_size-header_size)/frame_size;
+
+  if(*stime_min > *stime_max&&nframes>0){
+    FILE *stream = fopen(file, "rb");
+    if(stream!=NULL){
+      fseek(stream, header_size, SEEK_SET);
+      fseek(stream, 4, SEEK_CUR); fread(stime_min, sizeof(float), 1, stream); fseek(stream, 4, SEEK_CUR);
+      *stime_max = *stime_min;
+      if(nframes>1){
+        fseek(stream, header_size + (nframes-1)*frame_size, SEEK_SET);
+        fseek(stream, 4, SEEK_CUR); fread(stime_max, sizeof(float), 1, stream); fseek(stream, 4, SEEK_CUR);
+      }
+    }
+    if(stream!=NULL)fclose(stream);
+  }
+  return nframes;
+}
+
+/* ------------------ FinalizeSliceLoad ------------------------ */
+
+void FinalizeSliceLoad(slicedata *sd, int set_slicecolor, int *errorcode){
+  UpdateUnitDefs();
+  UpdateTimes();
+  CheckMemory;
+
+  //*** comment out following line to prevent crash when loading a slice when particles are loaded
+  //if(flag!=RESETBOUNDS)update_research_mode=1;
+  if(use_set_slicecolor==0||set_slicecolor==SET_SLICECOLOR){
+    if(sd->compression_type==UNCOMPRESSED){
+      UpdateSliceBounds();
+      UpdateAllSliceColors(slicefile_labelindex, errorcode);
+      list_slice_index = slicefile_labelindex;
+      SliceBounds2Glui(slicefile_labelindex);
+    }
+    else{
+      boundsdata *sb;
+
+      sb = slicebounds + slicefile_labelindex;
+      sb->data_valmin = sd->valmin;
+      sb->data_valmax = sd->valmax;
+
+      UpdateAllSliceLabels(slicefile_labelindex, errorcode);
+      MakeColorLabels(sb->colorlabels, sb->colorvalues, sd->valmin, sd->valmax, nrgb);
+    }
+  }
+  CheckMemory;
+
+  UpdateSliceList(list_slice_index);
+  CheckMemory;
+  UpdateSliceListIndex(slicefilenum);
+  CheckMemory;
+  UpdateGlui();
+  CheckMemory;
+#ifdef pp_MEMDEBUG
+  if(sd->compression_type==UNCOMPRESSED&&sd->paged==0){
+    ASSERT(ValidPointer(sd->qslicedata, sizeof(float)*sd->nslicei*sd->nslicej*sd->nslicek*sd->ntimes));
+  }
+  CheckMemory;
+#endif
+  IdleCB();
+}
+
+/* ------------------ FreeSliceBuffers ------------------------ */
+
+void FreeSliceBuffers(slicedata *sd, int flag){
+  int i;
+
+  if(flag==RELOAD)return;
+  if(sd->qslicedata != NULL){
+    FreeMemory(sd->qslicedata);
+    sd->qslicedata = NULL;
+  }
+  FREEMEMORY(sd->times);
+  FREEMEMORY(sd->slicelevel);
+  FREEMEMORY(sd->compindex);
+  FREEMEMORY(sd->qslicedata_compressed);
+  FREEMEMORY(sd->slicecomplevel);
+
+  if(sd->histograms!=NULL){
+    for(i = 0; i<sd->nhistograms; i++){
+      FreeHistogram(sd->histograms+i);
+    }
+    FREEMEMORY(sd->histograms);
+  }
+}
+
+/* ------------------ SetVolSliceBounds ------------------------ */
+
+void SetVolSliceBounds(slicedata *sd){
+
+// set the bounds of the 3d slice sd used when drawing.  If the slice was cropped to the load box
+// by GetSliceDataMMap only the cropped region is stored and is2 is the last i index of that region
+
+  meshdata *meshi;
+
+  meshi = meshinfo+sd->blocknumber;
+  if(sd->cropped==1&&sd->qslicedata!=NULL){
+    sd->nslicei = sd->is2+1-sd->is1;
+    sd->nslicej = sd->js2+1-sd->js1;
+    sd->nslicek = sd->ks2+1-sd->ks1;
+    sd->is2 = sd->is1;
+  }
+  sd->ijk_min[0] = sd->is1;
+  sd->ijk_max[0] = sd->is1+sd->nslicei-1;
+  sd->ijk_min[1] = sd->js1;
+  sd->ijk_max[1] = sd->js2;
+  sd->ijk_min[2] = sd->ks1;
+  sd->ijk_max[2] = sd->ks2;
+  sd->xyz_min[0] = meshi->xplt[sd->ijk_min[0]];
+  sd->xyz_max[0] = meshi->xplt[sd->ijk_max[0]];
+  sd->xyz_min[1] = meshi->yplt[sd->ijk_min[1]];
+  sd->xyz_max[1] = meshi->yplt[sd->ijk_max[1]];
+  sd->xyz_min[2] = meshi->zplt[sd->ijk_min[2]];
+  sd->xyz_max[2] = meshi->zplt[sd->ijk_max[2]];
+}
+
+/* ------------------ ReadSliceData ------------------------ */
+
+FILE_SIZE ReadSliceData(slicedata *sd, char *file, int time_frame, int flag, int *averagedptr, int *errorcode){
+
+// load entire slice file (flag=LOAD) or
+// load only portion of slice file written to since last time it was loaded (flag=RELOAD)
+// only sd is modified so that this routine may be called from a slice loading thread,
+// the global bookkeeping is done by ReadSlice
+
+  float *xplt_local, *yplt_local, *zplt_local, offset, qmin, qmax;
+  float xmid, ymid, zmid;
+  int error, i, headersize, framesize;
+  int ntimes_slice_old;
+  int loadbox[9], use_loadbox = 0;
+  meshdata *meshi;
+  FILE_SIZE return_filesize = 0;
+  int file_size = 0;
+#ifdef pp_memstatus
+  unsigned int availmemory;
+#endif
+
+  *errorcode = 0;
+  *averagedptr = 0;
+  error = 0;
+  if(sd->compression_type == UNCOMPRESSED){
+    sd->ntimes_old = sd->ntimes;
+    if(use_cslice==1){
+      GetSliceSizes(file, time_frame, &sd->nslicei, &sd->nslicej, &sd->nslicek, &sd->ntimes, sliceframestep, &error,
+        settmin_s, settmax_s, tmin_s, tmax_s, &headersize, &framesize);
+    }
+    else{
+      FORTgetslicesizes(file, &sd->nslicei, &sd->nslicej, &sd->nslicek, &sd->ntimes, &sliceframestep, &error,
+        &settmin_s, &settmax_s, &tmin_s, &tmax_s, &headersize, &framesize,
+        strlen(file));
+    }
+  }
+  else if(sd->compression_type != UNCOMPRESSED){
+    if(
+      GetSliceHeader(sd->comp_file, sd->size_file, sd->compression_type,
+        sliceframestep, settmin_s, settmax_s, tmin_s, tmax_s,
+        &sd->nslicei, &sd->nslicej, &sd->nslicek, &sd->ntimes, &sd->ncompressed, &sd->valmin, &sd->valmax) == 0){
+      *errorcode = 1;
+      return 0;
+    }
+  }
+  if(sd->nslicei != 1 && sd->nslicej != 1 && sd->nslicek != 1){
+    sd->volslice = 1;
+  }
+  if(error != 0){
+    *errorcode = 1;
+    return 0;
+  }
+  if(settmax_s == 0 && settmin_s == 0 && sd->compression_type == UNCOMPRESSED){
+    if(framesize <= 0){
+      fprintf(stderr, "*** Error: frame size is 0 in slice file %s . \n", file);
+      error = 1;
+    }
+    else{
+      if(time_frame==ALL_SLICE_FRAMES){
+        sd->ntimes = (int)(GetFileSizeSMV(file)-headersize)/framesize;
+        if(sliceframestep>1)sd->ntimes /= sliceframestep;
+      }
+    }
+  }
+  if(error != 0 || sd->ntimes<1){
+    *errorcode = 1;
+    return 0;
+  }
+  MEMSTATUS(1, &availmemory, NULL, NULL);
+  if(sd->compression_type != UNCOMPRESSED){
+    int return_code;
+
+    return_code = NewResizeMemory(sd->qslicedata_compressed, sd->ncompressed);
+    if(return_code!=0)return_code = NewResizeMemory(sd->times, sizeof(float)*sd->ntimes);
+    if(return_code!=0)return_code = NewResizeMemory(sd->compindex, sizeof(compdata)*(1+sd->ntimes));
+    if(return_code==0){
+      *errorcode = 1;
+      return 0;
+    }
+    return_code=GetSliceCompressedData(sd->comp_file, sd->compression_type,
+      settmin_s, settmax_s, tmin_s, tmax_s, sd->ncompressed, sliceframestep, sd->ntimes,
+      sd->times, sd->qslicedata_compressed, sd->compindex, &sd->globalmin, &sd->globalmax);
+    if(return_code == 0){
+      *errorcode = 1;
+      return 0;
+    }
+    file_size = sd->ncompressed;
+    return_filesize = (FILE_SIZE)file_size;
+  }
+  else{
+    int return_val;
+
+    if((slice_frame_budget>0||sd->force_paged==1)&&time_frame==ALL_SLICE_FRAMES&&slice_average_flag==0&&sd->is_fed==0)sd->paged = 1;
+    if(sd->volslice==1&&sd->paged==0&&sd->is_fed==0){
+      int inbox;
+
+      inbox = GetLoadBox(meshinfo+sd->blocknumber, loadbox);
+      if(inbox==-1){
+        PRINTF("%s is outside of the load box, not loaded\n", file);
+        *errorcode = 1;
+        return 0;
+      }
+      if(inbox==1)use_loadbox = 1;
+    }
+    if(sd->paged==1){
+
+      // paged loading: only a frame index is kept, frames are read on demand by GetSliceFrame
+
+      FREEMEMORY(sd->qslicedata);
+      return_val = NewResizeMemory(sd->times, sizeof(float)*sd->ntimes);
+      if(return_val!=0)return_val = NewMemory((void **)&sd->pageinfo.frame_offsets, sizeof(FILE_SIZE)*sd->ntimes);
+      if(return_val!=0)return_val = NewMemory((void **)&sd->pageinfo.frames, sizeof(sliceframedata *)*sd->ntimes);
+      if(return_val!=0){
+        for(i = 0; i<sd->ntimes; i++){
+          sd->pageinfo.frames[i] = NULL;
+        }
+      }
+    }
+    else if(use_loadbox==1){
+      int ijk_file[6], bounds[6], header_error;
+
+      // only the part of the slice inside the load box is kept, GetSliceDataMMap copies it in frame by frame
+
+      GetSliceFileHeader(file, ijk_file, ijk_file+1, ijk_file+2, ijk_file+3, ijk_file+4, ijk_file+5, &header_error);
+      if(header_error!=0){
+        *errorcode = 1;
+        return 0;
+      }
+      GetSliceCropBounds(loadbox, ijk_file, bounds);
+      return_val = NewResizeMemory(sd->qslicedata, sizeof(float)*(bounds[1]+2-bounds[0])*(bounds[3]+2-bounds[2])*(bounds[5]+2-bounds[4])*sd->ntimes);
+      if(return_val!=0)return_val = NewResizeMemory(sd->times, sizeof(float)*sd->ntimes);
+    }
+    else{
+      return_val = NewResizeMemory(sd->qslicedata, sizeof(float)*(sd->nslicei+1)*(sd->nslicej+1)*(sd->nslicek+1)*sd->ntimes);
+      if(return_val!=0)return_val = NewResizeMemory(sd->times, sizeof(float)*sd->ntimes);
+    }
+
+    if(return_val == 0){
+      *errorcode = 1;
+      return 0;
+    }
+#ifdef pp_MEMDEBUG
+    if(sd->paged==0&&use_loadbox==0){
+      ASSERT(ValidPointer(sd->qslicedata, sizeof(float)*sd->nslicei*sd->nslicej*sd->nslicek*sd->ntimes));
+    }
+#endif
+
+    ntimes_slice_old = 0;
+    if(flag==RELOAD&&sd->paged==0&&sd->cropped==0&&use_loadbox==0){
+      ntimes_slice_old = sd->ntimes_old;
+      qmin = sd->globalmin;
+      qmax = sd->globalmax;
+    }
+    else{
+      qmin = 1.0e30;
+      qmax = -1.0e30;
+    }
+    sd->cropped = 0;
+    if(sd->paged==1){
+      return_filesize =
+        GetSliceDataMMap(file, time_frame, &sd->is1, &sd->is2, &sd->js1, &sd->js2, &sd->ks1, &sd->ks2, &sd->idir,
+          &qmin, &qmax, NULL, &sd->pageinfo, NULL, &sd->cropped, sd->times, 0, &sd->ntimes,
+          sliceframestep, settmin_s, settmax_s, tmin_s, tmax_s
+#ifdef pp_MULTI_RES
+          , sd->multi_res
+#endif
+        );
+      file_size = (int)return_filesize;
+      sd->pageinfo.nframes = sd->ntimes;
+      sd->pageinfo.datamin = qmin;
+      sd->pageinfo.datamax = qmax;
+      sd->pageinfo.colormin = qmin;
+      sd->pageinfo.colormax = qmax;
+    }
+    else if(sd->ntimes > ntimes_slice_old){
+      if(use_loadbox==1||(use_cslice==1&&use_slice_mmap==1)){
+        return_filesize =
+          GetSliceDataMMap(file, time_frame, &sd->is1, &sd->is2, &sd->js1, &sd->js2, &sd->ks1, &sd->ks2, &sd->idir,
+            &qmin, &qmax, sd->qslicedata, NULL, use_loadbox==1 ? loadbox : NULL, &sd->cropped, sd->times, ntimes_slice_old, &sd->ntimes,
+            sliceframestep, settmin_s, settmax_s, tmin_s, tmax_s
+#ifdef pp_MULTI_RES
+            , sd->multi_res
+#endif
+          );
+        file_size = (int)return_filesize;
+      }
+      else if(use_cslice==1){
+        return_filesize =
+          GetSliceData(file, time_frame, &sd->is1, &sd->is2, &sd->js1, &sd->js2, &sd->ks1, &sd->ks2, &sd->idir,
+            &qmin, &qmax, sd->qslicedata, sd->times, ntimes_slice_old, &sd->ntimes,
+            sliceframestep, settmin_s, settmax_s, tmin_s, tmax_s
+#ifdef pp_MULTI_RES
+            , sd->multi_res
+#endif
+          );
+        file_size = (int)return_filesize;
+      }
+      else{
+        FORTgetslicedata(file,
+          &sd->is1, &sd->is2, &sd->js1, &sd->js2, &sd->ks1, &sd->ks2, &sd->idir,
+          &qmin, &qmax, sd->qslicedata, sd->times, &ntimes_slice_old, &sd->ntimes, &sliceframestep,
+          &settmin_s, &settmax_s, &tmin_s, &tmax_s, &file_size, strlen(file));
+        return_filesize = (FILE_SIZE)file_size;
+      }
+    }
+#ifdef pp_MEMDEBUG
+    if(sd->paged==0&&use_loadbox==0){
+      ASSERT(ValidPointer(sd->qslicedata, sizeof(float)*sd->nslicei*sd->nslicej*sd->nslicek*sd->ntimes));
+    }
+#endif
+  }
+
+  if(sd->compression_type==UNCOMPRESSED&&sd->volslice==1&&sd->is_fed==0){
+    if(use_loadbox==1&&sd->cropped==0){
+      *errorcode = 1;
+      return 0;
+    }
+    SetVolSliceBounds(sd);
+  }
+
+  if(slice_average_flag == 1){
+    int data_per_timestep;
+    int ndata;
+    int ntimes_local;
+
+    data_per_timestep = sd->nslicei*sd->nslicej*sd->nslicek;
+    ntimes_local = sd->ntimes;
+    ndata = data_per_timestep*ntimes_local;
+    *averagedptr = 1;
+
+    if(
+      sd->compression_type != UNCOMPRESSED ||
+      TimeAverageData(sd->qslicedata, sd->qslicedata, ndata, data_per_timestep, sd->times, ntimes_local, slice_average_interval) == 1
+      ){
+      *averagedptr = 0; // averaging failed
+    }
+  }
+
+  /*  initialize slice data */
+
+  sd->nslicetotal = 0;
+  sd->nsliceijk = 0;
+  if(sd->ntimes == 0)return 0;
+
+  /* estimate the slice offset, the distance to move a slice so
+  that it does not "interfere" with an adjacent block */
+
+  meshi = meshinfo + sd->blocknumber;
+  xplt_local = meshi->xplt;
+  yplt_local = meshi->yplt;
+  zplt_local = meshi->zplt;
+
+  xmid = (xplt_local[sd->is1] + xplt_local[sd->is2]) / 2.0;
+  ymid = (yplt_local[sd->js1] + yplt_local[sd->js2]) / 2.0;
+  zmid = (zplt_local[sd->ks1] + zplt_local[sd->ks2]) / 2.0;
+
+  sd->sliceoffset = 0.0;
+
+  switch (sd->idir){
+  case XDIR:
+    offset = sliceoffset_factor*(xplt_local[1] - xplt_local[0]);
+    if(InBlockage(meshi, xmid - offset, ymid, zmid) == 1){
+      sd->sliceoffset = offset;
+    }
+    if(InBlockage(meshi, xmid + offset, ymid, zmid) == 1){
+      sd->sliceoffset = -offset;
+    }
+    sd->nslicex = sd->js2 + 1 - sd->js1;
+    sd->nslicey = sd->ks2 + 1 - sd->ks1;
+    break;
+  case YDIR:
+    offset = sliceoffset_factor*(yplt_local[1] - yplt_local[0]);
+    if(InBlockage(meshi, xmid, ymid - offset, zmid) == 1){
+      sd->sliceoffset = offset;
+    }
+    if(InBlockage(meshi, xmid, ymid + offset, zmid) == 1){
+      sd->sliceoffset = -offset;
+    }
+    sd->nslicex = sd->is2 + 1 - sd->is1;
+    sd->nslicey = sd->ks2 + 1 - sd->ks1;
+    break;
+  case ZDIR:
+    offset = sliceoffset_factor*(zplt_local[1] - zplt_local[0]);
+    if(InBlockage(meshi, xmid, ymid, zmid - offset) == 1){
+      sd->sliceoffset = offset;
+    }
+    if(InBlockage(meshi, xmid, ymid, zmid + offset) == 1){
+      sd->sliceoffset = -offset;
+    }
+    sd->nslicex = sd->is2 + 1 - sd->is1;
+    sd->nslicey = sd->js2 + 1 - sd->js1;
+    break;
+  default:
+    ASSERT(FFALSE);
+    break;
+  }
+
+  sd->nsliceijk = sd->nslicei*sd->nslicej*sd->nslicek;
+  sd->nslicetotal = sd->ntimes*sd->nsliceijk;
+  if(sd->compression_type != UNCOMPRESSED){
+    if(NewMemory((void **)&sd->slicecomplevel, sd->nsliceijk * sizeof(unsigned char)) == 0){
+      *errorcode = 1;
+      return 0;
+    }
+  }
+  else if(sd->paged==1){
+    FREEMEMORY(sd->slicelevel);
+  }
+  else{
+    int return_code;
+
+    return_code = NewResizeMemory(sd->slicelevel, sd->nslicetotal*sizeof(int));
+    if(return_code == 0){
+      *errorcode = 1;
+      return 0;
+    }
+  }
+  return return_filesize;
+}
+
+/* ------------------ ReadSlice ------------------------ */
+
+FILE_SIZE ReadSlice(char *file, int ifile, int time_frame, float *time_value, int flag, int set_slicecolor, int *errorcode){
+  float qmin, qmax, total_time;
+  int blocknumber, error, i, ii, flag2 = 0, averaged = 0, memory_id_save;
+  slicedata *sd;
+
+  vslicedata *vd;
+  meshdata *meshi;
+
+  FILE_SIZE return_filesize=0;
+  int file_size=0;
+
+#ifndef pp_FSEEK
+  if(flag==RELOAD)flag = LOAD;
+#endif
+  update_fileload = 1;
+  CheckMemory;
+  START_TIMER(total_time);
+  if(flag!=FINISH_LOAD)PrefetchFlush();
+  *errorcode = 0;
+  error = 0;
+  show_slice_average = 0;
+  blocknumber = sliceinfo[ifile].blocknumber;
+  meshi = meshinfo + blocknumber;
+  if(meshi->terrain!=NULL&&meshi->terrain->nvalues==0){
+    if(flag==LOAD){
+      printf("***warning: all terrain elevations below %f.  Slice file %s not loaded\n", meshi->terrain->zmin_cutoff, file);
+    }
+    return 0;
+  }
+
+  slicefilenumber = ifile;
+  slicefilenum = ifile;
+  histograms_defined = 0;
+
+  ASSERT(slicefilenumber >= 0 && slicefilenumber<nsliceinfo);
+  sd = sliceinfo + slicefilenumber;
+  if(flag==LOAD||flag==RELOAD)EnforceMemoryBudget(GetMemoryLoadSize(file, sd->memory_id, &sd->last_display));
+  if(flag != RESETBOUNDS){
+    if(sd->loaded == 0 && flag == UNLOAD)return 0;
+    if(flag==UNLOAD)sd->force_paged = 0;
+    sd->display = 0;
+#ifdef pp_MEMDEBUG
+    if(sd->qslicedata != NULL){
+      ASSERT(ValidPointer(sd->qslicedata, sizeof(float)*sd->nslicetotal));
+    }
+#endif
 
-    /*  initialize slice data */
-
-    sd->nslicetotal = 0;
-    sd->nsliceijk = 0;
-    if(sd->ntimes == 0)return 0;
-
-    /* estimate the slice offset, the distance to move a slice so
-    that it does not "interfere" with an adjacent block */
+// free memory buffers
 
-    blocknumber = sliceinfo[ifile].blocknumber;
-    xplt_local = meshinfo[blocknumber].xplt;
-    yplt_local = meshinfo[blocknumber].yplt;
-    zplt_local = meshinfo[blocknumber].zplt;
+    if(flag!=FINISH_LOAD){
+      FreeSliceFrames(sd);
+      FreeSliceBuffers(sd, flag);
+    }
 
-    xslicemid = (xplt_local[sd->is1] + xplt_local[sd->is2]) / 2.0;
-    yslicemid = (yplt_local[sd->js1] + yplt_local[sd->js2]) / 2.0;
-    zslicemid = (zplt_local[sd->ks1] + zplt_local[sd->ks2]) / 2.0;
+    slicefilenum = ifile;
 
-    sd->sliceoffset = 0.0;
+// reset slice variables to an unloaded state
 
-    switch (sd->idir){
-    case XDIR:
-      offset = sliceoffset_factor*(xplt_local[1] - xplt_local[0]);
-      if(InBlockage(meshi, xslicemid - offset, yslicemid, zslicemid) == 1){
-        sd->sliceoffset = offset;
+    if(flag == UNLOAD){
+      update_flipped_colorbar = 1;
+      sd->ntimes_old = 0;
+      sd->ntimes = 0;
+      updatemenu = 1;
+      sd->loaded = 0;
+      sd->vloaded = 0;
+      sd->display = 0;
+      plotstate = GetPlotState(DYNAMIC_PLOTS);
+      ReadVolSlice = 0;
+      for(ii = 0; ii<nslice_loaded; ii++){
+        slicedata *sdi;
+
+        i = slice_loaded_list[ii];
+        sdi = sliceinfo + i;
+        if(sdi->volslice == 1)ReadVolSlice = 1;
       }
-      if(InBlockage(meshi, xslicemid + offset, yslicemid, zslicemid) == 1){
-        sd->sliceoffset = -offset;
+      for(ii = 0; ii<nslice_loaded; ii++){
+        slicedata *sdi;
+
+        i = slice_loaded_list[ii];
+        sdi = sliceinfo + i;
+        if(sdi->slicefile_labelindex == slicefile_labelindex){
+          slicefilenum = i;
+          flag2 = 1;
+          break;
+        }
       }
-      sd->nslicex = sd->js2 + 1 - sd->js1;
-      sd->nslicey = sd->ks2 + 1 - sd->ks1;
-      break;
-    case YDIR:
-      offset = sliceoffset_factor*(yplt_local[1] - yplt_local[0]);
-      if(InBlockage(meshi, xslicemid, yslicemid - offset, zslicemid) == 1){
-        sd->sliceoffset = offset;
+      if(flag2 == 0){
+        for(ii = 0; ii<nslice_loaded; ii++){
+          slicedata *sdi;
+
+          i = slice_loaded_list[ii];
+          sdi = sliceinfo + i;
+          if(sdi->slicefile_labelindex != slicefile_labelindex){
+            slicefilenum = i;
+            flag2 = 1;
+            break;
+          }
+        }
       }
-      if(InBlockage(meshi, xslicemid, yslicemid + offset, zslicemid) == 1){
-        sd->sliceoffset = -offset;
+      if(flag2 == 0){
+        slicefilenum = 0;
+        slicefile_labelindex = 0;
       }
-      sd->nslicex = sd->is2 + 1 - sd->is1;
-      sd->nslicey = sd->ks2 + 1 - sd->ks1;
-      break;
-    case ZDIR:
-      offset = sliceoffset_factor*(zplt_local[1] - zplt_local[0]);
-      if(InBlockage(meshi, xslicemid, yslicemid, zslicemid - offset) == 1){
-        sd->sliceoffset = offset;
+
+      for(i = 0; i<nvsliceinfo; i++){
+        vd = vsliceinfo + i;
+        if(vd->iu == ifile)vd->u = NULL;
+        if(vd->iv == ifile)vd->v = NULL;
+        if(vd->iw == ifile)vd->w = NULL;
+        if(vd->u == NULL&&vd->v == NULL&&vd->w == NULL){
+          vd->loaded = 0;
+          vd->display = 0;
+        }
+        if(vd->ival == ifile){
+          vd->val = NULL;
+          vd->loaded = 0;
+          vd->display = 0;
+        }
       }
-      if(InBlockage(meshi, xslicemid, yslicemid, zslicemid + offset) == 1){
-        sd->sliceoffset = -offset;
+      if(use_set_slicecolor == 0 || set_slicecolor == SET_SLICECOLOR){
+        if(sd->compression_type == UNCOMPRESSED){
+          UpdateSliceBounds();
+          list_slice_index = slicefile_labelindex;
+          SliceBounds2Glui(slicefile_labelindex);
+          UpdateAllSliceColors(slicefile_labelindex, errorcode);
+        }
+        else{
+          UpdateAllSliceLabels(slicefile_labelindex, errorcode);
+        }
       }
-      sd->nslicex = sd->is2 + 1 - sd->is1;
-      sd->nslicey = sd->js2 + 1 - sd->js1;
-      break;
-    default:
-      ASSERT(FFALSE);
-      break;
+
+      UpdateGlui();
+      UpdateUnitDefs();
+      UpdateTimes();
+      RemoveSliceLoadstack(slicefilenumber);
+      return 0;
     }
 
-    sd->nsliceijk = sd->nslicei*sd->nslicej*sd->nslicek;
-    sd->nslicetotal = sd->ntimes*sd->nsliceijk;
-    if(sd->compression_type != UNCOMPRESSED){
-      if(NewMemory((void **)&sd->slicecomplevel, sd->nsliceijk * sizeof(unsigned char)) == 0){
-        ReadSlice("", ifile, time_frame, time_value, UNLOAD,  set_slicecolor, &error);
-        *errorcode = 1;
-        return 0;
-      }
+// read slice data (or pick up data already read by a slice loading thread)
+
+    memory_id_save = SetMemoryId(sd->memory_id);
+#ifdef pp_SLICETHREAD
+    if(flag==FINISH_LOAD){
+      return_filesize = sd->load_size;
+      averaged = sd->load_averaged;
+      error = sd->load_error;
     }
     else{
-      int return_code;
-
-      return_code = NewResizeMemory(sd->slicelevel, sd->nslicetotal*sizeof(int));
-      if(return_code == 0){
-        ReadSlice("", ifile, time_frame, time_value, UNLOAD,  set_slicecolor, &error);
-        *errorcode = 1;
-        return 0;
-      }
+      return_filesize = ReadSliceData(sd, file, time_frame, flag, &averaged, &error);
+    }
+#else
+    return_filesize = ReadSliceData(sd, file, time_frame, flag, &averaged, &error);
+#endif
+    SetMemoryId(memory_id_save);
+    file_size = (int)return_filesize;
+    if(error != 0){
+      ReadSlice("", ifile, time_frame, time_value, UNLOAD, set_slicecolor, &error);
+      *errorcode = 1;
+      return 0;
+    }
+    if(sd->volslice == 1)ReadVolSlice = 1;
+    show_slice_average = averaged;
+    if(time_value!=NULL&&sd->ntimes>0){
+      *time_value = sd->times[0];
+    }
+    if(sd->ntimes == 0)return 0;
+    if(time_frame==ALL_SLICE_FRAMES&&flag!=FINISH_LOAD){
+      PRINTF("Loading %s(%s)", file, sd->label.shortlabel);
     }
-
 #ifdef pp_MEMDEBUG
-    if(sd->compression_type == UNCOMPRESSED){
+    if(sd->compression_type == UNCOMPRESSED&&sd->paged==0){
       ASSERT(ValidPointer(sd->qslicedata, sizeof(float)*sd->nslicetotal));
     }
 #endif
   }  /* RESETBOUNDS */
 
+
+
      // convert slice data into color indices
 
   if(sd->compression_type == UNCOMPRESSED){
@@ -5335,47 +6436,7 @@ FILE_SIZE ReadSlice(char *file, int ifile, int time_frame, float *time_value, in
   if(sd->vloaded == 0)sd->display = 1;
   slicefile_labelindex = GetSliceBoundsIndex(sd);
   plotstate = GetPlotState(DYNAMIC_PLOTS);
-  if(sd->finalize==1){
-    UpdateUnitDefs();
-    UpdateTimes();
-    CheckMemory;
-
-    //*** comment out following line to prevent crash when loading a slice when particles are loaded
-    //if(flag!=RESETBOUNDS)update_research_mode=1;
-    if(use_set_slicecolor==0||set_slicecolor==SET_SLICECOLOR){
-      if(sd->compression_type==UNCOMPRESSED){
-        UpdateSliceBounds();
-        UpdateAllSliceColors(slicefile_labelindex, errorcode);
-        list_slice_index = slicefile_labelindex;
-        SliceBounds2Glui(slicefile_labelindex);
-      }
-      else{
-        boundsdata *sb;
-
-        sb = slicebounds + slicefile_labelindex;
-        sb->data_valmin = qmin;
-        sb->data_valmax = qmax;
-
-        UpdateAllSliceLabels(slicefile_labelindex, errorcode);
-        MakeColorLabels(sb->colorlabels, sb->colorvalues, qmin, qmax, nrgb);
-      }
-    }
-    CheckMemory;
-
-    UpdateSliceList(list_slice_index);
-    CheckMemory;
-    UpdateSliceListIndex(slicefilenum);
-    CheckMemory;
-    UpdateGlui();
-    CheckMemory;
-#ifdef pp_MEMDEBUG
-    if(sd->compression_type==UNCOMPRESSED){
-      ASSERT(ValidPointer(sd->qslicedata, sizeof(float)*sd->nslicei*sd->nslicej*sd->nslicek*sd->ntimes));
-    }
-    CheckMemory;
-#endif
-    IdleCB();
-  }
+  if(sd->finalize==1)FinalizeSliceLoad(sd, set_slicecolor, errorcode);
 
   exportdata = 1;
   if(exportdata == 0){
@@ -5385,7 +6446,7 @@ FILE_SIZE ReadSlice(char *file, int ifile, int time_frame, float *time_value, in
   STOP_TIMER(total_time);
 
 
-  if(time_frame==ALL_SLICE_FRAMES&&flag != RESETBOUNDS){
+  if(time_frame==ALL_SLICE_FRAMES&&flag != RESETBOUNDS&&flag != FINISH_LOAD){
     if(file_size>1000000000){
       PRINTF(" - %.1f GB/%.1f s\n", (float)file_size / 1000000000., total_time);
     }
@@ -5470,13 +6531,6 @@ FILE_SIZE ReadSliceUseGluiBounds(char *file, int ifile, int time_frame, float *t
 }
 #endif
 
-#ifdef pp_SLICETHREAD
-/* ------------------ FinalizeSliceLoad ------------------------ */
-
-void FinalizeSliceLoad(slicedata *slicei){
-}
-#endif
-
 /* ------------------ UpdateSlice3DTexture ------------------------ */
 
 void UpdateSlice3DTexture(meshdata *meshi, slicedata *slicei, float *valdata){
@@ -5580,6 +6634,18 @@ void DrawGSliceDataGpu(slicedata *slicei){
   glPopMatrix();
 }
 
+/* ------------------ GetSlicePlane ------------------------ */
+
+int GetSlicePlane(int plot, int start, int n){
+
+// returns the mesh plane plot if it is one of the n planes of slice data beginning at start, -1 otherwise.
+// a loaded volume slice may only cover part of its mesh (see SetVolSliceBounds) so planes outside of it
+// must not be drawn
+
+  if(plot<start||plot>=start+n)return -1;
+  return plot;
+}
+
 /* ------------------ DrawVolSliceCellFaceCenter ------------------------ */
 
 void DrawVolSliceCellFaceCenter(const slicedata *sd, int flag){
@@ -5602,13 +6668,13 @@ void DrawVolSliceCellFaceCenter(const slicedata *sd, int flag){
   yplt = meshi->yplt;
   zplt = meshi->zplt;
   if(sd->volslice == 1){
-    plotx = meshi->iplotx_all[iplotx_all];
-    ploty = meshi->iploty_all[iploty_all];
-    plotz = meshi->iplotz_all[iplotz_all];
+    plotx = GetSlicePlane(meshi->iplotx_all[iplotx_all], sd->is1, sd->nslicei);
+    ploty = GetSlicePlane(meshi->iploty_all[iploty_all], sd->js1, sd->nslicej);
+    plotz = GetSlicePlane(meshi->iplotz_all[iplotz_all], sd->ks1, sd->nslicek);
     incx = 1;
     incy = 1;
     incz = 1;
-    iimin = 0;
+    iimin = sd->is1;
   }
   else{
     plotx = sd->is1;
@@ -5934,9 +7000,9 @@ void DrawVolSliceTerrain(const slicedata *sd){
   zplt = meshi->zplt_orig;
 
   if(sd->volslice == 1){
-    plotx = meshi->iplotx_all[iplotx_all];
-    ploty = meshi->iploty_all[iploty_all];
-    plotz = meshi->iplotz_all[iplotz_all];
+    plotx = GetSlicePlane(meshi->iplotx_all[iplotx_all], sd->is1, sd->nslicei);
+    ploty = GetSlicePlane(meshi->iploty_all[iploty_all], sd->js1, sd->nslicej);
+    plotz = GetSlicePlane(meshi->iplotz_all[iplotz_all], sd->ks1, sd->nslicek);
   }
   else{
     plotx = sd->is1;
@@ -6366,6 +7432,381 @@ void DrawVolAllSlicesTextureDiag(const slicedata *sd, int direction){
   if(cullfaces == 1)glEnable(GL_CULL_FACE);
 }
 
+/* ------------------ FreeSliceVBO ------------------------ */
+
+void FreeSliceVBO(slicedata *sd){
+  slicevbodata *vbo;
+  int dir;
+
+  vbo = &sd->vbo;
+  if(vbo->defined==0)return;
+  for(dir = 0; dir<3; dir++){
+    if(vbo->vertex_ids[dir]!=0)glDeleteBuffers(1, vbo->vertex_ids+dir);
+    if(vbo->texcoord_ids[dir]!=0)glDeleteBuffers(1, vbo->texcoord_ids+dir);
+    if(vbo->index_ids[dir]!=NULL){
+      int p;
+
+      for(p = 0; p<vbo->nplanes[dir]; p++){
+        if(vbo->index_ids[dir][p]!=0)glDeleteBuffers(1, vbo->index_ids[dir]+p);
+      }
+    }
+    FREEMEMORY(vbo->index_ids[dir]);
+    FREEMEMORY(vbo->nindices[dir]);
+  }
+  FREEMEMORY(vbo->texcoords);
+  vbo->ntexcoords = 0;
+  vbo->defined = 0;
+}
+
+/* ------------------ GetSlicePlaneLayout ------------------------ */
+
+int GetSlicePlaneLayout(const slicedata *sd, int dir, int *axis_a, int *axis_b, int *start, int *na, int *nb, int *nplanes){
+
+// node layout of a slice plane perpendicular to direction dir (0, 1 or 2).  the plane nodes are
+// indexed (a,b) along the axes axis_a and axis_b starting at mesh node start[axis_a], start[axis_b]
+// and the planes along dir start at start[dir].  returns 0 if the plane does not fit in the slice data
+
+  int nsliceijk[3], maxa, n;
+
+  start[0] = sd->is1;
+  start[1] = sd->js1;
+  start[2] = sd->ks1;
+  nsliceijk[0] = sd->nslicei;
+  nsliceijk[1] = sd->nslicej;
+  nsliceijk[2] = sd->nslicek;
+  switch(dir){
+  case 0:
+    *axis_a = 1;
+    *axis_b = 2;
+    maxa = MAX(sd->js2, sd->js1+1);
+    *nb = sd->ks2+1-sd->ks1;
+    break;
+  case 1:
+    *axis_a = 0;
+    *axis_b = 2;
+    maxa = MAX(sd->is1+sd->nslicei-1, sd->is1+1);
+    *nb = sd->ks2+1-sd->ks1;
+    break;
+  case 2:
+    *axis_a = 0;
+    *axis_b = 1;
+    maxa = MAX(sd->is1+sd->nslicei-1, sd->is1+1);
+    *nb = sd->js2+1-sd->js1;
+    break;
+  default:
+    ASSERT(FFALSE);
+    return 0;
+  }
+  *na = maxa+1-start[*axis_a];
+  *nplanes = nsliceijk[dir];
+  n = *na;
+  if(n<2||n>nsliceijk[*axis_a])return 0;
+  n = *nb;
+  if(n<2||n>nsliceijk[*axis_b])return 0;
+  return 1;
+}
+
+/* ------------------ SetupSliceVBO ------------------------ */
+
+void SetupSliceVBO(slicedata *sd, meshdata *meshi){
+
+// (re)define the vertex buffer objects of sd if the slice bounds or blanking settings have changed
+// since they were built (the slice was reloaded or the blanking arrays were computed).
+
+  slicevbodata *vbo;
+  int dir;
+
+  vbo = &sd->vbo;
+  if(vbo->defined==1&&
+     vbo->ijk_start[0]==sd->is1&&vbo->ijk_start[1]==sd->js1&&vbo->ijk_start[2]==sd->ks1&&
+     vbo->nijk[0]==sd->nslicei&&vbo->nijk[1]==sd->nslicej&&vbo->nijk[2]==sd->nslicek&&
+     vbo->c_iblank[0]==meshi->c_iblank_x&&vbo->c_iblank[1]==meshi->c_iblank_y&&vbo->c_iblank[2]==meshi->c_iblank_z&&
+     vbo->c_iblank_embed==meshi->c_iblank_embed&&
+     vbo->show_slice_in_obst==show_slice_in_obst&&vbo->skip_slice_in_embedded_mesh==skip_slice_in_embedded_mesh)return;
+  FreeSliceVBO(sd);
+  vbo->ijk_start[0] = sd->is1;
+  vbo->ijk_start[1] = sd->js1;
+  vbo->ijk_start[2] = sd->ks1;
+  vbo->nijk[0] = sd->nslicei;
+  vbo->nijk[1] = sd->nslicej;
+  vbo->nijk[2] = sd->nslicek;
+  vbo->c_iblank[0] = meshi->c_iblank_x;
+  vbo->c_iblank[1] = meshi->c_iblank_y;
+  vbo->c_iblank[2] = meshi->c_iblank_z;
+  vbo->c_iblank_embed = meshi->c_iblank_embed;
+  vbo->show_slice_in_obst = show_slice_in_obst;
+  vbo->skip_slice_in_embedded_mesh = skip_slice_in_embedded_mesh;
+  for(dir = 0; dir<3; dir++){
+    vbo->vertex_ids[dir] = 0;
+    vbo->texcoord_ids[dir] = 0;
+    vbo->index_ids[dir] = NULL;
+    vbo->nindices[dir] = NULL;
+    vbo->nplanes[dir] = 0;
+  }
+  vbo->texcoords = NULL;
+  vbo->ntexcoords = 0;
+  vbo->defined = 1;
+}
+
+/* ------------------ MakeSlicePlaneVBO ------------------------ */
+
+void MakeSlicePlaneVBO(slicedata *sd, meshdata *meshi, int dir){
+
+// store the node and cell center positions of the planes of sd perpendicular to dir in a vertex
+// buffer object.  the coordinate along dir is zero, planes are positioned with a translation.
+
+  slicevbodata *vbo;
+  float *plt[3], *xyz, *xyzi;
+  int axis_a, axis_b, start[3], na, nb, nplanes, a, b, nverts;
+
+  vbo = &sd->vbo;
+  GetSlicePlaneLayout(sd, dir, &axis_a, &axis_b, start, &na, &nb, &nplanes);
+  plt[0] = meshi->xplt;
+  plt[1] = meshi->yplt;
+  plt[2] = meshi->zplt;
+  nverts = na*nb+(na-1)*(nb-1);
+  NewMemory((void **)&xyz, 3*nverts*sizeof(float));
+  xyzi = xyz;
+  for(a = 0; a<na; a++){
+    for(b = 0; b<nb; b++){
+      xyzi[dir] = 0.0;
+      xyzi[axis_a] = plt[axis_a][start[axis_a]+a];
+      xyzi[axis_b] = plt[axis_b][start[axis_b]+b];
+      xyzi += 3;
+    }
+  }
+  for(a = 0; a<na-1; a++){
+    for(b = 0; b<nb-1; b++){
+      xyzi[dir] = 0.0;
+      xyzi[axis_a] = (plt[axis_a][start[axis_a]+a]+plt[axis_a][start[axis_a]+a+1])/2.0;
+      xyzi[axis_b] = (plt[axis_b][start[axis_b]+b]+plt[axis_b][start[axis_b]+b+1])/2.0;
+      xyzi += 3;
+    }
+  }
+  glGenBuffers(1, vbo->vertex_ids+dir);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo->vertex_ids[dir]);
+  glBufferData(GL_ARRAY_BUFFER, 3*nverts*sizeof(float), xyz, GL_STATIC_DRAW);
+  glGenBuffers(1, vbo->texcoord_ids+dir);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo->texcoord_ids[dir]);
+  glBufferData(GL_ARRAY_BUFFER, nverts*sizeof(float), NULL, GL_STREAM_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  FREEMEMORY(xyz);
+
+  vbo->na[dir] = na;
+  vbo->nb[dir] = nb;
+  vbo->nplanes[dir] = nplanes;
+  NewMemory((void **)&vbo->index_ids[dir], nplanes*sizeof(GLuint));
+  NewMemory((void **)&vbo->nindices[dir], nplanes*sizeof(int));
+  for(a = 0; a<nplanes; a++){
+    vbo->index_ids[dir][a] = 0;
+    vbo->nindices[dir][a] = -1;
+  }
+}
+
+/* ------------------ MakeSlicePlaneIndexVBO ------------------------ */
+
+void MakeSlicePlaneIndexVBO(slicedata *sd, meshdata *meshi, int dir, int plane){
+
+// store the triangles of plane number plane (perpendicular to dir) in an index buffer object.  each
+// cell is drawn as 4 triangles sharing the cell center, as in DrawVolSliceTexture.  cells hidden by
+// the show_slice_in_obst and skip_slice_in_embedded_mesh settings are left out.
+
+  slicevbodata *vbo;
+  GLuint *indices, *ind;
+  char *c_iblank, *iblank_embed;
+  int axis_a, axis_b, start[3], na, nb, nplanes, ca, cb, nindices;
+  int nx, nxy;
+
+  vbo = &sd->vbo;
+  GetSlicePlaneLayout(sd, dir, &axis_a, &axis_b, start, &na, &nb, &nplanes);
+  c_iblank = vbo->c_iblank[dir];
+  iblank_embed = vbo->c_iblank_embed;
+  nx = meshi->ibar+1;
+  nxy = nx*(meshi->jbar+1);
+
+  NewMemory((void **)&indices, 12*(na-1)*(nb-1)*sizeof(GLuint));
+  ind = indices;
+  for(ca = 0; ca<na-1; ca++){
+    for(cb = 0; cb<nb-1; cb++){
+      int ijk[3], ijkcell;
+      GLuint n11, n31, n13, n33, nmid;
+
+      ijk[dir] = start[dir]+plane;
+      ijk[axis_a] = start[axis_a]+ca;
+      ijk[axis_b] = start[axis_b]+cb;
+      ijkcell = IJK(ijk[0], ijk[1], ijk[2]);
+      if(show_slice_in_obst==ONLY_IN_SOLID && c_iblank!=NULL&&c_iblank[ijkcell]==GASGAS)continue;
+      if(show_slice_in_obst==ONLY_IN_GAS   && c_iblank!=NULL&&c_iblank[ijkcell]!=GASGAS)continue;
+      if(skip_slice_in_embedded_mesh==1&&iblank_embed!=NULL&&iblank_embed[ijkcell]==EMBED_YES)continue;
+
+      //  n13                n33
+      //            nmid
+      //  n11                n31
+
+      n11 = ca*nb+cb;
+      n31 = n11+nb;
+      n13 = n11+1;
+      n33 = n31+1;
+      nmid = na*nb+ca*(nb-1)+cb;
+      *ind++ = n11; *ind++ = n31; *ind++ = nmid;
+      *ind++ = n31; *ind++ = n33; *ind++ = nmid;
+      *ind++ = n33; *ind++ = n13; *ind++ = nmid;
+      *ind++ = n13; *ind++ = n11; *ind++ = nmid;
+    }
+  }
+  nindices = ind-indices;
+  glGenBuffers(1, vbo->index_ids[dir]+plane);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo->index_ids[dir][plane]);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, nindices*sizeof(GLuint), indices, GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  vbo->nindices[dir][plane] = nindices;
+  FREEMEMORY(indices);
+}
+
+/* ------------------ GetSlicePlaneTexCoords ------------------------ */
+
+void GetSlicePlaneTexCoords(slicedata *sd, int dir, int plane, float *texcoords){
+
+// texture coordinates of the nodes and cell centers of plane number plane (perpendicular to dir)
+// for the current frame.  the cell center value is the average of the 4 cell nodes.
+
+  int axis_a, axis_b, start[3], na, nb, nplanes, a, b;
+  int stride[3], offset;
+  float *tex_mid;
+  unsigned char *iq;
+
+  GetSlicePlaneLayout(sd, dir, &axis_a, &axis_b, start, &na, &nb, &nplanes);
+
+  // val(i,j,k) = di*nj*nk + dj*nk + dk
+
+  stride[0] = sd->nslicej*sd->nslicek;
+  stride[1] = sd->nslicek;
+  stride[2] = 1;
+  offset = plane*stride[dir];
+  iq = sd->iqsliceframe;
+  for(a = 0; a<na; a++){
+    unsigned char *iqa;
+    float *tex;
+
+    iqa = iq+offset+a*stride[axis_a];
+    tex = texcoords+a*nb;
+    for(b = 0; b<nb; b++){
+      tex[b] = (float)iqa[b*stride[axis_b]]/255.0;
+    }
+  }
+  tex_mid = texcoords+na*nb;
+  for(a = 0; a<na-1; a++){
+    float *tex1, *tex3;
+
+    tex1 = texcoords+a*nb;
+    tex3 = tex1+nb;
+    for(b = 0; b<nb-1; b++){
+      *tex_mid++ = (tex1[b]+tex3[b]+tex1[b+1]+tex3[b+1])/4.0;
+    }
+  }
+}
+
+/* ------------------ DrawVolSliceTextureVBO ------------------------ */
+
+int DrawVolSliceTextureVBO(slicedata *sd){
+
+// same as DrawVolSliceTexture but the plane geometry is kept in vertex and index buffer objects,
+// built the first time a plane is drawn.  only the texture coordinates are sent each frame.
+// returns 0 if the slice can not be drawn this way (OpenGL older than 1.5, multi-resolution
+// slices or a plane outside the slice data), DrawVolSliceTexture should then be used.
+
+  slicevbodata *vbo;
+  meshdata *meshi;
+  float *plt[3], constval[3];
+  int plot[3], plane[3], vis[3], dir, nverts_max;
+
+  if(opengl_version<150)return 0;
+#ifdef pp_MULTI_RES
+  if(sd->multi_res==1)return 0;
+#endif
+  if(sd->volslice == 1 && visx_all == 0 && visy_all == 0 && visz_all == 0)return 1;
+  meshi = meshinfo + sd->blocknumber;
+  vbo = &sd->vbo;
+
+  plt[0] = meshi->xplt;
+  plt[1] = meshi->yplt;
+  plt[2] = meshi->zplt;
+  if(sd->volslice == 1){
+    plot[0] = GetSlicePlane(meshi->iplotx_all[iplotx_all], sd->is1, sd->nslicei);
+    plot[1] = GetSlicePlane(meshi->iploty_all[iploty_all], sd->js1, sd->nslicej);
+    plot[2] = GetSlicePlane(meshi->iplotz_all[iplotz_all], sd->ks1, sd->nslicek);
+  }
+  else{
+    plot[0] = sd->is1;
+    plot[1] = sd->js1;
+    plot[2] = sd->ks1;
+  }
+  vis[0] = (sd->volslice == 1 && plot[0] >= 0 && visx_all == 1) || (sd->volslice == 0 && sd->idir == XDIR);
+  vis[1] = (sd->volslice == 1 && plot[1] >= 0 && visy_all == 1) || (sd->volslice == 0 && sd->idir == YDIR);
+  vis[2] = (sd->volslice == 1 && plot[2] >= 0 && visz_all == 1) || (sd->volslice == 0 && sd->idir == ZDIR);
+
+  // make sure every visible plane can be drawn from the buffers before drawing any of them
+
+  SetupSliceVBO(sd, meshi);
+  nverts_max = 0;
+  for(dir = 0; dir<3; dir++){
+    int axis_a, axis_b, start[3], na, nb, nplanes;
+
+    if(vis[dir]==0)continue;
+    if(GetSlicePlaneLayout(sd, dir, &axis_a, &axis_b, start, &na, &nb, &nplanes)==0)return 0;
+    plane[dir] = plot[dir]-start[dir];
+    if(plane[dir]<0||plane[dir]>=nplanes)return 0;
+    if(vbo->vertex_ids[dir]==0)MakeSlicePlaneVBO(sd, meshi, dir);
+    if(vbo->nindices[dir][plane[dir]]<0)MakeSlicePlaneIndexVBO(sd, meshi, dir, plane[dir]);
+    nverts_max = MAX(nverts_max, na*nb+(na-1)*(nb-1));
+    constval[dir] = plt[dir][plot[dir]]+offset_slice*sd->sliceoffset+SCALE2SMV(sliceoffset_all);
+  }
+  if(nverts_max>vbo->ntexcoords){
+    FREEMEMORY(vbo->texcoords);
+    NewMemory((void **)&vbo->texcoords, nverts_max*sizeof(float));
+    vbo->ntexcoords = nverts_max;
+  }
+
+  if(cullfaces == 1)glDisable(GL_CULL_FACE);
+  if(use_transparency_data == 1)TransparentOn();
+  glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+  glEnable(GL_TEXTURE_1D);
+  glBindTexture(GL_TEXTURE_1D, texture_slice_colorbar_id);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  for(dir = 0; dir<3; dir++){
+    float translate[3];
+    int nverts;
+
+    if(vis[dir]==0||vbo->nindices[dir][plane[dir]]==0)continue;
+    nverts = vbo->na[dir]*vbo->nb[dir]+(vbo->na[dir]-1)*(vbo->nb[dir]-1);
+    GetSlicePlaneTexCoords(sd, dir, plane[dir], vbo->texcoords);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo->texcoord_ids[dir]);
+    glBufferData(GL_ARRAY_BUFFER, nverts*sizeof(float), vbo->texcoords, GL_STREAM_DRAW);
+    glTexCoordPointer(1, GL_FLOAT, 0, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo->vertex_ids[dir]);
+    glVertexPointer(3, GL_FLOAT, 0, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo->index_ids[dir][plane[dir]]);
+
+    translate[0] = 0.0;
+    translate[1] = 0.0;
+    translate[2] = 0.0;
+    translate[dir] = constval[dir];
+    glPushMatrix();
+    glTranslatef(translate[0], translate[1], translate[2]);
+    glDrawElements(GL_TRIANGLES, vbo->nindices[dir][plane[dir]], GL_UNSIGNED_INT, 0);
+    glPopMatrix();
+  }
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  glDisable(GL_TEXTURE_1D);
+  if(use_transparency_data == 1)TransparentOff();
+  if(cullfaces == 1)glEnable(GL_CULL_FACE);
+  return 1;
+}
+
 /* ------------------ DrawVolSliceTexture ------------------------ */
 
 void DrawVolSliceTexture(const slicedata *sd){
@@ -6415,9 +7856,9 @@ void DrawVolSliceTexture(const slicedata *sd){
   zplt = meshi->zplt;
 #endif
   if(sd->volslice == 1){
-    plotx = meshi->iplotx_all[iplotx_all];
-    ploty = meshi->iploty_all[iploty_all];
-    plotz = meshi->iplotz_all[iplotz_all];
+    plotx = GetSlicePlane(meshi->iplotx_all[iplotx_all], sd->is1, sd->nslicei);
+    ploty = GetSlicePlane(meshi->iploty_all[iploty_all], sd->js1, sd->nslicej);
+    plotz = GetSlicePlane(meshi->iplotz_all[iplotz_all], sd->ks1, sd->nslicek);
   }
   else{
     plotx = sd->is1;
@@ -6932,9 +8373,9 @@ void DrawVolSlice(const slicedata *sd){
   yplt = meshi->yplt;
   zplt = meshi->zplt;
   if(sd->volslice == 1){
-    plotx = meshi->iplotx_all[iplotx_all];
-    ploty = meshi->iploty_all[iploty_all];
-    plotz = meshi->iplotz_all[iplotz_all];
+    plotx = GetSlicePlane(meshi->iplotx_all[iplotx_all], sd->is1, sd->nslicei);
+    ploty = GetSlicePlane(meshi->iploty_all[iploty_all], sd->js1, sd->nslicej);
+    plotz = GetSlicePlane(meshi->iplotz_all[iplotz_all], sd->ks1, sd->nslicek);
   }
   else{
     plotx = sd->is1;
@@ -7242,9 +8683,20 @@ void SortLoadedSliceList(void){
 void DrawSliceFrame(){
   int ii;
   int jjj, nslicemax, blend_mode;
+  double draw_start;
 
+  draw_start = GetWallTime();
   SortLoadedSliceList();
 
+  // release the vertex buffer objects of unloaded slices
+
+  for(ii = 0; ii<nsliceinfo; ii++){
+    slicedata *slicei;
+
+    slicei = sliceinfo+ii;
+    if(slicei->loaded==0&&slicei->vbo.defined==1)FreeSliceVBO(slicei);
+  }
+
 #ifdef pp_SLICE_DEBUG
 // debug output
   printf("DrawSliceFrame ntimes: ");
@@ -7284,16 +8736,16 @@ void DrawSliceFrame(){
         sd->iqsliceframe=sd->slicecomplevel;
       }
       else{
-        sd->iqsliceframe = sd->slicelevel + sd->itime*sd->nsliceijk;
-        sd->qslice = sd->qslicedata + sd->itime*sd->nsliceijk;
+        sd->qslice = GetSliceFrame(sd, sd->itime, &sd->iqsliceframe);
+        if(sd->qslice==NULL)continue;
       }
       sd->qsliceframe=NULL;
 #ifdef pp_MEMDEBUG
-      if(sd->compression_type==UNCOMPRESSED){
+      if(sd->compression_type==UNCOMPRESSED&&sd->paged==0){
         ASSERT(ValidPointer(sd->qslicedata,sizeof(float)*sd->nslicetotal));
       }
 #endif
-      if(sd->qslicedata!= NULL)sd->qsliceframe = sd->qslicedata + sd->itime*sd->nsliceijk;
+      if(sd->compression_type==UNCOMPRESSED)sd->qsliceframe = sd->qslice;
     }
     orien = 0;
     direction = 1;
@@ -7396,7 +8848,9 @@ void DrawSliceFrame(){
       case SLICE_NODE_CENTER:
         if(orien==0){
           if(usetexturebar!=0){
-            DrawVolSliceTexture(sd);
+            if(use_slice_vbo==0||DrawVolSliceTextureVBO(sd)==0){
+              DrawVolSliceTexture(sd);
+            }
             SNIFF_ERRORS("after DrawVolSliceTexture");
           }
           else{
@@ -7469,6 +8923,11 @@ void DrawSliceFrame(){
       DrawGeomData(DRAW_TRANSPARENT, patchi, GEOM_DYNAMIC);
     }
   }
+  if(show_task_timings==1&&nslice_loaded>0){
+    glFinish();
+    slice_draw_time[use_slice_vbo] += GetWallTime()-draw_start;
+    nslice_draw_frames[use_slice_vbo]++;
+  }
 }
 
 /* ------------------ DrawVVolSliceCellCenter ------------------------ */
@@ -7488,9 +8947,9 @@ void DrawVVolSliceCellCenter(const vslicedata *vd){
   yplttemp = meshi->yplt;
   zplttemp = meshi->zplt;
   if(vd->volslice == 1){
-    plotx = meshi->iplotx_all[iplotx_all];
-    ploty = meshi->iploty_all[iploty_all];
-    plotz = meshi->iplotz_all[iplotz_all];
+    plotx = GetSlicePlane(meshi->iplotx_all[iplotx_all], sd->is1, sd->nslicei);
+    ploty = GetSlicePlane(meshi->iploty_all[iploty_all], sd->js1, sd->nslicej);
+    plotz = GetSlicePlane(meshi->iplotz_all[iplotz_all], sd->ks1, sd->nslicek);
   }
   else{
     plotx = sd->is1;
@@ -7925,9 +9384,9 @@ void DrawVVolSliceTerrain(const vslicedata *vd){
   yplttemp = meshi->yplt;
   zplttemp = meshi->zplt;
   if(vd->volslice == 1){
-    plotx = meshi->iplotx_all[iplotx_all];
-    ploty = meshi->iploty_all[iploty_all];
-    plotz = meshi->iplotz_all[iplotz_all];
+    plotx = GetSlicePlane(meshi->iplotx_all[iplotx_all], sd->is1, sd->nslicei);
+    ploty = GetSlicePlane(meshi->iploty_all[iploty_all], sd->js1, sd->nslicej);
+    plotz = GetSlicePlane(meshi->iplotz_all[iplotz_all], sd->ks1, sd->nslicek);
   }
   else{
     plotx = sd->is1;
@@ -8232,9 +9691,9 @@ void DrawVVolSlice(const vslicedata *vd){
   yplttemp = meshi->yplt;
   zplttemp = meshi->zplt;
   if(vd->volslice == 1){
-    plotx = meshi->iplotx_all[iplotx_all];
-    ploty = meshi->iploty_all[iploty_all];
-    plotz = meshi->iplotz_all[iplotz_all];
+    plotx = GetSlicePlane(meshi->iplotx_all[iplotx_all], sd->is1, sd->nslicei);
+    ploty = GetSlicePlane(meshi->iploty_all[iploty_all], sd->js1, sd->nslicej);
+    plotz = GetSlicePlane(meshi->iplotz_all[iplotz_all], sd->ks1, sd->nslicek);
   }
   else{
     plotx = sd->is1;
@@ -8522,9 +9981,8 @@ void DrawVSliceFrame(void){
       VAL->iqsliceframe=VAL->slicecomplevel;
     }
     else{
-      if(VAL!=NULL)VAL->iqsliceframe = VAL->slicelevel + VAL->itime*VAL->nsliceijk;
+      VAL->qsliceframe = GetSliceFrame(VAL, VAL->itime, &VAL->iqsliceframe);
     }
-    if(VAL->qslicedata!=NULL)VAL->qsliceframe = VAL->qslicedata + VAL->itime*VAL->nsliceijk;
 #undef VAL
 #define VAL u
     if(VAL!=NULL){
@@ -8533,7 +9991,7 @@ void DrawVSliceFrame(void){
         VAL->iqsliceframe=VAL->slicecomplevel;
       }
       else{
-        if(VAL!=NULL)VAL->iqsliceframe = VAL->slicelevel + VAL->itime*VAL->nsliceijk;
+        VAL->qslice = GetSliceFrame(VAL, VAL->itime, &VAL->iqsliceframe);
       }
     }
 #undef VAL
@@ -8544,7 +10002,7 @@ void DrawVSliceFrame(void){
         VAL->iqsliceframe=VAL->slicecomplevel;
       }
       else{
-        if(VAL!=NULL)VAL->iqsliceframe = VAL->slicelevel + VAL->itime*VAL->nsliceijk;
+        VAL->qslice = GetSliceFrame(VAL, VAL->itime, &VAL->iqsliceframe);
       }
     }
 #undef VAL
@@ -8555,17 +10013,17 @@ void DrawVSliceFrame(void){
         VAL->iqsliceframe=VAL->slicecomplevel;
       }
       else{
-        if(VAL!=NULL)VAL->iqsliceframe = VAL->slicelevel + VAL->itime*VAL->nsliceijk;
+        VAL->qslice = GetSliceFrame(VAL, VAL->itime, &VAL->iqsliceframe);
       }
     }
     if(u!=NULL&&u->compression_type==UNCOMPRESSED){
-      u->qslice = u->qslicedata + u->itime*u->nsliceijk;
+      u->qslice = GetSliceFrame(u, u->itime, NULL);
     }
     if(v!=NULL&&v->compression_type==UNCOMPRESSED){
-      v->qslice = v->qslicedata + v->itime*v->nsliceijk;
+      v->qslice = GetSliceFrame(v, v->itime, NULL);
     }
     if(w!=NULL&&w->compression_type==UNCOMPRESSED){
-      w->qslice = w->qslicedata + w->itime*w->nsliceijk;
+      w->qslice = GetSliceFrame(w, w->itime, NULL);
     }
 
     if(vd->vslice_filetype==SLICE_TERRAIN){
@@ -8990,6 +10448,25 @@ void SliceData2Hist(slicedata *sd, float *xyz, float *dxyz, float time, float dt
   kmin = GetInterval(xyz[2]-dxyz[2], zplt, kbar+1);
   kmax = GetInterval(xyz[2]+dxyz[2], zplt, kbar+1);
 
+  // only use the part of the box that is inside the loaded (possibly cropped) slice data
+
+  if(tmin<0)tmin = time-dtime<times[0]     ? 0 : ntimes-1;
+  if(tmax<0)tmax = time+dtime<times[0]     ? 0 : ntimes-1;
+  if(imin<0)imin = xyz[0]-dxyz[0]<xplt[0] ? 0 : ibar;
+  if(imax<0)imax = xyz[0]+dxyz[0]<xplt[0] ? 0 : ibar;
+  if(jmin<0)jmin = xyz[1]-dxyz[1]<yplt[0] ? 0 : jbar;
+  if(jmax<0)jmax = xyz[1]+dxyz[1]<yplt[0] ? 0 : jbar;
+  if(kmin<0)kmin = xyz[2]-dxyz[2]<zplt[0] ? 0 : kbar;
+  if(kmax<0)kmax = xyz[2]+dxyz[2]<zplt[0] ? 0 : kbar;
+  imin = MAX(imin, sd->is1);
+  imax = MIN(imax, sd->is1+sd->nslicei-1);
+  jmin = MAX(jmin, sd->js1);
+  jmax = MIN(jmax, sd->js1+sd->nslicej-1);
+  kmin = MAX(kmin, sd->ks1);
+  kmax = MIN(kmax, sd->ks1+sd->nslicek-1);
+  InitHistogram(histogram, NHIST_BUCKETS, NULL, NULL);
+  if(imin>imax||jmin>jmax||kmin>kmax||tmin>tmax)return;
+
   nvals = (tmax+1-tmin)*(imax+1-imin)*(jmax+1-jmin)*(kmax+1-kmin);
   NewMemory((void **)&vals, nvals*sizeof(float));
 
@@ -9000,7 +10477,8 @@ void SliceData2Hist(slicedata *sd, float *xyz, float *dxyz, float time, float dt
   for(t = tmin; t<=tmax; t++){
     float *qslice;
 
-    qslice = sd->qslicedata+t*sd->nsliceijk;
+    qslice = GetSliceFrame(sd, t, NULL);
+    if(qslice==NULL)continue;
     for(i = imin; i<=imax; i++){
       float *qslicei;
 
@@ -9018,8 +10496,7 @@ void SliceData2Hist(slicedata *sd, float *xyz, float *dxyz, float time, float dt
       }
     }
   }
-  InitHistogram(histogram, NHIST_BUCKETS, NULL, NULL);
-  CopyVals2Histogram(vals, NULL, NULL, nvals, histogram);
+  CopyVals2Histogram(vals, NULL, NULL, ival, histogram);
   FREEMEMORY(vals);
 }
 
@@ -13,6 +13,7 @@
 #include "smokeviewvars.h"
 #include "IOvolsmoke.h"
 #include "compress.h"
+#include "threadpool.h"
 
 #define SKIP FSEEK( SMOKE3DFILE, fortran_skip, SEEK_CUR)
 
@@ -6113,6 +6114,93 @@ int SetupSmoke3D(smoke3ddata *smoke3di, int flag_arg, int iframe_arg, int *error
   return READSMOKE3D_CONTINUE_ON;
 }
 
+/* ------------------ CropSmoke3DFrames ------------------------ */
+
+void CropSmoke3DFrames(smoke3ddata *smoke3di, int iframe_start, int iframe_end, int pack){
+
+// zero the part of 3d smoke frames iframe_start to iframe_end-1 outside the load box (see GetLoadBox).
+// Each frame is recompressed in place.  A frame whose recompressed size is larger than its original
+// size is left as read.  If pack is 1 all loaded frames are then packed at the front of
+// smoke3di->smoke_comp_all and the unused memory is released
+
+  int box[6], nx, ny, nz;
+  int iframe, j, k;
+  unsigned char *frame, *comp_buffer;
+  meshdata *meshi;
+  uLongf ncomp_buffer;
+
+  meshi = meshinfo+smoke3di->blocknumber;
+  smoke3di->cropped = 0;
+  nx = meshi->ibar+1;
+  ny = meshi->jbar+1;
+  nz = meshi->kbar+1;
+  if(GetLoadBox(meshi, box)!=1||nx*ny*nz!=smoke3di->nchars_uncompressed||iframe_start>=iframe_end)return;
+
+  ncomp_buffer = compressBound(smoke3di->nchars_uncompressed);
+  NewMemory((void **)&frame, smoke3di->nchars_uncompressed);
+  NewMemory((void **)&comp_buffer, ncomp_buffer);
+  for(iframe = iframe_start; iframe<iframe_end; iframe++){
+    unsigned char *comp_frame;
+    uLongf countout;
+    int countin;
+
+    comp_frame = smoke3di->smokeframe_comp_list[iframe];
+    countin = smoke3di->nchars_compressed_smoke[iframe];
+    if(smoke3di->compression_type==RLE){
+      UnCompressRLE(comp_frame, countin, frame);
+    }
+    else{
+      countout = smoke3di->nchars_uncompressed;
+      UnCompressZLIB(frame, &countout, comp_frame, countin);
+    }
+    for(k = 0; k<nz; k++){
+      for(j = 0; j<ny; j++){
+        unsigned char *row;
+
+        row = frame+(k*ny+j)*nx;
+        if(k<box[4]||k>box[5]||j<box[2]||j>box[3]){
+          memset(row, 0, nx);
+          continue;
+        }
+        memset(row, 0, box[0]);
+        memset(row+box[1]+1, 0, nx-1-box[1]);
+      }
+    }
+    if(smoke3di->compression_type==RLE){
+      countout = CompressRLE(frame, smoke3di->nchars_uncompressed, comp_buffer);
+    }
+    else{
+      countout = ncomp_buffer;
+      CompressZLIB(comp_buffer, &countout, frame, smoke3di->nchars_uncompressed);
+    }
+    if(countout<=countin){
+      memcpy(comp_frame, comp_buffer, countout);
+      smoke3di->nchars_compressed_smoke[iframe] = countout;
+    }
+  }
+  FREEMEMORY(frame);
+  FREEMEMORY(comp_buffer);
+  smoke3di->cropped = 1;
+
+  if(pack==1){
+    int ncomp_total;
+
+    ncomp_total = 0;
+    for(iframe = 0; iframe<iframe_end; iframe++){
+      memmove(smoke3di->smoke_comp_all+ncomp_total, smoke3di->smokeframe_comp_list[iframe], smoke3di->nchars_compressed_smoke[iframe]);
+      ncomp_total += smoke3di->nchars_compressed_smoke[iframe];
+    }
+    if(ncomp_total>0&&ResizeMemory((void **)&smoke3di->smoke_comp_all, ncomp_total)!=0){
+      smoke3di->ncomp_smoke_total = ncomp_total;
+    }
+    ncomp_total = 0;
+    for(iframe = 0; iframe<iframe_end; iframe++){
+      smoke3di->smokeframe_comp_list[iframe] = smoke3di->smoke_comp_all+ncomp_total;
+      ncomp_total += smoke3di->nchars_compressed_smoke[iframe];
+    }
+  }
+}
+
 /* ------------------ ReadSmoke3D ------------------------ */
 
 FILE_SIZE ReadSmoke3D(int iframe_arg,int ifile_arg,int flag_arg, int first_time, int *errorcode_arg){
@@ -6130,28 +6218,55 @@ FILE_SIZE ReadSmoke3D(int iframe_arg,int ifile_arg,int flag_arg, int first_time,
   float time_local;
   char compstring_local[128];
   int fortran_skip=0;
+  int memory_id_save;
 
   update_fileload = 1;
+  PrefetchFlush();
 #ifndef pp_FSEEK
   if(flag_arg==RELOAD)flag_arg = LOAD;
 #endif
   START_TIMER(total_time_local);
   ASSERT(ifile_arg>=0&&ifile_arg<nsmoke3dinfo);
   smoke3di = smoke3dinfo + ifile_arg;
+  if(flag_arg!=UNLOAD){
+    int box[6], inbox;
+
+    inbox = GetLoadBox(meshinfo+smoke3di->blocknumber, box);
+
+    // the load box misses this mesh, there is nothing to load
+
+    if(inbox==-1){
+      PRINTF("%s is outside of the load box, not loaded\n", smoke3di->file);
+      return ReadSmoke3D(iframe_arg, ifile_arg, UNLOAD, FIRST_TIME, errorcode_arg);
+    }
+
+    // frames already loaded were cropped with the load box in effect at that time, read them all again
+
+    if(flag_arg==RELOAD&&(smoke3di->cropped==1||inbox==1))flag_arg = LOAD;
+  }
   if(smoke3di->filetype==FORTRAN_GENERATED&&smoke3di->is_zlib==0)fortran_skip=4;
+  if(flag_arg==LOAD&&first_time==FIRST_TIME&&iframe_arg==ALL_SMOKE_FRAMES){
+    EnforceMemoryBudget(GetMemoryLoadSize(smoke3di->file, smoke3di->memory_id, &smoke3di->last_display));
+  }
 
+  memory_id_save = SetMemoryId(smoke3di->memory_id);
   if(first_time == FIRST_TIME){
     if(SetupSmoke3D(smoke3di, flag_arg,iframe_arg, errorcode_arg)==READSMOKE3D_RETURN){
+      SetMemoryId(memory_id_save);
       return 0;
     }
   }
-  if(smoke3di->smokeframe_comp_list==NULL)return 0;
+  if(smoke3di->smokeframe_comp_list==NULL){
+    SetMemoryId(memory_id_save);
+    return 0;
+  }
 
 //*** read in data
 
   SMOKE3DFILE=fopen(smoke3di->file,"rb");
   if(SMOKE3DFILE==NULL){
     SetupSmoke3D(smoke3di,UNLOAD, iframe_arg, &error_local);
+    SetMemoryId(memory_id_save);
     *errorcode_arg =1;
     return 0;
   }
@@ -6234,6 +6349,7 @@ FILE_SIZE ReadSmoke3D(int iframe_arg,int ifile_arg,int flag_arg, int first_time,
     }
   }
   STOP_TIMER(read_time_local);
+  CropSmoke3DFrames(smoke3di, frame_start_local, iii, iframe_arg==ALL_SMOKE_FRAMES ? 1 : 0);
 
   if(SMOKE3DFILE!=NULL){
     fclose(SMOKE3DFILE);
@@ -6257,6 +6373,7 @@ FILE_SIZE ReadSmoke3D(int iframe_arg,int ifile_arg,int flag_arg, int first_time,
     PrintMemoryInfo;
   }
 
+  SetMemoryId(memory_id_save);
   *errorcode_arg = 0;
   return file_size_local;
 }
@@ -6322,103 +6439,64 @@ void ReadSmoke3DAllMeshesAllTimes(int smoketype2, int *errorcode){
 /* ------------------ UpdateSmoke3d ------------------------ */
 
 void UpdateSmoke3D(smoke3ddata *smoke3di){
+
+// decode the current frame of smoke3di.  the frame's all zeros flag and the
+// extent of its non-zero values are found while the frame is decoded
+
   int iframe_local;
   int countin;
   uLongf countout;
-#ifdef pp_GPUSMOKE
+  int dims[3], box[6], *boxptr = NULL;
   meshdata *mesh_smoke3d;
-#endif
 
   iframe_local = smoke3di->ismoke3d_time;
   countin = smoke3di->nchars_compressed_smoke[iframe_local];
   countout=smoke3di->nchars_uncompressed;
-  switch(smoke3di->compression_type){
-  case RLE:
-    countout = UnCompressRLE(smoke3di->smokeframe_comp_list[iframe_local],countin,smoke3di->smokeframe_in);
-    break;
-  case ZLIB:
-    UnCompressZLIB(smoke3di->smokeframe_in,&countout,smoke3di->smokeframe_comp_list[iframe_local],countin);
-    break;
-  default:
-    ASSERT(FFALSE);
-    break;
-  }
-
-#ifdef pp_GPUSMOKE
   mesh_smoke3d = meshinfo+smoke3di->blocknumber;
-#endif
-
-  if(
-#ifdef pp_GPUSMOKE
-    mesh_smoke3d->update_smokebox==1||
-#endif
-    smoke3di->frame_all_zeros[iframe_local] == SMOKE3D_ZEROS_UNKNOWN){
-    int i;
-    unsigned char *smokeframe_in;
-
-    smokeframe_in = smoke3di->smokeframe_in;
-    smoke3di->frame_all_zeros[iframe_local] = SMOKE3D_ZEROS_ALL;
+  dims[0] = mesh_smoke3d->ibar+1;
+  dims[1] = mesh_smoke3d->jbar+1;
+  dims[2] = mesh_smoke3d->kbar+1;
+  if(smoke3di->update_box==1||smoke3di->frame_all_zeros[iframe_local] == SMOKE3D_ZEROS_UNKNOWN)boxptr = box;
 
-    for(i=0;i<smoke3di->nchars_uncompressed;i++){
-      if(smokeframe_in[i]!=0){
-        smoke3di->frame_all_zeros[iframe_local]= SMOKE3D_ZEROS_SOME;
-        break;
-      }
+  if(PrefetchGetFrame(PREFETCH_SMOKE3D, smoke3di, iframe_local, &smoke3di->smokeframe_in, smoke3di->nchars_uncompressed)==0){
+    switch(smoke3di->compression_type){
+    case RLE:
+      countout = UnCompressRLEBox(smoke3di->smokeframe_comp_list[iframe_local],countin,smoke3di->smokeframe_in, dims, boxptr);
+      boxptr = NULL;
+      break;
+    case ZLIB:
+      UnCompressZLIB(smoke3di->smokeframe_in,&countout,smoke3di->smokeframe_comp_list[iframe_local],countin);
+      break;
+    default:
+      ASSERT(FFALSE);
+      break;
     }
+  }
+  if(boxptr!=NULL)GetFrameBox(smoke3di->smokeframe_in, smoke3di->nchars_uncompressed, dims, box);
+
+  if(smoke3di->update_box==1||smoke3di->frame_all_zeros[iframe_local] == SMOKE3D_ZEROS_UNKNOWN){
+    smoke3di->frame_all_zeros[iframe_local] = (box[0]<0 ? SMOKE3D_ZEROS_ALL : SMOKE3D_ZEROS_SOME);
 #ifdef pp_GPUSMOKE
     // construct a bounding box containing smoke
 
-    if(mesh_smoke3d->update_smokebox==1||smoke3di->frame_all_zeros[iframe_local] != SMOKE3D_ZEROS_ALL){
+    if(smoke3di->update_box==1||smoke3di->frame_all_zeros[iframe_local] != SMOKE3D_ZEROS_ALL){
       float *smoke_boxmin, *smoke_boxmax;
       float *xplt, *yplt, *zplt;
-      int ibar, jbar, kbar;
-      int nx, ny, nz;
-      int k;
-      int imin=-1, imax=-1, jmin=-1, jmax=-1, kmin=-1, kmax=-1;
-      unsigned char *smokeptr;
+      int imin, imax, jmin, jmax, kmin, kmax;
 
       xplt = mesh_smoke3d->xplt_orig;
       yplt = mesh_smoke3d->yplt_orig;
       zplt = mesh_smoke3d->zplt_orig;
 
-      ibar = mesh_smoke3d->ibar;
-      jbar = mesh_smoke3d->jbar;
-      kbar = mesh_smoke3d->kbar;
-
-      nx = ibar+1;
-      ny = jbar+1;
-      nz = kbar+1;
-
       smoke_boxmin = smoke3di->smoke_boxmin+3*iframe_local;
       smoke_boxmax = smoke3di->smoke_boxmax+3*iframe_local;
 
-      smokeptr = smokeframe_in;
-      for(k=0;k<nz;k++){
-        int j;
-
-        for(j=0;j<ny;j++){
-          int i;
-
-          for(i=0;i<nx;i++){
-            //ijk = i+nx*(j+k*ny);
-            // if(smokeframe_in[ijk]!=0){
-            if(*smokeptr++!=0){
-              if(imin==-1){imin = i;}else{imin = MIN(i,imin);}
-              if(imax==-1){imax = i;}else{imax = MAX(i,imax);}
-              if(jmin==-1){jmin = j;}else{jmin = MIN(j,jmin);}
-              if(jmax==-1){jmax = j;}else{jmax = MAX(j,jmax);}
-              if(kmin==-1){kmin = k;}else{kmin = MIN(k,kmin);}
-              if(kmax==-1){kmax = k;}else{kmax = MAX(k,kmax);}
-            }
-          }
-        }
-      }
-      imin = MAX(imin-smokebox_buffer, 0);
-      jmin = MAX(jmin-smokebox_buffer, 0);
-      kmin = MAX(kmin-smokebox_buffer, 0);
-      imax = MIN(imax+smokebox_buffer, ibar);
-      jmax = MIN(jmax+smokebox_buffer, jbar);
-      kmax = MIN(kmax+smokebox_buffer, kbar);
+      imin = MAX(box[0]-smokebox_buffer, 0);
+      jmin = MAX(box[2]-smokebox_buffer, 0);
+      kmin = MAX(box[4]-smokebox_buffer, 0);
+      imax = MIN(box[1]+smokebox_buffer, mesh_smoke3d->ibar);
+      jmax = MIN(box[3]+smokebox_buffer, mesh_smoke3d->jbar);
+      kmax = MIN(box[5]+smokebox_buffer, mesh_smoke3d->kbar);
       smoke_boxmin[0] = xplt[imin];
       smoke_boxmin[1] = yplt[jmin];
       smoke_boxmin[2] = zplt[kmin];
@@ -6426,12 +6504,87 @@ void UpdateSmoke3D(smoke3ddata *smoke3di){
       smoke_boxmax[1] = yplt[jmax];
       smoke_boxmax[2] = zplt[kmax];
     }
-    mesh_smoke3d->update_smokebox = 0;
 #endif
   }
+  smoke3di->update_box = 0;
   ASSERT(countout==smoke3di->nchars_uncompressed);
 }
 
+/* ------------------ MtUpdateSmoke3D ------------------------ */
+
+void *MtUpdateSmoke3D(void *arg){
+  int i;
+
+  for(i = *(int *)arg; i<nsmoke3d_update; i += nsmoke3d_update_tasks){
+    UpdateSmoke3D(smoke3d_update_list[i]);
+  }
+  return NULL;
+}
+
+/* ------------------ UpdateSmoke3DFrames ------------------------ */
+
+void UpdateSmoke3DFrames(void){
+
+// decode the current frame of each displayed 3D smoke file.  The frames of different
+// files are independent so they are decoded in parallel by the pool's worker threads
+
+  int i, mode;
+  double start;
+
+  if(nsmoke3dinfo>nsmoke3d_update_list){
+    FREEMEMORY(smoke3d_update_list);
+    NewMemory((void **)&smoke3d_update_list, nsmoke3dinfo*sizeof(smoke3ddata *));
+    nsmoke3d_update_list = nsmoke3dinfo;
+  }
+  nsmoke3d_update = 0;
+  for(i = 0;i < nsmoke3dinfo;i++){
+    smoke3ddata *smoke3di;
+
+    smoke3di = smoke3dinfo + i;
+    if(smoke3di->loaded == 0 || smoke3di->display == 0)continue;
+    smoke3di->ismoke3d_time = smoke3di->timeslist[itimes];
+    if(IsSmokeComponentPresent(smoke3di) == 0)continue;
+    if(smoke3di->ismoke3d_time != smoke3di->lastiframe){
+      smoke3di->lastiframe = smoke3di->ismoke3d_time;
+#ifdef pp_GPUSMOKE
+      {
+        meshdata *mesh_smoke3d;
+
+        // only the first file updated in a mesh recomputes its smoke box
+
+        mesh_smoke3d = meshinfo+smoke3di->blocknumber;
+        smoke3di->update_box = mesh_smoke3d->update_smokebox;
+        mesh_smoke3d->update_smokebox = 0;
+      }
+#endif
+      smoke3d_update_list[nsmoke3d_update++] = smoke3di;
+    }
+  }
+  if(nsmoke3d_update==0)return;
+
+  start = GetWallTime();
+  if(smoke3d_multithread==1&&ThreadPoolSize()>1&&nsmoke3d_update>1){
+    taskdata *tasks[MAX_POOL_THREADS];
+    int task_index[MAX_POOL_THREADS];
+
+    mode = 1;
+    nsmoke3d_update_tasks = MIN(ThreadPoolSize(), nsmoke3d_update);
+    for(i = 0; i<nsmoke3d_update_tasks; i++){
+      task_index[i] = i;
+      tasks[i] = ThreadPoolSubmit("smoke3d frame", MtUpdateSmoke3D, task_index+i);
+    }
+    ThreadPoolWaitAll(tasks, nsmoke3d_update_tasks);
+  }
+  else{
+    mode = 0;
+    for(i = 0; i<nsmoke3d_update; i++){
+      UpdateSmoke3D(smoke3d_update_list[i]);
+    }
+  }
+  smoke3d_decode_time[mode] += GetWallTime()-start;
+  nsmoke3d_decode_frames[mode]++;
+}
+
 /* ------------------ MergeSmoke3DColors ------------------------ */
 
 void MergeSmoke3DColors(smoke3ddata *smoke3dset){
@@ -11,6 +11,7 @@
 #include "smokeviewvars.h"
 #include "IOvolsmoke.h"
 #include "compress.h"
+#include "threadpool.h"
 
 #define HEADER_SIZE 4
 #define TRAILER_SIZE 4
@@ -65,11 +66,13 @@
       value = *vv;\
     }
 
+#define FOURPI 12.566370614359172
+
 /* ----------------------- GetScatterFraction ----------------------------- */
 
 float GetScatterFraction(float *view_vec, float *light_vec,float param,int phase_type){
   float phase=0.0;
-  float fourpi = 16.0*atan(1.0);
+  float fourpi = FOURPI;
   float cos_angle=0.0;
 
   if(phase_type != ISOTROPIC&&view_vec != NULL&&light_vec != NULL){
@@ -117,7 +120,7 @@ void GetSmokeColor(float *smoke_tran, float **smoke_color, float *scaled_intensi
   float *smokedata_local, *firedata_local, *lightdata_local;
   float light_fraction;
   int index;
-  float black[] = {0.0,0.0,0.0,1.0};
+  static float black[] = {0.0,0.0,0.0,1.0};
   int slicetype;
   float soot_density, temperature;
 
@@ -188,7 +191,7 @@ void GetSmokeColor(float *smoke_tran, float **smoke_color, float *scaled_intensi
     *smoke_color = rgb_volsmokecolormap+4*index;
   }
   else{
-    *smoke_color = GetColorPtr(black);
+    *smoke_color = black;
   }
   if(smokedata_local!=NULL){
     INTERP3D(smokedata_local, soot_density);
@@ -999,6 +1002,7 @@ void IntegrateSmokeColors(float *integrated_smokecolor, float *xyzvert, float dl
   float xi, smoke_transparency, *smoke_color=NULL, smoke_light_fraction;
   float last_xi, last_smoke_color[3], i_dlength;
   float tauhat,alphahat;
+  float scatter_fraction_iso = 0.0;
   meshdata *xyz_mesh=NULL;
 
   if(combine_meshes==1){
@@ -1108,6 +1112,7 @@ void IntegrateSmokeColors(float *integrated_smokecolor, float *xyzvert, float dl
   tauhat=1.0;
   alphahat=0.0;
   last_xi = 0.5;
+  if(use_light==1&&scatter_type_glui==ISOTROPIC)scatter_fraction_iso = GetScatterFraction(NULL, NULL, scatter_param, ISOTROPIC);
   for(xi = 0.5;xi+0.0001<(float)nsteps;){
     float factor, alphai, scaled_intensity;
     int inobst;
@@ -1173,9 +1178,11 @@ void IntegrateSmokeColors(float *integrated_smokecolor, float *xyzvert, float dl
         else{
           VEC3EQ(vvec,xyz_light_glui);
         }
+        scatter_fraction = GetScatterFraction(uvec, vvec, scatter_param, scatter_type_glui);
+      }
+      else{
+        scatter_fraction = scatter_fraction_iso;
       }
-
-      scatter_fraction = GetScatterFraction(uvec, vvec, scatter_param, scatter_type_glui);
       light_factor = alphai*light_intensity*smoke_light_fraction*scatter_fraction/255.0;
       integrated_smokecolor[0] += alphai*tauhat*(scaled_intensity*smoke_color[0] + light_factor*light_color[0]);
       integrated_smokecolor[1] += alphai*tauhat*(scaled_intensity*smoke_color[1] + light_factor*light_color[1]);
@@ -1215,147 +1222,194 @@ void IntegrateSmokeColors(float *integrated_smokecolor, float *xyzvert, float dl
   }
 }
 
+/* ------------------ ComputeWallSmokecolors ------------------------ */
+
+void ComputeWallSmokecolors(meshdata *meshi, int iwall, int irow1, int irow2){
+
+// compute the integrated smoke colors of rows irow1 to irow2-1 of wall iwall of mesh meshi
+
+  volrenderdata *vr;
+  float dlength;
+  float dx, dy, dz;
+  float *x, *y, *z;
+  int jbar, kbar;
+  float *smokecolor, *col;
+  float *xyz, xyzarray[3];
+  int i, j, ncols;
+
+  vr = &(meshi->volrenderinfo);
+  x = meshi->xvolplt;
+  y = meshi->yvolplt;
+  z = meshi->zvolplt;
+  jbar = meshi->jvolbar;
+  kbar = meshi->kvolbar;
+  dx = x[1] - x[0];
+  dy = y[1] - y[0];
+  dz = z[1] - z[0];
+  dlength = sqrt(dx*dx+dy*dy+dz*dz)/2.0;
+
+  xyz = xyzarray;
+  switch(iwall){
+    case XWALLMIN:
+    case XWALLMAX:
+      if(iwall<0){
+        smokecolor=vr->smokecolor_yz0;
+        xyz[0] = meshi->x0;
+      }
+      else{
+        smokecolor=vr->smokecolor_yz1;
+        xyz[0] = meshi->x1;
+      }
+      ncols = kbar+1;
+      col = z;
+      break;
+    case YWALLMIN:
+    case YWALLMAX:
+      if(iwall<0){
+        smokecolor=vr->smokecolor_xz0;
+        xyz[1] = meshi->y0;
+      }
+      else{
+        smokecolor=vr->smokecolor_xz1;
+        xyz[1] = meshi->y1;
+      }
+      ncols = kbar+1;
+      col = z;
+      break;
+    case ZWALLMIN:
+    case ZWALLMAX:
+      if(iwall<0){
+        smokecolor=vr->smokecolor_xy0;
+        xyz[2]=meshi->z0;
+      }
+      else{
+        smokecolor=vr->smokecolor_xy1;
+        xyz[2]=meshi->z1;
+      }
+      ncols = jbar+1;
+      col = y;
+      break;
+    default:
+      ASSERT(FFALSE);
+      return;
+  }
+  smokecolor += 4*irow1*ncols;
+  if(vr->firedataptr==NULL||vr->smokedataptr==NULL){
+    for(i=irow1;i<irow2;i++){
+      for(j=0;j<ncols;j++){
+        smokecolor[0]=0.0;
+        smokecolor[1]=0.0;
+        smokecolor[2]=0.0;
+        smokecolor[3]=0.0;
+        smokecolor+=4;
+      }
+    }
+    return;
+  }
+  for(i=irow1;i<irow2;i++){
+    switch(iwall){
+      case XWALLMIN:
+      case XWALLMAX:
+        xyz[1] = y[i];
+        break;
+      default:
+        xyz[0] = x[i];
+        break;
+    }
+    for(j=0;j<ncols;j++){
+      if(col==z){
+        xyz[2] = z[j];
+      }
+      else{
+        xyz[1] = y[j];
+      }
+      IntegrateSmokeColors(smokecolor,xyz,dlength,meshi,iwall);
+      smokecolor+=4;
+    }
+  }
+}
+
+/* ------------------ MtComputeSmokecolors ------------------------ */
+
+void *MtComputeSmokecolors(void *arg){
+  int i;
+
+  for(i = *(int *)arg; i<nvolsmoke_tiles; i += nvolsmoke_tile_tasks){
+    volsmoketiledata *tile;
+
+    tile = volsmoke_tiles+i;
+    ComputeWallSmokecolors(tile->meshi, tile->iwall, tile->irow1, tile->irow2);
+  }
+  return NULL;
+}
+
 /* ------------------ ComputeAllSmokecolors ------------------------ */
 
 void ComputeAllSmokecolors(void){
-  int ii;
+
+// integrate smoke colors along the view ray through each node of each visible mesh wall.  The walls
+// are split into tiles of VOLSMOKE_TILE_ROWS rows which are integrated by the pool's worker threads
+
+  int ii, i, mode;
+  double start;
 
   if(freeze_volsmoke==1)return;
+  nvolsmoke_tiles = 0;
   for(ii=0;ii<nmeshes;ii++){
     meshdata *meshi;
     volrenderdata *vr;
     int iwall;
-    float dlength;
-    float dx, dy, dz;
-    float *x, *y, *z;
-    int ibar, jbar, kbar;
-    float *smokecolor;
 
     meshi = meshinfo + ii;
     vr = &(meshi->volrenderinfo);
     if(vr->loaded==0||vr->display==0)continue;
-
-    x = meshi->xvolplt;
-    y = meshi->yvolplt;
-    z = meshi->zvolplt;
-    ibar = meshi->ivolbar;
-    jbar = meshi->jvolbar;
-    kbar = meshi->kvolbar;
-    dx = x[1] - x[0];
-    dy = y[1] - y[0];
-    dz = z[1] - z[0];
-    dlength = sqrt(dx*dx+dy*dy+dz*dz)/2.0;
-
     if(vr->smokeslice==NULL)continue;
     for(iwall=-3;iwall<=3;iwall++){
-      float *xyz,xyzarray[3];
-      int i, j;
+      int irow, nrows;
 
-      xyz = xyzarray;
       if(iwall==0||meshi->drawsides[iwall+3]==0)continue;
-      switch(iwall){
-        case XWALLMIN:
-        case XWALLMAX:
-          if(iwall<0){
-            smokecolor=vr->smokecolor_yz0;
-            xyz[0] = meshi->x0;
-          }
-          else{
-            smokecolor=vr->smokecolor_yz1;
-            xyz[0] = meshi->x1;
-          }
-          if(vr->firedataptr==NULL||vr->smokedataptr==NULL){
-            for(i=0;i<=jbar;i++){
-              for(j=0;j<=kbar;j++){
-                smokecolor[0]=0.0;
-                smokecolor[1]=0.0;
-                smokecolor[2]=0.0;
-                smokecolor[3]=0.0;
-                smokecolor+=4;
-              }
-            }
-          }
-          else{
-            for(i=0;i<=jbar;i++){
-              xyz[1] = y[i];
-              for(j=0;j<=kbar;j++){
-                xyz[2] = z[j];
-                IntegrateSmokeColors(smokecolor,xyz,dlength,meshi,iwall);
-                smokecolor+=4;
-              }
-            }
-          }
-          break;
-        case YWALLMIN:
-        case YWALLMAX:
-          if(iwall<0){
-            smokecolor=vr->smokecolor_xz0;
-            xyz[1] = meshi->y0;
-          }
-          else{
-            smokecolor=vr->smokecolor_xz1;
-            xyz[1] = meshi->y1;
-          }
-          if(vr->firedataptr==NULL||vr->smokedataptr==NULL){
-            for(i=0;i<=ibar;i++){
-              for(j=0;j<=kbar;j++){
-                smokecolor[0]=0.0;
-                smokecolor[1]=0.0;
-                smokecolor[2]=0.0;
-                smokecolor[3]=0.0;
-                smokecolor+=4;
-              }
-            }
-          }
-          else{
-            for(i=0;i<=ibar;i++){
-              xyz[0] = x[i];
-              for(j=0;j<=kbar;j++){
-                xyz[2] = z[j];
-                IntegrateSmokeColors(smokecolor,xyz,dlength,meshi,iwall);
-                smokecolor+=4;
-              }
-            }
-          }
-          break;
-        case ZWALLMIN:
-        case ZWALLMAX:
-          if(iwall<0){
-            smokecolor=vr->smokecolor_xy0;
-            xyz[2]=meshi->z0;
-          }
-          else{
-            smokecolor=vr->smokecolor_xy1;
-            xyz[2]=meshi->z1;
-          }
-          if(vr->firedataptr==NULL||vr->smokedataptr==NULL){
-            for(i=0;i<=ibar;i++){
-              for(j=0;j<=jbar;j++){
-                smokecolor[0]=0.0;
-                smokecolor[1]=0.0;
-                smokecolor[2]=0.0;
-                smokecolor[3]=0.0;
-                smokecolor+=4;
-              }
-            }
-          }
-          else{
-            for(i=0;i<=ibar;i++){
-              xyz[0] = x[i];
-              for(j=0;j<=jbar;j++){
-                xyz[1] = y[j];
-                IntegrateSmokeColors(smokecolor,xyz,dlength,meshi,iwall);
-                smokecolor+=4;
-              }
-            }
-          }
-          break;
-        default:
-          ASSERT(FFALSE);
-          break;
+      nrows = (iwall==XWALLMIN||iwall==XWALLMAX ? meshi->jvolbar+1 : meshi->ivolbar+1);
+      for(irow = 0; irow<nrows; irow += VOLSMOKE_TILE_ROWS){
+        volsmoketiledata *tile;
+
+        if(nvolsmoke_tiles==nvolsmoke_tiles_max){
+          nvolsmoke_tiles_max += 100;
+          NewResizeMemory(volsmoke_tiles, nvolsmoke_tiles_max*sizeof(volsmoketiledata));
+        }
+        tile = volsmoke_tiles+nvolsmoke_tiles++;
+        tile->meshi = meshi;
+        tile->iwall = iwall;
+        tile->irow1 = irow;
+        tile->irow2 = MIN(irow+VOLSMOKE_TILE_ROWS, nrows);
       }
     }
   }
+  if(nvolsmoke_tiles==0)return;
+
+  start = GetWallTime();
+  if(volsmoke_multithread==1&&ThreadPoolSize()>1&&nvolsmoke_tiles>1){
+    taskdata *tasks[MAX_POOL_THREADS];
+    int task_index[MAX_POOL_THREADS];
+
+    mode = 1;
+    nvolsmoke_tile_tasks = MIN(ThreadPoolSize(), nvolsmoke_tiles);
+    for(i = 0; i<nvolsmoke_tile_tasks; i++){
+      task_index[i] = i;
+      tasks[i] = ThreadPoolSubmit("volsmoke colors", MtComputeSmokecolors, task_index+i);
+    }
+    ThreadPoolWaitAll(tasks, nvolsmoke_tile_tasks);
+  }
+  else{
+    mode = 0;
+    for(i = 0; i<nvolsmoke_tiles; i++){
+      volsmoketiledata *tile;
+
+      tile = volsmoke_tiles+i;
+      ComputeWallSmokecolors(tile->meshi, tile->iwall, tile->irow1, tile->irow2);
+    }
+  }
+  volsmoke_compute_time[mode] += GetWallTime()-start;
+  nvolsmoke_compute_frames[mode]++;
 }
 
 /* ------------------ GetPos ------------------------ */
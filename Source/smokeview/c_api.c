@@ -1053,6 +1053,40 @@ void toggle_memload_visibility() {
 }
 #endif
 
+// memory by file type
+void set_memtypes_visibility(int setting) {
+  visMemorytypes = setting;
+  if(visMemorytypes==0)PRINTF("Memory by file type hidden\n");
+  if(visMemorytypes==1)PRINTF("Memory by file type visible\n");
+}
+
+int get_memtypes_visibility() {
+  return visMemorytypes;
+}
+
+void toggle_memtypes_visibility() {
+  visMemorytypes = 1 - visMemorytypes;
+  if(visMemorytypes==0)PRINTF("Memory by file type hidden\n");
+  if(visMemorytypes==1)PRINTF("Memory by file type visible\n");
+}
+
+void memory_report() {
+  PrintMemoryReport(1);
+}
+
+double get_memory_usage(const char *type) {
+  MMsize type_bytes[MAX_MEMORY_TYPES], nbytes = 0;
+  int i;
+
+  // bytes used by files of the given type (slice, boundary, ...), all files if type is NULL
+
+  GetMemoryTypeBytes(type_bytes);
+  for(i = 0; i<NMEMORY_TYPES; i++){
+    if(type==NULL||STRCMP(type, GetMemoryTypeLabel(i))==0)nbytes += type_bytes[i];
+  }
+  return (double)nbytes;
+}
+
 // mesh label
 void set_meshlabel_visibility(int setting) {
   visMeshlabel = setting;
@@ -1792,6 +1826,32 @@ void loadvslice(const char *type, int axis, float distance){
                              "to load\n",type);
 }
 
+/* ------------------ setloadbox ------------------------ */
+
+void setloadbox(int option, float xmin, float xmax, float ymin, float ymax, float zmin, float zmax){
+  load_box_option = CLAMP(option, LOADBOX_OFF, LOADBOX_CLIP);
+  load_box[0] = xmin;
+  load_box[1] = xmax;
+  load_box[2] = ymin;
+  load_box[3] = ymax;
+  load_box[4] = zmin;
+  load_box[5] = zmax;
+  updatemenu = 1;
+}
+
+/* ------------------ sliceprobes ------------------------ */
+
+int sliceprobes(const char *quantity, float *xyz, int nprobes, const char *csvfile){
+  int nfound;
+
+  PRINTF("outputting %s at %i points to %s\n", quantity, nprobes, csvfile);
+  nfound = SliceProbesToCSV((char *)quantity, xyz, nprobes, (char *)csvfile);
+  if(nfound>=0&&nfound<nprobes){
+    fprintf(stderr, "*** Warning: %i of %i points are not in a 3d %s slice\n", nprobes-nfound, nprobes, quantity);
+  }
+  return nfound;
+}
+
 /* ------------------ unloadslice ------------------------ */
 
 void unloadslice(int value){
@@ -3007,6 +3067,11 @@ int set_showmemload(int v) {
 } // SHOWMEMLOAD
 #endif
 
+int set_showmemtypes(int v) {
+  visMemorytypes = v;
+  return 0;
+} // SHOWMEMTYPES
+
 // int set_shownormalwhensmooth(int v); // SHOWNORMALWHENSMOOTH
 int set_showopenvents(int a, int b) {
   visOpenVents = a;
@@ -49,6 +49,8 @@ void loadiso(const char *type);
 void loadslice(const char *type, int axis, float distance);
 void loadsliceindex(int index);
 void loadvslice(const char *type, int axis, float distance);
+void setloadbox(int option, float xmin, float xmax, float ymin, float ymax, float zmin, float zmax);
+int sliceprobes(const char *quantity, float *xyz, int nprobes, const char *csvfile);
 void unloadall();
 void unloadtour();
 void exit_smokeview();
@@ -189,6 +191,13 @@ int get_memload_visibility();
 void toggle_memload_visibility();
 #endif
 
+// memory by file type
+void set_memtypes_visibility(int setting);
+int get_memtypes_visibility();
+void toggle_memtypes_visibility();
+void memory_report();
+double get_memory_usage(const char *type);
+
 // mesh
 void set_meshlabel_visibility(int setting);
 int get_meshlabel_visibility();
@@ -372,6 +381,7 @@ int set_showiso(int v); // SHOWISO
 int set_showisonormals(int v); // SHOWISONORMALS
 int set_showlabels(int v); // SHOWLABELS
 int set_showmemload(int v); // SHOWMEMLOAD
+int set_showmemtypes(int v); // SHOWMEMTYPES
 int set_shownormalwhensmooth(int v); // SHOWNORMALWHENSMOOTH
 int set_showopenvents(int a, int b); // SHOWOPENVENTS
 int set_showothervents(int v); // SHOWOTHERVENTS
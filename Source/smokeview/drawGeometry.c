@@ -1,4 +1,5 @@
 #include "options.h"
+#include "glew.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -7,6 +8,7 @@
 
 #include "update.h"
 #include "smokeviewvars.h"
+#include "threadpool.h"
 
 cadgeomdata *current_cadgeom;
 
@@ -2530,6 +2532,7 @@ void UpdateFaces(void){
     }
     meshi->nfaces=faceptr-meshi->faceinfo;
   }
+  update_blockage_vbo = 1; // face color pointers may have changed, the blockage vbo batches keep a copy
   UpdateHiddenFaces();
   UpdateFaceLists();
   UpdateSelectFaces();
@@ -3050,6 +3053,7 @@ void UpdateFaceLists(void){
     meshi = meshinfo  + i;
     n_geom_triangles += meshi->nface_textures+meshi->nface_normals_single+meshi->nface_normals_double;
   }
+  update_blockage_vbo = 1;
 }
 
 /* ------------------ DrawSelectFaces ------------------------ */
@@ -4847,6 +4851,193 @@ void GetDrawingParms(int *drawing_transparent, int *drawing_blockage_transparent
   }
 }
 
+/* ------------------ FreeBlockageVBO ------------------------ */
+
+void FreeBlockageVBO(meshdata *meshi){
+  blockagevbodata *vbo;
+
+  vbo = &meshi->face_vbo;
+  if(vbo->defined==0)return;
+  glDeleteBuffers(1, &vbo->vertex_id);
+  glDeleteBuffers(1, &vbo->index_id);
+  FREEMEMORY(vbo->batch_colors);
+  FREEMEMORY(vbo->batch_starts);
+  FREEMEMORY(vbo->batch_counts);
+  FREEMEMORY(vbo->faces_dynamic);
+  vbo->defined = 0;
+}
+
+/* ------------------ SplitBlockageVBOFaces ------------------------ */
+
+int SplitBlockageVBOFaces(facedata **faces, int nfaces, facedata **faces_static, facedata **faces_dynamic, int *nfaces_dynamic){
+
+// faces shown or hidden over time (HIDE_OBST/SHOW_OBST) are still drawn in immediate mode,
+// the rest are put into the vertex buffer sorted by color so each color is drawn with one call
+
+  int i, nfaces_static = 0;
+
+  *nfaces_dynamic = 0;
+  for(i = 0; i<nfaces; i++){
+    facedata *facei;
+
+    facei = faces[i];
+    if(*(facei->showtimelist_handle)==NULL){
+      faces_static[nfaces_static++] = facei;
+    }
+    else{
+      faces_dynamic[(*nfaces_dynamic)++] = facei;
+    }
+  }
+  if(nfaces_static>1)qsort((facedata **)faces_static, (size_t)nfaces_static, sizeof(facedata *), CompareColorFaces);
+  return nfaces_static;
+}
+
+/* ------------------ MakeBlockageVBO ------------------------ */
+
+void MakeBlockageVBO(meshdata *meshi){
+
+// put the single and double sided blockage faces of a mesh into one vertex buffer
+// (4 vertices per face, position and normal) and one index buffer (2 triangles per face).
+// faces are grouped into batches of the same color, single sided batches first.
+
+  blockagevbodata *vbo;
+  facedata **faces_static;
+  float *vertices;
+  unsigned int *indices;
+  int nfaces, nsingle, ndouble, nstatic, i;
+
+  FreeBlockageVBO(meshi);
+  vbo = &meshi->face_vbo;
+  vbo->blocklocation = blocklocation;
+  vbo->vertex_id = 0;
+  vbo->index_id = 0;
+  vbo->nbatches = 0;
+  vbo->nbatches_single = 0;
+
+  nfaces = meshi->nface_normals_single+meshi->nface_normals_double;
+  NewMemory((void **)&faces_static,        MAX(nfaces, 1)*sizeof(facedata *));
+  NewMemory((void **)&vbo->faces_dynamic,  MAX(nfaces, 1)*sizeof(facedata *));
+  NewMemory((void **)&vbo->batch_colors,   MAX(nfaces, 1)*sizeof(float *));
+  NewMemory((void **)&vbo->batch_starts,   MAX(nfaces, 1)*sizeof(int));
+  NewMemory((void **)&vbo->batch_counts,   MAX(nfaces, 1)*sizeof(int));
+  nsingle = SplitBlockageVBOFaces(meshi->face_normals_single, meshi->nface_normals_single,
+                                  faces_static, vbo->faces_dynamic, &vbo->nfaces_dynamic_single);
+  ndouble = SplitBlockageVBOFaces(meshi->face_normals_double, meshi->nface_normals_double,
+                                  faces_static+nsingle, vbo->faces_dynamic+vbo->nfaces_dynamic_single, &vbo->nfaces_dynamic_double);
+  nstatic = nsingle+ndouble;
+  vbo->defined = 1;
+  if(nstatic==0){
+    FREEMEMORY(faces_static);
+    return;
+  }
+
+  NewMemory((void **)&vertices, 4*6*nstatic*sizeof(float));
+  NewMemory((void **)&indices,  6*nstatic*sizeof(unsigned int));
+  for(i = 0; i<nstatic; i++){
+    facedata *facei;
+    float *xyz, *vert;
+    unsigned int *ind;
+    int k;
+
+    facei = faces_static[i];
+    if(i==0||i==nsingle||facei->color!=faces_static[i-1]->color){
+      vbo->batch_colors[vbo->nbatches] = facei->color;
+      vbo->batch_starts[vbo->nbatches] = 6*i;
+      vbo->batch_counts[vbo->nbatches] = 0;
+      vbo->nbatches++;
+    }
+    vbo->batch_counts[vbo->nbatches-1] += 6;
+    if(i<nsingle)vbo->nbatches_single = vbo->nbatches;
+
+    if(blocklocation==BLOCKlocation_grid){
+      xyz = facei->approx_vertex_coords;
+    }
+    else{
+      xyz = facei->exact_vertex_coords;
+    }
+    vert = vertices+4*6*i;
+    for(k = 0; k<4; k++){
+      memcpy(vert+6*k,   xyz+3*k,      3*sizeof(float));
+      memcpy(vert+6*k+3, facei->normal, 3*sizeof(float));
+    }
+    ind = indices+6*i;
+    ind[0] = 4*i;
+    ind[1] = 4*i+1;
+    ind[2] = 4*i+2;
+    ind[3] = 4*i;
+    ind[4] = 4*i+2;
+    ind[5] = 4*i+3;
+  }
+
+  glGenBuffers(1, &vbo->vertex_id);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo->vertex_id);
+  glBufferData(GL_ARRAY_BUFFER, 4*6*nstatic*sizeof(float), vertices, GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glGenBuffers(1, &vbo->index_id);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo->index_id);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, 6*nstatic*sizeof(unsigned int), indices, GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  FREEMEMORY(vertices);
+  FREEMEMORY(indices);
+  FREEMEMORY(faces_static);
+}
+
+/* ------------------ UpdateBlockageVBOs ------------------------ */
+
+int UpdateBlockageVBOs(void){
+
+// returns 1 if the blockage faces can be drawn from vertex buffers.  the buffers are rebuilt
+// after the face lists change (blockage visibility, clipping, blockage view method) or
+// when blockage locations are switched between grid and exact
+
+  int i;
+
+  if(use_blockage_vbo==0||opengl_version<150||showedit_dialog==1)return 0;
+  for(i = 0; i<nmeshes; i++){
+    meshdata *meshi;
+
+    meshi = meshinfo+i;
+    if(update_blockage_vbo==1||meshi->face_vbo.defined==0||meshi->face_vbo.blocklocation!=blocklocation){
+      MakeBlockageVBO(meshi);
+    }
+  }
+  update_blockage_vbo = 0;
+  return 1;
+}
+
+/* ------------------ DrawBlockageVBO ------------------------ */
+
+void DrawBlockageVBO(meshdata *meshi, int draw_double){
+  blockagevbodata *vbo;
+  int ibatch, ibatch_start, ibatch_end;
+
+  vbo = &meshi->face_vbo;
+  if(draw_double==0){
+    ibatch_start = 0;
+    ibatch_end = vbo->nbatches_single;
+  }
+  else{
+    ibatch_start = vbo->nbatches_single;
+    ibatch_end = vbo->nbatches;
+  }
+  if(ibatch_start==ibatch_end)return;
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_NORMAL_ARRAY);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo->vertex_id);
+  glVertexPointer(3, GL_FLOAT, 6*sizeof(float), (void *)0);
+  glNormalPointer(GL_FLOAT, 6*sizeof(float), (void *)(3*sizeof(float)));
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo->index_id);
+  for(ibatch = ibatch_start; ibatch<ibatch_end; ibatch++){
+    glColor4fv(vbo->batch_colors[ibatch]);
+    glDrawElements(GL_TRIANGLES, vbo->batch_counts[ibatch], GL_UNSIGNED_INT, (void *)(vbo->batch_starts[ibatch]*sizeof(unsigned int)));
+  }
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glDisableClientState(GL_NORMAL_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+}
+
 /* ------------------ DrawFacesOLD ------------------------ */
 // add option to turn off lighting when verifying smoke
 void DrawFacesOLD(){
@@ -4855,7 +5046,14 @@ void DrawFacesOLD(){
   float up_color[4]={0.9,0.9,0.9,1.0};
   float down_color[4]={0.1,0.1,0.1,1.0};
   float highlight_color[4]={1.0,0.0,0.0,1.0};
+  int use_vbo;
+  double draw_start = 0.0;
 
+  if(show_task_timings==1){
+    glFinish();
+    draw_start = GetWallTime();
+  }
+  use_vbo = UpdateBlockageVBOs();
   if(nface_normals_single>0){
     int j;
 
@@ -4871,15 +5069,22 @@ void DrawFacesOLD(){
     glBegin(GL_TRIANGLES);
     for(j=0;j<nmeshes;j++){
       meshdata *meshi;
-      int i;
+      facedata **face_list;
+      int i, nface_list;
 
       meshi=meshinfo + j;
       if(meshi->blockvis==0)continue;
-      for(i=0;i<meshi->nface_normals_single;i++){
+      face_list = meshi->face_normals_single;
+      nface_list = meshi->nface_normals_single;
+      if(use_vbo==1){
+        face_list = meshi->face_vbo.faces_dynamic;
+        nface_list = meshi->face_vbo.nfaces_dynamic_single;
+      }
+      for(i=0;i<nface_list;i++){
         facedata *facei;
         float *vertices;
 
-        facei = meshi->face_normals_single[i];
+        facei = face_list[i];
         if(blocklocation==BLOCKlocation_grid){
           vertices = facei->approx_vertex_coords;
         }
@@ -4930,6 +5135,16 @@ void DrawFacesOLD(){
       }
     }
     glEnd();
+    if(use_vbo==1){
+      for(j=0;j<nmeshes;j++){
+        meshdata *meshi;
+
+        meshi=meshinfo + j;
+        if(meshi->blockvis==0)continue;
+        DrawBlockageVBO(meshi, 0);
+      }
+      old_color = NULL;
+    }
     AntiAliasSurface(OFF);
     if(light_faces==1){
       glDisable(GL_COLOR_MATERIAL);
@@ -4951,14 +5166,21 @@ void DrawFacesOLD(){
     glBegin(GL_QUADS);
     for(j=0;j<nmeshes;j++){
       meshdata *meshi;
-      int i;
+      facedata **face_list;
+      int i, nface_list;
 
       meshi=meshinfo + j;
-      for(i=0;i<meshi->nface_normals_double;i++){
+      face_list = meshi->face_normals_double;
+      nface_list = meshi->nface_normals_double;
+      if(use_vbo==1){
+        face_list = meshi->face_vbo.faces_dynamic+meshi->face_vbo.nfaces_dynamic_single;
+        nface_list = meshi->face_vbo.nfaces_dynamic_double;
+      }
+      for(i=0;i<nface_list;i++){
         facedata *facei;
         float *vertices;
 
-        facei = meshi->face_normals_double[i];
+        facei = face_list[i];
         if(blocklocation==BLOCKlocation_grid){
           vertices = facei->approx_vertex_coords;
         }
@@ -5007,6 +5229,12 @@ void DrawFacesOLD(){
       }
     }
     glEnd();
+    if(use_vbo==1){
+      for(j=0;j<nmeshes;j++){
+        DrawBlockageVBO(meshinfo + j, 1);
+      }
+      old_color = NULL;
+    }
     AntiAliasLine(OFF);
     if(cullfaces==1)glEnable(GL_CULL_FACE);
     if(light_faces==1){
@@ -5150,6 +5378,11 @@ void DrawFacesOLD(){
       glDisable(GL_COLOR_MATERIAL);
     }
   }
+  if(show_task_timings==1&&nface_normals_single+nface_normals_double>0){
+    glFinish();
+    blockage_draw_time[use_vbo] += GetWallTime()-draw_start;
+    nblockage_draw_frames[use_vbo]++;
+  }
   if(show_triangle_count==1)printf("obst/vent triangles: %i\n",n_geom_triangles);
 }
 
@@ -270,76 +270,6 @@ end do
 close(lu26)
 end subroutine getzonesize
 
-!  ------------------ getpatchsizes1 ------------------------
-
-subroutine getpatchsizes1(file_unit,patchfilename,npatch,headersize,error)
-use cio
-implicit none
-
-character(len=*), intent(in) :: patchfilename
-integer, intent(out) :: file_unit,npatch, headersize, error
-
-integer :: sizes(3), nsizes
-logical :: exists
-
-error=0
-inquire(file=trim(patchfilename),exist=exists)
-if(exists)then
-  open(newunit=file_unit,file=trim(patchfilename),form="unformatted",action="read")
-else
-  write(6,*)' The boundary file name, ',trim(patchfilename),' does not exist'
-  error=1
-  return
-endif
-
-sizes(1) = 30
-sizes(2) = 30
-sizes(3) = 30
-nsizes = 3
-call ffseek(file_unit,sizes,nsizes,seek_set,error) ! skip over long, short and unit labels (each 30 characters in length)
-if(error.eq.0)read(file_unit,iostat=error)npatch
-headersize = 3*(4+30+4) + 4 + 4 + 4
-
-return
-end subroutine getpatchsizes1
-
-!  ------------------ getpatchsizes2 ------------------------
-
-subroutine getpatchsizes2(file_unit,version,npatch,npatchsize,pi1,pi2,pj1,pj2,pk1,pk2,patchdir,headersize,framesize)
-implicit none
-
-integer, intent(in) :: file_unit,version, npatch
-integer, intent(out) :: npatchsize
-integer, intent(out), dimension(npatch) :: pi1, pi2, pj1, pj2, pk1, pk2, patchdir
-integer, intent(inout) :: headersize
-integer, intent(out) :: framesize
-
-integer :: n, i1, i2, j1, j2, k1, k2, error
-
-error=0
-
-npatchsize = 0
-do n = 1, npatch
-  if(version.eq.0)then
-    read(file_unit)i1, i2, j1, j2, k1, k2
-   else
-    read(file_unit)i1, i2, j1, j2, k1, k2, patchdir(n)
-  endif
-  pi1(n)=i1
-  pi2(n)=i2
-  pj1(n)=j1
-  pj2(n)=j2
-  pk1(n)=k1
-  pk2(n)=k2
-  npatchsize = npatchsize + (i2+1-i1)*(j2+1-j1)*(k2+1-k1)
-end do
-headersize = headersize + npatch*(4+6*4+4)
-if(version.eq.1)headersize = headersize + npatch*4
-framesize = 8+4+8*npatch+npatchsize*4
-
-return
-end subroutine getpatchsizes2
-
 !  ------------------ getsliceparms ------------------------
 
 subroutine getsliceparms(slicefilename, ip1, ip2, jp1, jp2, kp1, kp2, ni, nj, nk, slice3d, error)
@@ -994,23 +924,6 @@ end do
 close(lu26)
 end subroutine getzonedata
 
-!  ------------------ skipdata ------------------------
-
-subroutine skipdata(file_unit,skip)
-use cio
-implicit none
-
-integer, intent(in) :: file_unit, skip
-
-integer :: error, sizes(1), nsizes
-
-sizes(1) = skip
-nsizes = 1
-
-call ffseek(file_unit,sizes,nsizes,seek_cur,error)
-
-end subroutine skipdata
-
 !  ------------------ getpatchdata ------------------------
 
 subroutine getpatchdata(file_unit,npatch,pi1,pi2,pj1,pj2,pk1,pk2,patchtime,pqq,npqq,file_size,error)
@@ -113,20 +113,14 @@ void GetBoundaryColors2(float *t, int nt, unsigned char *it,
               int *extreme_min, int *extreme_max
               ){
   int n;
-  float *tcopy, factor, range;
+  float factor, range;
   int itt;
   float local_tmin, local_tmax, tmin2, tmax2;
   int local_skip;
 
   tmin2 = *t;
   tmax2 = *t;
-
-  tcopy = t+1;
-  for(n=1;n<nt;n++){
-    if(*tcopy<tmin2)tmin2=*tcopy;
-    if(*tcopy>tmax2)tmax2=*tcopy;
-    tcopy++;
-  }
+  if(nt>0)GetMinMax(t, nt, &tmin2, &tmax2);
   *tmin_arg = tmin2;
   *tmax_arg = tmax2;
   local_skip=0;
@@ -712,6 +706,7 @@ void GetPartColors(partdata *parti, int nlevel, int convert_flag){
     Num2String(&labels[nlevel-1][0],tval);
     CheckMemory;
   }
+  update_part_vbo = 1;
 }
 
 /* ------------------ GetZoneColor ------------------------ */
@@ -1710,6 +1705,7 @@ void UpdateRGBColors(int colorbar_index){
       facej->color=foregroundcolor;
     }
   }
+  update_blockage_vbo = 1;
   UpdateChopColors();
   InitCadColors();
   UpdateTexturebar();
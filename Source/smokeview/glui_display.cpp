@@ -121,6 +121,7 @@ GLUI_Checkbox *CHECKBOX_labels_framelabel=NULL;
 GLUI_Checkbox *CHECKBOX_labels_hrrlabel=NULL;
 GLUI_Checkbox *CHECKBOX_labels_firecutoff=NULL;
 GLUI_Checkbox *CHECKBOX_labels_availmemory=NULL;
+GLUI_Checkbox *CHECKBOX_labels_memorytypes=NULL;
 GLUI_Checkbox *CHECKBOX_labels_labels=NULL;
 GLUI_Checkbox *CHECKBOX_labels_gridloc=NULL;
 GLUI_Checkbox *CHECKBOX_labels_average=NULL;
@@ -641,6 +642,7 @@ extern "C" void GluiLabelsSetup(int main_window){
 #ifdef pp_memstatus
   CHECKBOX_labels_availmemory = glui_labels->add_checkbox_to_panel(PANEL_gen1, _("Memory load"), &visAvailmemory, LABELS_label, LabelsCB);
 #endif
+  CHECKBOX_labels_memorytypes = glui_labels->add_checkbox_to_panel(PANEL_gen1, _("Memory by file type"), &visMemorytypes, LABELS_label, LabelsCB);
 
   glui_labels->add_column_to_panel(PANEL_gen1, false);
 
@@ -1346,6 +1348,7 @@ extern "C" void LabelsCB(int var){
 #ifdef pp_memstatus
   if(CHECKBOX_labels_availmemory!=NULL)CHECKBOX_labels_availmemory->set_int_val(visAvailmemory);
 #endif
+  if(CHECKBOX_labels_memorytypes!=NULL)CHECKBOX_labels_memorytypes->set_int_val(visMemorytypes);
   if(CHECKBOX_labels_labels!=NULL)CHECKBOX_labels_labels->set_int_val(visLabels);
 
   if(CHECKBOX_labels_flip!=NULL)CHECKBOX_labels_flip->set_int_val(background_flip);
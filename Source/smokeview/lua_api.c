@@ -846,6 +846,12 @@ int lua_slice_get_filename(lua_State *L) {
 int lua_slice_get_data(lua_State *L) {
   // get the lightuserdata from the stack, which is a pointer to the 'slicedata'
   slicedata *slice = (slicedata *)lua_touserdata(L, 1);
+  // Paged slices only hold the frames in the frame cache, there is no
+  // qslicedata array to return. Use the per frame functions
+  // (slice_data_map_frames etc) for those.
+  if(slice->paged==1){
+    return luaL_error(L, "slice %s is paged, its data is only available one frame at a time", slice->file);
+  }
   // Push a lightuserdata (a pointer) onto the lua stack that points to the
   // qslicedata.
   lua_pushlightuserdata(L, slice->qslicedata);
@@ -875,13 +881,16 @@ int lua_slice_data_map_frames(lua_State *L) {
     return luaL_error(L, "slice %s not loaded", slice->file);
   }
   int framepoints = slice->nslicex*slice->nslicey;
-  // Pointer to the first frame.
-  float *qslicedata = slice->qslicedata;
   // The second argument is the function to be called on each frame.
   lua_createtable(L, slice->ntimes, 0);
   // framenumber is the index of the frame (0-based).
   int framenumber;
   for (framenumber = 0; framenumber < slice->ntimes; framenumber++) {
+    // Pointer to the frame, read from the slice file if the slice is paged.
+    float *qslicedata = GetSliceFrame(slice, framenumber, NULL);
+    if (qslicedata == NULL) {
+      return luaL_error(L, "slice %s frame %d not available", slice->file, framenumber);
+    }
     // duplicate the function so that we can use it and keep it
     lua_pushvalue (L, 2);
     // Push the first frame onto the stack by first putting them into a lua
@@ -889,7 +898,7 @@ int lua_slice_data_map_frames(lua_State *L) {
     // Feed the lua function a lightuserdata (pointer) that is can use
     // with a special function to index the array.
     lua_pushnumber(L, framepoints);
-    // lua_pushlightuserdata(L, &qslicedata[framenumber*framepoints]);
+    // lua_pushlightuserdata(L, qslicedata);
 
     // this table method is more flexible but slower
     lua_createtable(L, framepoints, 0);
@@ -898,7 +907,7 @@ int lua_slice_data_map_frames(lua_State *L) {
     for (pointnumber = 0; pointnumber < framepoints; pointnumber++) {
       // adjust the index to start from 1
       lua_pushnumber(L, pointnumber+1);
-      lua_pushnumber(L, qslicedata[framenumber*framepoints+pointnumber]);
+      lua_pushnumber(L, qslicedata[pointnumber]);
       lua_settable(L, -3);
     }
 
@@ -922,13 +931,16 @@ int lua_slice_data_map_frames_count_less(lua_State *L) {
   }
   float threshold = lua_tonumber(L, 2);
   int framepoints = slice->nslicex*slice->nslicey;
-  // Pointer to the first frame.
-  float *qslicedata = slice->qslicedata;
   lua_createtable(L, slice->ntimes, 0);
   int framenumber;
   for (framenumber = 0; framenumber < slice->ntimes; framenumber++) {
     int count = 0;
     int pointnumber;
+    // Pointer to the frame, read from the slice file if the slice is paged.
+    float *qslicedata = GetSliceFrame(slice, framenumber, NULL);
+    if (qslicedata == NULL) {
+      return luaL_error(L, "slice %s frame %d not available", slice->file, framenumber);
+    }
     for (pointnumber = 0; pointnumber < framepoints; pointnumber++) {
       if (*qslicedata < threshold) {
         count++;
@@ -950,13 +962,16 @@ int lua_slice_data_map_frames_count_less_eq(lua_State *L) {
   }
   float threshold = lua_tonumber(L, 2);
   int framepoints = slice->nslicex*slice->nslicey;
-  // Pointer to the first frame.
-  float *qslicedata = slice->qslicedata;
   lua_createtable(L, slice->ntimes, 0);
   int framenumber;
   for (framenumber = 0; framenumber < slice->ntimes; framenumber++) {
     int count = 0;
     int pointnumber;
+    // Pointer to the frame, read from the slice file if the slice is paged.
+    float *qslicedata = GetSliceFrame(slice, framenumber, NULL);
+    if (qslicedata == NULL) {
+      return luaL_error(L, "slice %s frame %d not available", slice->file, framenumber);
+    }
     for (pointnumber = 0; pointnumber < framepoints; pointnumber++) {
       if (*qslicedata <= threshold) {
         count++;
@@ -978,13 +993,16 @@ int lua_slice_data_map_frames_count_greater(lua_State *L) {
   }
   float threshold = lua_tonumber(L, 2);
   int framepoints = slice->nslicex*slice->nslicey;
-  // Pointer to the first frame.
-  float *qslicedata = slice->qslicedata;
   lua_createtable(L, slice->ntimes, 0);
   int framenumber;
   for (framenumber = 0; framenumber < slice->ntimes; framenumber++) {
     int count = 0;
     int pointnumber;
+    // Pointer to the frame, read from the slice file if the slice is paged.
+    float *qslicedata = GetSliceFrame(slice, framenumber, NULL);
+    if (qslicedata == NULL) {
+      return luaL_error(L, "slice %s frame %d not available", slice->file, framenumber);
+    }
     for (pointnumber = 0; pointnumber < framepoints; pointnumber++) {
       if (*qslicedata > threshold) {
         count++;
@@ -1006,13 +1024,16 @@ int lua_slice_data_map_frames_count_greater_eq(lua_State *L) {
   }
   float threshold = lua_tonumber(L, 2);
   int framepoints = slice->nslicex*slice->nslicey;
-  // Pointer to the first frame.
-  float *qslicedata = slice->qslicedata;
   lua_createtable(L, slice->ntimes, 0);
   int framenumber;
   for (framenumber = 0; framenumber < slice->ntimes; framenumber++) {
     int count = 0;
     int pointnumber;
+    // Pointer to the frame, read from the slice file if the slice is paged.
+    float *qslicedata = GetSliceFrame(slice, framenumber, NULL);
+    if (qslicedata == NULL) {
+      return luaL_error(L, "slice %s frame %d not available", slice->file, framenumber);
+    }
     for (pointnumber = 0; pointnumber < framepoints; pointnumber++) {
       if (*qslicedata >= threshold) {
         count++;
@@ -1192,6 +1213,66 @@ int lua_loadvslice(lua_State *L) {
   return 0;
 }
 
+/*
+  Restrict the region of 3D slice and 3D smoke files loaded afterwards.
+  option is 0 (whole mesh), 1 (the box xmin, xmax, ymin, ymax, zmin, zmax)
+  or 2 (inside the clip planes).
+*/
+int lua_setloadbox(lua_State *L) {
+  int option = lua_tonumber(L, 1);
+  float xmin = lua_tonumber(L, 2);
+  float xmax = lua_tonumber(L, 3);
+  float ymin = lua_tonumber(L, 4);
+  float ymax = lua_tonumber(L, 5);
+  float zmin = lua_tonumber(L, 6);
+  float zmax = lua_tonumber(L, 7);
+  setloadbox(option, xmin, xmax, ymin, ymax, zmin, zmax);
+  return 0;
+}
+
+/*
+  Output the time history of a 3D slice quantity at a list of points to a CSV
+  file without loading the slice files. points is a table of {x, y, z}
+  tables. Returns the number of points found in a 3D slice.
+*/
+int lua_sliceprobes(lua_State *L) {
+  const char *quantity = lua_tostring(L, 1);
+  const char *csvfile = lua_tostring(L, 3);
+  if (!lua_istable(L, 2)){
+    fprintf(stderr, "point table is not present\n");
+    return 0;
+  }
+  int nprobes = 0;
+  lua_pushnil(L);
+  while(lua_next(L,2)!=0) {
+    nprobes++;
+    lua_pop(L, 1);
+  }
+  if (nprobes == 0) {
+    lua_pushnumber(L, 0);
+    return 1;
+  }
+  int i, n;
+  float xyz[3*nprobes];
+  for (i = 1; i <= nprobes; i++) {
+    lua_pushnumber(L, i);
+    lua_gettable(L, 2);
+    for (n = 1; n <= 3; n++) {
+      xyz[3*(i-1)+n-1] = 0.0;
+      if (lua_istable(L, -1)) {
+        lua_pushnumber(L, n);
+        lua_gettable(L, -2);
+        xyz[3*(i-1)+n-1] = lua_tonumber(L, -1);
+        lua_pop(L, 1);
+      }
+    }
+    lua_pop(L, 1);
+  }
+  int nfound = sliceprobes(quantity, xyz, nprobes, csvfile);
+  lua_pushnumber(L, nfound);
+  return 1;
+}
+
 int lua_loadiso(lua_State *L) {
   const char *type = lua_tostring(L, 1);
   loadiso(type);
@@ -1669,6 +1750,35 @@ int lua_toggle_memload_visibility(lua_State *L) {
 }
 #endif
 
+// memory by file type
+int lua_set_memtypes_visibility(lua_State *L) {
+  int setting = lua_toboolean(L, 1);
+  set_memtypes_visibility(setting);
+  return 0;
+}
+
+int lua_get_memtypes_visibility(lua_State *L) {
+  int setting = get_memtypes_visibility();
+  lua_pushboolean(L, setting);
+  return 1;
+}
+
+int lua_toggle_memtypes_visibility(lua_State *L) {
+  toggle_memtypes_visibility();
+  return 0;
+}
+
+int lua_memory_report(lua_State *L) {
+  memory_report();
+  return 0;
+}
+
+int lua_get_memory_usage(lua_State *L) {
+  const char *type = lua_isstring(L, 1) ? lua_tostring(L, 1) : NULL;
+  lua_pushnumber(L, get_memory_usage(type));
+  return 1;
+}
+
 // mesh label
 int lua_set_meshlabel_visibility(lua_State *L) {
   int setting = lua_toboolean(L, 1);
@@ -3084,6 +3194,13 @@ int lua_set_showmemload(lua_State *L) {
 }
 #endif
 
+int lua_set_showmemtypes(lua_State *L) {
+  int v = lua_tonumber(L, 1);
+  int return_code = set_showmemtypes(v);
+  lua_pushnumber(L, return_code);
+  return 1;
+}
+
 int lua_set_showopenvents(lua_State *L) {
   int a = lua_tonumber(L, 1);
   int b = lua_tonumber(L, 1);
@@ -4484,6 +4601,8 @@ lua_State* initLua() {
   lua_register(L, "loadsliceindex", lua_loadsliceindex);
   // lua_register(L, "loadnamedslice", lua_loadnamedslice);
   lua_register(L, "loadvslice", lua_loadvslice);
+  lua_register(L, "setloadbox", lua_setloadbox);
+  lua_register(L, "sliceprobes", lua_sliceprobes);
   lua_register(L, "loadiso", lua_loadiso);
   lua_register(L, "unloadall", lua_unloadall);
   lua_register(L, "unloadtour", lua_unloadtour);
@@ -4568,6 +4687,13 @@ lua_State* initLua() {
   lua_register(L, "toggle_memload_visibility", lua_toggle_memload_visibility);
 #endif
 
+  // memory by file type
+  lua_register(L, "set_memtypes_visibility", lua_set_memtypes_visibility);
+  lua_register(L, "get_memtypes_visibility", lua_get_memtypes_visibility);
+  lua_register(L, "toggle_memtypes_visibility", lua_toggle_memtypes_visibility);
+  lua_register(L, "memory_report", lua_memory_report);
+  lua_register(L, "get_memory_usage", lua_get_memory_usage);
+
   // mesh label
   lua_register(L, "set_meshlabel_visibility", lua_set_meshlabel_visibility);
   lua_register(L, "get_meshlabel_visibility", lua_get_meshlabel_visibility);
@@ -4775,6 +4901,7 @@ lua_State* initLua() {
 #ifdef pp_memstatus
   lua_register(L, "set_showmemload", lua_set_showmemload);
 #endif
+  lua_register(L, "set_showmemtypes", lua_set_showmemtypes);
   lua_register(L, "set_showopenvents", lua_set_showopenvents);
   lua_register(L, "set_showothervents", lua_set_showothervents);
   lua_register(L, "set_showsensors", lua_set_showsensors);
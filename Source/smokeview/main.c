@@ -37,14 +37,20 @@ void Usage(char *prog,int option){
     PRINTF("%s\n", _(" -demo          - use demonstrator mode of Smokeview"));
     PRINTF("%s\n", _(" -fast          - assume slice files exist in order to reduce startup time"));
     PRINTF("%s\n", _(" -fed           - pre-calculate all FED slice files"));
+    PRINTF("%s\n", _(" -follow        - read frames appended to loaded files as the case runs"));
     PRINTF("%s\n", _(" -geominfo      - output information about geometry triangles"));
     PRINTF("%s\n", _(" -html          - output html version of smokeview scene"));
     PRINTF("%s\n", _(" -info            generate casename.slcf and casename.viewpoint files containing slice file and viewpiont info"));
     PRINTF("%s\n", _(" -lang xx       - where xx is de, es, fr, it for German, Spanish, French or Italian"));
+    PRINTF("%s\n", _(" -memory_budget n - keep loaded data within n MB by unloading the least recently displayed files"));
+    PRINTF("%s\n", _(" -memreport     - output memory used by each loaded file when files are loaded or unloaded"));
     PRINTF("%s\n", _(" -ng_ini        - non-graphics version of -ini."));
+    PRINTF("%s\n", _(" -nosmvcache    - do not read or write casename.smvidx, the cache of values parsed from the .smv file"));
+    PRINTF("%s\n", _(" -nthreads n    - use n worker threads (default: number of processors)"));
     PRINTF("%s\n", _(" -scriptrenderdir dir - directory containing script rendered images"));
     PRINTF("%s\n", _("                  (override directory specified by RENDERDIR script keyword)"));
     PRINTF("%s\n", _(" -setup         - only show geometry"));
+    PRINTF("%s\n", _(" -statsweep     - find the size and time of all casename* files in parallel when opening a case"));
     PRINTF("%s\n", _(" -script scriptfile - run the script file scriptfile"));
 #ifdef pp_LUA
     PRINTF("%s\n", " -runluascript  - run the lua script file casename.lua");
@@ -59,6 +65,7 @@ void Usage(char *prog,int option){
     PRINTF("%s\n", _(" -smoke3d       - only show 3d smoke"));
     PRINTF("%s\n", _(" -startframe n  - start rendering at frame n"));
     PRINTF("%s\n", _(" -stereo        - activate stereo mode"));
+    PRINTF("%s\n", _(" -task_timings  - output worker thread task, 3D smoke decode, volume smoke, slice, blockage and particle drawing timings when smokeview exits"));
     PRINTF("%s\n", _(" -update_bounds - calculate boundary file bounds and save to casename.binfo"));
     PRINTF("%s\n", _(" -update_slice  - calculate slice file parameters"));
     PRINTF("%s\n", _(" -update        - equivalent to -update_bounds and -update_slice"));
@@ -216,6 +223,8 @@ void ParseCommandline(int argc, char **argv){
 #endif
         strncmp(argi, "-startframe", 11) == 0 ||
         strncmp(argi, "-skipframe", 10) == 0 ||
+        strncmp(argi, "-nthreads", 9) == 0 ||
+        strncmp(argi, "-memory_budget", 14) == 0 ||
         strncmp(argi, "-bindir", 7) == 0 ||
         strncmp(argi, "-update_ini", 11) == 0
         ){
@@ -532,12 +541,21 @@ void ParseCommandline(int argc, char **argv){
       iblank_set_on_commandline = 1;
       use_iblank = 0;
     }
+    else if(strncmp(argv[i], "-follow", 7) == 0){
+      follow_files = 1;
+    }
     else if(strncmp(argv[i], "-fed", 4) == 0){
       compute_fed = 1;
     }
     else if(strncmp(argv[i], "-geominfo", 9)==0){
       print_geominfo = 1;
     }
+    else if(strncmp(argv[i], "-statsweep", 10) == 0){
+      stat_sweep = 1;
+    }
+    else if(strncmp(argv[i], "-nosmvcache", 11) == 0){
+      use_smvcache = 0;
+    }
     else if(strncmp(argv[i], "-fast", 5) == 0){
       fast_startup = 1;
       lookfor_compressed_slice = 0;
@@ -606,6 +624,25 @@ void ParseCommandline(int argc, char **argv){
         }
       }
     }
+    else if(strncmp(argv[i], "-nthreads", 9) == 0){
+      ++i;
+      if(i < argc){
+        sscanf(argv[i], "%i", &pool_nthreads);
+      }
+    }
+    else if(strncmp(argv[i], "-task_timings", 13) == 0){
+      show_task_timings = 1;
+    }
+    else if(strncmp(argv[i], "-memreport", 10) == 0){
+      show_memory_report = 1;
+    }
+    else if(strncmp(argv[i], "-memory_budget", 14) == 0){
+      ++i;
+      if(i < argc){
+        sscanf(argv[i], "%i", &memory_budget);
+        memory_budget = MAX(memory_budget, 0);
+      }
+    }
     else if(strncmp(argv[i], "-skipframe", 10) == 0){
       from_commandline = 1;
       ++i;
@@ -816,5 +853,51 @@ int main(int argc, char **argv){
 /* ------------------ SMV_EXIT ------------------------ */
 
 void SMV_EXIT(int code){
+  if(prefetch_nframes>0){
+    PRINTF("prefetch: %i hits, %i misses\n", prefetch_hits, prefetch_misses);
+  }
+  if(show_task_timings==1){
+    int i;
+
+    ThreadPoolPrintTimes();
+    for(i = 0; i<2; i++){
+      if(nsmoke3d_decode_frames[i]==0)continue;
+      PRINTF("smoke3d frame decode (%s): %i frames, %.3f ms/frame\n", i==0 ? "serial" : "parallel",
+        nsmoke3d_decode_frames[i], 1000.0*smoke3d_decode_time[i]/(double)nsmoke3d_decode_frames[i]);
+    }
+    for(i = 0; i<2; i++){
+      if(nvolsmoke_compute_frames[i]==0)continue;
+      PRINTF("volume smoke colors (%s): %i frames, %.3f ms/frame\n", i==0 ? "serial" : "parallel",
+        nvolsmoke_compute_frames[i], 1000.0*volsmoke_compute_time[i]/(double)nvolsmoke_compute_frames[i]);
+    }
+    for(i = 0; i<2; i++){
+      if(npart_decode_files[i]==0)continue;
+      PRINTF("particle decode (%s): %i files, %i frames, %.3f ms/file\n", i==0 ? "serial" : "parallel",
+        npart_decode_files[i], npart_decode_frames[i], 1000.0*part_decode_time[i]/(double)npart_decode_files[i]);
+    }
+    for(i = 0; i<2; i++){
+      if(nslice_draw_frames[i]==0)continue;
+      PRINTF("slice draw (%s): %i frames, %.3f ms/frame\n", i==0 ? "immediate" : "vbo",
+        nslice_draw_frames[i], 1000.0*slice_draw_time[i]/(double)nslice_draw_frames[i]);
+    }
+    for(i = 0; i<2; i++){
+      if(nblockage_draw_frames[i]==0)continue;
+      PRINTF("blockage draw (%s): %i frames, %.3f ms/frame\n", i==0 ? "immediate" : "vbo",
+        nblockage_draw_frames[i], 1000.0*blockage_draw_time[i]/(double)nblockage_draw_frames[i]);
+    }
+    for(i = 0; i<4; i++){
+      char *part_draw_labels[] = {"cpu", "gpu", "cpu lod", "gpu lod"};
+
+      if(npart_draw_frames[i]==0)continue;
+      PRINTF("particle draw (%s): %i frames, %.3f ms/frame\n", part_draw_labels[i],
+        npart_draw_frames[i], 1000.0*part_draw_time[i]/(double)npart_draw_frames[i]);
+    }
+    for(i = 0; i<2; i++){
+      if(nboundary_draw_frames[i]==0)continue;
+      PRINTF("boundary draw (%s): %i frames, %.3f ms/frame\n", i==0 ? "cpu" : "gpu",
+        nboundary_draw_frames[i], 1000.0*boundary_draw_time[i]/(double)nboundary_draw_frames[i]);
+    }
+  }
+  if(show_memory_report==1)PrintMemoryReport(1);
   exit(code);
 }
@@ -19,12 +19,6 @@ int       part_file_count;
 FILE_SIZE part_load_size;
 float     part_load_time;
 
-#ifdef pp_SLICETHREAD
-int       slice_file_count;
-FILE_SIZE slice_load_size;
-float     slice_load_time;
-#endif
-
 
 #ifdef WIN32
 #include <direct.h>
@@ -56,6 +50,7 @@ float     slice_load_time;
 
 #define MENU_SLICE_FILE_SIZES -9
 
+
 #define MENU_OPTION_TRAINERMENU 2
 
 #define MENU_UPDATEBOUNDS             -6
@@ -759,6 +754,7 @@ void LabelMenu(int value){
 #ifdef pp_memstatus
     visAvailmemory=1;
 #endif
+    visMemorytypes=1;
     visaxislabels=1;
     visTimelabel=1;
     visFramelabel=1;
@@ -796,6 +792,7 @@ void LabelMenu(int value){
 #ifdef pp_memstatus
     visAvailmemory=0;
 #endif
+    visMemorytypes=0;
     break;
    case MENU_LABEL_northangle:
      vis_northangle = 1-vis_northangle;
@@ -833,6 +830,9 @@ void LabelMenu(int value){
 #endif
      break;
 #endif
+   case MENU_LABEL_memtypes:
+     visMemorytypes = 1 - visMemorytypes;
+     break;
    case MENU_LABEL_fdsticks:
      visFDSticks=1-visFDSticks;
      break;
@@ -2679,6 +2679,238 @@ void PeriodicReloads(int value){
   }
 }
 
+/* ------------------ SetFollowFile ------------------------ */
+
+int SetFollowFile(followdata *followi, char *file, int type, int index){
+  if(file==NULL)return 0;
+  followi->file     = file;
+  followi->type     = type;
+  followi->index    = index;
+  followi->watch_id = -1;
+  followi->size     = 0;
+  return 1;
+}
+
+/* ------------------ GetFollowFiles ------------------------ */
+
+int GetFollowFiles(followdata *followlist){
+
+// list the .smv file and each loaded slice, vector slice, boundary, 3D smoke and particle file
+
+  int i, ii, n = 0;
+
+  n += SetFollowFile(followlist+n, smv_filename, FOLLOW_SMV, 0);
+  for(i = 0; i<nvsliceinfo; i++){
+    vslicedata *vd;
+    int ids[4], j;
+
+    vd = vsliceinfo+i;
+    if(vd->loaded==0)continue;
+    ids[0] = vd->iu;
+    ids[1] = vd->iv;
+    ids[2] = vd->iw;
+    ids[3] = vd->ival;
+    for(j = 0; j<4; j++){
+      if(ids[j]!=-1)n += SetFollowFile(followlist+n, sliceinfo[ids[j]].file, FOLLOW_VSLICE, i);
+    }
+  }
+  for(ii = 0; ii<nslice_loaded; ii++){
+    int j;
+
+    i = slice_loaded_list[ii];
+    for(j = 0; j<n; j++){
+      if(followlist[j].type==FOLLOW_VSLICE&&followlist[j].file==sliceinfo[i].file)break;
+    }
+    if(j<n)continue;
+    n += SetFollowFile(followlist+n, sliceinfo[i].file, FOLLOW_SLICE, i);
+  }
+  for(ii = 0; ii<npatch_loaded; ii++){
+    i = patch_loaded_list[ii];
+    n += SetFollowFile(followlist+n, patchinfo[i].file, FOLLOW_BOUNDARY, i);
+  }
+  for(i = 0; i<nsmoke3dinfo; i++){
+    if(smoke3dinfo[i].loaded==1)n += SetFollowFile(followlist+n, smoke3dinfo[i].file, FOLLOW_SMOKE3D, i);
+  }
+  for(i = 0; i<npartinfo; i++){
+    if(partinfo[i].loaded==1)n += SetFollowFile(followlist+n, partinfo[i].file, FOLLOW_PART, i);
+  }
+  return n;
+}
+
+/* ------------------ UpdateFollowWatches ------------------------ */
+
+int UpdateFollowWatches(void){
+
+// rebuild the list of followed files (and their inotify watches) when files are loaded or unloaded.
+// returns 1 if the list changed
+
+  followdata *follownew;
+  int i, nfollownew, nfollownew_max;
+
+  nfollownew_max = 1+4*nvsliceinfo+nsliceinfo+npatchinfo+nsmoke3dinfo+npartinfo;
+  NewMemory((void **)&follownew, nfollownew_max*sizeof(followdata));
+  nfollownew = GetFollowFiles(follownew);
+  if(nfollownew==nfollowinfo){
+    for(i = 0; i<nfollownew; i++){
+      if(follownew[i].type!=followinfo[i].type||follownew[i].index!=followinfo[i].index||follownew[i].file!=followinfo[i].file)break;
+    }
+    if(i==nfollownew){
+      FREEMEMORY(follownew);
+      return 0;
+    }
+  }
+
+  FileWatchClose(follow_watch);
+  follow_watch = FileWatchInit();
+  for(i = 0; i<nfollownew; i++){
+    followdata *followi;
+    int j;
+
+    followi = follownew+i;
+    followi->watch_id = FileWatchAdd(follow_watch, followi->file);
+    followi->size = GetFileSizeSMV(followi->file);
+
+    // keep the old size of files already followed so growth since the last check is not lost
+    for(j = 0; j<nfollowinfo; j++){
+      if(followinfo[j].file==followi->file&&followinfo[j].type==followi->type){
+        followi->size = followinfo[j].size;
+        break;
+      }
+    }
+  }
+  FREEMEMORY(followinfo);
+  followinfo  = follownew;
+  nfollowinfo = nfollownew;
+  return 1;
+}
+
+/* ------------------ ReadFollowFiles ------------------------ */
+
+void ReadFollowFiles(void){
+
+// read the frames appended to followed files that have grown since the last check.
+// files that shrink (e.g. a restarted case) are loaded again from the beginning
+
+  int i, *changed, *watch_changed = NULL, nwatch = 0, last_slice = -1, nchanged = 0;
+
+  NewMemory((void **)&changed, MAX(nfollowinfo, 1)*sizeof(int));
+  for(i = 0; i<nfollowinfo; i++){
+    nwatch = MAX(nwatch, followinfo[i].watch_id+1);
+  }
+  if(follow_watch>=0&&nwatch>0){
+    NewMemory((void **)&watch_changed, nwatch*sizeof(int));
+    memset(watch_changed, 0, nwatch*sizeof(int));
+    FileWatchRead(follow_watch, watch_changed, nwatch);
+  }
+  for(i = 0; i<nfollowinfo; i++){
+    followdata *followi;
+    FILE_SIZE size;
+
+    followi = followinfo+i;
+    changed[i] = 0;
+
+    // only stat files inotify reported as written to (or all files when inotify is not available)
+    if(watch_changed!=NULL&&followi->watch_id>=0&&watch_changed[followi->watch_id]==0)continue;
+    size = GetFileSizeSMV(followi->file);
+    if(size==followi->size)continue;
+    changed[i] = size>followi->size ? RELOAD : LOAD;
+    followi->size = size;
+    if(followi->type==FOLLOW_SLICE)last_slice = i;
+    nchanged++;
+  }
+  FREEMEMORY(watch_changed);
+  if(nchanged==0){
+    FREEMEMORY(changed);
+    return;
+  }
+
+  LOCK_COMPRESS
+  for(i = 0; i<nfollowinfo; i++){
+    followdata *followi;
+    int errorcode, j;
+
+    followi = followinfo+i;
+    if(changed[i]==0)continue;
+    switch(followi->type){
+    case FOLLOW_SMV:
+      // while FDS is part way through a line only the tail of the .smv file is read, the file
+      // is parsed again once a complete new line is there (or from the start if it was rewritten)
+      ReadSMVDynamic(smv_filename);
+      break;
+    case FOLLOW_VSLICE:
+      for(j = i+1; j<nfollowinfo; j++){
+        if(followinfo[j].type==FOLLOW_VSLICE&&followinfo[j].index==followi->index)changed[j] = 0;
+      }
+      ReadVSlice(followi->index, ALL_SLICE_FRAMES, NULL, changed[i], &errorcode);
+      break;
+    case FOLLOW_SLICE:
+      {
+        slicedata *slicei;
+        int set_slicecolor;
+
+        slicei = sliceinfo+followi->index;
+        set_slicecolor = DEFER_SLICECOLOR;
+        if(i==last_slice)set_slicecolor = SET_SLICECOLOR;
+        if(slicei->slice_filetype==SLICE_GEOM){
+          ReadGeomData(slicei->patchgeom, slicei, changed[i], &errorcode);
+        }
+        else{
+#ifdef pp_NEWBOUND_DIALOG
+          ReadSliceUseGluiBounds(slicei->file, followi->index, ALL_SLICE_FRAMES, changed[i], set_slicecolor, &errorcode);
+#else
+          ReadSlice(slicei->file, followi->index, ALL_SLICE_FRAMES, NULL, changed[i], set_slicecolor, &errorcode);
+#endif
+        }
+      }
+      break;
+    case FOLLOW_BOUNDARY:
+      ReadBoundary(followi->index, changed[i], &errorcode);
+      break;
+    case FOLLOW_SMOKE3D:
+      ReadSmoke3D(ALL_SMOKE_FRAMES, followi->index, changed[i], FIRST_TIME, &errorcode);
+      break;
+
+    // particle files have no incremental reader, load them again
+    case FOLLOW_PART:
+      npartframes_max = GetMinPartFrames(PARTFILE_RELOADALL);
+      ReadPart(followi->file, followi->index, UNLOAD, &errorcode);
+      ReadPart(followi->file, followi->index, LOAD, &errorcode);
+      break;
+    default:
+      ASSERT(FFALSE);
+      break;
+    }
+  }
+  UNLOCK_COMPRESS
+  FREEMEMORY(changed);
+  updatemenu = 1;
+  GLUTPOSTREDISPLAY;
+}
+
+/* ------------------ FollowFiles ------------------------ */
+
+void FollowFiles(int value){
+  if(follow_files==0){
+    FileWatchClose(follow_watch);
+    follow_watch = -1;
+    FREEMEMORY(followinfo);
+    nfollowinfo = 0;
+    follow_timer = 0;
+    return;
+  }
+  if(UpdateFollowWatches()==0)ReadFollowFiles();
+  glutTimerFunc((unsigned int)value, FollowFiles, value);
+}
+
+/* ------------------ StartFollowFiles ------------------------ */
+
+void StartFollowFiles(void){
+  if(follow_files==0||follow_timer==1)return;
+  follow_timer = 1;
+  follow_interval = MAX(follow_interval, 100);
+  glutTimerFunc((unsigned int)follow_interval, FollowFiles, follow_interval);
+}
+
 
 /* ------------------ ScriptMenu2 ------------------------ */
 
@@ -2841,6 +3073,11 @@ void ReloadMenu(int value){
   switch(value){
   case STOP_RELOADING:
     periodic_reloads=0;
+    follow_files=0;
+    break;
+  case RELOAD_FOLLOW:
+    follow_files = 1-follow_files;
+    StartFollowFiles();
     break;
   case RELOAD_SWITCH:
     if(load_incremental==1)LoadUnloadMenu(RELOAD_INCREMENTAL_ALL);
@@ -3584,27 +3821,69 @@ void UnloadAllPartFiles(void){
 void LoadAllSliceFiles(int slicenum){
   int i;
 
-  for(i = 0; i<nsliceinfo; i++){
+  // read slice data.  only the data for each slice is updated here so this
+  // routine may be called by several slice loading threads at once,
+  // the global bookkeeping is done afterwards by FinishAllSliceFiles
+
+  for(i = 0; i<nsliceinfo-nfedinfo; i++){
     slicedata *slicei;
-    int errorcode;
-    FILE_SIZE file_size;
+    int memory_id_save;
 
     slicei = sliceinfo+i;
     if(slicei->skipload==1)continue;
+    if(slicei->slice_filetype==SLICE_GEOM)continue;
     if(slicenum>=0&&i!=slicenum)continue;  //  load only slice file with file index slicenum
     LOCK_SLICE_LOAD;                       //  or load all slice files
     if(slicei->loadstatus==FILE_UNLOADED){
       slicei->loadstatus = FILE_LOADING;
       UNLOCK_SLICE_LOAD;
-      file_size = ReadSlice(slicei->file, i, ALL_SLICE_FRAMES, LOAD, SET_SLICECOLOR, &errorcode);
+      FreeSliceBuffers(slicei, LOAD);
+      memory_id_save = SetMemoryId(slicei->memory_id);
+      slicei->load_size = ReadSliceData(slicei, slicei->file, ALL_SLICE_FRAMES, LOAD, &slicei->load_averaged, &slicei->load_error);
+      SetMemoryId(memory_id_save);
       LOCK_SLICE_LOAD;
       slicei->loadstatus = FILE_LOADED;
-      slice_load_size += file_size;
+      slice_load_size += slicei->load_size;
       slice_file_count++;
     }
     UNLOCK_SLICE_LOAD;
   }
 }
+
+/* ------------------ FinishAllSliceFiles ------------------------ */
+
+FILE_SIZE FinishAllSliceFiles(int slicenum){
+  int i;
+  FILE_SIZE load_size = 0;
+
+  // update the global slice state for files read by LoadAllSliceFiles, slice
+  // colors and menus are only updated for the slice marked with finalize==1.
+  // geometry and fed slices are not read by LoadAllSliceFiles, they are loaded here
+
+  for(i = 0; i<nsliceinfo; i++){
+    slicedata *slicei;
+    int errorcode, set_slicecolor;
+
+    slicei = sliceinfo+i;
+    if(slicei->skipload==1)continue;
+    if(slicenum>=0&&i!=slicenum)continue;
+    set_slicecolor = DEFER_SLICECOLOR;
+    if(slicei->finalize==1)set_slicecolor = SET_SLICECOLOR;
+    if(slicei->slice_filetype==SLICE_GEOM||i>=nsliceinfo-nfedinfo){
+      FILE_SIZE LoadSlicei(int set_slicecolor, int value, int time_frame, float *time_value);
+
+      load_size += LoadSlicei(set_slicecolor, i, ALL_SLICE_FRAMES, NULL);
+    }
+    else if(slicei->loadstatus==FILE_LOADED){
+#ifdef pp_NEWBOUND_DIALOG
+      load_size += ReadSliceUseGluiBounds(slicei->file, i, ALL_SLICE_FRAMES, NULL, FINISH_LOAD, set_slicecolor, &errorcode);
+#else
+      load_size += ReadSlice(slicei->file, i, ALL_SLICE_FRAMES, NULL, FINISH_LOAD, set_slicecolor, &errorcode);
+#endif
+    }
+  }
+  return load_size;
+}
 #endif
 
 /* ------------------ LoadAllPartFiles ------------------------ */
@@ -4773,7 +5052,7 @@ int SetupSlice(int value){
       slicedata *slicei;
 
       slicei = sliceinfo + mslicei->islices[i];
-      if(slicei->skipdup== 0 && slicei->loaded == 0){
+      if(slicei->skipdup== 0){
         return_val = mslicei->islices[i];
         slicei->finalize = 1;
         break;
@@ -4816,7 +5095,42 @@ int SetupSlice(int value){
   }
   return return_val;
 }
+
+/* ------------------ ResetSliceFinalize ------------------------ */
+
+void ResetSliceFinalize(void){
+  int i;
+
+  for(i = 0; i<nsliceinfo; i++){
+    sliceinfo[i].finalize = 1;
+  }
+}
+
+/* ------------------ UseSliceThreads ------------------------ */
+
+int UseSliceThreads(void){
+  if(slice_multithread==0||use_cslice==0)return 0; // the fortran slice reader is not thread safe
+  if(compute_slice_file_sizes==1||slice_average_flag==1)return 0;
+  return 1;
+}
 #endif
+
+/* ------------------ LoadBoxMenu ------------------------ */
+
+void LoadBoxMenu(int value){
+
+// region (value = LOADBOX_OFF, LOADBOX_USER or LOADBOX_CLIP) used when 3d slice and 3d smoke files are loaded
+
+  if(value==MENU_DUMMY)return;
+  load_box_option = value;
+  if(scriptoutstream!=NULL){
+    fprintf(scriptoutstream, "LOADBOX\n");
+    fprintf(scriptoutstream, " %i\n", load_box_option);
+    fprintf(scriptoutstream, " %f %f %f %f %f %f\n", load_box[0], load_box[1], load_box[2], load_box[3], load_box[4], load_box[5]);
+  }
+  updatemenu = 1;
+}
+
 /* ------------------ LoadMultiSliceMenu ------------------------ */
 
 void LoadMultiSliceMenu(int value){
@@ -4864,7 +5178,17 @@ void LoadMultiSliceMenu(int value){
           UnloadSliceMenu(mslicei->islices[i]);
         }
       }
+#ifdef pp_SLICETHREAD
+      if(UseSliceThreads()==1){
+        LoadAllSliceFilesMT(-1);
+      }
+      else{
+        total_size = LoadAllMSlices(last_slice, mslicei);
+      }
+      ResetSliceFinalize();
+#else
       total_size = LoadAllMSlices(last_slice, mslicei);
+#endif
       if(compute_slice_file_sizes==1){
         PRINTF(" size of slice files to be loaded=");
         if(total_size>1000000000){
@@ -4883,21 +5207,29 @@ void LoadMultiSliceMenu(int value){
     script_multislice=0;
   }
   else if(value<=-1000){
-    int submenutype, last_slice, dir, errorcode;
+    int last_slice, errorcode;
+#ifndef pp_SLICETHREAD
+    int submenutype, dir;
     char *submenulabel;
+#endif
     slicedata *slicei;
     float load_time, load_size = 0.0;
     int file_count = 0;
 
+#ifdef pp_SLICETHREAD
+    last_slice = SetupSlice(value);
+    if(UseSliceThreads()==1){
+      LoadAllSliceFilesMT(-1);
+      ResetSliceFinalize();
+      return;
+    }
+#else
     value = -(1000 + value);
     submenutype=value/4;
     dir=value%4;
     submenutype=msubslice_menuindex[submenutype];
     slicei = sliceinfo + submenutype;
     submenulabel = slicei->label.longlabel;
-#ifdef pp_SLICETHREAD
-    last_slice = SetupSlice(value);
-#else
     last_slice = nsliceinfo - 1;
     for(i = nsliceinfo-1; i>=0; i--){
       char *longlabel;
@@ -4943,6 +5275,9 @@ void LoadMultiSliceMenu(int value){
       }
       file_count++;
     }
+#ifdef pp_SLICETHREAD
+    ResetSliceFinalize();
+#endif
     STOP_TIMER(load_time);
     PRINT_LOADTIMES(file_count,load_size,load_time);
   }
@@ -6232,6 +6567,7 @@ static int *loadsubplot3dmenu=NULL, nloadsubplot3dmenu=0;
 static int loadmultivslicemenu=0, unloadmultivslicemenu=0;
 static int duplicatevectorslicemenu=0, duplicateslicemenu=0, duplicateboundaryslicemenu=0;
 static int unloadmultislicemenu=0, vsliceloadmenu=0, staticslicemenu=0;
+static int loadboxmenu=0;
 static int evacmenu=0, particlemenu=0, particlesubmenu=0, showpatchmenu=0, zonemenu=0, isoshowmenu=0, isoshowsubmenu=0, isolevelmenu=0, smoke3dshowmenu=0;
 static int smoke3dshowsinglemenu = 0;
 static int particlepropshowmenu=0,humanpropshowmenu=0;
@@ -7412,6 +7748,8 @@ updatemenu=0;
   if(visUsagememory == 1)glutAddMenuEntry(_("*Memory usage"), MENU_LABEL_memusage);
   if(visUsagememory == 0)glutAddMenuEntry(_("Memory usage"), MENU_LABEL_memusage);
 #endif
+  if(visMemorytypes == 1)glutAddMenuEntry(_("*Memory by file type"), MENU_LABEL_memtypes);
+  if(visMemorytypes == 0)glutAddMenuEntry(_("Memory by file type"), MENU_LABEL_memtypes);
   if(visMeshlabel == 1)glutAddMenuEntry(_("*Mesh"), MENU_LABEL_meshlabel);
   if(visMeshlabel == 0)glutAddMenuEntry(_("Mesh"), MENU_LABEL_meshlabel);
   if(vis_slice_average == 1)glutAddMenuEntry(_("*Slice average"), MENU_LABEL_sliceaverage);
@@ -10099,6 +10437,17 @@ updatemenu=0;
     }
   }
 
+  /* --------------------------------3d slice and 3d smoke load region menu -------------------------- */
+
+  if(nsliceinfo>0||nsmoke3dinfo>0){
+    CREATEMENU(loadboxmenu, LoadBoxMenu);
+    if(load_box_option==LOADBOX_OFF)glutAddMenuEntry(_("  *whole mesh"), LOADBOX_OFF);
+    if(load_box_option!=LOADBOX_OFF)glutAddMenuEntry(_("  whole mesh"), LOADBOX_OFF);
+    if(load_box_option==LOADBOX_CLIP)glutAddMenuEntry(_("  *inside clip planes"), LOADBOX_CLIP);
+    if(load_box_option!=LOADBOX_CLIP)glutAddMenuEntry(_("  inside clip planes"), LOADBOX_CLIP);
+    if(load_box_option==LOADBOX_USER)glutAddMenuEntry(_("  *box set by script"), LOADBOX_USER);
+  }
+
   /* --------------------------------unload and load multislice menus -------------------------- */
 
   if(nmultisliceinfo+nfedinfo<nsliceinfo||have_geom_slice_menus==1){
@@ -10269,6 +10618,7 @@ updatemenu=0;
     if(nslicedups > 0){
       GLUTADDSUBMENU(_("Duplicate slices"), duplicateslicemenu);
     }
+    GLUTADDSUBMENU(_("3D slice region"), loadboxmenu);
     glutAddMenuEntry(_("Settings..."), MENU_SLICE_SETTINGS);
     if(nsliceinfo>0&&nmultisliceinfo+nfedinfo<nsliceinfo){
       char loadmenulabel[100];
@@ -10508,6 +10858,7 @@ updatemenu=0;
         else{
           glutAddMenuEntry(_("compute size of 3D smoke files to be loaded"), MENU_SMOKE_FILE_SIZES);
         }
+        GLUTADDSUBMENU(_("Region"), loadboxmenu);
         glutAddMenuEntry(_("Settings..."), MENU_SMOKE_SETTINGS);
         if(nsmoke3dloaded==1)glutAddMenuEntry(_("Unload"),UNLOAD_ALL);
         if(nsmoke3dloaded>1)GLUTADDSUBMENU(_("Unload"),unloadsmoke3dmenu);
@@ -11150,6 +11501,8 @@ updatemenu=0;
     if(periodic_value!=5)glutAddMenuEntry(_("   every 5 minutes"),5);
     if(periodic_value==10)glutAddMenuEntry(_("   *every 10 minutes"),10);
     if(periodic_value!=10)glutAddMenuEntry(_("   every 10 minutes"),10);
+    if(follow_files==1)glutAddMenuEntry(_("   *when files change"),RELOAD_FOLLOW);
+    if(follow_files==0)glutAddMenuEntry(_("   when files change"),RELOAD_FOLLOW);
     glutAddMenuEntry(_("Cancel"),STOP_RELOADING);
 
 
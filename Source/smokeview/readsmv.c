@@ -16,6 +16,7 @@
 #include "update.h"
 #include "smokeviewvars.h"
 #include "IOvolsmoke.h"
+#include "threadpool.h"
 
 #define BREAK break
 #define BREAK2 \
@@ -35,6 +36,468 @@
 #define ZVENT_1ROOM 1
 #define ZVENT_2ROOM 2
 
+/* ------------------ smv keyword table ------------------------ */
+
+// each keyword tested at the top level of a ReadSMV or ReadSMVDynamic pass and the passes that
+// test it.  a pass skips lines that do not start with one of its keywords (see SkipSMVLines),
+// so a keyword must be added here when it is handled by a new pass
+
+smvkeyworddata smvkeywordinfo[] = {
+  {"ALBEDO",             SMV_PASS1},
+  {"AMBIENT",            SMV_PASS3},
+  {"AUTOTERRAIN",        SMV_PASS1},
+  {"AVATAR_COLOR",       SMV_PASS1},
+  {"BGEOM",              SMV_PASS1|SMV_PASS2},
+  {"BNDC",               SMV_PASS1|SMV_PASS4},
+  {"BNDE",               SMV_PASS1|SMV_PASS4},
+  {"BNDF",               SMV_PASS1|SMV_PASS4},
+  {"BNDS",               SMV_PASS1|SMV_PASS4},
+  {"CADGEOM",            SMV_PASS1|SMV_PASS2},
+  {"CADTEXTUREPATH",     SMV_PASS1},
+  {"CHID",               SMV_PASS4},
+  {"CLASS_OF_HUMANS",    SMV_PASS1|SMV_PASS2|SMV_PASS4},
+  {"CLASS_OF_PARTICLES", SMV_PASS1|SMV_PASS2|SMV_PASS4},
+  {"CLOSE_CVENT",        SMV_DYNAMIC_PASS1|SMV_DYNAMIC_PASS2},
+  {"CLOSE_VENT",         SMV_DYNAMIC_PASS1|SMV_DYNAMIC_PASS2},
+  {"CSVF",               SMV_PASS1|SMV_PASS2},
+  {"CUTCELLS",           SMV_PASS3},
+  {"CVENT",              SMV_PASS1|SMV_PASS4},
+  {"DEVICE",             SMV_PASS1|SMV_PASS3},
+  {"DEVICE_ACT",         SMV_PASS1|SMV_PASS3|SMV_DYNAMIC_PASS1|SMV_DYNAMIC_PASS2},
+  {"ENDF",               SMV_PASS4},
+  {"EVA5",               SMV_PASS1|SMV_PASS4},
+  {"FDSVERSION",         SMV_PASS1},
+  {"FIRE",               SMV_PASS1|SMV_PASS4},
+  {"GEOM",               SMV_PASS1|SMV_PASS2},
+  {"GEOMDIAG",           SMV_PASS1|SMV_PASS2},
+  {"GRID",               SMV_PASS1|SMV_PASS2},
+  {"GVEC",               SMV_PASS1},
+  {"HEAT",               SMV_PASS1|SMV_PASS3},
+  {"HEAT_ACT",           SMV_DYNAMIC_PASS1},
+  {"HFLOWGEOM",          SMV_PASS1|SMV_PASS4},
+  {"HIDE_OBST",          SMV_DYNAMIC_PASS1|SMV_DYNAMIC_PASS2},
+  {"HRRPUVCUT",          SMV_PASS4},
+  {"HVENTGEOM",          SMV_PASS1|SMV_PASS4},
+  {"HVENTPOS",           SMV_PASS1|SMV_PASS4},
+  {"IBLANK",             SMV_PASS1},
+  {"ISOF",               SMV_PASS1|SMV_PASS4},
+  {"ISOG",               SMV_PASS1|SMV_PASS4},
+  {"LABEL",              SMV_PASS2},
+  {"MATERIAL",           SMV_PASS1|SMV_PASS2},
+  {"MFLOWGEOM",          SMV_PASS1|SMV_PASS4},
+  {"MFLOWPOS",           SMV_PASS4},
+  {"MINMAXBNDF",         SMV_PASS1|SMV_PASS5},
+  {"MINMAXPL3D",         SMV_PASS1|SMV_DYNAMIC_PASS1|SMV_DYNAMIC_PASS3},
+  {"MINMAXSLCF",         SMV_PASS1|SMV_PASS5},
+  {"MVENTGEOM",          SMV_PASS1|SMV_PASS4},
+  {"MVENTPOS",           SMV_PASS1|SMV_PASS4},
+  {"NORTHANGLE",         SMV_PASS1},
+  {"OBST",               SMV_PASS1|SMV_PASS2|SMV_PASS4|SMV_PASS5},
+  {"OFFSET",             SMV_PASS1|SMV_PASS2|SMV_PASS4|SMV_DYNAMIC_PASS1|SMV_DYNAMIC_PASS2},
+  {"OPEN_CVENT",         SMV_DYNAMIC_PASS1|SMV_DYNAMIC_PASS2},
+  {"OPEN_VENT",          SMV_DYNAMIC_PASS1|SMV_DYNAMIC_PASS2},
+  {"OUTLINE",            SMV_PASS1|SMV_PASS2},
+  {"PDIM",               SMV_PASS1|SMV_PASS4},
+  {"PL3D",               SMV_PASS1|SMV_PASS2|SMV_PASS3|SMV_PASS4|SMV_PASS5|SMV_DYNAMIC_PASS1|SMV_DYNAMIC_PASS2},
+  {"PROP",               SMV_PASS1|SMV_PASS2},
+  {"PRT5",               SMV_PASS1|SMV_PASS4},
+  {"RAMP",               SMV_PASS2},
+  {"ROOM",               SMV_PASS1|SMV_PASS2},
+  {"SGEOM",              SMV_PASS1|SMV_PASS2},
+  {"SHOW_OBST",          SMV_DYNAMIC_PASS1|SMV_DYNAMIC_PASS2},
+  {"SLCC",               SMV_PASS1|SMV_PASS4},
+  {"SLCD",               SMV_PASS1|SMV_PASS4},
+  {"SLCF",               SMV_PASS1|SMV_PASS4},
+  {"SLCT",               SMV_PASS1|SMV_PASS4},
+  {"SMOD",               SMV_PASS1|SMV_PASS3},
+  {"SMOD_ACT",           SMV_DYNAMIC_PASS1},
+  {"SMOKE3D",            SMV_PASS1|SMV_PASS4},
+  {"SMOKEDIFF",          SMV_PASS1},
+  {"SMOKF3D",            SMV_PASS1|SMV_PASS4},
+  {"SMOKG3D",            SMV_PASS1|SMV_PASS4},
+  {"SOLID_HT3D",         SMV_PASS1},
+  {"SPRK",               SMV_PASS1|SMV_PASS3},
+  {"SPRK_ACT",           SMV_DYNAMIC_PASS1},
+  {"SURFACE",            SMV_PASS1|SMV_PASS2},
+  {"SURFDEF",            SMV_PASS2},
+  {"TERRAIN",            SMV_PASS1|SMV_PASS2},
+  {"TERRAINIMAGE",       SMV_PASS1},
+  {"TEXTUREDIR",         SMV_PASS1},
+  {"THCP",               SMV_PASS1|SMV_PASS3},
+  {"TICKS",              SMV_PASS1|SMV_PASS2},
+  {"TISOF",              SMV_PASS1|SMV_PASS4},
+  {"TISOG",              SMV_PASS1|SMV_PASS4},
+  {"TITLE",              SMV_PASS1},
+  {"TOFFSET",            SMV_PASS1},
+  {"TREE",               SMV_PASS4},
+  {"TREESTATE",          SMV_PASS4},
+  {"TRNX",               SMV_PASS1|SMV_PASS4},
+  {"TRNY",               SMV_PASS1|SMV_PASS4},
+  {"TRNZ",               SMV_PASS1|SMV_PASS4},
+  {"USETEXTURES",        SMV_PASS1},
+  {"VENT",               SMV_PASS1|SMV_PASS4},
+  {"VENTGEOM",           SMV_PASS1|SMV_PASS4},
+  {"VFLOWGEOM",          SMV_PASS1|SMV_PASS4},
+  {"VFLOWPOS",           SMV_PASS4},
+  {"VIEWTIMES",          SMV_PASS1},
+  {"VSMOKE3D",           SMV_PASS1|SMV_PASS4},
+  {"VSMOKF3D",           SMV_PASS1|SMV_PASS4},
+  {"VSMOKG3D",           SMV_PASS1|SMV_PASS4},
+  {"VVENTGEOM",          SMV_PASS1|SMV_PASS4},
+  {"VVENTPOS",           SMV_PASS1|SMV_PASS4},
+  {"ZONE",               SMV_PASS1|SMV_PASS2},
+};
+
+/* ------------------ HashSMVKeyword ------------------------ */
+
+unsigned int HashSMVKeyword(char *keyword, unsigned int seed, int *lenptr){
+
+// FNV-1a hash of the first token of keyword, the token length is returned in lenptr
+
+  unsigned int hash;
+  int len;
+
+  hash = 2166136261u^seed;
+  for(len = 0; keyword[len]!=0&&isspace((unsigned char)keyword[len])==0; len++){
+    hash = (hash^(unsigned char)keyword[len])*16777619u;
+  }
+  *lenptr = len;
+  return hash;
+}
+
+/* ------------------ InitSMVKeywords ------------------------ */
+
+void InitSMVKeywords(void){
+
+// build a perfect hash table for smvkeywordinfo.  seeds (then table sizes) are tried
+// until no two keywords share a slot so a lookup needs only one comparison
+
+  int nkeywords, size;
+
+  if(smvkeyword_hash!=NULL)return;
+  nkeywords = sizeof(smvkeywordinfo)/sizeof(smvkeyworddata);
+  for(size = 256; size<2*nkeywords; size *= 2);
+  for(;;){
+    unsigned int seed;
+
+    NewMemory((void **)&smvkeyword_hash, size*sizeof(int));
+    for(seed = 0; seed<1000; seed++){
+      int i;
+
+      for(i = 0; i<size; i++){
+        smvkeyword_hash[i] = -1;
+      }
+      for(i = 0; i<nkeywords; i++){
+        int len, slot;
+
+        slot = HashSMVKeyword(smvkeywordinfo[i].keyword, seed, &len)&(size-1);
+        if(smvkeyword_hash[slot]>=0)break;
+        smvkeyword_hash[slot] = i;
+      }
+      if(i==nkeywords){
+        smvkeyword_hash_size = size;
+        smvkeyword_seed = seed;
+        return;
+      }
+    }
+    FREEMEMORY(smvkeyword_hash);
+    size *= 2;
+  }
+}
+
+/* ------------------ GetSMVKeyword ------------------------ */
+
+int GetSMVKeyword(char *line){
+
+// index in smvkeywordinfo of the keyword starting line, -1 if line does not start with a keyword
+
+  int len, index;
+  char *keyword;
+
+  if(line==NULL||line[0]==0||isspace((unsigned char)line[0])!=0)return -1;
+  index = smvkeyword_hash[HashSMVKeyword(line, smvkeyword_seed, &len)&(smvkeyword_hash_size-1)];
+  if(index<0)return -1;
+  keyword = smvkeywordinfo[index].keyword;
+  if(strncmp(line, keyword, len)!=0||keyword[len]!=0)return -1;
+  return index;
+}
+
+/* ------------------ IndexSMVLines ------------------------ */
+
+void IndexSMVLines(bufferstreamdata *stream){
+
+// classify each line of stream once by its keyword
+
+  filedata *fileinfo;
+  int i;
+
+  fileinfo = stream->fileinfo;
+  if(fileinfo==NULL)return;
+  InitSMVKeywords();
+  FREEMEMORY(fileinfo->line_keys);
+  if(fileinfo->nlines==0)return;
+  NewMemory((void **)&fileinfo->line_keys, fileinfo->nlines*sizeof(int));
+  for(i = 0; i<fileinfo->nlines; i++){
+    fileinfo->line_keys[i] = GetSMVKeyword(fileinfo->lines[i]);
+  }
+}
+
+/* ------------------ SkipSMVLines ------------------------ */
+
+void SkipSMVLines(bufferstreamdata *stream, int pass){
+
+// advance stream to the next line starting with a keyword tested by pass.  The lines
+// skipped would fail every keyword test of the pass
+
+  filedata *fileinfo;
+  int i;
+
+  fileinfo = stream->fileinfo;
+  if(fileinfo==NULL||fileinfo->line_keys==NULL)return;
+  for(i = fileinfo->iline; i<fileinfo->nlines; i++){
+    int key;
+
+    key = fileinfo->line_keys[i];
+    if(key>=0&&(smvkeywordinfo[key].passes&pass)!=0)break;
+  }
+  fileinfo->iline = i;
+}
+
+/* ------------------ HashSMVBuffer ------------------------ */
+
+unsigned long long HashSMVBuffer(char *buffer, FILE_SIZE nbuffer){
+
+// 64 bit FNV-1a hash of nbuffer characters of the .smv file
+
+  unsigned long long hash;
+  FILE_SIZE i;
+
+  hash = 14695981039346656037ull;
+  for(i = 0; i<nbuffer; i++){
+    hash = (hash^(unsigned char)buffer[i])*1099511628211ull;
+  }
+  return hash;
+}
+
+/* ------------------ HashSMVKeywordTable ------------------------ */
+
+unsigned int HashSMVKeywordTable(void){
+
+// hash of smvkeywordinfo so that a cache written by a smokeview with a different keyword table is not used
+
+  unsigned int hash;
+  int i, nkeywords;
+
+  hash = 2166136261u;
+  nkeywords = sizeof(smvkeywordinfo)/sizeof(smvkeyworddata);
+  for(i = 0; i<nkeywords; i++){
+    int len;
+
+    hash ^= HashSMVKeyword(smvkeywordinfo[i].keyword, 0, &len);
+    hash = (hash^(unsigned int)smvkeywordinfo[i].passes)*16777619u;
+  }
+  return hash;
+}
+
+/* ------------------ CloseSMVCache ------------------------ */
+
+void CloseSMVCache(void){
+  if(smvcache_mode==SMVCACHE_READ){
+    MUnmapFile(&smvcache_map);
+  }
+  if(smvcache_mode==SMVCACHE_RECORD){
+    FREEMEMORY(smvcache_obsts);
+    FREEMEMORY(smvcache_slices);
+  }
+  smvcache_obsts       = NULL;
+  smvcache_slices      = NULL;
+  nsmvcache_obsts      = 0;
+  nsmvcache_obsts_max  = 0;
+  ismvcache_obst       = 0;
+  nsmvcache_slices     = 0;
+  nsmvcache_slices_max = 0;
+  ismvcache_slice      = 0;
+  smvcache_mode        = SMVCACHE_OFF;
+}
+
+/* ------------------ SameSMVCacheHeader ------------------------ */
+
+int SameSMVCacheHeader(smvcacheheaderdata *header1, smvcacheheaderdata *header2){
+  if(strncmp(header1->magic, header2->magic, 8)!=0)return 0;
+  if(header1->version!=header2->version)return 0;
+  if(header1->nlines!=header2->nlines)return 0;
+  if(header1->nkeywords!=header2->nkeywords)return 0;
+  if(header1->keyword_hash!=header2->keyword_hash)return 0;
+  if(header1->smv_size!=header2->smv_size)return 0;
+  if(header1->smv_modtime!=header2->smv_modtime)return 0;
+  if(header1->smv_hash!=header2->smv_hash)return 0;
+  return 1;
+}
+
+/* ------------------ LoadSMVCache ------------------------ */
+
+int LoadSMVCache(bufferstreamdata *stream){
+
+// classify the lines of stream.  if smvcache_filename was written for this .smv file (same size, modification
+// time and hash) the line keywords, obstruction values and headers of unchanged slice files are taken from it
+// and 1 is returned.  otherwise the lines are classified, the values are recorded as they are parsed so
+// WriteSMVCache can save them and 0 is returned
+
+  filedata *fileinfo;
+
+  CloseSMVCache();
+  fileinfo = stream->fileinfo;
+  if(use_smvcache==0||fileinfo==NULL||fileinfo->nlines==0||smvcache_filename==NULL){
+    IndexSMVLines(stream);
+    return 0;
+  }
+
+  memset(&smvcache_header, 0, sizeof(smvcacheheaderdata));
+  strncpy(smvcache_header.magic, SMVCACHE_MAGIC, 8);
+  smvcache_header.version      = SMVCACHE_VERSION;
+  smvcache_header.nlines       = fileinfo->nlines;
+  smvcache_header.nkeywords    = sizeof(smvkeywordinfo)/sizeof(smvkeyworddata);
+  smvcache_header.keyword_hash = HashSMVKeywordTable();
+  smvcache_header.smv_size     = fileinfo->filesize;
+  smvcache_header.smv_modtime  = (long long)FileModtime(smv_filename);
+  smvcache_header.smv_hash     = HashSMVBuffer(fileinfo->buffer, fileinfo->filesize);
+
+  if(MMapFile(smvcache_filename, &smvcache_map, MMAP_SEQUENTIAL)==1){
+    smvcacheheaderdata *header;
+    unsigned char *data;
+
+    header = (smvcacheheaderdata *)smvcache_map.buffer;
+    if(smvcache_map.size>=sizeof(smvcacheheaderdata)&&SameSMVCacheHeader(header, &smvcache_header)==1&&
+       header->nobsts>=0&&header->nslices>=0&&
+       smvcache_map.size==sizeof(smvcacheheaderdata)+(FILE_SIZE)header->nlines*sizeof(int)+
+                          (FILE_SIZE)header->nobsts*sizeof(smvcacheobstdata)+(FILE_SIZE)header->nslices*sizeof(smvcacheslicedata)){
+      data = smvcache_map.buffer+sizeof(smvcacheheaderdata);
+
+      FREEMEMORY(fileinfo->line_keys);
+      NewMemory((void **)&fileinfo->line_keys, fileinfo->nlines*sizeof(int));
+      memcpy(fileinfo->line_keys, data, fileinfo->nlines*sizeof(int));
+      data += fileinfo->nlines*sizeof(int);
+
+      smvcache_obsts   = (smvcacheobstdata *)data;
+      nsmvcache_obsts  = header->nobsts;
+      data += header->nobsts*sizeof(smvcacheobstdata);
+
+      smvcache_slices  = (smvcacheslicedata *)data;
+      nsmvcache_slices = header->nslices;
+
+      smvcache_mode = SMVCACHE_READ;
+      return 1;
+    }
+    MUnmapFile(&smvcache_map);
+  }
+  IndexSMVLines(stream);
+  smvcache_mode = SMVCACHE_RECORD;
+  return 0;
+}
+
+/* ------------------ WriteSMVCache ------------------------ */
+
+void WriteSMVCache(filedata *fileinfo){
+
+// save the values recorded while parsing the .smv file.  the cache is only written when it was missing or stale
+
+  FILE *stream;
+
+  if(smvcache_mode==SMVCACHE_RECORD&&fileinfo!=NULL&&fileinfo->line_keys!=NULL){
+    stream = fopen(smvcache_filename, "wb");
+    if(stream!=NULL){
+      smvcache_header.nobsts  = nsmvcache_obsts;
+      smvcache_header.nslices = nsmvcache_slices;
+      fwrite(&smvcache_header, sizeof(smvcacheheaderdata), 1, stream);
+      fwrite(fileinfo->line_keys, sizeof(int), fileinfo->nlines, stream);
+      if(nsmvcache_obsts>0)fwrite(smvcache_obsts, sizeof(smvcacheobstdata), nsmvcache_obsts, stream);
+      if(nsmvcache_slices>0)fwrite(smvcache_slices, sizeof(smvcacheslicedata), nsmvcache_slices, stream);
+      fclose(stream);
+    }
+  }
+  CloseSMVCache();
+}
+
+/* ------------------ GetSMVCacheObst ------------------------ */
+
+smvcacheobstdata *GetSMVCacheObst(int line){
+
+// cached values of the obstruction defined on line, NULL if there are none.  lines are requested in increasing order
+
+  if(smvcache_mode!=SMVCACHE_READ)return NULL;
+  while(ismvcache_obst<nsmvcache_obsts&&smvcache_obsts[ismvcache_obst].line<line)ismvcache_obst++;
+  if(ismvcache_obst<nsmvcache_obsts&&smvcache_obsts[ismvcache_obst].line==line)return smvcache_obsts+ismvcache_obst++;
+  return NULL;
+}
+
+/* ------------------ AddSMVCacheObst ------------------------ */
+
+void AddSMVCacheObst(smvcacheobstdata *obsti){
+  if(smvcache_mode!=SMVCACHE_RECORD)return;
+  if(nsmvcache_obsts==nsmvcache_obsts_max){
+    nsmvcache_obsts_max = MAX(1024, 2*nsmvcache_obsts_max);
+    NewResizeMemory(smvcache_obsts, nsmvcache_obsts_max*sizeof(smvcacheobstdata));
+  }
+  memcpy(smvcache_obsts+nsmvcache_obsts++, obsti, sizeof(smvcacheobstdata));
+}
+
+/* ------------------ CopySMVCacheObst ------------------------ */
+
+void CopySMVCacheObst(smvcacheobstdata *from, smvcacheobstdata *to){
+
+// copy the values that sscanf found (in the order they appear on an OBST line) so that missing values keep their defaults
+
+  int i, nvals;
+
+  nvals = from->nvals;
+  for(i = 0; i<6; i++){
+    if(i<nvals)to->xyzEXACT[i] = from->xyzEXACT[i];
+  }
+  if(6<nvals)to->blockage_id = from->blockage_id;
+  for(i = 0; i<6; i++){
+    if(7+i<nvals)to->s_num[i] = from->s_num[i];
+  }
+  for(i = 0; i<3; i++){
+    if(13+i<nvals)to->t_origin[i] = from->t_origin[i];
+  }
+  to->nvals = nvals;
+}
+
+/* ------------------ GetSMVCacheSlice ------------------------ */
+
+smvcacheslicedata *GetSMVCacheSlice(int line, char *file){
+
+// cached header of the slice file named on line, NULL if there is none or if file was rewritten
+// (its size or modification time changed) after the cache was written.  lines are requested in increasing order
+
+  smvcacheslicedata *slicei;
+
+  if(smvcache_mode!=SMVCACHE_READ)return NULL;
+  while(ismvcache_slice<nsmvcache_slices&&smvcache_slices[ismvcache_slice].line<line)ismvcache_slice++;
+  if(ismvcache_slice>=nsmvcache_slices||smvcache_slices[ismvcache_slice].line!=line)return NULL;
+  slicei = smvcache_slices+ismvcache_slice++;
+  if(slicei->file_size!=GetFileSizeSMV(file)||slicei->file_modtime!=(long long)FileModtime(file))return NULL;
+  return slicei;
+}
+
+/* ------------------ AddSMVCacheSlice ------------------------ */
+
+void AddSMVCacheSlice(int line, char *file, int *ijk){
+  smvcacheslicedata *slicei;
+
+  if(smvcache_mode!=SMVCACHE_RECORD)return;
+  if(nsmvcache_slices==nsmvcache_slices_max){
+    nsmvcache_slices_max = MAX(1024, 2*nsmvcache_slices_max);
+    NewResizeMemory(smvcache_slices, nsmvcache_slices_max*sizeof(smvcacheslicedata));
+  }
+  slicei = smvcache_slices+nsmvcache_slices++;
+  slicei->line = line;
+  slicei->file_size = GetFileSizeSMV(file);
+  slicei->file_modtime = (long long)FileModtime(file);
+  slicei->dummy = 0;
+  memcpy(slicei->ijk, ijk, 6*sizeof(int));
+}
+
 /* ------------------ ReadHRR ------------------------ */
 #define LENBUFFER 1024
 void ReadHRR(int flag, int *errorcode){
@@ -468,6 +931,7 @@ void InitMesh(meshdata *meshi){
   meshi->patchval_iframe = NULL;
   meshi->thresholdtime = NULL;
   meshi->patchblank = NULL;
+  meshi->boundary_vbo.defined = 0;
   meshi->patch_contours = NULL;
   meshi->patch_timeslist = NULL;
   meshi->ntc = 0;
@@ -494,6 +958,7 @@ void InitMesh(meshdata *meshi){
 
   meshi->faceinfo = NULL;
   meshi->face_normals_single = NULL;
+  meshi->face_vbo.defined = 0;
   meshi->face_normals_double = NULL;
   meshi->face_transparent_double = NULL;
   meshi->face_textures = NULL;
@@ -580,6 +1045,488 @@ ventdata *GetCloseVent(meshdata *ventmesh, int ivent){
   return close_vent;
 }
 
+/* ------------------ SetDeviceActTime ------------------------ */
+
+void SetDeviceActTime(int type, int nn, float time_local){
+
+// set the activation time of the nn'th device of the given type (heat detector, sprinkler or smoke detector)
+
+  int idev;
+  int count=0;
+
+  for(idev=0;idev<ndeviceinfo;idev++){
+    devicedata *devicei;
+
+    devicei = deviceinfo + idev;
+    if(devicei->type==type){
+      count++;
+      if(nn==count){
+        devicei->act_time=time_local;
+        break;
+      }
+    }
+  }
+}
+
+/* ------------------ ReadMinMaxPL3D ------------------------ */
+
+void ReadMinMaxPL3D(bufferstreamdata *stream){
+
+// read the plot3d file name and bounds following a MINMAXPL3D keyword
+
+  char buffer[255], *file_ptr, file2[1024];
+  float valmin[5], valmax[5];
+  float percentile_min[5], percentile_max[5];
+  int i;
+
+  FGETS(buffer,255,stream);
+  strcpy(file2,buffer);
+  file_ptr = file2;
+  TrimBack(file2);
+  file_ptr = TrimFront(file2);
+
+  for(i=0;i<5;i++){
+    FGETS(buffer,255,stream);
+    sscanf(buffer,"%f %f %f %f",valmin +i,valmax+i, percentile_min+i,percentile_max+i);
+  }
+
+  for(i=0;i<nplot3dinfo;i++){
+    plot3ddata *plot3di;
+
+    plot3di = plot3dinfo + i;
+    if(strcmp(file_ptr,plot3di->file)==0){
+      int j;
+
+      for(j=0;j<5;j++){
+        plot3di->diff_valmin[j]=percentile_min[j];
+        plot3di->diff_valmax[j]=percentile_max[j];
+      }
+      break;
+    }
+  }
+}
+
+/* ------------------ ParsePL3DDynamic ------------------------ */
+
+int ParsePL3DDynamic(bufferstreamdata *stream, plot3ddata *plot3di, char *bufferptr){
+
+// set the file names of plot3di to bufferptr and read its labels.  returns 1 if the plot3d file exists and
+// its labels were read, 0 otherwise
+
+  int len;
+
+  len = strlen(bufferptr);
+  NewMemory((void **)&plot3di->reg_file,(unsigned int)(len+1));
+  STRCPY(plot3di->reg_file,bufferptr);
+
+  NewMemory((void **)&plot3di->comp_file,(unsigned int)(len+4+1));
+  STRCPY(plot3di->comp_file,bufferptr);
+  STRCAT(plot3di->comp_file,".svz");
+
+  //   if(FILE_EXISTS_CASEDIR(plot3di->comp_file)==YES){
+  //     plot3di->compression_type=COMPRESSED_ZLIB;
+  //     plot3di->file=plot3di->comp_file;
+  //   }
+  //   else{
+  //     plot3di->compression_type=UNCOMPRESSED;
+  //     plot3di->file=plot3di->reg_file;
+  //   }
+  //disable compression for now
+  plot3di->compression_type=UNCOMPRESSED;
+  plot3di->file=plot3di->reg_file;
+
+  if(fast_startup==1||FILE_EXISTS_CASEDIR(plot3di->file)==YES){
+    int n;
+    int read_ok = YES;
+#ifdef pp_PLOT3D_STATIC
+    char *label_buffer;
+#endif
+
+    plot3di->u = -1;
+    plot3di->v = -1;
+    plot3di->w = -1;
+    for(n = 0;n<5;n++){
+#ifdef pp_PLOT3D_STATIC
+      label_buffer = plot3dlabels + (plot3di-plot3dinfo)*MAXPLOT3DLABELSIZE*6*3 + n*61*3;
+      if(ReadPlot3DLabels(&plot3di->label[n], stream, NULL, label_buffer)!=LABEL_OK){
+#else
+      if(ReadLabels(&plot3di->label[n], stream, NULL)!=LABEL_OK){
+#endif
+        read_ok=NO;
+        break;
+      }
+      if(STRCMP(plot3di->label[n].shortlabel, "U-VEL")==0){
+        plot3di->u = n;
+      }
+      if(STRCMP(plot3di->label[n].shortlabel, "V-VEL")==0){
+        plot3di->v = n;
+      }
+      if(STRCMP(plot3di->label[n].shortlabel, "W-VEL")==0){
+        plot3di->w = n;
+      }
+    }
+    if(read_ok==NO)return 0;
+    if(plot3di->u>-1||plot3di->v>-1||plot3di->w>-1){
+      plot3di->nvars = MAXPLOT3DVARS;
+    }
+    else{
+      plot3di->nvars = 5;
+    }
+#ifdef pp_PLOT3D_STATIC
+    label_buffer = plot3dlabels + (plot3di-plot3dinfo)*MAXPLOT3DLABELSIZE*6*3 + 5*61*3;
+    plot3di->label[5].longlabel = label_buffer;
+    plot3di->label[5].shortlabel = label_buffer+MAXPLOT3DLABELSIZE;
+    plot3di->label[5].unit       = label_buffer+2*MAXPLOT3DLABELSIZE;
+#else
+    if(NewMemory((void **)&plot3di->label[5].longlabel, 6)==0)return 0;
+    if(NewMemory((void **)&plot3di->label[5].shortlabel, 6)==0)return 0;
+    if(NewMemory((void **)&plot3di->label[5].unit, 4)==0)return 0;
+#endif
+
+    STRCPY(plot3di->label[5].longlabel, "Speed");
+    STRCPY(plot3di->label[5].shortlabel, "Speed");
+    STRCPY(plot3di->label[5].unit, "m/s");
+
+    STRCPY(plot3di->longlabel, "");
+    for(n = 0;n<5;n++){
+      STRCAT(plot3di->longlabel, plot3di->label[n].shortlabel);
+      if(n!=4)STRCAT(plot3di->longlabel, ", ");
+    }
+
+    return 1;
+  }
+  else{
+    int n;
+
+    for(n = 0;n<5;n++){
+      if(ReadLabels(&plot3di->label[n], stream, NULL)==LABEL_ERR)break;
+    }
+  }
+  return 0;
+}
+
+/* ------------------ SMVDynamicDataLines ------------------------ */
+
+int SMVDynamicDataLines(int key){
+
+// number of lines following a keyword line that belong to a record read by ReadSMVDynamic
+
+  char *keyword;
+
+  if(key<0||(smvkeywordinfo[key].passes&(SMV_DYNAMIC_PASS1|SMV_DYNAMIC_PASS2|SMV_DYNAMIC_PASS3))==0)return 0;
+  keyword = smvkeywordinfo[key].keyword;
+  if(strcmp(keyword, "OFFSET")==0)return 0;
+  if(strcmp(keyword, "PL3D")==0)return 1+5*3;
+  if(strcmp(keyword, "MINMAXPL3D")==0)return 1+5;
+  return 1;
+}
+
+/* ------------------ GetSMVDynamicLines ------------------------ */
+
+int GetSMVDynamicLines(filedata *fileinfo, int iline){
+
+// number of lines of fileinfo before the first incomplete record at or after iline.  FDS may still be
+// writing the .smv file so a record missing some of its data lines is left for the next call to
+// ReadSMVDynamic (File2Buffer already leaves a last line without an end of line out of nlines)
+
+  int i, nlines;
+
+  nlines = fileinfo->nlines;
+  if(nlines==0)return 0;
+  if(fileinfo->line_keys==NULL)return nlines;
+  for(i = iline; i<nlines; i++){
+    if(i+SMVDynamicDataLines(fileinfo->line_keys[i])>=nlines)return i;
+  }
+  return nlines;
+}
+
+/* ------------------ SetSMVDynamicEnd ------------------------ */
+
+void SetSMVDynamicEnd(filedata *fileinfo, FILE_SIZE buffer_offset, int ioffset, int nn_plot3d){
+
+// remember where ReadSMVDynamic stopped (fileinfo->nlines lines were parsed, buffer_offset is the
+// position of fileinfo->buffer in the .smv file) and a hash of the characters before that point so
+// that the next call can check that the file was only appended to and parse just the new records
+
+  FILE_SIZE end;
+
+  if(fileinfo==NULL||fileinfo->nlines==0){
+    smvdynamic_offset = 0;
+    return;
+  }
+  end = fileinfo->lines[fileinfo->nlines]-fileinfo->buffer;
+  smvdynamic_offset    = buffer_offset+end;
+  smvdynamic_nchecked  = MIN(end, SMVDYNAMIC_NCHECK);
+  smvdynamic_check     = HashSMVBuffer(fileinfo->buffer+end-smvdynamic_nchecked, smvdynamic_nchecked);
+  smvdynamic_ioffset   = ioffset;
+  smvdynamic_nn_plot3d = nn_plot3d;
+}
+
+/* ------------------ GetSMVDynamicMesh ------------------------ */
+
+meshdata *GetSMVDynamicMesh(char *buffer, int ioffset, int col){
+
+// mesh of a dynamic record, given by the number starting at column col of buffer or else by the
+// number of OFFSET keywords before the record
+
+  int blocknumber = 0;
+
+  if(nmeshes>1)blocknumber = ioffset-1;
+  if((int)strlen(buffer)>col){
+    int blocktemp = 0;
+
+    sscanf(buffer+col, "%i", &blocktemp);
+    if(blocktemp>0&&blocktemp<=nmeshes)blocknumber = blocktemp-1;
+  }
+  blocknumber = CLAMP(blocknumber, 0, nmeshes-1);
+  return meshinfo+blocknumber;
+}
+
+/* ------------------ ReadSMVDynamicAppend ------------------------ */
+
+int ReadSMVDynamicAppend(char *file){
+
+// parse only the records appended to the .smv file since the last call to ReadSMVDynamic.  returns 0
+// if the file was changed before that point, it must then be read from the start
+
+  bufferstreamdata streaminfo, *stream = &streaminfo;
+  filedata *fileinfo;
+  FILE_SIZE buffer_offset;
+  int ioffset, nn_plot3d, iline;
+  int nplot3d_new = 0, update_faces = 0, update_times = 0;
+
+  buffer_offset = smvdynamic_offset-smvdynamic_nchecked;
+  fileinfo = File2BufferOffset(file, buffer_offset);
+  if(fileinfo==NULL)return 0;
+  stream->fileinfo = fileinfo;
+  if(fileinfo->filesize-1<smvdynamic_nchecked||
+     HashSMVBuffer(fileinfo->buffer, smvdynamic_nchecked)!=smvdynamic_check){
+    FCLOSE(stream);
+    return 0;
+  }
+
+  // the first new line starts right after the characters that were checked.  lines[nlines] is the
+  // end of the last complete line so iline==nlines means nothing new has been completely written yet
+
+  for(iline = 0; iline<=fileinfo->nlines; iline++){
+    if((FILE_SIZE)(fileinfo->lines[iline]-fileinfo->buffer)==smvdynamic_nchecked)break;
+  }
+  if(iline>fileinfo->nlines){
+    FCLOSE(stream);
+    return 0;
+  }
+  if(iline==fileinfo->nlines){
+    FCLOSE(stream);
+    return 1;
+  }
+  IndexSMVLines(stream);
+  fileinfo->nlines = GetSMVDynamicLines(fileinfo, iline);
+  fileinfo->iline  = iline;
+  ioffset   = smvdynamic_ioffset;
+  nn_plot3d = smvdynamic_nn_plot3d;
+
+  for(;;){
+    char buffer[255];
+    meshdata *meshi;
+    float time_local;
+    int tempval;
+
+    SkipSMVLines(stream, SMV_DYNAMIC_PASS1|SMV_DYNAMIC_PASS2|SMV_DYNAMIC_PASS3);
+    if(FGETS(buffer,255,stream)==NULL)break;
+    if(strncmp(buffer," ",1)==0||buffer[0]==0)continue;
+    if(Match(buffer,"OFFSET") == 1){
+      ioffset++;
+      continue;
+    }
+    if(Match(buffer,"PL3D") == 1){
+      plot3ddata *plot3di;
+      char buffer2[255], *bufferptr;
+      int blocktemp = 0;
+
+      if(setup_only==1||smoke3d_only==1)continue;
+#ifdef pp_PLOT3D_STATIC
+      FCLOSE(stream);  // plot3d labels are stored in one block that is only allocated by a full read
+      return 0;
+#endif
+      nn_plot3d++;
+      TrimBack(buffer);
+      meshi = meshinfo;
+      if(nmeshes>1&&ioffset>0)meshi = meshinfo+ioffset-1;
+      time_local = -1.0;
+      if(strlen(buffer)>5){
+        sscanf(buffer,"%s %f %i",buffer2,&time_local,&blocktemp);
+        if(blocktemp>0&&blocktemp<=nmeshes)meshi = meshinfo+blocktemp-1;
+      }
+      FGETS(buffer,255,stream);
+      bufferptr = TrimFrontBack(buffer);
+      NewResizeMemory(plot3dinfo, (nplot3dinfo+1)*sizeof(plot3ddata));
+      plot3di = plot3dinfo+nplot3dinfo;
+      plot3di->blocknumber = meshi-meshinfo;
+      plot3di->seq_id      = nn_plot3d;
+      plot3di->autoload    = 0;
+      plot3di->time        = time_local;
+      plot3di->loaded      = 0;
+      plot3di->display     = 0;
+      if(ParsePL3DDynamic(stream, plot3di, bufferptr)==1){
+        nplot3dinfo++;
+        nplot3d_new++;
+      }
+      continue;
+    }
+    if(Match(buffer,"MINMAXPL3D") == 1){
+      ReadMinMaxPL3D(stream);
+      continue;
+    }
+    if(Match(buffer,"OPEN_VENT") == 1||Match(buffer,"CLOSE_VENT")==1||
+       Match(buffer, "OPEN_CVENT") == 1 || Match(buffer, "CLOSE_CVENT") == 1){
+      int showvent, isvent;
+      float **showtime;
+      unsigned char **showhide;
+      int *nshowtime;
+
+      isvent = 0;
+      if(Match(buffer, "CLOSE_VENT") == 1 || Match(buffer, "OPEN_VENT") == 1)isvent = 1;
+      showvent = 1;
+      if(Match(buffer,"CLOSE_VENT") == 1 || Match(buffer, "CLOSE_CVENT") == 1)showvent = 0;
+      TrimBack(buffer);
+      meshi = GetSMVDynamicMesh(buffer, ioffset, showvent==1 ? 10 : 11);
+      FGETS(buffer,255,stream);
+      sscanf(buffer,"%i %f",&tempval,&time_local);
+      tempval--;
+      if(isvent==1){
+        ventdata *vi;
+
+        if(meshi->ventinfo == NULL || tempval < 0 || tempval >= meshi->nvents)continue;
+        vi = GetCloseVent(meshi, tempval);
+        showtime  = &vi->showtime;
+        showhide  = &vi->showhide;
+        nshowtime = &vi->nshowtime;
+      }
+      else{
+        cventdata *cvi;
+
+        if(meshi->cventinfo == NULL || tempval < 0 || tempval >= meshi->ncvents)continue;
+        cvi = meshi->cventinfo + tempval;
+        showtime  = &cvi->showtime;
+        showhide  = &cvi->showhide;
+        nshowtime = &cvi->nshowtime;
+      }
+      if(*showtime==NULL){
+        NewMemory((void **)showtime, 2*sizeof(float));
+        NewMemory((void **)showhide, 2*sizeof(unsigned char));
+        (*showtime)[0] = 0.0;
+        (*showhide)[0] = 1;
+        *nshowtime = 1;
+        update_faces = 1;
+      }
+      else{
+        ResizeMemory((void **)showtime, (*nshowtime+1)*sizeof(float));
+        ResizeMemory((void **)showhide, (*nshowtime+1)*sizeof(unsigned char));
+      }
+      (*showhide)[*nshowtime] = showvent;
+      (*showtime)[(*nshowtime)++] = time_local;
+      update_times = 1;
+      continue;
+    }
+    if(Match(buffer,"SHOW_OBST") == 1||Match(buffer,"HIDE_OBST")==1){
+      blockagedata *bc;
+      int showobst;
+
+      showobst = 0;
+      if(Match(buffer,"SHOW_OBST") == 1)showobst = 1;
+      meshi = GetSMVDynamicMesh(buffer, ioffset, 10);
+      FGETS(buffer,255,stream);
+      sscanf(buffer,"%i %f",&tempval,&time_local);
+      tempval--;
+      if(tempval<0||tempval>=meshi->nbptrs)continue;
+      bc = meshi->blockageinfoptrs[tempval];
+      if(bc->showtime==NULL){
+        NewMemory((void **)&bc->showtime, 2*sizeof(float));
+        NewMemory((void **)&bc->showhide, 2*sizeof(unsigned char));
+        bc->nshowtime = 0;
+        if(time_local!=0.0){
+          bc->nshowtime = 1;
+          bc->showtime[0] = 0.0;
+          bc->showhide[0] = 1-showobst;
+        }
+        update_faces = 1;
+      }
+      else{
+        ResizeMemory((void **)&bc->showtime, (bc->nshowtime+1)*sizeof(float));
+        ResizeMemory((void **)&bc->showhide, (bc->nshowtime+1)*sizeof(unsigned char));
+      }
+      bc->showhide[bc->nshowtime] = showobst;
+      bc->showtime[bc->nshowtime++] = time_local;
+      update_times = 1;
+      continue;
+    }
+    if(Match(buffer,"DEVICE_ACT") == 1){
+      devicedata *devicei;
+      int idevice;
+      float act_time;
+      int act_state = 1;
+
+      FGETS(buffer,255,stream);
+      sscanf(buffer,"%i %f %i",&idevice,&act_time,&act_state);
+      idevice--;
+      if(idevice<0||idevice>=ndeviceinfo)continue;
+      devicei = deviceinfo + idevice;
+      devicei->act_time = act_time;
+      if(devicei->act_times==NULL){
+        NewMemory((void **)&devicei->act_times, 2*sizeof(float));
+        NewMemory((void **)&devicei->state_values, 2*sizeof(int));
+        devicei->act_times[0]    = 0.0;
+        devicei->state_values[0] = devicei->state0;
+        devicei->nstate_changes  = 1;
+        devicei->istate_changes  = 1;
+      }
+      else{
+        ResizeMemory((void **)&devicei->act_times, (devicei->nstate_changes+1)*sizeof(float));
+        ResizeMemory((void **)&devicei->state_values, (devicei->nstate_changes+1)*sizeof(int));
+      }
+      devicei->act_times[devicei->istate_changes]      = act_time;
+      devicei->state_values[devicei->istate_changes++] = act_state;
+      devicei->nstate_changes++;
+      update_times = 1;
+      continue;
+    }
+    if(Match(buffer,"HEAT_ACT") == 1||Match(buffer,"SPRK_ACT") == 1||Match(buffer,"SMOD_ACT") == 1){
+      int nn, type;
+
+      type = DEVICE_SMOKE;
+      if(Match(buffer,"HEAT_ACT") == 1)type = DEVICE_HEAT;
+      if(Match(buffer,"SPRK_ACT") == 1)type = DEVICE_SPRK;
+      meshi = GetSMVDynamicMesh(buffer, ioffset, 9);
+      FGETS(buffer,255,stream);
+      sscanf(buffer,"%i %f",&nn,&time_local);
+      if(type==DEVICE_HEAT){
+        if(meshi->theat==NULL||nn<1||nn>meshi->nheat)continue;
+        meshi->theat[nn-1] = time_local;
+      }
+      if(type==DEVICE_SPRK){
+        if(meshi->tspr==NULL||nn<1||nn>meshi->nspr)continue;
+        meshi->tspr[nn-1] = time_local;
+      }
+      SetDeviceActTime(type, nn, time_local);
+      continue;
+    }
+  }
+  SetSMVDynamicEnd(fileinfo, buffer_offset, ioffset, nn_plot3d);
+  FCLOSE(stream);
+
+  // only update what the new records changed
+
+  if(update_faces==1)updatefacelists = 1;
+  if(nplot3d_new>0){
+    updatemenu = 1;
+    UpdatePlot3dMenuLabels();
+    InitPlot3dTimeList();
+    update_times = 1;
+  }
+  if(update_times==1)UpdateTimes();
+  return 1;
+}
+
 /* ------------------ ReadSMVDynamic ------------------------ */
 
 void ReadSMVDynamic(char *file){
@@ -591,7 +1538,10 @@ void ReadSMVDynamic(char *file){
   int nplot3dinfo_old;
   bufferstreamdata streaminfo, *stream=&streaminfo;
 
+  if(smvdynamic_offset>0&&ReadSMVDynamicAppend(file)==1)return;
   stream->fileinfo = File2Buffer(file);
+  IndexSMVLines(stream);
+  if(stream->fileinfo!=NULL)stream->fileinfo->nlines = GetSMVDynamicLines(stream->fileinfo, 0);
 
   nplot3dinfo_old=nplot3dinfo;
 
@@ -660,6 +1610,7 @@ void ReadSMVDynamic(char *file){
   for(;;){
     char buffer[255],buffer2[255];
 
+    SkipSMVLines(stream, SMV_DYNAMIC_PASS1);
     if(FGETS(buffer,255,stream)==NULL)break;
     if(strncmp(buffer," ",1)==0||buffer[0]==0)continue;
   /*
@@ -837,22 +1788,8 @@ void ReadSMVDynamic(char *file){
       FGETS(buffer,255,stream);
       sscanf(buffer,"%i %f",&nn,&time_local);
       if(meshi->theat!=NULL && nn>=1 && nn <= meshi->nheat){
-        int idev;
-        int count=0;
-
         meshi->theat[nn-1]=time_local;
-        for(idev=0;idev<ndeviceinfo;idev++){
-          devicedata *devicei;
-
-          devicei = deviceinfo + idev;
-          if(devicei->type==DEVICE_HEAT){
-            count++;
-            if(nn==count){
-              devicei->act_time=time_local;
-              break;
-            }
-          }
-        }
+        SetDeviceActTime(DEVICE_HEAT, nn, time_local);
       }
       continue;
     }
@@ -880,23 +1817,8 @@ void ReadSMVDynamic(char *file){
       FGETS(buffer,255,stream);
       sscanf(buffer,"%i %f",&nn,&time_local);
       if(meshi->tspr!=NULL && nn <= meshi->nspr && nn > 0){
-        int idev;
-        int count=0;
-
         meshi->tspr[nn-1]=time_local;
-
-        for(idev=0;idev<ndeviceinfo;idev++){
-          devicedata *devicei;
-
-          devicei = deviceinfo + idev;
-          if(devicei->type==DEVICE_SPRK){
-            count++;
-            if(nn==count){
-              devicei->act_time=time_local;
-              break;
-            }
-          }
-        }
+        SetDeviceActTime(DEVICE_SPRK, nn, time_local);
       }
       continue;
     }
@@ -906,24 +1828,11 @@ void ReadSMVDynamic(char *file){
     +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
   */
     if(Match(buffer,"SMOD_ACT") == 1){
-      int idev;
-      int count=0;
       int nn;
 
       FGETS(buffer,255,stream);
       sscanf(buffer,"%i %f",&nn,&time_local);
-      for(idev=0;idev<ndeviceinfo;idev++){
-        devicedata *devicei;
-
-        devicei = deviceinfo + idev;
-        if(devicei->type==DEVICE_SMOKE){
-          count++;
-          if(nn==count){
-            devicei->act_time=time_local;
-            break;
-          }
-        }
-      }
+      SetDeviceActTime(DEVICE_SMOKE, nn, time_local);
       continue;
     }
   /*
@@ -940,6 +1849,8 @@ void ReadSMVDynamic(char *file){
 
   // ------------------------------- pass 1 dynamic - end ------------------------------------
 
+  smvdynamic_ioffset = ioffset;
+
   if(nplot3dinfo>0){
     if(plot3dinfo==NULL){
       NewMemory((void **)&plot3dinfo,nplot3dinfo*sizeof(plot3ddata));
@@ -969,6 +1880,7 @@ void ReadSMVDynamic(char *file){
   while(do_pass2==1){
     char buffer[255],buffer2[255];
 
+    SkipSMVLines(stream, SMV_DYNAMIC_PASS2);
     if(FGETS(buffer,255,stream)==NULL)break;
     if(strncmp(buffer," ",1)==0||buffer[0]==0)continue;
   /*
@@ -987,14 +1899,13 @@ void ReadSMVDynamic(char *file){
   */
     if(Match(buffer,"PL3D") == 1){
       plot3ddata *plot3di;
-      int len,blocknumber,blocktemp;
+      int blocknumber,blocktemp;
       char *bufferptr;
 
       if(setup_only==1||smoke3d_only==1)continue;
       if(minmaxpl3d==1)do_pass3=1;
       nn_plot3d++;
       TrimBack(buffer);
-      len=strlen(buffer);
       blocknumber = 0;
       if(nmeshes>1){
         blocknumber=ioffset-1;
@@ -1014,7 +1925,6 @@ void ReadSMVDynamic(char *file){
         break;
       }
       bufferptr=TrimFrontBack(buffer);
-      len=strlen(bufferptr);
 
       plot3di=plot3dinfo+iplot3d;
       plot3di->blocknumber=blocknumber;
@@ -1026,94 +1936,10 @@ void ReadSMVDynamic(char *file){
         plot3di->display=0;
       }
 
-      NewMemory((void **)&plot3di->reg_file,(unsigned int)(len+1));
-      STRCPY(plot3di->reg_file,bufferptr);
-
-      NewMemory((void **)&plot3di->comp_file,(unsigned int)(len+4+1));
-      STRCPY(plot3di->comp_file,bufferptr);
-      STRCAT(plot3di->comp_file,".svz");
-
-   //   if(FILE_EXISTS_CASEDIR(plot3di->comp_file)==YES){
-   //     plot3di->compression_type=COMPRESSED_ZLIB;
-   //     plot3di->file=plot3di->comp_file;
-   //   }
-   //   else{
-   //     plot3di->compression_type=UNCOMPRESSED;
-   //     plot3di->file=plot3di->reg_file;
-   //   }
-      //disable compression for now
-      plot3di->compression_type=UNCOMPRESSED;
-      plot3di->file=plot3di->reg_file;
-
-      if(fast_startup==1||FILE_EXISTS_CASEDIR(plot3di->file)==YES){
-        int n;
-        int read_ok = YES;
-#ifdef pp_PLOT3D_STATIC
-        char *label_buffer;
-#endif
-
-        plot3di->u = -1;
-        plot3di->v = -1;
-        plot3di->w = -1;
-        for(n = 0;n<5;n++){
-#ifdef pp_PLOT3D_STATIC
-          label_buffer = plot3dlabels + (plot3di-plot3dinfo)*MAXPLOT3DLABELSIZE*6*3 + n*61*3;
-          if(ReadPlot3DLabels(&plot3di->label[n], stream, NULL, label_buffer)!=LABEL_OK){
-#else
-          if(ReadLabels(&plot3di->label[n], stream, NULL)!=LABEL_OK){
-#endif
-            read_ok=NO;
-            break;
-          }
-          if(STRCMP(plot3di->label[n].shortlabel, "U-VEL")==0){
-            plot3di->u = n;
-          }
-          if(STRCMP(plot3di->label[n].shortlabel, "V-VEL")==0){
-            plot3di->v = n;
-          }
-          if(STRCMP(plot3di->label[n].shortlabel, "W-VEL")==0){
-            plot3di->w = n;
-          }
-        }
-        if(read_ok==NO){
-          nplot3dinfo--;
-          continue;
-        }
-        if(plot3di->u>-1||plot3di->v>-1||plot3di->w>-1){
-          plot3di->nvars = MAXPLOT3DVARS;
-        }
-        else{
-          plot3di->nvars = 5;
-        }
-#ifdef pp_PLOT3D_STATIC
-        label_buffer = plot3dlabels + (plot3di-plot3dinfo)*MAXPLOT3DLABELSIZE*6*3 + 5*61*3;
-        plot3di->label[5].longlabel = label_buffer;
-        plot3di->label[5].shortlabel = label_buffer+MAXPLOT3DLABELSIZE;
-        plot3di->label[5].unit       = label_buffer+2*MAXPLOT3DLABELSIZE;
-#else
-        if(NewMemory((void **)&plot3di->label[5].longlabel, 6)==0)return;
-        if(NewMemory((void **)&plot3di->label[5].shortlabel, 6)==0)return;
-        if(NewMemory((void **)&plot3di->label[5].unit, 4)==0)return;
-#endif
-
-        STRCPY(plot3di->label[5].longlabel, "Speed");
-        STRCPY(plot3di->label[5].shortlabel, "Speed");
-        STRCPY(plot3di->label[5].unit, "m/s");
-
-        STRCPY(plot3di->longlabel, "");
-        for(n = 0;n<5;n++){
-          STRCAT(plot3di->longlabel, plot3di->label[n].shortlabel);
-          if(n!=4)STRCAT(plot3di->longlabel, ", ");
-        }
-
+      if(ParsePL3DDynamic(stream, plot3di, bufferptr)==1){
         iplot3d++;
       }
       else{
-        int n;
-
-        for(n = 0;n<5;n++){
-          if(ReadLabels(&plot3di->label[n], stream, NULL)==LABEL_ERR)break;
-        }
         nplot3dinfo--;
       }
       continue;
@@ -1302,6 +2128,7 @@ void ReadSMVDynamic(char *file){
   while(do_pass3==1){
     char buffer[255];
 
+    SkipSMVLines(stream, SMV_DYNAMIC_PASS3);
     if(FGETS(buffer,255,stream)==NULL)break;
     if(strncmp(buffer," ",1)==0||buffer[0]==0)continue;
   /*
@@ -1310,38 +2137,11 @@ void ReadSMVDynamic(char *file){
     +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
   */
     if(Match(buffer,"MINMAXPL3D") == 1){
-      char *file_ptr, file2[1024];
-      float valmin[5], valmax[5];
-      float percentile_min[5], percentile_max[5];
-
-      FGETS(buffer,255,stream);
-      strcpy(file2,buffer);
-      file_ptr = file2;
-      TrimBack(file2);
-      file_ptr = TrimFront(file2);
-
-      for(i=0;i<5;i++){
-        FGETS(buffer,255,stream);
-        sscanf(buffer,"%f %f %f %f",valmin +i,valmax+i, percentile_min+i,percentile_max+i);
-      }
-
-      for(i=0;i<nplot3dinfo;i++){
-        plot3ddata *plot3di;
-
-        plot3di = plot3dinfo + i;
-        if(strcmp(file_ptr,plot3di->file)==0){
-          int j;
-
-          for(j=0;j<5;j++){
-            plot3di->diff_valmin[j]=percentile_min[j];
-            plot3di->diff_valmax[j]=percentile_max[j];
-          }
-          break;
-        }
-      }
+      ReadMinMaxPL3D(stream);
       continue;
     }
   }
+  SetSMVDynamicEnd(stream->fileinfo, 0, smvdynamic_ioffset, nn_plot3d);
   FCLOSE(stream);
   UpdatePlot3dMenuLabels();
   InitPlot3dTimeList();
@@ -3868,27 +4668,59 @@ void SetupMeshWallsNew(void){
     }
   }
 }
+/* ------------------ MtStatCaseFiles ------------------------ */
+
+void *MtStatCaseFiles(void *arg){
+  int i;
+
+  for(i = *(int *)arg; i<nstat_casefiles; i += nstat_casefile_tasks){
+    StatDirCacheFile(stat_casefiles[i]);
+  }
+  return NULL;
+}
+
 /* ------------------ MakeFileLists ------------------------ */
 
 void MakeFileLists(void){
-  char filter_casedir[256], filter_casename[256];
 
-  // create list of all files for the case being visualized (casename*.* )
+// scan the case directory once.  existence, size and time checks of files in the
+// case directory are then answered from this scan while the case is opened
 
-  strcpy(filter_casename, "");
-  if(fdsprefix != NULL&&strlen(fdsprefix) > 0){
-    strcat(filter_casename, fdsprefix);
-    strcat(filter_casename, "*");
-  }
+  filelistdata *files;
+  int i, nfiles, lenprefix;
+
+  MakeDirCache(".");
+  if(stat_sweep==0||fdsprefix==NULL)return;
 
-  // create a list of all files in the current directory
+  // stat the casename* files in parallel so that their sizes and times are known before
+  // they are needed, on network file systems the requests then overlap
 
-  nfilelist_casename = GetFileListSize(".", filter_casename);
-  MakeFileList(".", filter_casename, nfilelist_casename, YES, &filelist_casename);
+  files = GetDirCache(&nfiles);
+  FREEMEMORY(stat_casefiles);
+  NewMemory((void **)&stat_casefiles, MAX(nfiles, 1)*sizeof(filelistdata *));
+  nstat_casefiles = 0;
+  lenprefix = strlen(fdsprefix);
+  for(i = 0; i<nfiles; i++){
+    if(strncmp(files[i].file, fdsprefix, lenprefix)==0)stat_casefiles[nstat_casefiles++] = files+i;
+  }
+  if(ThreadPoolSize()>1&&nstat_casefiles>1){
+    taskdata *tasks[MAX_POOL_THREADS];
+    int task_index[MAX_POOL_THREADS];
 
-  strcpy(filter_casedir, "");
-  nfilelist_casedir = GetFileListSize(".", filter_casedir);
-  MakeFileList(".", filter_casedir, nfilelist_casedir, YES, &filelist_casedir);
+    nstat_casefile_tasks = MIN(ThreadPoolSize(), nstat_casefiles);
+    for(i = 0; i<nstat_casefile_tasks; i++){
+      task_index[i] = i;
+      tasks[i] = ThreadPoolSubmit("stat case files", MtStatCaseFiles, task_index+i);
+    }
+    ThreadPoolWaitAll(tasks, nstat_casefile_tasks);
+  }
+  else{
+    for(i = 0; i<nstat_casefiles; i++){
+      StatDirCacheFile(stat_casefiles[i]);
+    }
+  }
+  FREEMEMORY(stat_casefiles);
+  nstat_casefiles = 0;
 }
 
 #define RETURN_TWO        2
@@ -3972,7 +4804,8 @@ int ParseISOFProcess(bufferstreamdata *stream, char *buffer, int *iiso_in, int *
   isoi->nlevels = 0;
   isoi->levels = NULL;
   isoi->is_fed = 0;
-  isoi->memory_id = ++nmemory_ids;
+  isoi->memory_id = NewMemoryId(MEMORY_ISO);
+  isoi->last_display = 0;
   isoi->geom_nstatics = NULL;
   isoi->geom_ndynamics = NULL;
   isoi->geom_times = NULL;
@@ -3985,8 +4818,7 @@ int ParseISOFProcess(bufferstreamdata *stream, char *buffer, int *iiso_in, int *
   isoi->color_label.unit = NULL;
   isoi->geominfo = NULL;
   NewMemory((void **)&isoi->geominfo, sizeof(geomdata));
-  nmemory_ids++;
-  isoi->geominfo->memory_id = nmemory_ids;
+  isoi->geominfo->memory_id = NewMemoryId(MEMORY_ISO);
   InitGeom(isoi->geominfo, GEOM_ISO, NOT_FDSBLOCK);
 
   bufferptr = TrimFrontBack(buffer);
@@ -4289,6 +5121,8 @@ int ParsePRT5Process(bufferstreamdata *stream, char *buffer, int *nn_part_in, in
   }
   parti->compression_type = UNCOMPRESSED;
   parti->loaded = 0;
+  parti->memory_id = NewMemoryId(MEMORY_PART);
+  parti->last_display = 0;
   parti->request_load = 0;
   parti->finalize = 0;
   parti->display = 0;
@@ -4302,12 +5136,16 @@ int ParsePRT5Process(bufferstreamdata *stream, char *buffer, int *nn_part_in, in
   parti->global_max = NULL;
   parti->filepos = NULL;
   parti->tags = NULL;
-  parti->sort_tags = NULL;
+  parti->tag_hash = NULL;
   parti->vis_part = NULL;
+  parti->ranks = NULL;
   parti->sx = NULL;
   parti->sy = NULL;
   parti->sz = NULL;
   parti->irvals = NULL;
+  parti->vbo.buffer_ids = NULL;
+  parti->vbo.nbuffers = 0;
+  parti->vbo.frame = -1;
 
   parti->data5 = NULL;
   parti->partclassptr = NULL;
@@ -4561,6 +5399,8 @@ int ParseBNDFProcess(bufferstreamdata *stream, char *buffer, int *nn_patch_in, i
   patchi->seq_id = nn_patch;
   patchi->autoload = 0;
   patchi->loaded = 0;
+  patchi->memory_id = NewMemoryId(MEMORY_BOUNDARY);
+  patchi->last_display = 0;
   patchi->display = 0;
   patchi->inuse = 0;
   patchi->inuse_getbounds = 0;
@@ -4730,12 +5570,16 @@ int ParseSMOKE3DProcess(bufferstreamdata *stream, char *buffer, int *nn_smoke3d_
     smoke3di->smoke_boxmax = NULL;
     smoke3di->display = 0;
     smoke3di->loaded = 0;
+    smoke3di->memory_id = NewMemoryId(MEMORY_SMOKE3D);
+    smoke3di->last_display = 0;
     smoke3di->finalize = 0;
     smoke3di->request_load = 0;
     smoke3di->primary_file = 0;
     smoke3di->file_size = 0;
     smoke3di->blocknumber = blocknumber;
     smoke3di->lastiframe = -999;
+    smoke3di->update_box = 0;
+    smoke3di->cropped = 0;
     for(ii = 0; ii<MAXSMOKETYPES; ii++){
       smoke3di->smokestate[ii].index = -1;
     }
@@ -5142,12 +5986,38 @@ int ParseSLCFProcess(int option, bufferstreamdata *stream, char *buffer, int *nn
   }
   if(read_slice_header==1){
     int error;
+    smvcacheslicedata *slicecache;
 
+    slicecache = GetSMVCacheSlice(stream->fileinfo->iline-1, sd->file);
+    if(slicecache!=NULL){
+      ii1 = slicecache->ijk[0];
+      ii2 = slicecache->ijk[1];
+      jj1 = slicecache->ijk[2];
+      jj2 = slicecache->ijk[3];
+      kk1 = slicecache->ijk[4];
+      kk2 = slicecache->ijk[5];
+    }
+    else{
 #ifdef pp_C_SLICE
-    GetSliceFileHeader(sd->file, &ii1, &ii2, &jj1, &jj2, &kk1, &kk2, &error);
+      GetSliceFileHeader(sd->file, &ii1, &ii2, &jj1, &jj2, &kk1, &kk2, &error);
 #else
-    FORTgetsliceheader(sd->file, &ii1, &ii2, &jj1, &jj2, &kk1, &kk2, &error, strlen(sd->file));
+      FORTgetsliceheader(sd->file, &ii1, &ii2, &jj1, &jj2, &kk1, &kk2, &error, strlen(sd->file));
 #endif
+
+      // only complete headers are cached so a slice file that is still being written is read again next time
+
+      if(error==0&&ii1<=ii2&&jj1<=jj2&&kk1<=kk2){
+        int ijk[6];
+
+        ijk[0] = ii1;
+        ijk[1] = ii2;
+        ijk[2] = jj1;
+        ijk[3] = jj2;
+        ijk[4] = kk1;
+        ijk[5] = kk2;
+        AddSMVCacheSlice(stream->fileinfo->iline-1, sd->file, ijk);
+      }
+    }
   }
   sd->is1 = ii1;
   sd->is2 = ii2;
@@ -5167,8 +6037,17 @@ int ParseSLCFProcess(int option, bufferstreamdata *stream, char *buffer, int *nn
   sd->autoload = 0;
   sd->display = 0;
   sd->loaded = 0;
+  sd->memory_id = NewMemoryId(MEMORY_SLICE);
+  sd->last_display = 0;
+  sd->force_paged = 0;
   sd->loading = 0;
   sd->qslicedata = NULL;
+  sd->paged = 0;
+  sd->cropped = 0;
+  sd->pageinfo.stream = NULL;
+  sd->pageinfo.frame_offsets = NULL;
+  sd->pageinfo.frames = NULL;
+  sd->vbo.defined = 0;
   sd->compindex = NULL;
   sd->slicecomplevel = NULL;
   sd->qslicedata_compressed = NULL;
@@ -5492,12 +6371,13 @@ void GenerateViewpointMenu(void){
   fclose(stream);
 }
 
-/* ------------------ ReadSMV ------------------------ */
+/* ------------------ ReadSMV0 ------------------------ */
 
-int ReadSMV(bufferstreamdata *stream){
+int ReadSMV0(bufferstreamdata *stream){
 
 /* read the .smv file */
   float read_time, processing_time, wrapup_time, getfilelist_time;
+  int nmetadata_calls;
   float pass0_time, pass1_time, pass2_time, pass3_time, pass4_time, pass5_time;
   int have_zonevents,nzventsnew=0;
   devicedata *devicecopy;
@@ -5524,6 +6404,7 @@ int ReadSMV(bufferstreamdata *stream){
 
   START_TIMER(processing_time);
 
+  nmetadata_calls = GetFileMetadataCalls();
   START_TIMER(getfilelist_time);
   MakeFileLists();
   STOP_TIMER(getfilelist_time);
@@ -5809,6 +6690,9 @@ int ReadSMV(bufferstreamdata *stream){
 
   if(cadgeominfo!=NULL)FreeCADInfo();
 
+  LoadSMVCache(stream);
+  smvdynamic_offset = 0;
+
   STOP_TIMER(pass0_time );
 
 /*
@@ -5830,6 +6714,7 @@ int ReadSMV(bufferstreamdata *stream){
     if(FEOF(stream)!=0){
       BREAK;
     }
+    SkipSMVLines(stream, SMV_PASS1);
     if(FGETS(buffer,255,stream)==NULL){
       BREAK;
     }
@@ -6614,6 +7499,7 @@ int ReadSMV(bufferstreamdata *stream){
       startpass=0;
     }
     else{
+      SkipSMVLines(stream, SMV_PASS2);
       if(FGETS(buffer,255,stream)==NULL){
         BREAK;
       }
@@ -6774,7 +7660,7 @@ int ReadSMV(bufferstreamdata *stream){
       geomi = geominfo + ngeominfo;
       geomi->ngeomobjinfo=0;
       geomi->geomobjinfo=NULL;
-      geomi->memory_id = ++nmemory_ids;
+      geomi->memory_id = NewMemoryId(MEMORY_GEOM);
 
       TrimBack(buffer);
       if(strlen(buffer)>4){
@@ -7977,6 +8863,7 @@ int ReadSMV(bufferstreamdata *stream){
     if(FEOF(stream)!=0){
       BREAK;
     }
+    SkipSMVLines(stream, SMV_PASS3);
     if(FGETS(buffer,255,stream)==NULL){
       BREAK;
     }
@@ -8467,6 +9354,7 @@ int ReadSMV(bufferstreamdata *stream){
         startpass=0;
       }
       else{
+        SkipSMVLines(stream, SMV_PASS4);
         if(FGETS(buffer,255,stream)==NULL){
           BREAK;
         }
@@ -9027,15 +9915,42 @@ typedef struct {
         {
           float t_origin[3];
           float *xyzEXACT;
+          smvcacheobstdata obstval, *obstcache;
 
-          t_origin[0]=texture_origin[0];
-          t_origin[1]=texture_origin[1];
-          t_origin[2]=texture_origin[2];
+          // the values of an OBST line are read in the order: xyz, id, surface indices, texture origin
+
+          obstval.line = stream->fileinfo->iline-1;
+          memcpy(obstval.xyzEXACT, bc->xyzEXACT, 6*sizeof(float));
+          obstval.blockage_id = bc->blockage_id;
+          for(i = 0; i<6; i++){
+            obstval.s_num[i] = -1;
+          }
+          obstval.t_origin[0] = texture_origin[0];
+          obstval.t_origin[1] = texture_origin[1];
+          obstval.t_origin[2] = texture_origin[2];
+          obstcache = GetSMVCacheObst(obstval.line);
+          if(obstcache!=NULL){
+            CopySMVCacheObst(obstcache, &obstval);
+          }
+          else{
+            obstval.nvals = sscanf(buffer,"%f %f %f %f %f %f %i %i %i %i %i %i %i %f %f %f",
+              obstval.xyzEXACT,obstval.xyzEXACT+1,obstval.xyzEXACT+2,obstval.xyzEXACT+3,obstval.xyzEXACT+4,obstval.xyzEXACT+5,
+              &obstval.blockage_id,obstval.s_num,obstval.s_num+1,obstval.s_num+2,obstval.s_num+3,obstval.s_num+4,obstval.s_num+5,
+              obstval.t_origin,obstval.t_origin+1,obstval.t_origin+2);
+            AddSMVCacheObst(&obstval);
+          }
           xyzEXACT = bc->xyzEXACT;
-          sscanf(buffer,"%f %f %f %f %f %f %i %i %i %i %i %i %i %f %f %f",
-            xyzEXACT,xyzEXACT+1,xyzEXACT+2,xyzEXACT+3,xyzEXACT+4,xyzEXACT+5,
-            &(bc->blockage_id),s_num+DOWN_X,s_num+UP_X,s_num+DOWN_Y,s_num+UP_Y,s_num+DOWN_Z,s_num+UP_Z,
-            t_origin,t_origin+1,t_origin+2);
+          memcpy(xyzEXACT, obstval.xyzEXACT, 6*sizeof(float));
+          bc->blockage_id = obstval.blockage_id;
+          s_num[DOWN_X] = obstval.s_num[0];
+          s_num[UP_X]   = obstval.s_num[1];
+          s_num[DOWN_Y] = obstval.s_num[2];
+          s_num[UP_Y]   = obstval.s_num[3];
+          s_num[DOWN_Z] = obstval.s_num[4];
+          s_num[UP_Z]   = obstval.s_num[5];
+          t_origin[0] = obstval.t_origin[0];
+          t_origin[1] = obstval.t_origin[1];
+          t_origin[2] = obstval.t_origin[2];
           bc->xmin=xyzEXACT[0];
           bc->xmax=xyzEXACT[1];
           bc->ymin=xyzEXACT[2];
@@ -9936,6 +10851,7 @@ typedef struct {
       BREAK;
     }
 
+    SkipSMVLines(stream, SMV_PASS5);
     if(FGETS(buffer,255,stream)==NULL){
       BREAK;
     }
@@ -10069,6 +10985,7 @@ typedef struct {
   else{
     pass5_time = 0.0;
   }
+  WriteSMVCache(stream->fileinfo);
 
 /*
    ************************************************************************
@@ -10352,6 +11269,8 @@ typedef struct {
   PrintMemoryInfo;
 
   STOP_TIMER(wrapup_time);
+  UseDirCache(0);
+  nmetadata_calls = GetFileMetadataCalls()-nmetadata_calls;
   PRINTF("\n");
   PRINTF(".smv Processing Times\n");
   PRINTF("---------------------\n");
@@ -10364,6 +11283,7 @@ typedef struct {
 
   if(ALWAYS read_time>1.0)         PRINTF(".smv file(net): %.1f s\n", read_time);
   if(ALWAYS getfilelist_time>1.0)  PRINTF("      filelist: %.1f s\n", getfilelist_time);
+  if(ALWAYS show_task_timings==1)  PRINTF(" file metadata: %i calls\n", nmetadata_calls);
   if(ALWAYS read_time_elapsed>1.0) PRINTF(".smv file(cum): %.1f s\n", read_time_elapsed);
   if(ALWAYS pass0_time>1.0)        PRINTF("         setup: %.1f s\n", pass0_time);
   if(ALWAYS pass1_time>1.0)        PRINTF("        pass 1: %.1f s\n", pass1_time);
@@ -10377,6 +11297,18 @@ typedef struct {
   return 0;
 }
 
+/* ------------------ ReadSMV ------------------------ */
+
+int ReadSMV(bufferstreamdata *stream){
+  int return_code;
+
+  // the directory cache made by MakeFileLists must not outlive the read, also when it fails part way
+
+  return_code = ReadSMV0(stream);
+  UseDirCache(0);
+  return return_code;
+}
+
 /* ------------------ UpdateUseTextures ------------------------ */
 
 void UpdateUseTextures(void){
@@ -10545,7 +11477,7 @@ int ReadIni2(char *inifile, int localfile){
     }
     if(Match(buffer, "BLENDMODE")==1){
       fgets(buffer, 255, stream);
-      sscanf(buffer, " %i %i,%i", &slices3d_max_blending, &hrrpuv_max_blending,&showall_3dslices);
+      sscanf(buffer, " %i %i %i", &slices3d_max_blending, &hrrpuv_max_blending,&showall_3dslices);
     }
     if(Match(buffer, "FIREPARAMS")==1){
       fgets(buffer, 255, stream);
@@ -10768,6 +11700,12 @@ int ReadIni2(char *inifile, int localfile){
       sscanf(buffer, "%i %f %i %f %i %i", &use_tload_begin, &tload_begin, &use_tload_end, &tload_end, &use_tload_skip, &tload_skip);
       continue;
     }
+    if(Match(buffer, "VOLSMOKEFAST") == 1){
+      fgets(buffer, 255, stream);
+      sscanf(buffer, "%i", &volsmoke_multithread);
+      ONEORZERO(volsmoke_multithread);
+      continue;
+    }
     if(Match(buffer, "VOLSMOKE") == 1){
       fgets(buffer, 255, stream);
       sscanf(buffer, "%i %i %i %i %i",
@@ -11727,6 +12665,12 @@ int ReadIni2(char *inifile, int localfile){
       ONEORZERO(output_slicedata);
       continue;
     }
+    if(Match(buffer, "SMOKE3DFAST") == 1){
+      fgets(buffer, 255, stream);
+      sscanf(buffer, "%i", &smoke3d_multithread);
+      ONEORZERO(smoke3d_multithread);
+      continue;
+    }
     if(Match(buffer, "SMOKE3DZIPSTEP") == 1){
       fgets(buffer, 255, stream);
       sscanf(buffer, "%i", &smoke3dzipstep);
@@ -11748,6 +12692,12 @@ int ReadIni2(char *inifile, int localfile){
       isozipskip = isozipstep - 1;
       continue;
     }
+    if(Match(buffer, "BOUNDARYFAST") == 1){
+      fgets(buffer, 255, stream);
+      sscanf(buffer, "%i", &boundary_multithread);
+      ONEORZERO(boundary_multithread);
+      continue;
+    }
     if(Match(buffer, "BOUNDZIPSTEP") == 1){
       fgets(buffer, 255, stream);
       sscanf(buffer, "%i", &boundzipstep);
@@ -11760,6 +12710,13 @@ int ReadIni2(char *inifile, int localfile){
       sscanf(buffer, "%i %i", &load_incremental,&use_cslice);
       continue;
     }
+    if(Match(buffer, "FOLLOWFILES") == 1){
+      fgets(buffer, 255, stream);
+      sscanf(buffer, "%i %i", &follow_files, &follow_interval);
+      follow_files = CLAMP(follow_files, 0, 1);
+      follow_interval = MAX(follow_interval, 100);
+      continue;
+    }
     if(Match(buffer, "MSCALE") == 1){
       fgets(buffer, 255, stream);
       sscanf(buffer, "%f %f %f", mscale, mscale + 1, mscale + 2);
@@ -12435,6 +13392,12 @@ int ReadIni2(char *inifile, int localfile){
       continue;
     }
 #endif
+    if(Match(buffer, "SHOWMEMTYPES") == 1){
+      fgets(buffer, 255, stream);
+      sscanf(buffer, "%i", &visMemorytypes);
+      ONEORZERO(visMemorytypes);
+      continue;
+    }
     if(Match(buffer, "SHOWBLOCKLABEL") == 1){
       fgets(buffer, 255, stream);
       sscanf(buffer, "%i", &visMeshlabel);
@@ -12554,18 +13517,87 @@ int ReadIni2(char *inifile, int localfile){
       sscanf(buffer, "%i", &rotation_type);
       continue;
     }
+    if(Match(buffer, "MEMORYBUDGET")==1){
+      fgets(buffer, 255, stream);
+      sscanf(buffer, "%i", &memory_budget);
+      memory_budget = MAX(memory_budget, 0);
+      continue;
+    }
     if(Match(buffer, "NOPART") == 1){
       fgets(buffer, 255, stream);
       sscanf(buffer, "%i", &nopart);
       continue;
     }
+    if(Match(buffer, "PREFETCHFRAMES")==1){
+      fgets(buffer, 255, stream);
+      sscanf(buffer, "%i %i", &prefetch_nframes, &prefetch_nthreads);
+      prefetch_nframes = MAX(prefetch_nframes, 0);
+      prefetch_nthreads = CLAMP(prefetch_nthreads, 1, MAX_PREFETCH_THREADS);
+      continue;
+    }
+    if(Match(buffer, "PREFETCHRING")==1){
+      fgets(buffer, 255, stream);
+      sscanf(buffer, "%i", &prefetch_ringsize);
+      prefetch_ringsize = MAX(prefetch_ringsize, 1);
+      continue;
+    }
+    if(Match(buffer, "SLICEFRAMEBUDGET")==1){
+      fgets(buffer, 255, stream);
+      sscanf(buffer, "%i", &slice_frame_budget);
+      slice_frame_budget = MAX(slice_frame_budget, 0);
+      continue;
+    }
+    if(Match(buffer, "SLICEMMAP")==1){
+      fgets(buffer, 255, stream);
+      sscanf(buffer, "%i", &use_slice_mmap);
+      ONEORZERO(use_slice_mmap);
+      continue;
+    }
+    if(Match(buffer, "BLOCKAGEVBO")==1){
+      fgets(buffer, 255, stream);
+      sscanf(buffer, "%i", &use_blockage_vbo);
+      ONEORZERO(use_blockage_vbo);
+      continue;
+    }
+    if(Match(buffer, "PARTLOD")==1){
+      fgets(buffer, 255, stream);
+      sscanf(buffer, "%i %f", &use_part_lod, &part_lod_density);
+      ONEORZERO(use_part_lod);
+      if(part_lod_density<=0.0)part_lod_density = 0.25;
+      continue;
+    }
+    if(Match(buffer, "PARTGPU")==1){
+      fgets(buffer, 255, stream);
+      sscanf(buffer, "%i", &use_part_gpu);
+      ONEORZERO(use_part_gpu);
+      continue;
+    }
+    if(Match(buffer, "BOUNDARYGPU")==1){
+      fgets(buffer, 255, stream);
+      sscanf(buffer, "%i", &use_boundary_gpu);
+      ONEORZERO(use_boundary_gpu);
+      continue;
+    }
+    if(Match(buffer, "SLICEVBO")==1){
+      fgets(buffer, 255, stream);
+      sscanf(buffer, "%i", &use_slice_vbo);
+      ONEORZERO(use_slice_vbo);
+      continue;
+    }
 #ifdef pp_SLICETHREAD
     if(Match(buffer, "SLICEFAST")==1){
       fgets(buffer, 255, stream);
       sscanf(buffer, "%i %i", &slice_multithread, &nslicethread_ids);
+      nslicethread_ids = CLAMP(nslicethread_ids, 1, MAX_SLICE_THREADS);
       continue;
     }
 #endif
+    if(Match(buffer, "PARTDECODEFAST")==1){
+      fgets(buffer, 255, stream);
+      sscanf(buffer, "%i", &part_decode_multithread);
+      ONEORZERO(part_decode_multithread);
+      continue;
+    }
     if(Match(buffer, "PARTFAST")==1){
       fgets(buffer, 255, stream);
       sscanf(buffer, "%i %i %i", &partfast, &part_multithread, &npartthread_ids);
@@ -14420,20 +15452,36 @@ void WriteIni(int flag,char *filename){
   fprintf(fileout, "\n *** DATA LOADING ***\n\n");
 
 
+  fprintf(fileout, "BOUNDARYFAST\n");
+  fprintf(fileout, " %i\n", boundary_multithread);
   fprintf(fileout, "BOUNDZIPSTEP\n");
   fprintf(fileout, " %i\n", boundzipstep);
   fprintf(fileout, "FED\n");
   fprintf(fileout," %i\n",regenerate_fed);
   fprintf(fileout, "FEDCOLORBAR\n");
   fprintf(fileout, " %s\n", default_fed_colorbar);
+  fprintf(fileout, "FOLLOWFILES\n");
+  fprintf(fileout, " %i %i\n", follow_files, follow_interval);
   fprintf(fileout, "ISOZIPSTEP\n");
   fprintf(fileout, " %i\n", isozipstep);
   fprintf(fileout, "LOADINC\n");
   fprintf(fileout, " %i %i\n", load_incremental,use_cslice);
+  fprintf(fileout, "MEMORYBUDGET\n");
+  fprintf(fileout, " %i\n", memory_budget);
   fprintf(fileout, "NOPART\n");
   fprintf(fileout, " %i\n", nopart);
+  fprintf(fileout, "PARTDECODEFAST\n");
+  fprintf(fileout, " %i\n", part_decode_multithread);
   fprintf(fileout, "PARTFAST\n");
   fprintf(fileout, " %i %i %i\n", partfast, part_multithread, npartthread_ids);
+  fprintf(fileout, "PARTGPU\n");
+  fprintf(fileout, " %i\n", use_part_gpu);
+  fprintf(fileout, "PARTLOD\n");
+  fprintf(fileout, " %i %f\n", use_part_lod, part_lod_density);
+  fprintf(fileout, "PREFETCHFRAMES\n");
+  fprintf(fileout, " %i %i\n", prefetch_nframes, prefetch_nthreads);
+  fprintf(fileout, "PREFETCHRING\n");
+  fprintf(fileout, " %i\n", prefetch_ringsize);
   fprintf(fileout, "RESEARCHMODE\n");
   // if colorbars are hidden then research mode needs to be off
   if(visColorbarVertical_val==0&&visColorbarHorizontal_val==0){
@@ -14447,12 +15495,20 @@ void WriteIni(int flag,char *filename){
   fprintf(fileout, " %i %f %i\n", slice_average_flag, slice_average_interval, vis_slice_average);
   fprintf(fileout, "SLICEDATAOUT\n");
   fprintf(fileout, " %i \n", output_slicedata);
-#ifdef pp_SLICEFAST
+#ifdef pp_SLICETHREAD
   fprintf(fileout, "SLICEFAST\n");
   fprintf(fileout, " %i %i\n", slice_multithread, nslicethread_ids);
 #endif
+  fprintf(fileout, "SLICEFRAMEBUDGET\n");
+  fprintf(fileout, " %i\n", slice_frame_budget);
+  fprintf(fileout, "SLICEMMAP\n");
+  fprintf(fileout, " %i\n", use_slice_mmap);
+  fprintf(fileout, "SLICEVBO\n");
+  fprintf(fileout, " %i\n", use_slice_vbo);
   fprintf(fileout, "SLICEZIPSTEP\n");
   fprintf(fileout, " %i\n", slicezipstep);
+  fprintf(fileout, "SMOKE3DFAST\n");
+  fprintf(fileout, " %i\n", smoke3d_multithread);
   fprintf(fileout, "SMOKE3DZIPSTEP\n");
   fprintf(fileout, " %i\n", smoke3dzipstep);
   fprintf(fileout, "USER_ROTATE\n");
@@ -14467,10 +15523,14 @@ void WriteIni(int flag,char *filename){
   fprintf(fileout, " %i\n", axislabels_smooth);
   fprintf(fileout, "BLOCKLOCATION\n");
   fprintf(fileout, " %i\n", blocklocation);
+  fprintf(fileout, "BLOCKAGEVBO\n");
+  fprintf(fileout, " %i\n", use_blockage_vbo);
   fprintf(fileout, "BEAM\n");
   fprintf(fileout, " %i %f %i %i %i %i\n", showbeam_as_line,beam_line_width,use_beamcolor,beam_color[0], beam_color[1], beam_color[2]);
   fprintf(fileout, "BLENDMODE\n");
   fprintf(fileout, " %i %i %i\n", slices3d_max_blending, hrrpuv_max_blending,showall_3dslices);
+  fprintf(fileout, "BOUNDARYGPU\n");
+  fprintf(fileout, " %i\n", use_boundary_gpu);
   fprintf(fileout, "BOUNDARYMESH\n");
   fprintf(fileout, " %i\n", show_bndf_mesh_interface);
   fprintf(fileout, "BOUNDARYTWOSIDE\n");
@@ -14628,6 +15688,8 @@ void WriteIni(int flag,char *filename){
   fprintf(fileout, "SHOWMEMLOAD\n");
   fprintf(fileout, " %i\n", visAvailmemory);
 #endif
+  fprintf(fileout, "SHOWMEMTYPES\n");
+  fprintf(fileout, " %i\n", visMemorytypes);
   fprintf(fileout, "SHOWOPENVENTS\n");
   fprintf(fileout, " %i %i\n", visOpenVents, visOpenVentsAsOutline);
   fprintf(fileout, "SHOWOTHERVENTS\n");
@@ -14883,6 +15945,8 @@ void WriteIni(int flag,char *filename){
     glui_compress_volsmoke, use_multi_threading, load_at_rendertimes, volbw, show_volsmoke_moving);
   fprintf(fileout, " %f %f %f %f %f %f %f\n",
     global_temp_min, global_temp_cutoff, global_temp_max, fire_opacity_factor, mass_extinct, gpu_vol_factor, nongpu_vol_factor);
+  fprintf(fileout, "VOLSMOKEFAST\n");
+  fprintf(fileout, " %i\n", volsmoke_multithread);
 
   fprintf(fileout, "\n *** ZONE FIRE PARAMETRES ***\n\n");
 
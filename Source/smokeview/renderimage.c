@@ -404,11 +404,11 @@ void OutputSliceData(void){
     if(sd->display == 0 || sd->slicefile_labelindex != slicefile_labelindex)continue;
     if(sd->times[0] > global_times[itimes])continue;
 
-    if(sd->qslicedata == NULL){
+    data = GetSliceFrame(sd, sd->itime, NULL);
+    if(data == NULL){
       PRINTF("  Slice data unavailable for output\n");
       continue;
     }
-    data = sd->qslicedata + sd->itime*sd->nsliceijk;
     strcpy(datafile, sd->file);
     ext = strstr(datafile, ".");
     if(ext != NULL){
@@ -9,7 +9,7 @@
 
 #include "smokeviewvars.h"
 
-GLuint p_smoke, p_3dslice, p_zonesmoke, p_volsmoke;
+GLuint p_smoke, p_3dslice, p_zonesmoke, p_volsmoke, p_part, p_boundary;
 #ifdef pp_GPUSMOKE
 GLuint p_newsmoke;
 #endif
@@ -386,6 +386,163 @@ int Set3DSliceShaders(void){
   return 1;
 }
 
+/* ------------------ SetPartShaders ------------------------ */
+
+int SetPartShaders(void){
+  GLuint vert_shader, frag_shader;
+
+  const GLchar *FragmentShaderSource[]={
+    "#version 120\n"
+    "uniform sampler1D colormap;"
+    "uniform int use_default;"
+    "uniform vec4 default_color;"
+    "varying float colorindex;"
+    "void main(){"
+    "  if(use_default==1){"
+    "    gl_FragColor = default_color;"
+    "  }"
+    "  else{"
+    "    gl_FragColor = texture1D(colormap,(colorindex+0.5)/256.0);"
+    "  }"
+    "}"
+  };
+
+// particle positions are the quantized sx, sy, sz values (see DecodePartFrame), the same
+// mapping as the xplts, yplts and zplts arrays.  hidden particles, particles left out by the
+// level of detail (see UpdatePartLOD) and particles outside the displayed color range are
+// moved outside of the view volume
+
+  const GLchar *VertexShaderSource[]={
+    "#version 120\n"
+    "attribute float sx, sy, sz, vis, rank, color;"
+    "uniform vec3 xyz0, dxyz;"
+    "uniform int use_default;"
+    "uniform float imin, imax, lod_level;"
+    "varying float colorindex;"
+    "void main(){"
+    "  vec4 position;"
+    "  position = vec4(xyz0+vec3(sx,sy,sz)*dxyz,1.0);"
+    "  colorindex = color;"
+    "  gl_ClipVertex = gl_ModelViewMatrix*position;"
+    "  gl_Position = gl_ModelViewProjectionMatrix*position;"
+    "  if(vis<0.5||rank>=lod_level||(use_default==0&&(color<imin||color>imax))){"
+    "    gl_Position = vec4(2.0,2.0,2.0,1.0);"
+    "  }"
+    "}"
+  };
+
+  vert_shader = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(vert_shader,1, VertexShaderSource,NULL);
+  glCompileShader(vert_shader);
+  if(ShaderCompileStatus(vert_shader,"particle vertex shader")==GL_FALSE)return 0;
+
+  frag_shader = glCreateShader(GL_FRAGMENT_SHADER);
+  glShaderSource(frag_shader, 1, FragmentShaderSource,NULL);
+  glCompileShader(frag_shader);
+  if(ShaderCompileStatus(frag_shader,"particle fragment shader")==GL_FALSE)return 0;
+
+  p_part = glCreateProgram();
+  glAttachShader(p_part,vert_shader);
+  glAttachShader(p_part,frag_shader);
+
+  // some drivers only draw if generic attribute 0 is an enabled array
+
+  glBindAttribLocation(p_part,0,"sx");
+  glLinkProgram(p_part);
+  if(ShaderLinkStatus(p_part) == GL_FALSE)return 0;
+
+  GPUpart_sx            = glGetAttribLocation(p_part,"sx");
+  GPUpart_sy            = glGetAttribLocation(p_part,"sy");
+  GPUpart_sz            = glGetAttribLocation(p_part,"sz");
+  GPUpart_vis           = glGetAttribLocation(p_part,"vis");
+  GPUpart_rank          = glGetAttribLocation(p_part,"rank");
+  GPUpart_color         = glGetAttribLocation(p_part,"color");
+  GPUpart_xyz0          = glGetUniformLocation(p_part,"xyz0");
+  GPUpart_dxyz          = glGetUniformLocation(p_part,"dxyz");
+  GPUpart_colormap      = glGetUniformLocation(p_part,"colormap");
+  GPUpart_use_default   = glGetUniformLocation(p_part,"use_default");
+  GPUpart_default_color = glGetUniformLocation(p_part,"default_color");
+  GPUpart_imin          = glGetUniformLocation(p_part,"imin");
+  GPUpart_imax          = glGetUniformLocation(p_part,"imax");
+  GPUpart_lod_level     = glGetUniformLocation(p_part,"lod_level");
+
+  return 1;
+}
+
+/* ------------------ SetBoundaryShaders ------------------------ */
+
+int SetBoundaryShaders(void){
+  GLuint vert_shader, frag_shader;
+
+// the color index (red) and the threshold flag (green) are passed in gl_Color so that
+// cell centered files can be drawn with glShadeModel(GL_FLAT), each cell then takes its
+// color from the last vertex of its triangles (see MakeBoundaryVBO)
+
+  const GLchar *FragmentShaderSource[]={
+    "#version 120\n"
+    "uniform sampler1D colormap;"
+    "uniform int cell_center, use_data;"
+    "uniform vec4 burn_color;"
+    "void main(){"
+    "  float colorindex;"
+    "  vec4 color;"
+    "  colorindex = gl_Color.r;"
+    "  if(cell_center==1)colorindex = (floor(255.0*colorindex+0.5)+0.5)/256.0;"
+    "  color = vec4(1.0,1.0,1.0,1.0);"
+    "  if(use_data==1)color = texture1D(colormap,colorindex);"
+    "  gl_FragColor = mix(color,burn_color,gl_Color.g);"
+    "}"
+  };
+
+  const GLchar *VertexShaderSource[]={
+    "#version 120\n"
+    "attribute vec3 position;"
+    "attribute float value, thresholdtime;"
+    "uniform int use_threshold;"
+    "uniform float time;"
+    "void main(){"
+    "  float burnt;"
+    "  burnt = 0.0;"
+    "  if(use_threshold==1&&thresholdtime>=0.0&&time>thresholdtime)burnt = 1.0;"
+    "  gl_FrontColor = vec4(value/255.0,burnt,0.0,1.0);"
+    "  gl_ClipVertex = gl_ModelViewMatrix*vec4(position,1.0);"
+    "  gl_Position = gl_ModelViewProjectionMatrix*vec4(position,1.0);"
+    "}"
+  };
+
+  vert_shader = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(vert_shader,1, VertexShaderSource,NULL);
+  glCompileShader(vert_shader);
+  if(ShaderCompileStatus(vert_shader,"boundary vertex shader")==GL_FALSE)return 0;
+
+  frag_shader = glCreateShader(GL_FRAGMENT_SHADER);
+  glShaderSource(frag_shader, 1, FragmentShaderSource,NULL);
+  glCompileShader(frag_shader);
+  if(ShaderCompileStatus(frag_shader,"boundary fragment shader")==GL_FALSE)return 0;
+
+  p_boundary = glCreateProgram();
+  glAttachShader(p_boundary,vert_shader);
+  glAttachShader(p_boundary,frag_shader);
+
+  // some drivers only draw if generic attribute 0 is an enabled array
+
+  glBindAttribLocation(p_boundary,0,"position");
+  glLinkProgram(p_boundary);
+  if(ShaderLinkStatus(p_boundary) == GL_FALSE)return 0;
+
+  GPUbndf_position      = glGetAttribLocation(p_boundary,"position");
+  GPUbndf_value         = glGetAttribLocation(p_boundary,"value");
+  GPUbndf_thresholdtime = glGetAttribLocation(p_boundary,"thresholdtime");
+  GPUbndf_colormap      = glGetUniformLocation(p_boundary,"colormap");
+  GPUbndf_cell_center   = glGetUniformLocation(p_boundary,"cell_center");
+  GPUbndf_use_data      = glGetUniformLocation(p_boundary,"use_data");
+  GPUbndf_use_threshold = glGetUniformLocation(p_boundary,"use_threshold");
+  GPUbndf_burn_color    = glGetUniformLocation(p_boundary,"burn_color");
+  GPUbndf_time          = glGetUniformLocation(p_boundary,"time");
+
+  return 1;
+}
+
 /* ------------------ SetVolSmokeShaders ------------------------ */
 
 int SetVolSmokeShaders(){
@@ -778,6 +935,18 @@ void Load3DSliceShaders(void){
   glUseProgram(p_3dslice);
 }
 
+/* ------------------ LoadPartShaders ------------------------ */
+
+void LoadPartShaders(void){
+  glUseProgram(p_part);
+}
+
+/* ------------------ LoadBoundaryShaders ------------------------ */
+
+void LoadBoundaryShaders(void){
+  glUseProgram(p_boundary);
+}
+
 /* ------------------ LoadZoneSmokeShaders ------------------------ */
 
 void LoadZoneSmokeShaders(void){
@@ -856,6 +1025,20 @@ int InitShaders(void){
       PRINTF("    3D slice failed to load\n");
       err=1;
     }
+    if(SetPartShaders()==1){
+      PRINTF("    particles loaded\n");
+    }
+    else{
+      PRINTF("    particles failed to load\n");
+      err=1;
+    }
+    if(SetBoundaryShaders()==1){
+      PRINTF("    boundary loaded\n");
+    }
+    else{
+      PRINTF("    boundary failed to load\n");
+      err=1;
+    }
     if(SetZoneSmokeShaders()==1){
       PRINTF("    zone smoke loaded\n");
     }
@@ -53,6 +53,18 @@ EXTERNCPP FILE_SIZE GetSliceData(char *slicefilename, int time_frame, int *is1pt
   , int multi_res
 #endif
 );
+EXTERNCPP unsigned char *GetFortRecord(mmapfiledata *mapinfo, FILE_SIZE *offsetptr, int nbytes);
+EXTERNCPP int SliceProbesToCSV(char *quantity, float *xyz, int nprobes, char *csvfile);
+EXTERNCPP FILE_SIZE GetSliceDataMMap(char *slicefilename, int time_frame, int *is1ptr, int *is2ptr, int *js1ptr, int *js2ptr, int *ks1ptr, int *ks2ptr, int *idirptr,
+  float *qminptr, float *qmaxptr, float *qdataptr, slicepagedata *pageinfo, int *loadbox, int *croppedptr, float *timesptr, int ntimes_old_arg, int *ntimesptr,
+  int sliceframestep_arg, int settmin_s_arg, int settmax_s_arg, float tmin_s_arg, float tmax_s_arg
+#ifdef pp_MULTI_RES
+  , int multi_res
+#endif
+);
+EXTERNCPP float *GetSliceFrame(slicedata *sd, int itime, unsigned char **levelsptr);
+EXTERNCPP void GetSliceFrameLevels(slicedata *sd, sliceframedata *framei);
+EXTERNCPP void FreeSliceFrames(slicedata *sd);
 EXTERNCPP void GetSliceSizes(char *slicefilenameptr, int time_frame, int *nsliceiptr, int *nslicejptr, int *nslicekptr, int *ntimesptr, int sliceframestep_arg,
   int *errorptr, int settmin_s_arg, int settmax_s_arg, float tmin_s_arg, float tmax_s_arg, int *headersizeptr, int *framesizeptr);
 EXTERNCPP void PrintPartLoadSummary(int option, int type);
@@ -67,8 +79,12 @@ EXTERNCPP void CloseRollouts(GLUI *dialog);
 
 #ifdef pp_SLICETHREAD
 EXTERNCPP void LoadAllSliceFiles(int slicenum);
-EXTERNCPP void FinalizeSliceLoad(slicedata *slicei);
+EXTERNCPP FILE_SIZE FinishAllSliceFiles(int slicenum);
+EXTERNCPP void LoadAllSliceFilesMT(int slicenum);
 #endif
+EXTERNCPP void FinalizeSliceLoad(slicedata *sd, int set_slicecolor, int *errorcode);
+EXTERNCPP void FreeSliceBuffers(slicedata *sd, int flag);
+EXTERNCPP FILE_SIZE ReadSliceData(slicedata *sd, char *file, int time_frame, int flag, int *averagedptr, int *errorcode);
 
 EXTERNCPP void MakeColorLabels(char colorlabels[12][11], float colorvalues[12], float tmin_arg, float tmax_arg, int nlevel);
 EXTERNCPP void FinalizePartLoad(partdata *parti);
@@ -470,6 +486,8 @@ EXTERNCPP void LoadNewSmokeShaders(void);
 #endif
 EXTERNCPP void LoadSmokeShaders(void);
 EXTERNCPP void Load3DSliceShaders(void);
+EXTERNCPP void LoadPartShaders(void);
+EXTERNCPP void LoadBoundaryShaders(void);
 EXTERNCPP void LoadZoneSmokeShaders(void);
 EXTERNCPP void LoadVolsmokeShaders(void);
 EXTERNCPP void UnLoadShaders(void);
@@ -502,6 +520,7 @@ EXTERNCPP void UpdatePartClassDepend(partclassdata *partclassi);
 EXTERNCPP char *GetChid(char *file, char *buffer);
 EXTERNCPP void AddColorbar(int icolorbar);
 EXTERNCPP void ReloadMenu(int value);
+EXTERNCPP void StartFollowFiles(void);
 EXTERNCPP void ColorbarMenu(int val);
 EXTERNCPP void InitDefaultColorbars(int nini);
 EXTERNCPP void DrawColorbarPath(void);
@@ -516,6 +535,15 @@ EXTERNCPP void CopyArgs(int *argc, char **aargv, char ***argv_sv);
 EXTERNCPP void InitUserTicks(void);
 EXTERNCPP void DrawUserTicks(void);
 EXTERNCPP void InitMultiThreading(void);
+EXTERNCPP void PrefetchFrames(void);
+EXTERNCPP void PrintMemoryReport(int option);
+EXTERNCPP void UpdateMemoryDisplayTimes(void);
+EXTERNCPP FILE_SIZE GetMemoryLoadSize(char *file, int memory_id, int *last_display);
+EXTERNCPP void EnforceMemoryBudget(FILE_SIZE load_size);
+EXTERNCPP void GetMemoryTypesLabel(char *label);
+EXTERNCPP char *GetMemoryTypeLabel(int memory_type);
+EXTERNCPP int PrefetchGetFrame(int type, void *object, int iframe, unsigned char **bufferptr, int nbuffer);
+EXTERNCPP void PrefetchFlush(void);
 #ifdef WIN32
 EXTERNCPP void OpenSMVFile(char *filename,int filenamelength,int *openfile);
 #endif
@@ -617,6 +645,7 @@ EXTERNCPP int  PointInFrustum( float *xyz);
 EXTERNCPP int BoxInFrustum(float *xx, float *yy, float *zz);
 EXTERNCPP int  RectangleInFrustum( float *x11, float *x12, float *x22, float *x21);
 EXTERNCPP void UpdateSmoke3D(smoke3ddata *smoke3di);
+EXTERNCPP void UpdateSmoke3DFrames(void);
 #ifdef pp_SMOKETEST
 EXTERNCPP void DrawSmokeFrame(int option);
 #else
@@ -664,6 +693,7 @@ EXTERNCPP char *STRSTR(char *c, const char *key);
 EXTERNCPP void HandlePLOT3DKeys(int  key);
 EXTERNCPP void HandleMoveKeys(int  key);
 EXTERNCPP int GetInterval(float val, float *array, int n);
+EXTERNCPP int GetLoadBox(meshdata *meshi, int *box);
 
 EXTERNCPP void SetUnitVis(void);
 EXTERNCPP void ShowHideTranslate(int var);
@@ -886,6 +916,15 @@ EXTERNCPP FILE_SIZE ReadIso(const char *file, int ifile, int flag, int *geom_fra
 EXTERNCPP void InitMenus(int unload);
 EXTERNCPP void SmoothLabel(float *min, float *max, int n);
 int ReadSMV(bufferstreamdata *stream);
+EXTERNCPP void IndexSMVLines(bufferstreamdata *stream);
+EXTERNCPP void SkipSMVLines(bufferstreamdata *stream, int pass);
+EXTERNCPP int  LoadSMVCache(bufferstreamdata *stream);
+EXTERNCPP void WriteSMVCache(filedata *fileinfo);
+EXTERNCPP smvcacheobstdata *GetSMVCacheObst(int line);
+EXTERNCPP void AddSMVCacheObst(smvcacheobstdata *obsti);
+EXTERNCPP void CopySMVCacheObst(smvcacheobstdata *from, smvcacheobstdata *to);
+EXTERNCPP smvcacheslicedata *GetSMVCacheSlice(int line, char *file);
+EXTERNCPP void AddSMVCacheSlice(int line, char *file, int *ijk);
 EXTERNCPP void ReadSMVDynamic(char *file);
 EXTERNCPP int  STRCMP(const char *s1, const char *s2);
 EXTERNCPP void OutputAxisLabels(void);
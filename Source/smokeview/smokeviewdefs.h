@@ -311,6 +311,10 @@ void _Sniff_Errors(char *whereat, char *file, int line);
 #define CLIP_DATA           3
 #define CLIP_MAX            3
 
+#define LOADBOX_OFF         0 // load 3d slice and 3d smoke files over the whole mesh
+#define LOADBOX_USER        1 // load the box given by the LOADBOX script keyword
+#define LOADBOX_CLIP        2 // load the region inside the clip planes
+
 #define UNCLIP SetClipPlanes(NULL,CLIP_OFF)
 #define CLIP SetClipPlanes(&clipinfo,CLIP_ON)
 
@@ -628,6 +632,7 @@ void _Sniff_Errors(char *whereat, char *file, int line);
 #define RELOAD_MODE_INCREMENTAL -5
 #define RELOAD_MODE_ALL -6
 #define RELOAD_SMV_FILE -7
+#define RELOAD_FOLLOW -8
 
 #define RELOAD_INCREMENTAL_ALL 9
 #define RELOADALL 4
@@ -708,6 +713,41 @@ void _Sniff_Errors(char *whereat, char *file, int line);
 #define SMOKE3D_ZEROS_ALL     1
 #define SMOKE3D_ZEROS_UNKNOWN 2
 
+#define VOLSMOKE_TILE_ROWS 4
+
+#define SMV_PASS1         1
+#define SMV_PASS2         2
+#define SMV_PASS3         4
+#define SMV_PASS4         8
+#define SMV_PASS5         16
+#define SMV_DYNAMIC_PASS1 32
+#define SMV_DYNAMIC_PASS2 64
+#define SMV_DYNAMIC_PASS3 128
+
+#define SMVCACHE_MAGIC    "SMVIDX"
+#define SMVCACHE_VERSION  2
+#define SMVCACHE_OFF      0
+#define SMVCACHE_READ     1
+#define SMVCACHE_RECORD   2
+
+#define SMVDYNAMIC_NCHECK 4096
+
+#define FOLLOW_SMV        0
+#define FOLLOW_SLICE      1
+#define FOLLOW_VSLICE     2
+#define FOLLOW_BOUNDARY   3
+#define FOLLOW_SMOKE3D    4
+#define FOLLOW_PART       5
+
+#define PREFETCH_SMOKE3D  0
+#define PREFETCH_SLICE    1
+#define PREFETCH_BOUNDARY 2
+
+#define PREFETCH_EMPTY    0
+#define PREFETCH_QUEUED   1
+#define PREFETCH_BUSY     2
+#define PREFETCH_READY    3
+
 #define SHOW_VOLSMOKE -2
 #define HIDE_VOLSMOKE -1
 #define TOGGLE_VOLSMOKE -3
@@ -807,6 +847,7 @@ void _Sniff_Errors(char *whereat, char *file, int line);
 #define RELOAD      3
 #define UPDATE_HIST 4
 #define BOUNDS_ONLY 5
+#define FINISH_LOAD 6
 
 #define FIRST_TIME  1
 #define LATER_TIMES 0
@@ -865,6 +906,16 @@ void _Sniff_Errors(char *whereat, char *file, int line);
 #define MENU_LABEL_hrr                 19
 #define MENU_LABEL_northangle          20
 #define MENU_LABEL_SETTINGS            21
+#define MENU_LABEL_memtypes            22
+
+#define MEMORY_OTHER                    0
+#define MEMORY_SLICE                    1
+#define MEMORY_BOUNDARY                 2
+#define MEMORY_SMOKE3D                  3
+#define MEMORY_PART                     4
+#define MEMORY_ISO                      5
+#define MEMORY_GEOM                     6
+#define NMEMORY_TYPES                   7
 
 #define MENU_TITLE_title_smv_version    0
 #define MENU_TITLE_title_fds            1
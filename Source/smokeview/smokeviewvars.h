@@ -126,11 +126,38 @@ SVEXTERN int npart5loaded, npartloaded, nevacloaded;
 #ifdef pp_SLICETHREAD
 SVEXTERN int SVDECL(nslicethread_ids, 4);
 SVEXTERN int SVDECL(slice_multithread, 0);
+SVEXTERN int SVDECL(slice_file_count, 0);
+SVEXTERN FILE_SIZE SVDECL(slice_load_size, 0);
 #endif
 
 SVEXTERN int SVDECL(global_have_global_bound_file, 0);
 SVEXTERN FILE_SIZE  SVDECL(global_part_boundsize, 0);
 SVEXTERN int SVDECL(npartthread_ids, 4);
+SVEXTERN int SVDECL(pool_nthreads, 0), SVDECL(show_task_timings, 0);
+SVEXTERN int SVDECL(smoke3d_multithread, 1);
+SVEXTERN int SVDECL(nsmoke3d_update, 0), SVDECL(nsmoke3d_update_list, 0), SVDECL(nsmoke3d_update_tasks, 1);
+SVEXTERN smoke3ddata SVDECL(**smoke3d_update_list, NULL);
+SVEXTERN int SVDECL(volsmoke_multithread, 1);
+SVEXTERN int SVDECL(nvolsmoke_tiles, 0), SVDECL(nvolsmoke_tiles_max, 0), SVDECL(nvolsmoke_tile_tasks, 1);
+SVEXTERN volsmoketiledata SVDECL(*volsmoke_tiles, NULL);
+SVEXTERN int SVDECL(part_decode_multithread, 1);
+SVEXTERN int SVDECL(boundary_multithread, 1);
+SVEXTERN int SVDECL(load_box_option, LOADBOX_OFF);
+SVEXTERN int SVDECL(*smvkeyword_hash, NULL), SVDECL(smvkeyword_hash_size, 0);
+SVEXTERN unsigned int SVDECL(smvkeyword_seed, 0);
+SVEXTERN int SVDECL(use_smvcache, 1), SVDECL(smvcache_mode, SMVCACHE_OFF);
+SVEXTERN smvcacheheaderdata smvcache_header;
+SVEXTERN mmapfiledata smvcache_map;
+SVEXTERN smvcacheobstdata SVDECL(*smvcache_obsts, NULL);
+SVEXTERN int SVDECL(nsmvcache_obsts, 0), SVDECL(nsmvcache_obsts_max, 0), SVDECL(ismvcache_obst, 0);
+SVEXTERN smvcacheslicedata SVDECL(*smvcache_slices, NULL);
+SVEXTERN int SVDECL(nsmvcache_slices, 0), SVDECL(nsmvcache_slices_max, 0), SVDECL(ismvcache_slice, 0);
+SVEXTERN FILE_SIZE SVDECL(smvdynamic_offset, 0), SVDECL(smvdynamic_nchecked, 0);
+SVEXTERN unsigned long long SVDECL(smvdynamic_check, 0);
+SVEXTERN int SVDECL(smvdynamic_ioffset, 0), SVDECL(smvdynamic_nn_plot3d, 0);
+SVEXTERN int SVDECL(follow_files, 0), SVDECL(follow_interval, 1000), SVDECL(follow_timer, 0), SVDECL(follow_watch, -1);
+SVEXTERN followdata SVDECL(*followinfo, NULL);
+SVEXTERN int SVDECL(nfollowinfo, 0);
 SVEXTERN int SVDECL(partfast, NO);
 SVEXTERN int SVDECL(have_vr, 0), SVDECL(use_vr,0);
 SVEXTERN int SVDECL(use_fire_alpha, 0);
@@ -169,6 +196,22 @@ SVEXTERN int SVDECL(script_defer_loading, 0);
 
 SVEXTERN int SVDECL(use_light0, 1), SVDECL(use_light1, 1);
 SVEXTERN int SVDECL(use_cslice, 1);
+SVEXTERN int SVDECL(use_slice_mmap, 1);
+SVEXTERN int SVDECL(use_slice_vbo, 1);
+SVEXTERN int SVDECL(use_blockage_vbo, 1), SVDECL(update_blockage_vbo, 1);
+SVEXTERN int SVDECL(use_part_gpu, 1), SVDECL(update_part_vbo, 1);
+SVEXTERN int SVDECL(use_boundary_gpu, 1), SVDECL(update_boundary_vbo, 1);
+SVEXTERN int SVDECL(use_part_lod, 0), SVDECL(part_lod_level, 256);
+SVEXTERN float SVDECL(part_lod_density, 0.25);
+SVEXTERN int SVDECL(slice_frame_budget, 0);
+SVEXTERN int SVDECL(prefetch_nframes, 0), SVDECL(prefetch_ringsize, 32), SVDECL(prefetch_nthreads, 2);
+SVEXTERN int SVDECL(nprefetchinfo, 0), SVDECL(iprefetchinfo, 0), SVDECL(prefetch_threads_started, 0);
+SVEXTERN int SVDECL(prefetch_hits, 0), SVDECL(prefetch_misses, 0);
+SVEXTERN int SVDECL(show_memory_report, 0), SVDECL(visMemorytypes, 0);
+SVEXTERN int SVDECL(memory_budget, 0), SVDECL(memory_display_count, 0);
+SVEXTERN prefetchdata SVDECL(*prefetchinfo, NULL);
+SVEXTERN FILE_SIZE SVDECL(slice_frame_cache_size, 0);
+SVEXTERN sliceframedata SVDECL(*slice_frame_first, NULL), SVDECL(*slice_frame_last, NULL);
 SVEXTERN int SVDECL(iso_transparency_option, 1);
 SVEXTERN int SVDECL(iso_opacity_change, 1);
 
@@ -477,7 +520,6 @@ SVEXTERN geomdiagdata SVDECL(*geomdiaginfo,NULL);
 SVEXTERN int SVDECL(zone_rho, 1);
 SVEXTERN int SVDECL(visventslab, 0), SVDECL(visventprofile, 1);
 SVEXTERN int SVDECL(update_readiso_geom_wrapup, UPDATE_ISO_OFF);
-SVEXTERN int SVDECL(nmemory_ids, 0);
 SVEXTERN int SVDECL(update_playmovie, 0);
 SVEXTERN int SVDECL(play_movie_now, 1);
 SVEXTERN int SVDECL(update_makemovie, 0),SVDECL(movie_filetype,AVI);
@@ -607,8 +649,8 @@ SVEXTERN char default_fed_colorbar[255];
 SVEXTERN int SVDECL(*meshvisptr,NULL);
 SVEXTERN smoke3ddata SVDECL(**smoke3dinfo_sorted,NULL);
 SVEXTERN int SVDECL(from_commandline,0);
-SVEXTERN filelistdata SVDECL(*ini_filelist,NULL), SVDECL(*filelist_casename, NULL), SVDECL(*filelist_casedir, NULL);
-SVEXTERN int          SVDECL(nini_filelist,0),    SVDECL(nfilelist_casename, 0),    SVDECL(nfilelist_casedir, 0);
+SVEXTERN filelistdata SVDECL(*ini_filelist,NULL), SVDECL(**stat_casefiles, NULL);
+SVEXTERN int          SVDECL(nini_filelist,0), SVDECL(nstat_casefiles, 0), SVDECL(nstat_casefile_tasks, 1), SVDECL(stat_sweep, 0);
 SVEXTERN float this_mouse_time, SVDECL(last_mouse_time,0.0);
 SVEXTERN int move_gslice;
 
@@ -788,6 +830,11 @@ SVEXTERN int GPU3dslice_valtexture,GPU3dslice_colormap;
 SVEXTERN int GPU3dslice_val_min,GPU3dslice_val_max;
 SVEXTERN int GPU3dslice_boxmin, GPU3dslice_boxmax;
 SVEXTERN int GPU3dslice_transparent_level;
+SVEXTERN int GPUpart_sx, GPUpart_sy, GPUpart_sz, GPUpart_vis, GPUpart_rank, GPUpart_color;
+SVEXTERN int GPUpart_xyz0, GPUpart_dxyz, GPUpart_colormap;
+SVEXTERN int GPUpart_use_default, GPUpart_default_color, GPUpart_imin, GPUpart_imax, GPUpart_lod_level;
+SVEXTERN int GPUbndf_position, GPUbndf_value, GPUbndf_thresholdtime, GPUbndf_colormap;
+SVEXTERN int GPUbndf_cell_center, GPUbndf_use_data, GPUbndf_use_threshold, GPUbndf_burn_color, GPUbndf_time;
 SVEXTERN int GPUvol_block_volsmoke;
 SVEXTERN int GPUvol_voltemp_offset;
 SVEXTERN int GPUvol_voltemp_factor;
@@ -1349,9 +1396,39 @@ SVEXTERN float tour_xyz[3]={0.0,0.0,0.0};
 SVEXTERN float gslice_xyz[3]={-1000001.0,-1000001.0,-1000001.0};
 SVEXTERN float gslice_normal_xyz[3]={0.0,0.0,1.0};
 SVEXTERN float gslice_normal_azelev[2]={0.0,90.0};
+SVEXTERN double smoke3d_decode_time[2]={0.0,0.0};
+SVEXTERN int nsmoke3d_decode_frames[2]={0,0};
+SVEXTERN double volsmoke_compute_time[2]={0.0,0.0};
+SVEXTERN int nvolsmoke_compute_frames[2]={0,0};
+SVEXTERN double part_decode_time[2]={0.0,0.0};
+SVEXTERN int npart_decode_files[2]={0,0}, npart_decode_frames[2]={0,0};
+SVEXTERN double slice_draw_time[2]={0.0,0.0};
+SVEXTERN int nslice_draw_frames[2]={0,0};
+SVEXTERN double blockage_draw_time[2]={0.0,0.0};
+SVEXTERN int nblockage_draw_frames[2]={0,0};
+SVEXTERN double part_draw_time[4]={0.0,0.0,0.0,0.0};
+SVEXTERN int npart_draw_frames[4]={0,0,0,0};
+SVEXTERN double boundary_draw_time[2]={0.0,0.0};
+SVEXTERN int nboundary_draw_frames[2]={0,0};
+SVEXTERN float load_box[6]={0.0,0.0,0.0,0.0,0.0,0.0};
 #else
 SVEXTERN float tour_xyz[3];
 SVEXTERN float gslice_xyz[3];
+SVEXTERN double smoke3d_decode_time[2];
+SVEXTERN int nsmoke3d_decode_frames[2];
+SVEXTERN double volsmoke_compute_time[2];
+SVEXTERN int nvolsmoke_compute_frames[2];
+SVEXTERN double part_decode_time[2];
+SVEXTERN int npart_decode_files[2], npart_decode_frames[2];
+SVEXTERN double slice_draw_time[2];
+SVEXTERN int nslice_draw_frames[2];
+SVEXTERN double blockage_draw_time[2];
+SVEXTERN int nblockage_draw_frames[2];
+SVEXTERN double part_draw_time[4];
+SVEXTERN int npart_draw_frames[4];
+SVEXTERN double boundary_draw_time[2];
+SVEXTERN int nboundary_draw_frames[2];
+SVEXTERN float load_box[6];
 SVEXTERN float gslice_normal_xyz[3];
 SVEXTERN float gslice_normal_azelev[3];
 #endif
@@ -1519,6 +1596,7 @@ SVEXTERN FILE SVDECL(*STREAM_SB,NULL);
 SVEXTERN float temp_threshold;
 SVEXTERN char SVDECL(*smv_filename,NULL),SVDECL(*fed_filename,NULL),fed_filename_base[1024],SVDECL(*stop_filename,NULL);
 SVEXTERN char SVDECL(*part_globalbound_filename, NULL);
+SVEXTERN char SVDECL(*smvcache_filename, NULL);
 SVEXTERN char SVDECL(*sliceinfo_filename,NULL);
 SVEXTERN char SVDECL(*deviceinfo_filename, NULL);
 SVEXTERN char SVDECL(*database_filename,NULL),SVDECL(*smokeview_bindir,NULL),SVDECL(*iso_filename,NULL);
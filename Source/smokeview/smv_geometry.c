@@ -999,6 +999,62 @@ int GetInterval(float val, float *array, int n){
   return low;
 }
 
+/* ------------------ GetLoadBox ------------------------ */
+
+int GetLoadBox(meshdata *meshi, int *box){
+
+// node bounds box=(i1,i2,j1,j2,k1,k2) of the part of meshi kept when 3d slice and 3d smoke
+// files are loaded.  The region comes from the LOADBOX script keyword (load_box) or from
+// the clip planes.  The box always contains at least one cell.
+// returns 0 if the whole mesh is loaded, -1 if the region misses meshi (nothing should be
+// loaded) and 1 otherwise
+
+  float *plts[3], xyzbox[6];
+  int nbars[3], dir, active = 0, outside = 0;
+
+  plts[0] = meshi->xplt_orig;
+  plts[1] = meshi->yplt_orig;
+  plts[2] = meshi->zplt_orig;
+  nbars[0] = meshi->ibar;
+  nbars[1] = meshi->jbar;
+  nbars[2] = meshi->kbar;
+  for(dir = 0; dir<3; dir++){
+    xyzbox[2*dir]   = plts[dir][0];
+    xyzbox[2*dir+1] = plts[dir][nbars[dir]];
+  }
+  if(load_box_option==LOADBOX_USER){
+    memcpy(xyzbox, load_box, 6*sizeof(float));
+  }
+  else if(load_box_option==LOADBOX_CLIP&&clip_mode!=CLIP_OFF){
+    if(clipinfo.clip_xmin==1)xyzbox[0] = clipinfo.xmin;
+    if(clipinfo.clip_xmax==1)xyzbox[1] = clipinfo.xmax;
+    if(clipinfo.clip_ymin==1)xyzbox[2] = clipinfo.ymin;
+    if(clipinfo.clip_ymax==1)xyzbox[3] = clipinfo.ymax;
+    if(clipinfo.clip_zmin==1)xyzbox[4] = clipinfo.zmin;
+    if(clipinfo.clip_zmax==1)xyzbox[5] = clipinfo.zmax;
+  }
+  for(dir = 0; dir<3; dir++){
+    float *plt, vmin, vmax;
+    int n, i1, i2;
+
+    plt = plts[dir];
+    n = nbars[dir];
+    vmin = xyzbox[2*dir];
+    vmax = xyzbox[2*dir+1];
+    if(vmax<plt[0]||vmin>plt[n])outside = 1;
+
+    // largest node <= vmin and smallest node >= vmax
+
+    for(i1 = n-1; i1>0&&plt[i1]>vmin; i1--);
+    for(i2 = i1+1; i2<n&&plt[i2]<vmax; i2++);
+    box[2*dir]   = i1;
+    box[2*dir+1] = i2;
+    if(i1>0||i2<n)active = 1;
+  }
+  if(outside==1)return -1;
+  return active;
+}
+
 /* ------------------ GetNewPos ------------------------ */
 
 void GetNewPos(float *oldpos, float dx, float dy, float dz,float local_speed_factor){
@@ -194,6 +194,12 @@ int SetupCase(int argc, char **argv){
   STRCAT(part_globalbound_filename, ".prt5.gbnd");
   part_globalbound_filename = GetFileName(smokeviewtempdir, part_globalbound_filename, NOT_FORCE_IN_DIR);
 
+  FREEMEMORY(smvcache_filename);
+  NewMemory((void **)&smvcache_filename, strlen(fdsprefix)+strlen(".smvidx")+1);
+  STRCPY(smvcache_filename, fdsprefix);
+  STRCAT(smvcache_filename, ".smvidx");
+  smvcache_filename = GetFileName(smokeviewtempdir, smvcache_filename, NOT_FORCE_IN_DIR);
+
   // setup input files names
 
   input_file = smv_filename;
@@ -225,6 +225,7 @@ typedef struct _scriptdata {
   int need_graphics;
   char *cval,*cval2;
   float fval,fval2,fval3,fval4,fval5;
+  float *fvals;
   int exit,first,remove_frame;
 } scriptdata;
 
@@ -564,7 +565,7 @@ typedef struct _isodata {
   int isof_index;
   char *reg_file, *size_file, *topo_file;
   short *normaltable;
-  int memory_id;
+  int memory_id, last_display;
   int fds_skip;
   float fds_delta;
   int nnormaltable;
@@ -627,6 +628,28 @@ typedef struct _volrenderdata {
   int loaded, display;
 } volrenderdata;
 
+/* --------------------------  blockagevbodata ------------------------------------ */
+
+typedef struct _blockagevbodata {
+  int defined, blocklocation;
+  GLuint vertex_id, index_id;
+  int nbatches, nbatches_single;
+  float **batch_colors;
+  int *batch_starts, *batch_counts;
+  facedata **faces_dynamic;
+  int nfaces_dynamic_single, nfaces_dynamic_double;
+} blockagevbodata;
+
+/* --------------------------  boundaryvbodata ------------------------------------ */
+
+typedef struct _boundaryvbodata {
+  int defined;
+  GLuint vertex_id, index_id, value_id;
+  int *patch_starts, *patch_counts;
+  int *draw_counts;
+  GLvoid **draw_starts;
+} boundaryvbodata;
+
 /* --------------------------  meshplanedata ------------------------------------ */
 
 typedef struct _meshplanedata {
@@ -774,6 +797,7 @@ typedef struct _meshdata {
   float **patchventcolors;
   float *thresholdtime;
   int *patchblank;
+  boundaryvbodata boundary_vbo;
   int npatch_times,npatches;
   int patch_itime;
   int *patch_timeslist;
@@ -790,6 +814,7 @@ typedef struct _meshdata {
   int nface_normals_single_DOWN_X,nface_normals_single_UP_X;
   int nface_normals_single_DOWN_Y,nface_normals_single_UP_Y;
   int nface_normals_single_DOWN_Z,nface_normals_single_UP_Z;
+  blockagevbodata face_vbo;
 
   int itextureoffset;
 
@@ -837,6 +862,55 @@ typedef struct _supermeshdata {
   int ibar, jbar, kbar;
 } supermeshdata;
 
+/* --------------------------  smvkeyworddata ------------------------------------ */
+
+typedef struct _smvkeyworddata {
+  char *keyword;
+  int passes;
+} smvkeyworddata;
+
+/* --------------------------  smvcacheheaderdata ------------------------------------ */
+
+typedef struct _smvcacheheaderdata {
+  FILE_SIZE smv_size;
+  unsigned long long smv_hash;
+  long long smv_modtime;
+  char magic[8];
+  int version, nlines, nkeywords, nobsts, nslices, dummy;
+  unsigned int keyword_hash, dummy2;
+} smvcacheheaderdata;
+
+/* --------------------------  smvcacheobstdata ------------------------------------ */
+
+typedef struct _smvcacheobstdata {
+  int line, nvals;
+  int blockage_id, s_num[6];
+  float xyzEXACT[6], t_origin[3];
+} smvcacheobstdata;
+
+/* --------------------------  smvcacheslicedata ------------------------------------ */
+
+typedef struct _smvcacheslicedata {
+  FILE_SIZE file_size;
+  long long file_modtime;
+  int line, ijk[6], dummy;
+} smvcacheslicedata;
+
+/* --------------------------  followdata ------------------------------------ */
+
+typedef struct _followdata {
+  char *file;
+  int type, index, watch_id;
+  FILE_SIZE size;
+} followdata;
+
+/* --------------------------  volsmoketiledata ------------------------------------ */
+
+typedef struct _volsmoketiledata {
+  meshdata *meshi;
+  int iwall, irow1, irow2;
+} volsmoketiledata;
+
 /* --------------------------  volfacelistdata ------------------------------------ */
 
 typedef struct _volfacelistdata {
@@ -1125,13 +1199,36 @@ typedef struct _part5data {
   float *dsx, *dsy, *dsz;
   float *avatar_angle, *avatar_width, *avatar_depth, *avatar_height;
   int humancolor_varindex;
-  int *tags,*sort_tags;
-  unsigned char *vis_part;
+  int *tags,*tag_hash;
+  unsigned char *vis_part, *ranks;
   float *rvals,**rvalsptr;
   unsigned char *irvals;
   unsigned char **cvals;
 } part5data;
 
+/* --------------------------  partframedata ------------------------------------ */
+
+typedef struct _partframedata {
+  part5data *datacopy;
+  float *xyz;
+  int *tags, nparts;
+} partframedata;
+
+/* --------------------------  partdecodedata ------------------------------------ */
+
+typedef struct _partdecodedata {
+  struct _partdata *parti;
+  partframedata *frames;
+  int nframes, itask, ntasks;
+} partdecodedata;
+
+/* --------------------------  partvbodata ------------------------------------ */
+
+typedef struct _partvbodata {
+  GLuint *buffer_ids;
+  int nbuffers, frame;
+} partvbodata;
+
 /* --------------------------  partdata ------------------------------------ */
 
 typedef struct _partdata {
@@ -1139,7 +1236,7 @@ typedef struct _partdata {
 
   char *file, *comp_file, *size_file, *reg_file, *hist_file, *bound_file;
   int seq_id, autoload, loaded, skipload, request_load, display, reload, finalize;
-  int loadstatus, boundstatus;
+  int loadstatus, boundstatus, memory_id, last_display;
   int compression_type, evac;
   int blocknumber;
   int *timeslist, ntimes, itime;
@@ -1160,11 +1257,12 @@ typedef struct _partdata {
 #endif
   int bounds_set;
   float *global_min, *global_max;
-  unsigned char *vis_part;
+  unsigned char *vis_part, *ranks;
   int *tags;
-  int *sort_tags;
+  int *tag_hash;
   short *sx, *sy, *sz;
   unsigned char *irvals;
+  partvbodata vbo;
 } partdata;
 
 /* --------------------------  compdata ------------------------------------ */
@@ -1210,11 +1308,64 @@ typedef struct _multiresdata {
 } multiresdata;
 #endif
 
+/* --------------------------  prefetchdata ------------------------------------ */
+
+typedef struct _prefetchdata {
+  void *object;
+  int type, iframe, state, cancel;
+  unsigned char *buffer;
+  int nbuffer;
+} prefetchdata;
+
+/* --------------------------  memoryfiledata ------------------------------------ */
+
+typedef struct _memoryfiledata {
+  int memory_id, memory_type, index, last_display;
+  MMsize bytes;
+  char *file;
+} memoryfiledata;
+
+/* --------------------------  sliceframedata ------------------------------------ */
+
+typedef struct _sliceframedata {
+  struct _slicedata *slicei;
+  int itime;
+  float *vals;
+  unsigned char *levels;
+  struct _sliceframedata *prev, *next;
+} sliceframedata;
+
+/* --------------------------  slicevbodata ------------------------------------ */
+
+typedef struct _slicevbodata {
+  int defined;
+  int ijk_start[3], nijk[3];
+  char *c_iblank[3], *c_iblank_embed;
+  int show_slice_in_obst, skip_slice_in_embedded_mesh;
+  int na[3], nb[3], nplanes[3];
+  GLuint vertex_ids[3], texcoord_ids[3];
+  GLuint *index_ids[3];
+  int *nindices[3];
+  float *texcoords;
+  int ntexcoords;
+} slicevbodata;
+
+/* --------------------------  slicepagedata ------------------------------------ */
+
+typedef struct _slicepagedata {
+  FILE *stream;
+  FILE_SIZE *frame_offsets;
+  sliceframedata **frames;
+  int nframes;
+  int nxsp, nysp, nzsp, joff, koff, contiguous;
+  float datamin, datamax, colormin, colormax;
+} slicepagedata;
+
 /* --------------------------  slicedata ------------------------------------ */
 
 typedef struct _slicedata {
   int mesh_type;
-  int seq_id, autoload;
+  int seq_id, autoload, memory_id, last_display, force_paged;
   char *file, *size_file, *bound_file;
   char *comp_file, *reg_file, *vol_file;
   char *geom_file;
@@ -1295,8 +1446,13 @@ typedef struct _slicedata {
   struct _boundsdata *bounds;
 #endif
   FILE_SIZE file_size;
+  int paged, cropped;
+  slicepagedata pageinfo;
+  slicevbodata vbo;
 #ifdef pp_SLICETHREAD
   int skipload, loadstatus, boundstatus;
+  int load_error, load_averaged;
+  FILE_SIZE load_size;
 #endif
 } slicedata;
 
@@ -1392,7 +1548,7 @@ typedef struct {
   /* --------------------------  smoke3ddata ------------------------------------ */
 
 typedef struct _smoke3ddata {
-  int seq_id,autoload;
+  int seq_id,autoload,memory_id,last_display;
   char *file;
   char *comp_file, *reg_file;
   int filetype;
@@ -1420,6 +1576,7 @@ typedef struct _smoke3ddata {
   unsigned char *smokeview_tmp;
   unsigned char *smoke_comp_all;
   unsigned char *frame_all_zeros;
+  int update_box, cropped;
   FILE_SIZE file_size;
   float *smoke_boxmin, *smoke_boxmax;
   smokedata smoke, light;
@@ -1429,7 +1586,7 @@ typedef struct _smoke3ddata {
 /* --------------------------  patchdata ------------------------------------ */
 
 typedef struct _patchdata {
-  int seq_id, autoload;
+  int seq_id, autoload, memory_id, last_display;
   char *file,*size_file,*bound_file;
   char *comp_file, *reg_file;
   char *geomfile, *filetype_label;
@@ -1470,6 +1627,15 @@ typedef struct _patchdata {
   bounddata bounds;
 } patchdata;
 
+/* --------------------------  bndffiledata ------------------------------------ */
+
+typedef struct _bndffiledata {
+  mmapfiledata map;
+  int npatches, npatchsize, nframes;
+  int *ijk, *patchsize;
+  FILE_SIZE header_size, frame_size;
+} bndffiledata;
+
 /* --------------------------  plot3ddata ------------------------------------ */
 
 typedef struct _plot3ddata {
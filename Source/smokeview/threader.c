@@ -3,9 +3,11 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include GLUT_H
 
 #include "smokeviewvars.h"
 #include "IOvolsmoke.h"
+#include "compress.h"
 
 /* ------------------ InitMultiThreading ------------------------ */
 
@@ -14,12 +16,16 @@ void InitMultiThreading(void){
 #ifdef pp_SLICETHREAD
   pthread_mutex_init(&mutexSLICE_LOAD, NULL);
 #endif
+  ThreadPoolInit(pool_nthreads);
   pthread_mutex_init(&mutexPART_LOAD, NULL);
   pthread_mutex_init(&mutexCOMPRESS,NULL);
 #ifdef pp_ISOTHREAD
   pthread_mutex_init(&mutexTRIANGLES,NULL);
 #endif
   pthread_mutex_init(&mutexVOLLOAD,NULL);
+  pthread_mutex_init(&mutexPREFETCH,NULL);
+  pthread_mutex_init(&mutexSLICE_FRAMES,NULL);
+  pthread_cond_init(&condPREFETCH,NULL);
 #ifdef pp_THREADIBLANK
   pthread_mutex_init(&mutexIBLANK, NULL);
 #endif
@@ -97,40 +103,69 @@ void CompressSVZip(void){
 /* ------------------ MtLoadAllSliceFiles ------------------------ */
 
 void *MtLoadAllSliceFiles(void *arg){
-  int *valptr;
-
-  valptr = (int *)(arg);
-  LoadAllSliceFiles(*valptr);
-  pthread_exit(NULL);
+  LoadAllSliceFiles(*(int *)arg);
   return NULL;
 }
 
-/* ------------------ LoadAllSlieFilesMT ------------------------ */
+/* ------------------ LoadAllSliceFilesMT ------------------------ */
 
 void LoadAllSliceFilesMT(int slicenum){
   int i;
+  float load_time;
+  FILE_SIZE budget_size = 0;
+
+  START_TIMER(load_time);
+  PrefetchFlush();
+  slice_load_size = 0;
+  slice_file_count = 0;
+  for(i = 0; i<nsliceinfo; i++){
+    slicedata *slicei;
+
+    slicei = sliceinfo+i;
+    if(slicei->skipload==1)continue;
+    if(slicenum>=0&&i!=slicenum)continue;
+    budget_size += GetMemoryLoadSize(slicei->file, slicei->memory_id, &slicei->last_display);
+  }
+  EnforceMemoryBudget(budget_size);  // the slice threads can't unload files so make room for all of them first
+  for(i = 0; i<nsliceinfo; i++){
+    slicedata *slicei;
+
+    slicei = sliceinfo+i;
+    if(slicei->skipload==1)continue;
+    if(slicenum>=0&&i!=slicenum)continue;
+    slicei->display = 0;
+    slicei->load_size = 0;
+    slicei->load_error = 0;
+    slicei->load_averaged = 0;
+    FreeSliceFrames(slicei);  // the frame cache list is shared, so release it before the threads start
+  }
 
   if(slice_multithread==0){
     LoadAllSliceFiles(slicenum);
-    return;
   }
+  else{
+    taskdata *tasks[MAX_SLICE_THREADS];
+    int ntasks;
 
-  for(i = 0; i<nslicethread_ids; i++){
-    pthread_create(slicethread_ids+i, NULL, MtLoadAllSliceFiles, &slicenum);
-  }
-  for(i=0;i<nslicethread_ids;i++){
-    pthread_join(slicethread_ids[i],NULL);
-  }
-  if(slicenum<0){
-    for(i = 0; i<nsliceinfo; i++){
-      slicedata *slicei;
-
-     slicei = sliceinfo+i;
-      if(slicei->finalize==1)FinalizeSliceLoad(slicei);
+    ntasks = CLAMP(nslicethread_ids, 1, MAX_SLICE_THREADS);
+    for(i = 0; i<ntasks; i++){
+      tasks[i] = ThreadPoolSubmit("slice load", MtLoadAllSliceFiles, &slicenum);
     }
+    ThreadPoolWaitAll(tasks, ntasks);
   }
-  else{
-    FinalizeSliceLoad(sliceinfo+slicenum);
+  slice_load_size = FinishAllSliceFiles(slicenum);
+  STOP_TIMER(load_time);
+  if(slice_file_count>1){
+    PRINTF("Loaded %i slice files", slice_file_count);
+    if(slice_load_size>1000000000){
+      PRINTF(" - %.1f GB in %.1f s\n", (float)slice_load_size/1000000000., load_time);
+    }
+    else if(slice_load_size>1000000){
+      PRINTF(" - %.1f MB in %.1f s\n", (float)slice_load_size/1000000., load_time);
+    }
+    else{
+      PRINTF(" - %.0f kB in %.1f s\n", (float)slice_load_size/1000., load_time);
+    }
   }
 }
 #endif
@@ -140,6 +175,7 @@ void LoadAllSliceFilesMT(int slicenum){
 #ifdef pp_SLICETHREAD
 void LoadAllSliceFilesMT(int slicenum){
   LoadAllSliceFiles(slicenum);
+  FinishAllSliceFiles(slicenum);
 }
 #endif
 #endif
@@ -154,26 +190,38 @@ void *MtLoadAllPartFiles(void *arg){
 
   valptr = (int *)(arg);
   LoadAllPartFiles(*valptr);
-  pthread_exit(NULL);
   return NULL;
 }
 
 /* ------------------ LoadAllPartFilesMT ------------------------ */
 
 void LoadAllPartFilesMT(int partnum){
-  int i;
+  taskdata *tasks[MAX_PART_THREADS];
+  int i, ntasks;
+  FILE_SIZE budget_size = 0;
 
   if(part_multithread==0){
     LoadAllPartFiles(partnum);
     return;
   }
 
-  for(i = 0; i<npartthread_ids; i++){
-    pthread_create(partthread_ids+i, NULL, MtLoadAllPartFiles, &partnum);
+  // the particle threads can't unload files so make room for all of them first
+
+  for(i = 0; i<npartinfo; i++){
+    partdata *parti;
+
+    parti = partinfo+i;
+    if(parti->skipload==1)continue;
+    if(partnum>=0&&i!=partnum)continue;
+    budget_size += GetMemoryLoadSize(parti->file, parti->memory_id, &parti->last_display);
   }
-  for(i=0;i<npartthread_ids;i++){
-    pthread_join(partthread_ids[i],NULL);
+  EnforceMemoryBudget(budget_size);
+
+  ntasks = CLAMP(npartthread_ids, 1, MAX_PART_THREADS);
+  for(i = 0; i<ntasks; i++){
+    tasks[i] = ThreadPoolSubmit("part load", MtLoadAllPartFiles, &partnum);
   }
+  ThreadPoolWaitAll(tasks, ntasks);
   if(partnum<0){
     for(i = 0; i<npartinfo; i++){
       partdata *parti;
@@ -197,7 +245,6 @@ void LoadAllPartFilesMT(int partnum){
 
 void *MtGetAllPartBounds(void *arg){
   GetAllPartBounds();
-  pthread_exit(NULL);
   return NULL;
 }
 
@@ -205,14 +252,14 @@ void *MtGetAllPartBounds(void *arg){
 
 void GetAllPartBoundsMT(void){
   if(part_multithread==1){
-    int i;
+    taskdata *tasks[MAX_PART_THREADS];
+    int i, ntasks;
 
-    for(i = 0; i<npartthread_ids; i++){
-      pthread_create(partthread_ids+i, NULL, MtGetAllPartBounds, NULL);
-    }
-    for(i = 0; i<npartthread_ids; i++){
-      pthread_join(partthread_ids[i], NULL);
+    ntasks = CLAMP(npartthread_ids, 1, MAX_PART_THREADS);
+    for(i = 0; i<ntasks; i++){
+      tasks[i] = ThreadPoolSubmit("part bounds", MtGetAllPartBounds, NULL);
     }
+    ThreadPoolWaitAll(tasks, ntasks);
   }
   else{
     GetAllPartBounds();
@@ -233,7 +280,6 @@ void GetAllPartBoundsMT(void){
 #ifdef pp_THREAD
 void *MtUpdateTriangles(void *arg){
   UpdateTriangles(GEOM_DYNAMIC,GEOM_UPDATE_ALL);
-  pthread_exit(NULL);
   return NULL;
 }
 
@@ -241,7 +287,7 @@ void *MtUpdateTriangles(void *arg){
 
 void UpdateTrianglesMT(void){
   if(iso_multithread==1){
-    pthread_create(&triangles_id, NULL, MtUpdateTriangles, NULL);
+    triangles_task = ThreadPoolSubmit("triangles", MtUpdateTriangles, NULL);
   }
   else{
     UpdateTriangles(GEOM_DYNAMIC, GEOM_UPDATE_ALL);
@@ -251,7 +297,10 @@ void UpdateTrianglesMT(void){
 /* ------------------ FinishUpdateTriangles ------------------------ */
 
 void FinishUpdateTriangles(void){
-  if(iso_multithread==1)pthread_join(triangles_id, NULL);
+  if(iso_multithread==1){
+    ThreadPoolWait(triangles_task);
+    triangles_task = NULL;
+  }
 }
 
 /* ------------------ CancelUpdateTriangles ------------------------ */
@@ -293,7 +342,6 @@ void *MtMakeIBlank(void *arg){
   LOCK_IBLANK
   update_setvents = 1;
   UNLOCK_IBLANK
-  pthread_exit(NULL);
   return NULL;
 }
 #endif
@@ -333,7 +381,15 @@ void SampleMT(void){
 #ifdef pp_THREAD
 #ifdef pp_THREADIBLANK
 void MakeIBlankAll(void){
-  pthread_create(&makeiblank_thread_id, NULL, MtMakeIBlank, NULL);
+  JoinIBlank();
+  iblank_task = ThreadPoolSubmit("iblank", MtMakeIBlank, NULL);
+}
+
+/* ------------------ JoinIBlank ------------------------ */
+
+void JoinIBlank(void){
+  ThreadPoolWait(iblank_task);
+  iblank_task = NULL;
 }
 #else
 void MakeIBlankAll(void){
@@ -392,7 +448,8 @@ void PSystem(char *commandline){
 int Update_Bounds(void){
   UpdateAllBoundaryBounds();
 #ifdef pp_THREAD
-  pthread_join(update_all_patch_bounds_id,NULL);
+  ThreadPoolWait(update_all_patch_bounds_task);
+  update_all_patch_bounds_task = NULL;
 #endif
   return 1;
 }
@@ -402,11 +459,11 @@ int Update_Bounds(void){
 #ifdef pp_THREAD
 void *UpdateAllBoundaryBoundsMT(void *arg){
   UpdateAllBoundaryBoundsST();
-  pthread_exit(NULL);
   return NULL;
 }
 void UpdateAllBoundaryBounds(void){
-  pthread_create(&update_all_patch_bounds_id,NULL, UpdateAllBoundaryBoundsMT,NULL);
+  ThreadPoolWait(update_all_patch_bounds_task); // only one bounds update at a time
+  update_all_patch_bounds_task = ThreadPoolSubmit("boundary bounds", UpdateAllBoundaryBoundsMT, NULL);
 }
 #else
 void UpdateAllBoundaryBounds(void){
@@ -418,6 +475,305 @@ void UpdateAllBoundaryBounds(void){
 
 #ifdef pp_THREAD
 void MtReadVolsmokeAllFramesAllMeshes2(void){
-  pthread_create(&read_volsmoke_id,NULL,ReadVolsmokeAllFramesAllMeshes2,NULL);
+  ThreadPoolRun("volsmoke load", ReadVolsmokeAllFramesAllMeshes2, NULL);
+}
+#endif
+
+//***************************** playback-ahead prefetch ***********************************
+
+/* ------------------ PrefetchDecode ------------------------ */
+
+void PrefetchDecode(prefetchdata *pfi){
+
+// decode frame pfi->iframe of a compressed 3D smoke, slice or boundary file into pfi->buffer .
+// only the compressed data of the file is read so this may be called from a worker thread
+
+  smoke3ddata *smoke3di;
+  slicedata *sd;
+  meshdata *meshi;
+  unsigned char *compressed_data;
+  uLongf countout;
+  int countin;
+
+  switch(pfi->type){
+  case PREFETCH_SMOKE3D:
+    smoke3di = (smoke3ddata *)pfi->object;
+    compressed_data = smoke3di->smokeframe_comp_list[pfi->iframe];
+    countin = smoke3di->nchars_compressed_smoke[pfi->iframe];
+    countout = smoke3di->nchars_uncompressed;
+    if(smoke3di->compression_type==RLE){
+      UnCompressRLE(compressed_data, countin, pfi->buffer);
+    }
+    else{
+      UnCompressZLIB(pfi->buffer, &countout, compressed_data, countin);
+    }
+    break;
+  case PREFETCH_SLICE:
+    sd = (slicedata *)pfi->object;
+    compressed_data = sd->qslicedata_compressed+sd->compindex[pfi->iframe].offset;
+    countin = sd->compindex[pfi->iframe].size;
+    countout = sd->nsliceijk;
+    if(sd->compression_type==COMPRESSED_ZLIB){
+      UnCompressZLIB(pfi->buffer, &countout, compressed_data, countin);
+    }
+    else{
+      UnCompressRLE(compressed_data, countin, pfi->buffer);
+    }
+    break;
+  case PREFETCH_BOUNDARY:
+    meshi = (meshdata *)pfi->object;
+    compressed_data = meshi->cpatchval_zlib+meshi->zipoffset[pfi->iframe];
+    countin = meshi->zipsize[pfi->iframe];
+    countout = meshi->npatchsize;
+    UnCompressZLIB(pfi->buffer, &countout, compressed_data, countin);
+    break;
+  default:
+    ASSERT(FFALSE);
+    break;
+  }
+}
+
+#ifdef pp_THREAD
+/* ------------------ MtPrefetchFrames ------------------------ */
+
+void *MtPrefetchFrames(void *arg){
+  for(;;){
+    prefetchdata *pfi;
+    int i;
+
+    LOCK_PREFETCH
+    for(pfi = NULL;pfi==NULL;){
+      for(i = 0; i<nprefetchinfo; i++){
+        if(prefetchinfo[i].state==PREFETCH_QUEUED){
+          pfi = prefetchinfo+i;
+          break;
+        }
+      }
+      if(pfi==NULL)pthread_cond_wait(&condPREFETCH, &mutexPREFETCH);
+    }
+    pfi->state = PREFETCH_BUSY;
+    UNLOCK_PREFETCH
+
+    PrefetchDecode(pfi);
+
+    LOCK_PREFETCH
+    if(pfi->cancel==1){
+      pfi->state = PREFETCH_EMPTY;
+      pfi->cancel = 0;
+    }
+    else{
+      pfi->state = PREFETCH_READY;
+    }
+    pthread_cond_broadcast(&condPREFETCH);
+    UNLOCK_PREFETCH
+  }
+  return NULL;
+}
+
+/* ------------------ InitPrefetch ------------------------ */
+
+void InitPrefetch(void){
+  int i;
+
+  nprefetchinfo = MAX(prefetch_ringsize, 1);
+  NewMemory((void **)&prefetchinfo, nprefetchinfo*sizeof(prefetchdata));
+  for(i = 0; i<nprefetchinfo; i++){
+    prefetchdata *pfi;
+
+    pfi = prefetchinfo+i;
+    pfi->object = NULL;
+    pfi->state = PREFETCH_EMPTY;
+    pfi->cancel = 0;
+    pfi->buffer = NULL;
+    pfi->nbuffer = 0;
+  }
+  iprefetchinfo = 0;
+  prefetch_nthreads = CLAMP(prefetch_nthreads, 1, MAX_PREFETCH_THREADS);
+  for(i = 0; i<prefetch_nthreads; i++){
+    pthread_create(prefetchthread_ids+i, NULL, MtPrefetchFrames, NULL);
+    pthread_detach(prefetchthread_ids[i]);
+  }
+  prefetch_threads_started = 1;
+}
+
+/* ------------------ PrefetchQueue ------------------------ */
+
+void PrefetchQueue(int type, void *object, int iframe, int nbuffer){
+
+// queue frame iframe of object for decoding, called with the prefetch lock held
+
+  prefetchdata *pfi;
+  int i;
+
+  if(iframe<0)return;
+  for(i = 0; i<nprefetchinfo; i++){
+    pfi = prefetchinfo+i;
+    if(pfi->state!=PREFETCH_EMPTY&&pfi->object==object&&pfi->type==type&&pfi->iframe==iframe)return;
+  }
+
+  // take the oldest slot in the ring, skipping slots that are being decoded
+
+  pfi = NULL;
+  for(i = 0; i<nprefetchinfo; i++){
+    prefetchdata *pfj;
+
+    pfj = prefetchinfo+iprefetchinfo;
+    iprefetchinfo = (iprefetchinfo+1)%nprefetchinfo;
+    if(pfj->state!=PREFETCH_BUSY){
+      pfi = pfj;
+      break;
+    }
+  }
+  if(pfi==NULL)return;
+  pfi->state = PREFETCH_EMPTY;
+  if(pfi->nbuffer<nbuffer){
+    if(NewResizeMemory(pfi->buffer, nbuffer)==0){
+      pfi->buffer = NULL;
+      pfi->nbuffer = 0;
+      return;
+    }
+    pfi->nbuffer = nbuffer;
+  }
+  pfi->type = type;
+  pfi->object = object;
+  pfi->iframe = iframe;
+  pfi->cancel = 0;
+  pfi->state = PREFETCH_QUEUED;
 }
 #endif
+
+/* ------------------ PrefetchFrames ------------------------ */
+
+void PrefetchFrames(void){
+
+// queue the next prefetch_nframes frames, in the direction of playback, of each visible compressed
+// 3D smoke, slice and boundary file.  The frames are decoded by worker threads into a ring buffer
+// and picked up by UpdateSmoke3D, UncompressSliceDataFrame and UncompressBoundaryDataFrame .
+
+#ifdef pp_THREAD
+  int k;
+
+  if(prefetch_nframes<=0||nglobal_times<=1)return;
+  if(prefetch_threads_started==0)InitPrefetch();
+  LOCK_PREFETCH
+  for(k = 1; k<=prefetch_nframes; k++){
+    int itime, i;
+
+    itime = itimes+k*FlowDir;
+    itime = (itime%nglobal_times+nglobal_times)%nglobal_times;
+    if(show3dsmoke==1){
+      for(i = 0; i<nsmoke3dinfo; i++){
+        smoke3ddata *smoke3di;
+
+        smoke3di = smoke3dinfo+i;
+        if(smoke3di->loaded==0||smoke3di->display==0||smoke3di->timeslist==NULL)continue;
+        PrefetchQueue(PREFETCH_SMOKE3D, smoke3di, smoke3di->timeslist[itime], smoke3di->nchars_uncompressed);
+      }
+    }
+    if(showslice==1||showvslice==1){
+      int ii;
+
+      for(ii = 0; ii<nslice_loaded; ii++){
+        slicedata *sd;
+
+        sd = sliceinfo+slice_loaded_list[ii];
+        if(sd->compression_type==UNCOMPRESSED||sd->slice_filetype==SLICE_GEOM||sd->timeslist==NULL)continue;
+        if(sd->display==0&&sd->vloaded==0)continue;
+        PrefetchQueue(PREFETCH_SLICE, sd, sd->timeslist[itime], sd->nsliceijk);
+      }
+    }
+    if(showpatch==1){
+      for(i = 0; i<nmeshes; i++){
+        meshdata *meshi;
+        patchdata *patchi;
+
+        meshi = meshinfo+i;
+        if(meshi->patchfilenum<0||meshi->patchfilenum>npatchinfo-1)continue;
+        patchi = patchinfo+meshi->patchfilenum;
+        if(patchi->structured==NO||patchi->compression_type==UNCOMPRESSED||meshi->patch_timeslist==NULL)continue;
+        PrefetchQueue(PREFETCH_BOUNDARY, meshi, meshi->patch_timeslist[itime], meshi->npatchsize);
+      }
+    }
+  }
+  pthread_cond_broadcast(&condPREFETCH);
+  UNLOCK_PREFETCH
+#endif
+}
+
+/* ------------------ PrefetchGetFrame ------------------------ */
+
+int PrefetchGetFrame(int type, void *object, int iframe, unsigned char **bufferptr, int nbuffer){
+
+// if frame iframe of object has been decoded by a prefetch thread put it in *bufferptr and return 1.
+// The buffers are swapped so no data is copied, except for 3D smoke where other smoke3ddata entries
+// in the same mesh keep pointers to smokeframe_in (smokestate) so the frame is copied instead.
+
+#ifdef pp_THREAD
+  int i, found = 0;
+
+  if(prefetch_nframes<=0||prefetch_threads_started==0)return 0;
+  LOCK_PREFETCH
+  for(i = 0; i<nprefetchinfo; i++){
+    prefetchdata *pfi;
+
+    pfi = prefetchinfo+i;
+    if(pfi->state!=PREFETCH_READY||pfi->object!=object||pfi->type!=type||pfi->iframe!=iframe)continue;
+    if(type==PREFETCH_SMOKE3D){
+      memcpy(*bufferptr, pfi->buffer, nbuffer);
+    }
+    else{
+      unsigned char *buffer;
+
+      buffer = *bufferptr;
+      *bufferptr = pfi->buffer;
+      pfi->buffer = buffer;
+      pfi->nbuffer = nbuffer;
+    }
+    pfi->state = PREFETCH_EMPTY;
+    found = 1;
+    break;
+  }
+  if(found==1){
+    prefetch_hits++;
+  }
+  else{
+    prefetch_misses++;
+  }
+  UNLOCK_PREFETCH
+  return found;
+#else
+  return 0;
+#endif
+}
+
+/* ------------------ PrefetchFlush ------------------------ */
+
+void PrefetchFlush(void){
+
+// discard all prefetched frames and wait for frames being decoded.  Called before a 3D smoke,
+// slice or boundary file is loaded or unloaded since the workers read its compressed data.
+
+#ifdef pp_THREAD
+  if(prefetch_threads_started==0)return;
+  LOCK_PREFETCH
+  for(;;){
+    int i, busy = 0;
+
+    for(i = 0; i<nprefetchinfo; i++){
+      prefetchdata *pfi;
+
+      pfi = prefetchinfo+i;
+      if(pfi->state==PREFETCH_BUSY){
+        pfi->cancel = 1;
+        busy = 1;
+      }
+      else{
+        pfi->state = PREFETCH_EMPTY;
+      }
+    }
+    if(busy==0)break;
+    pthread_cond_wait(&condPREFETCH, &mutexPREFETCH);
+  }
+  UNLOCK_PREFETCH
+#endif
+}
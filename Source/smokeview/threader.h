@@ -4,6 +4,7 @@
 #ifdef pp_THREAD
 #include <pthread.h>
 #endif
+#include "threadpool.h"
 #endif
 
 #ifdef INTHREADER
@@ -13,6 +14,7 @@
 #endif
 
 #define MAX_PART_THREADS 16
+#define MAX_PREFETCH_THREADS 16
 #ifdef pp_SLICETHREAD
 #define MAX_SLICE_THREADS 16
 #endif
@@ -43,10 +45,16 @@
   #define LOCK_VOLLOAD      pthread_mutex_lock(&mutexVOLLOAD);
   #define UNLOCK_VOLLOAD    pthread_mutex_unlock(&mutexVOLLOAD);
 
+  #define LOCK_PREFETCH     pthread_mutex_lock(&mutexPREFETCH);
+  #define UNLOCK_PREFETCH   pthread_mutex_unlock(&mutexPREFETCH);
+
+  #define LOCK_SLICE_FRAMES   pthread_mutex_lock(&mutexSLICE_FRAMES);
+  #define UNLOCK_SLICE_FRAMES pthread_mutex_unlock(&mutexSLICE_FRAMES);
+
 #ifdef pp_THREADIBLANK
   #define LOCK_IBLANK       pthread_mutex_lock(&mutexIBLANK);
   #define UNLOCK_IBLANK     pthread_mutex_unlock(&mutexIBLANK);
-  #define JOIN_IBLANK       pthread_join(makeiblank_thread_id,NULL);
+  #define JOIN_IBLANK       JoinIBlank();
 #else
   #define LOCK_IBLANK
   #define UNLOCK_IBLANK
@@ -80,6 +88,12 @@
   #define LOCK_VOLLOAD
   #define UNLOCK_VOLLOAD
 
+  #define LOCK_PREFETCH
+  #define UNLOCK_PREFETCH
+
+  #define LOCK_SLICE_FRAMES
+  #define UNLOCK_SLICE_FRAMES
+
   #define LOCK_IBLANK
   #define UNLOCK_IBLANK
   #define JOIN_IBLANK
@@ -94,6 +108,7 @@
 
 #ifdef pp_THREAD
 void MtReadVolsmokeAllFramesAllMeshes2(void);
+void JoinIBlank(void);
 #endif
 
 // define mutex's and thread_ids
@@ -101,7 +116,6 @@ void MtReadVolsmokeAllFramesAllMeshes2(void);
 #ifndef CPP
 #ifdef pp_THREAD
 
-MT_EXTERN pthread_t makeiblank_thread_id;
 #ifdef pp_SLICETHREAD
 MT_EXTERN pthread_mutex_t mutexSLICE_LOAD;
 #endif
@@ -109,6 +123,9 @@ MT_EXTERN pthread_mutex_t mutexPART_LOAD;
 MT_EXTERN pthread_mutex_t mutexIBLANK;
 MT_EXTERN pthread_mutex_t mutexVOLLOAD;
 MT_EXTERN pthread_mutex_t mutexCOMPRESS;
+MT_EXTERN pthread_mutex_t mutexPREFETCH;
+MT_EXTERN pthread_mutex_t mutexSLICE_FRAMES;
+MT_EXTERN pthread_cond_t condPREFETCH;
 #ifdef pp_ISOTHREAD
 MT_EXTERN pthread_mutex_t mutexTRIANGLES;
 #endif
@@ -118,13 +135,8 @@ MT_EXTERN pthread_mutex_t mutexSAMPLE;
 
 MT_EXTERN pthread_t system_thread_id;
 MT_EXTERN pthread_t compress_thread_id;
-MT_EXTERN pthread_t update_all_patch_bounds_id;
-MT_EXTERN pthread_t read_volsmoke_id;
-MT_EXTERN pthread_t triangles_id;
-MT_EXTERN pthread_t partthread_ids[MAX_PART_THREADS];
-#ifdef pp_SLICETHREAD
-MT_EXTERN pthread_t slicethread_ids[MAX_SLICE_THREADS];
-#endif
+MT_EXTERN pthread_t prefetchthread_ids[MAX_PREFETCH_THREADS];
+MT_EXTERN taskdata *iblank_task, *update_all_patch_bounds_task, *triangles_task;
 #ifdef pp_SAMPLE
 MT_EXTERN pthread_t sample_thread_id;
 #endif
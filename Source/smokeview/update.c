@@ -15,6 +15,7 @@
 #include "glui_smoke.h"
 #include "glui_motion.h"
 #include "glui_wui.h"
+#include "threadpool.h"
 
 /* ------------------ CompareFloat ------------------------ */
 
@@ -176,6 +177,7 @@ void UpdateFrameNumber(int changetime){
           if(sd->timeslist == NULL)continue;
           sd->itime = sd->timeslist[itimes];
           slice_time = sd->itime;
+          if(sd->paged==1)GetSliceFrame(sd, sd->itime, NULL);
         }
       }
       for (i = 0; i < npatchinfo; i++) {
@@ -192,18 +194,7 @@ void UpdateFrameNumber(int changetime){
     }
     if(show3dsmoke==1){
       if(nsmoke3dinfo > 0){
-        for(i = 0;i < nsmoke3dinfo;i++){
-          smoke3ddata *smoke3di;
-
-          smoke3di = smoke3dinfo + i;
-          if(smoke3di->loaded == 0 || smoke3di->display == 0)continue;
-          smoke3di->ismoke3d_time = smoke3di->timeslist[itimes];
-          if(IsSmokeComponentPresent(smoke3di) == 0)continue;
-          if(smoke3di->ismoke3d_time != smoke3di->lastiframe){
-            smoke3di->lastiframe = smoke3di->ismoke3d_time;
-            UpdateSmoke3D(smoke3di);
-          }
-        }
+        UpdateSmoke3DFrames();
         if(use_newsmoke==SMOKE3D_ORIG||use_newsmoke==SMOKE3D_NEW){
           MergeSmoke3D(NULL);
           PrintMemoryInfo;
@@ -239,6 +230,7 @@ void UpdateFrameNumber(int changetime){
         }
       }
     }
+    PrefetchFrames();
     if(showiso==1){
       isodata *isoi;
       meshdata *meshi;
@@ -257,6 +249,326 @@ void UpdateFrameNumber(int changetime){
   }
 }
 
+/* ------------------ GetMemoryTypeLabel  ------------------------ */
+
+char *GetMemoryTypeLabel(int memory_type){
+  char *labels[NMEMORY_TYPES] = {"other", "slice", "boundary", "3d smoke", "particle", "isosurface", "geometry"};
+
+  if(memory_type<0||memory_type>=NMEMORY_TYPES)return labels[MEMORY_OTHER];
+  return labels[memory_type];
+}
+
+/* ------------------ GetMemoryTypesLabel  ------------------------ */
+
+void GetMemoryTypesLabel(char *label){
+
+// label giving the memory used by each type of loaded file, for example "slice 900 MB boundary 300 MB"
+
+  MMsize type_bytes[MAX_MEMORY_TYPES];
+  int i;
+
+  GetMemoryTypeBytes(type_bytes);
+  strcpy(label, "");
+  for(i = MEMORY_SLICE; i<NMEMORY_TYPES; i++){
+    char size_label[32];
+
+    if(type_bytes[i]<1000000)continue;
+    getMemusage(type_bytes[i], size_label);
+    if(strlen(label)>0)strcat(label, " ");
+    strcat(label, GetMemoryTypeLabel(i));
+    strcat(label, " ");
+    strcat(label, size_label);
+  }
+  if(strlen(label)==0)strcpy(label, "no data loaded");
+}
+
+/* ------------------ CompareMemoryFiles  ------------------------ */
+
+int CompareMemoryFiles(const void *arg1, const void *arg2){
+  memoryfiledata *mf1, *mf2;
+
+  mf1 = (memoryfiledata *)arg1;
+  mf2 = (memoryfiledata *)arg2;
+  if(mf1->bytes>mf2->bytes)return -1;
+  if(mf1->bytes<mf2->bytes)return 1;
+  return 0;
+}
+
+/* ------------------ GetMemoryFiles  ------------------------ */
+
+int GetMemoryFiles(memoryfiledata **memoryfilesptr){
+
+// return the number of loaded files and, in *memoryfilesptr, the memory id and size of each.
+// the list is freed by the caller
+
+  memoryfiledata *memoryfiles = NULL;
+  int i, nmemoryfiles = 0, nmemoryfiles_max;
+
+  *memoryfilesptr = NULL;
+  nmemoryfiles_max = nsliceinfo+npatchinfo+nsmoke3dinfo+npartinfo+nisoinfo+ngeominfo;
+  if(nmemoryfiles_max==0||NewMemory((void **)&memoryfiles, nmemoryfiles_max*sizeof(memoryfiledata))==0)return 0;
+#define ADD_MEMORY_FILE(info, ninfo, type, last)                 \
+  for(i = 0; i<(ninfo); i++){                                    \
+    memoryfiledata *mf;                                          \
+                                                                 \
+    if((info)[i].loaded==0||(info)[i].memory_id<=0)continue;     \
+    mf = memoryfiles+nmemoryfiles++;                             \
+    mf->memory_id = (info)[i].memory_id;                         \
+    mf->memory_type = type;                                      \
+    mf->index = i;                                               \
+    mf->last_display = last;                                     \
+    mf->bytes = GetMemoryIdBytes(mf->memory_id);                 \
+    mf->file = (info)[i].file;                                   \
+  }
+  ADD_MEMORY_FILE(sliceinfo,   nsliceinfo,   MEMORY_SLICE,    sliceinfo[i].last_display);
+  ADD_MEMORY_FILE(patchinfo,   npatchinfo,   MEMORY_BOUNDARY, patchinfo[i].last_display);
+  ADD_MEMORY_FILE(smoke3dinfo, nsmoke3dinfo, MEMORY_SMOKE3D,  smoke3dinfo[i].last_display);
+  ADD_MEMORY_FILE(partinfo,    npartinfo,    MEMORY_PART,     partinfo[i].last_display);
+  ADD_MEMORY_FILE(isoinfo,     nisoinfo,     MEMORY_ISO,      isoinfo[i].last_display);
+  ADD_MEMORY_FILE(geominfo,    ngeominfo,    MEMORY_GEOM,     memory_display_count);
+  *memoryfilesptr = memoryfiles;
+  return nmemoryfiles;
+}
+
+/* ------------------ PrintMemoryReport  ------------------------ */
+
+void PrintMemoryReport(int option){
+
+// print the memory used by each type of file and by each loaded file (largest first).
+// option==0 only prints if a total changed by more than 1 MB since the last report
+
+  static MMsize type_bytes_old[MAX_MEMORY_TYPES];
+  MMsize type_bytes[MAX_MEMORY_TYPES], total_bytes = 0;
+  memoryfiledata *memoryfiles = NULL;
+  char size_label[32];
+  int i, nmemoryfiles, changed = 0;
+
+  GetMemoryTypeBytes(type_bytes);
+  for(i = 0; i<NMEMORY_TYPES; i++){
+    MMsize delta;
+
+    delta = type_bytes[i]>type_bytes_old[i] ? type_bytes[i]-type_bytes_old[i] : type_bytes_old[i]-type_bytes[i];
+    if(delta>1000000)changed = 1;
+    total_bytes += type_bytes[i];
+  }
+  if(option==0&&changed==0)return;
+  memcpy(type_bytes_old, type_bytes, sizeof(type_bytes));
+
+  nmemoryfiles = GetMemoryFiles(&memoryfiles);
+  if(nmemoryfiles>1)qsort(memoryfiles, nmemoryfiles, sizeof(memoryfiledata), CompareMemoryFiles);
+
+  PRINTF("memory usage\n");
+  for(i = 0; i<NMEMORY_TYPES; i++){
+    if(type_bytes[i]==0)continue;
+    getMemusage(type_bytes[i], size_label);
+    PRINTF("  %-12s %10s\n", GetMemoryTypeLabel(i), size_label);
+  }
+  getMemusage(total_bytes, size_label);
+  PRINTF("  %-12s %10s\n", "total", size_label);
+  if(memory_budget>0)PRINTF("  %-12s %7i MB\n", "budget", memory_budget);
+  for(i = 0; i<nmemoryfiles; i++){
+    memoryfiledata *mf;
+
+    mf = memoryfiles+i;
+    getMemusage(mf->bytes, size_label);
+    PRINTF("  %10s %-10s %s\n", size_label, GetMemoryTypeLabel(mf->memory_type), mf->file);
+  }
+  FREEMEMORY(memoryfiles);
+}
+
+/* ------------------ UpdateMemoryDisplayTimes  ------------------------ */
+
+void UpdateMemoryDisplayTimes(void){
+
+// record when each loaded file was last visible, used to pick the files unloaded by EnforceMemoryBudget
+
+  int i;
+
+  if(memory_budget<=0)return;
+  memory_display_count++;
+  for(i = 0; i<nslice_loaded; i++){
+    slicedata *slicei;
+
+    slicei = sliceinfo+slice_loaded_list[i];
+    if(slicei->display==1&&slicei->slicefile_labelindex==slicefile_labelindex)slicei->last_display = memory_display_count;
+  }
+  for(i = 0; i<npatchinfo; i++){
+    patchdata *patchi;
+
+    patchi = patchinfo+i;
+    if(patchi->loaded==1&&patchi->display==1)patchi->last_display = memory_display_count;
+  }
+  for(i = 0; i<nsmoke3dinfo; i++){
+    smoke3ddata *smoke3di;
+
+    smoke3di = smoke3dinfo+i;
+    if(smoke3di->loaded==1&&smoke3di->display==1)smoke3di->last_display = memory_display_count;
+  }
+  for(i = 0; i<npartinfo; i++){
+    partdata *parti;
+
+    parti = partinfo+i;
+    if(parti->loaded==1&&parti->display==1)parti->last_display = memory_display_count;
+  }
+  for(i = 0; i<nisoinfo; i++){
+    isodata *isoi;
+
+    isoi = isoinfo+i;
+    if(isoi->loaded==1&&isoi->display==1)isoi->last_display = memory_display_count;
+  }
+}
+
+/* ------------------ CompareMemoryDisplay  ------------------------ */
+
+int CompareMemoryDisplay(const void *arg1, const void *arg2){
+  memoryfiledata *mf1, *mf2;
+
+  // least recently displayed first, largest first if displayed at the same time
+
+  mf1 = (memoryfiledata *)arg1;
+  mf2 = (memoryfiledata *)arg2;
+  if(mf1->last_display<mf2->last_display)return -1;
+  if(mf1->last_display>mf2->last_display)return 1;
+  return CompareMemoryFiles(arg1, arg2);
+}
+
+/* ------------------ GetMemoryLoadSize  ------------------------ */
+
+FILE_SIZE GetMemoryLoadSize(char *file, int memory_id, int *last_display){
+
+// estimate the memory needed to load file (its size less the memory it already uses if it is
+// being reloaded) and mark it as displayed so it is not unloaded while other files are loaded
+
+  FILE_SIZE file_size, bytes;
+
+  if(last_display!=NULL)*last_display = memory_display_count;
+  if(memory_budget<=0||file==NULL)return 0;
+  file_size = GetFileSizeSMV(file);
+  bytes = (FILE_SIZE)GetMemoryIdBytes(memory_id);
+  return file_size>bytes ? file_size-bytes : 0;
+}
+
+/* ------------------ DegradeSliceMemory  ------------------------ */
+
+int DegradeSliceMemory(int islice){
+
+// reload a slice so that only a frame index is kept in memory, frames are then read
+// from the file when displayed.  return 1 if the slice was reloaded
+
+  slicedata *slicei;
+  int errorcode, display, labelindex;
+
+  slicei = sliceinfo+islice;
+  if(slicei->compression_type!=UNCOMPRESSED||slicei->paged==1||slicei->vloaded==1||slicei->is_fed==1)return 0;
+  if(slicei->slice_filetype==SLICE_GEOM||slice_average_flag==1||slicei->ntimes<2)return 0;
+  display = slicei->display;
+  labelindex = slicefile_labelindex;
+  slicei->force_paged = 1;
+  ReadSlice(slicei->file, islice, ALL_SLICE_FRAMES, NULL, LOAD, SET_SLICECOLOR, &errorcode);
+  slicei->display = display;
+  slicefile_labelindex = labelindex;
+  return (errorcode==0&&slicei->paged==1) ? 1 : 0;
+}
+
+/* ------------------ UnloadMemoryFile  ------------------------ */
+
+void UnloadMemoryFile(memoryfiledata *mf){
+  int errorcode;
+
+  switch(mf->memory_type){
+    case MEMORY_SLICE:
+      ReadSlice("", mf->index, ALL_SLICE_FRAMES, NULL, UNLOAD, SET_SLICECOLOR, &errorcode);
+      break;
+    case MEMORY_BOUNDARY:
+      ReadBoundary(mf->index, UNLOAD, &errorcode);
+      break;
+    case MEMORY_SMOKE3D:
+      ReadSmoke3D(ALL_SMOKE_FRAMES, mf->index, UNLOAD, FIRST_TIME, &errorcode);
+      break;
+    case MEMORY_PART:
+      partinfo[mf->index].finalize = 1;
+      ReadPart("", mf->index, UNLOAD, &errorcode);
+      break;
+    case MEMORY_ISO:
+      ReadIso("", mf->index, UNLOAD, NULL, &errorcode);
+      break;
+    default:
+      ASSERT(FFALSE);
+      break;
+  }
+}
+
+/* ------------------ GetLoadedMemory  ------------------------ */
+
+MMsize GetLoadedMemory(void){
+  MMsize type_bytes[MAX_MEMORY_TYPES], used_bytes = 0;
+  int i;
+
+  GetMemoryTypeBytes(type_bytes);
+  for(i = MEMORY_SLICE; i<NMEMORY_TYPES; i++){
+    used_bytes += type_bytes[i];
+  }
+  return used_bytes;
+}
+
+/* ------------------ EnforceMemoryBudget  ------------------------ */
+
+void EnforceMemoryBudget(FILE_SIZE load_size){
+
+// make room for load_size bytes of new data within memory_budget MB.  slices not displayed
+// recently are first reloaded so only a frame index is kept (see DegradeSliceMemory), then
+// least recently displayed files are unloaded.  files displayed or loaded since the last
+// display update (last_display==memory_display_count) are kept
+
+  static int in_budget = 0;
+  memoryfiledata *memoryfiles;
+  MMsize used_bytes, budget_bytes;
+  int pass, nmemoryfiles, ndegraded = 0, nunloaded = 0;
+
+  if(memory_budget<=0||in_budget==1||ThreadPoolIsWorker()==1)return;
+  budget_bytes = (MMsize)memory_budget*1000000;
+
+  used_bytes = GetLoadedMemory();
+  if(used_bytes+load_size<=budget_bytes)return;
+
+  in_budget = 1;
+  nmemoryfiles = GetMemoryFiles(&memoryfiles);
+  if(nmemoryfiles>1)qsort(memoryfiles, nmemoryfiles, sizeof(memoryfiledata), CompareMemoryDisplay);
+  for(pass = 0; pass<2&&used_bytes+load_size>budget_bytes; pass++){
+    int j;
+
+    for(j = 0; j<nmemoryfiles&&used_bytes+load_size>budget_bytes; j++){
+      memoryfiledata *mf;
+
+      mf = memoryfiles+j;
+      if(mf->last_display>=memory_display_count||mf->memory_type==MEMORY_GEOM)continue;
+      if(pass==0){
+        if(mf->memory_type==MEMORY_SLICE&&DegradeSliceMemory(mf->index)==1)ndegraded++;
+      }
+      else{
+        if(mf->memory_type==MEMORY_SLICE&&sliceinfo[mf->index].vloaded==1)continue;
+        if(GetMemoryIdBytes(mf->memory_id)==0)continue;
+        UnloadMemoryFile(mf);
+        nunloaded++;
+      }
+      used_bytes = GetLoadedMemory();
+    }
+  }
+  FREEMEMORY(memoryfiles);
+  in_budget = 0;
+  if(ndegraded>0||nunloaded>0){
+    PRINTF("memory budget: %i slice files paged, %i files unloaded\n", ndegraded, nunloaded);
+    updatemenu = 1;
+  }
+  if(used_bytes+load_size>budget_bytes){
+    char used_label[32], load_label[32];
+
+    getMemusage(used_bytes, used_label);
+    getMemusage(load_size, load_label);
+    fprintf(stderr, "***warning: %s loaded and %s to load exceeds the memory budget of %i MB\n", used_label, load_label, memory_budget);
+  }
+}
+
 /* ------------------ UpdateFileLoad  ------------------------ */
 
 void UpdateFileLoad(void){
@@ -346,6 +658,7 @@ void UpdateFileLoad(void){
     if(parti->loaded==1&&parti->evac==1)nevacloaded++;
     if(parti->loaded==1)npart5loaded++;
   }
+  if(show_memory_report==1)PrintMemoryReport(0);
 }
 
 /* ------------------ UpdateShow ------------------------ */
@@ -356,6 +669,7 @@ void UpdateShow(void){
   int shooter_flag;
 
   if(update_fileload==1)UpdateFileLoad();
+  UpdateMemoryDisplayTimes();
   have_fire = HaveFire();
   showtime=0;
   showtime2=0;
@@ -1793,6 +2107,7 @@ void UpdateShowScene(void){
   if(loadfiles_at_startup==1&&update_load_files == 1){
     LoadFiles();
   }
+  if(follow_files==1&&follow_timer==0)StartFollowFiles();
   if(update_startup_view == 1){
     cameradata *ca;
 
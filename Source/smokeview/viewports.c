@@ -151,6 +151,7 @@ void GetViewportInfo(void){
 #ifdef pp_memstatus
   if(doit==0&&visAvailmemory==1)doit=1;
 #endif
+  if(doit==0&&visMemorytypes==1)doit=1;
 
   VP_timebar.left = titlesafe_offset;
   VP_timebar.down = titlesafe_offset;
@@ -751,6 +752,10 @@ void ViewportTimebar(int quad, GLint screen_left, GLint screen_down) {
   if(visFramerate==1&&showtime==1){
     sprintf(frameratelabel," Frame rate:%4.1f",framerate);
     OutputText(right_label_pos,v_space,frameratelabel);
+    if(prefetch_nframes>0&&prefetch_hits+prefetch_misses>0){
+      sprintf(frameratelabel," Prefetch:%3.0f%%",100.0*(float)prefetch_hits/(float)(prefetch_hits+prefetch_misses));
+      OutputText(right_label_pos,2*v_space+VP_timebar.text_height,frameratelabel);
+    }
   }
   if(show_slice_average==1&&vis_slice_average==1&&slice_average_flag==1){
     sprintf(frameratelabel," AVG: %4.1f",slice_average_interval);
@@ -844,6 +849,18 @@ void ViewportTimebar(int quad, GLint screen_left, GLint screen_down) {
       }
   }
 #endif
+  if(visMemorytypes==1){
+    char memtypes_label[256];
+    int memtypes_pos, memtypes_row;
+
+    // memory used by each type of loaded file, right justified above the frame rate and memory labels
+
+    GetMemoryTypesLabel(memtypes_label);
+    memtypes_pos = MIN(right_label_pos, VP_timebar.right-GetStringWidth(memtypes_label)-h_space);
+    memtypes_row = 2;
+    if(show_slice_average==1&&vis_slice_average==1&&slice_average_flag==1)memtypes_row = 3;
+    OutputText(memtypes_pos, (memtypes_row+1)*v_space+memtypes_row*VP_timebar.text_height, memtypes_label);
+  }
 }
 
 /* --------------------- ViewportVerticalColorbar ------------------------- */
@@ -5,30 +5,31 @@
 #include "MALLOCC.h"
 #include "zlib.h"
 #include "svzip.h"
+#include "threadpool.h"
 
 /* ------------------ mt_compress_all ------------------------ */
 #ifdef pp_THREAD
 void mt_compress_all(void){
   int i;
-  pthread_t *thread_ids;
+  taskdata **tasks;
   int *index;
 
-  NewMemory((void **)&thread_ids,mt_nthreads*sizeof(pthread_t));
+  ThreadPoolInit(mt_nthreads);
+  NewMemory((void **)&tasks,mt_nthreads*sizeof(taskdata *));
   NewMemory((void **)&index,mt_nthreads*sizeof(int));
   NewMemory((void **)&threadinfo,mt_nthreads*sizeof(threaddata));
 
   for(i=0;i<mt_nthreads;i++){
     index[i]=i;
-    pthread_create(&thread_ids[i],NULL,compress_all,&index[i]);
     threadinfo[i].stat=-1;
   }
-
   for(i=0;i<mt_nthreads;i++){
-    pthread_join(thread_ids[i],NULL);
+    tasks[i] = ThreadPoolSubmit("compress",compress_all,&index[i]);
   }
+  ThreadPoolWaitAll(tasks,mt_nthreads);
 
   print_summary();
-  FREEMEMORY(thread_ids);
+  FREEMEMORY(tasks);
   FREEMEMORY(index);
   FREEMEMORY(threadinfo);
 }
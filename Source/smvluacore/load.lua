@@ -85,6 +85,23 @@ function load.slice_std(slice_type, axis, distance)
     end)
 end
 
+-- Restrict 3D slice and 3D smoke files loaded afterwards to the box
+-- xmin..xmax, ymin..ymax, zmin..zmax.
+function load.box(xmin, xmax, ymin, ymax, zmin, zmax)
+    setloadbox(1, xmin, xmax, ymin, ymax, zmin, zmax)
+end
+
+-- Restrict 3D slice and 3D smoke files loaded afterwards to the region
+-- inside the clip planes.
+function load.clipbox()
+    setloadbox(2, 0, 0, 0, 0, 0, 0)
+end
+
+-- Load 3D slice and 3D smoke files over whole meshes.
+function load.wholemesh()
+    setloadbox(0, 0, 0, 0, 0, 0, 0)
+end
+
 -- TODO: load using path relative to simulation directory
 function load.datafile(filename)
     local errorcode = loaddatafile(filename)
@@ -0,0 +1,133 @@
+#!/bin/bash
+# time how long smokeview takes to read a large synthetic .smv file.  The case has
+# nmeshes meshes each with nobsts blockages, nslices slice files and nbndfs boundary
+# files (about 1,000,000 lines with the defaults).  The data files do not exist so
+# only the time to parse the .smv file is measured.  smokeview is run twice, the
+# second run uses the casename.smvidx cache written by the first.
+
+SMV=smokeview
+nmeshes=1000
+nobsts=200
+nslices=100
+nbndfs=10
+dir=/tmp/smv_startup_benchmark
+keep=
+
+function usage {
+  echo "Usage: smv_startup_benchmark.sh [options]"
+  echo ""
+  echo "time reading a synthetic .smv file"
+  echo ""
+  echo "Options:"
+  echo " -b nbndfs  - boundary files per mesh [default: $nbndfs]"
+  echo " -d dir     - directory where the case is created [default: $dir]"
+  echo " -e exe     - smokeview executable [default: $SMV]"
+  echo " -h         - display this message"
+  echo " -k         - keep the case when done"
+  echo " -m nmeshes - number of meshes [default: $nmeshes]"
+  echo " -o nobsts  - blockages per mesh [default: $nobsts]"
+  echo " -s nslices - slice files per mesh [default: $nslices]"
+  exit
+}
+
+while getopts 'b:d:e:hkm:o:s:' OPTION
+do
+case $OPTION  in
+  b)
+   nbndfs="$OPTARG"
+   ;;
+  d)
+   dir="$OPTARG"
+   ;;
+  e)
+   SMV="$OPTARG"
+   ;;
+  h)
+   usage
+   ;;
+  k)
+   keep=1
+   ;;
+  m)
+   nmeshes="$OPTARG"
+   ;;
+  o)
+   nobsts="$OPTARG"
+   ;;
+  s)
+   nslices="$OPTARG"
+   ;;
+esac
+done
+shift $(($OPTIND-1))
+
+mkdir -p $dir
+casename=synthetic
+smvfile=$dir/$casename.smv
+
+awk -v nmeshes=$nmeshes -v nobsts=$nobsts -v nslices=$nslices -v nbndfs=$nbndfs -v casename=$casename '
+BEGIN {
+  n = 8;
+  print "TITLE";
+  print " synthetic smokeview startup benchmark";
+  print "CHID";
+  print " " casename;
+  print "";
+  for(m = 1; m <= nmeshes; m++){
+    x0 = (m-1)%100; y0 = int((m-1)/100);
+    printf("GRID  MESH%05i\n %i %i %i 0\n\n", m, n, n, n);
+    printf("PDIM\n %f %f %f %f %f %f 0.0 0.0 0.0\n\n", x0, x0+1.0, y0, y0+1.0, 0.0, 1.0);
+    split("TRNX TRNY TRNZ", trn, " ");
+    base[1] = x0; base[2] = y0; base[3] = 0.0;
+    for(d = 1; d <= 3; d++){
+      printf("%s\n 0\n", trn[d]);
+      for(i = 0; i <= n; i++){
+        printf(" %i %f\n", i, base[d]+i/n);
+      }
+      print "";
+    }
+    printf("OBST\n %i\n", nobsts);
+    for(i = 1; i <= nobsts; i++){
+      ii = (i-1)%n;
+      printf(" %f %f %f %f %f %f %i -1 -1 -1 -1 -1 -1\n", x0+ii/n, x0+(ii+1)/n, y0, y0+1.0/n, 0.0, 1.0/n, i);
+    }
+    for(i = 1; i <= nobsts; i++){
+      ii = (i-1)%n;
+      printf(" %i %i 0 1 0 1 -1 0\n", ii, ii+1);
+    }
+    print "";
+    print "VENT";
+    print " 0 0";
+    print "";
+  }
+  for(m = 1; m <= nmeshes; m++){
+    for(i = 1; i <= nslices; i++){
+      printf("SLCF %i # STRUCTURED & 0 %i 0 %i %i %i\n", m, n, n, i%n, i%n);
+      printf(" %s_%04i_%02i.sf\n TEMPERATURE\n temp\n C\n", casename, m, i);
+    }
+    for(i = 1; i <= nbndfs; i++){
+      printf("BNDF %i %i\n", m, i);
+      printf(" %s_%04i_%02i.bf\n WALL TEMPERATURE\n wall_temp\n C\n", casename, m, i);
+    }
+  }
+}' > $smvfile
+
+echo "$smvfile: `wc -l < $smvfile` lines"
+
+cd $dir
+rm -f $casename.smvidx
+
+# the first run parses the text .smv file and writes casename.smvidx, the second run uses it
+
+for run in cold warm; do
+  start=`date +%s.%N`
+  $SMV -info $casename > $casename.log 2>&1
+  stop=`date +%s.%N`
+  echo "$run start:"
+  grep "pass\|.smv file\|setup" $casename.log
+  echo "startup time: `awk -v t1=$start -v t2=$stop 'BEGIN{printf("%.2f", t2-t1)}'` s"
+done
+
+if [ "$keep" == "" ]; then
+  rm -f $dir/$casename*
+fi
@@ -0,0 +1,11 @@
+#!/bin/bash
+# time loading the particle files of parttest with the frames decoded serially
+# and on the worker threads (GetPartData).
+# parttest must be run first.  set SMV to the smokeview to test
+
+CURDIR=`pwd`
+SMV=${SMV:-smokeview}
+
+cd $CURDIR/../Parttest
+$SMV -task_timings -script parttest_benchmark.ssf parttest | grep "particle decode"
+cd $CURDIR
@@ -0,0 +1,28 @@
+#!/bin/bash
+# time the CPU volume smoke ray integration (ComputeAllSmokecolors) of voltest2
+# with one and with all worker threads and check that the rendered images match.
+# voltest2 must be run first (Run_cases_voltest.sh).  set SMV to the smokeview to test
+
+CURDIR=`pwd`
+SMV=${SMV:-smokeview}
+
+cd $CURDIR/../Voltest
+rm -f frames/voltest2_serial*.png frames/voltest2_parallel*.png
+
+$SMV -nogpu -task_timings -script voltest2_benchmark.ssf voltest2 | grep "volume smoke colors"
+
+SERIAL=`ls frames/voltest2_serial*.png 2> /dev/null | head -1`
+PARALLEL=`ls frames/voltest2_parallel*.png 2> /dev/null | head -1`
+if [ "$SERIAL" == "" ] || [ "$PARALLEL" == "" ]; then
+  echo "***error: voltest2 images were not rendered"
+  cd $CURDIR
+  exit 1
+fi
+if cmp -s $SERIAL $PARALLEL; then
+  echo "serial and parallel images are identical"
+else
+  echo "***error: serial and parallel images differ"
+  cd $CURDIR
+  exit 1
+fi
+cd $CURDIR
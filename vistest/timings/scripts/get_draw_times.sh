@@ -0,0 +1,87 @@
+#!/bin/bash
+
+# time drawing a case in several drawing modes.  The smokeview script
+# script.ssf loads the data to be drawn and switches between the modes with
+# LOADINIFILE script_mode.ini, so one smokeview run times every mode.  The
+# times reported are the average time per frame spent drawing in each mode,
+# including the time for the GPU to finish drawing, as output by
+# smokeview -task_timings on the "type draw" lines.
+#
+# usage: get_draw_times.sh [-C casedir] [-e smokeview] [-n] -c case -s script -t type mode1 mode2 ...
+#
+# slice planes: get_draw_times.sh -c slice_timing    -s slice_timing_draw    -t slice    immediate vbo
+# blockages:    get_draw_times.sh -c blockage_timing -s blockage_timing_draw -t blockage immediate vbo
+# particles:    get_draw_times.sh -c slice_timing    -s part_timing_draw     -t particle cpu gpu lod
+# boundaries:   get_draw_times.sh -c isotest1        -s isotest1_bndfdraw    -t boundary cpu gpu
+
+CURDIR=`pwd`
+SMOKEVIEW=smokeview
+SETUP_XSERVER=1
+CASE=
+SCRIPT=
+TYPE=
+CASEDIR=$CURDIR/../cases
+
+while getopts 'c:C:e:ns:t:' OPTION
+do
+case $OPTION in
+  c)
+   CASE="$OPTARG"
+   ;;
+  C)
+   CASEDIR="$OPTARG"
+   ;;
+  e)
+   SMOKEVIEW="$OPTARG"
+   ;;
+  n)
+  SETUP_XSERVER=
+   ;;
+  s)
+   SCRIPT="$OPTARG"
+   ;;
+  t)
+   TYPE="$OPTARG"
+   ;;
+esac
+done
+shift $(($OPTIND-1))
+MODES="$@"
+
+if [ "$CASE" == "" ] || [ "$SCRIPT" == "" ] || [ "$TYPE" == "" ] || [ "$MODES" == "" ]; then
+  echo "usage: get_draw_times.sh [-C casedir] [-e smokeview] [-n] -c case -s script -t type mode1 mode2 ..."
+  exit
+fi
+
+cd ../../../
+smvrepo=`pwd`
+if [ ! -d $CASEDIR ]; then
+  echo "***error the directory $CASEDIR does not exist"
+  exit
+fi
+cd $CASEDIR
+if [ ! -e ${CASE}.smv ]; then
+  echo "***error the case $CASE has not been run"
+  exit
+fi
+if [ ! -e ${SCRIPT}.ssf ]; then
+  echo "***error the script ${SCRIPT}.ssf does not exist"
+  exit
+fi
+for MODE in $MODES; do
+  if [ ! -e ${SCRIPT}_${MODE}.ini ]; then
+    echo "***error the mode file ${SCRIPT}_${MODE}.ini does not exist"
+    exit
+  fi
+  if [ "`grep ${SCRIPT}_${MODE}.ini ${SCRIPT}.ssf`" == "" ]; then
+    echo "***warning ${SCRIPT}.ssf does not load ${SCRIPT}_${MODE}.ini"
+  fi
+done
+if [ "$SETUP_XSERVER" == "1" ]; then
+  source $smvrepo/Utilities/Scripts/startXserver.sh >/dev/null 2>&1
+fi
+$SMOKEVIEW -task_timings -script ${SCRIPT}.ssf $CASE | grep "^$TYPE draw"
+if [ "$SETUP_XSERVER" == "1" ]; then
+  source $smvrepo/Utilities/Scripts/stopXserver.sh >/dev/null 2>&1
+fi
+cd $CURDIR
@@ -0,0 +1,69 @@
+#!/bin/bash
+
+# time loading the 3D slice files of the slice_timing case using each of the
+# slice file readers: Fortran (FORTgetslicedata), C fread (GetSliceData)
+# and C memory mapped (GetSliceDataMMap).  The startup time is reported
+# separately so that it can be subtracted from the load times.
+
+CURDIR=`pwd`
+SMOKEVIEW=
+LABEL=smokeview
+SETUP_XSERVER=1
+CASE=slice_timing
+CASEDIR=$CURDIR/../cases
+TIMEFILE=timefile.$$
+
+while getopts 'c:C:e:l:n' OPTION
+do
+case $OPTION in
+  c)
+   CASE="$OPTARG"
+   ;;
+  C)
+   CASEDIR="$OPTARG"
+   ;;
+  e)
+   SMOKEVIEW="$OPTARG"
+   ;;
+  l)
+   LABEL="$OPTARG"
+   ;;
+  n)
+  SETUP_XSERVER=
+   ;;
+esac
+done
+shift $(($OPTIND-1))
+
+if [ "$SMOKEVIEW" != "" ]; then
+  if [ -e $SMOKEVIEW ]; then
+    SMOKEVIEW="-e $SMOKEVIEW"
+  else
+    exit
+  fi
+fi
+
+cd ../../../
+smvrepo=`pwd`
+if [ ! -d $CASEDIR ]; then
+  echo "***error the directory $CASEDIR does not exist"
+  exit
+fi
+cd $CASEDIR
+if [ ! -e ${CASE}.smv ]; then
+  echo "***error the case $CASE has not been run"
+  exit
+fi
+if [ "$SETUP_XSERVER" == "1" ]; then
+  source $smvrepo/Utilities/Scripts/startXserver.sh >/dev/null 2>&1
+fi
+time0=`$smvrepo/Utilities/Scripts/smokeview.sh $SMOKEVIEW -t $TIMEFILE -s ${CASE}_startup.ssf $CASE`
+time1=`$smvrepo/Utilities/Scripts/smokeview.sh $SMOKEVIEW -t $TIMEFILE -s ${CASE}_fortran.ssf $CASE`
+time2=`$smvrepo/Utilities/Scripts/smokeview.sh $SMOKEVIEW -t $TIMEFILE -s ${CASE}_fread.ssf   $CASE`
+time3=`$smvrepo/Utilities/Scripts/smokeview.sh $SMOKEVIEW -t $TIMEFILE -s ${CASE}_mmap.ssf    $CASE`
+echo label,startup,fortran,fread,mmap
+echo $LABEL,$time0,$time1,$time2,$time3
+if [ "$SETUP_XSERVER" == "1" ]; then
+  source $smvrepo/Utilities/Scripts/stopXserver.sh >/dev/null 2>&1
+fi
+cd $CURDIR